@@ -2,16 +2,50 @@
 #define ENGINE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct Engine Engine;
 
+typedef enum {
+    ENGINE_RENDERER_OPENGL = 0,
+    ENGINE_RENDERER_NULL,       // Records every call into a command log, needs no GPU
+} EngineRendererType;
+
+typedef enum {
+    ENGINE_PLATFORM_SDL = 0,
+    ENGINE_PLATFORM_HEADLESS,   // No window or display - use with ENGINE_RENDERER_NULL
+} EnginePlatformType;
+
+// Optional heap hooks with malloc/realloc/free semantics; returned memory must be aligned
+// for any type. All three functions must be set.
+typedef struct EngineAllocator {
+    void* (*alloc)(void* user, size_t size);
+    void* (*realloc)(void* user, void* ptr, size_t size);
+    void  (*free)(void* user, void* ptr);
+    void* user;
+} EngineAllocator;
+
 typedef struct EngineConfig {
     int width;
     int height;
     const char* title;
     int vsync;
     void* user_data; // Placeholder for now - add additional user_data for subsystems
+    EngineRendererType renderer;
+    EnginePlatformType platform;
+    const EngineAllocator* allocator; // NULL uses the C runtime. Process wide until engine_shutdown
+    size_t frame_arena_size;          // Per-frame scratch, allocated twice. 0 = 16 MiB
+    int io_threads;                   // Threads for engine_load_file_async. 0 = 2
+    int profiler;                     // Start with the frame profiler enabled
+    const char* shader_cache_dir;     // Existing directory for linked shader binaries. NULL = no cache
+    int draw_buckets;                 // Per thread draw lists for engine_bucket_draw. 0 = none
+    int render_thread;                // Submit and present on a thread of its own, see engine_begin_frame
+    int job_threads;                  // Workers for engine_jobs_run. 0 = one per core besides the calling thread, < 0 = none
+    int occlusion_culling;            // Also cull draws hidden behind ENGINE_MESH_OCCLUDER meshes, see engine_occlusion_depth
+    int transform_nodes;              // Capacity of the transform hierarchy. 0 = 16384
+    int max_entities;                 // Capacity of the entity component system. 0 = 65536
+    float lod_error_pixels;           // Each draw takes its coarsest LOD whose error covers at most this many pixels. 0 = 1
 } EngineConfig;
 
 typedef enum {
@@ -63,6 +97,9 @@ typedef uint32_t MeshHandle;
 typedef uint32_t ShaderHandle;
 typedef uint32_t TextureHandle;
 typedef uint32_t MaterialHandle;
+typedef uint32_t NodeHandle;
+typedef uint32_t EntityHandle;
+typedef uint32_t ComponentId;
 
 // Vertex format used by the default pipeline
 typedef struct {
@@ -71,26 +108,156 @@ typedef struct {
     float uv[2];
 } EngineVertex;
 
+// GPU storage of each vertex attribute. Compact formats cut vertex fetch bandwidth; shaders
+// keep declaring vec3 a_position, vec3 a_normal and vec2 a_uv except where noted.
+typedef enum {
+    ENGINE_POSITION_FLOAT3,        // 12 bytes
+    ENGINE_POSITION_HALF3,         // 8 bytes, padded. Keep meshes near their origin.
+} EnginePositionFormat;
+
+typedef enum {
+    ENGINE_NORMAL_FLOAT3,          // 12 bytes
+    ENGINE_NORMAL_INT_2_10_10_10,  // 4 bytes, signed normalized - renormalize in the shader
+    ENGINE_NORMAL_OCT16,           // 4 bytes, octahedral: declare vec2 a_normal and use ENGINE_GLSL_OCT_DECODE
+    ENGINE_NORMAL_NONE,
+} EngineNormalFormat;
+
+typedef enum {
+    ENGINE_UV_FLOAT2,              // 8 bytes
+    ENGINE_UV_UNORM16,             // 4 bytes, [0, 1] only - encoding clamps
+    ENGINE_UV_NONE,
+} EngineUVFormat;
+
+// The zero layout is EngineVertex itself. Half positions with either 4 byte normal format
+// give 16 bytes with UVs, 12 without.
+typedef struct {
+    EnginePositionFormat position;
+    EngineNormalFormat   normal;
+    EngineUVFormat       uv;
+} EngineVertexLayout;
+
+#define ENGINE_GLSL_OCT_DECODE \
+    "vec3 oct_decode(vec2 e) {\n" \
+    "    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n" \
+    "    float t = max(-n.z, 0.0);\n" \
+    "    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);\n" \
+    "    return normalize(n);\n" \
+    "}\n"
+
+// Post-transform cache efficiency of an index buffer, simulated with a 16 entry FIFO
+typedef struct {
+    uint32_t vertices_before;       // Vertex count before and after deduplication
+    uint32_t vertices_after;
+    float    acmr_before;           // Average cache miss ratio: vertices shaded per triangle, 0.5 at best
+    float    acmr_after;
+    float    atvr_before;           // Average transformed vertex ratio: vertices shaded per vertex, 1.0 at best
+    float    atvr_after;
+} EngineMeshOptimizeStats;
+
+enum {
+    ENGINE_MESH_OPTIMIZE = 1 << 0,  // Run engine_mesh_optimize on vertices before creating the mesh
+    ENGINE_MESH_OCCLUDER = 1 << 1,  // Hides what is behind it (EngineConfig.occlusion_culling). For large,
+                                    // solid, low polygon meshes: walls, floors, building shells.
+    ENGINE_MESH_LODS     = 1 << 2,  // Build the LOD chain with engine_mesh_build_lods at create time, unless
+                                    // lods has one already. Needs vertices, not packed_vertices.
+};
+
+#define ENGINE_MESH_MAX_LODS 8      // LOD 0, the mesh's own indices, and up to 7 coarser levels
+
+// Coarser index lists over the same vertices as LOD 0, each about half the triangles of the
+// one before. Every draw picks a level from the size its error would have on screen.
+typedef struct {
+    uint32_t        count;                                   // Levels after LOD 0
+    const uint32_t* indices;                                 // All of theirs, back to back, coarsest last
+    uint32_t        indices_count[ENGINE_MESH_MAX_LODS - 1];
+    float           error[ENGINE_MESH_MAX_LODS - 1];         // How far each strays from LOD 0, in mesh units, rising
+} EngineMeshLods;
+
 typedef struct {
     const EngineVertex* vertices;
     uint32_t vertex_count;
     const uint32_t* indices;
     uint32_t indices_count;
+    EngineVertexLayout layout;   // Vertices are encoded into it at create time
+    const void* packed_vertices; // Optional, already in layout (engine_vertex_encode); replaces vertices
+    uint32_t flags;              // ENGINE_MESH_*. Optimization needs vertices, not packed_vertices.
+    EngineMeshOptimizeStats* optimize_stats; // Optional, filled in by ENGINE_MESH_OPTIMIZE
+    EngineMeshLods lods;         // Optional. ENGINE_MESH_OPTIMIZE renumbers vertices, so it cannot have one.
 } EngineMeshDesc;
 
+// Deduplicates the vertices of an indexed triangle list, reorders triangles for the
+// post-transform vertex cache (Tipsify) and then for overdraw, and renumbers vertices in
+// first use order for fetch locality. out_vertices and out_indices need room for the input
+// counts and may alias the input. Returns the optimized vertex count, 0 on failure. Meant for
+// tools and load time - it allocates scratch memory.
+uint32_t engine_mesh_optimize(const EngineMeshDesc*, EngineVertex* out_vertices, uint32_t* out_indices, EngineMeshOptimizeStats* out_stats);
+
+// Builds a LOD chain for the mesh by edge collapse under quadric error metrics: vertices merge
+// into neighbours, never move, so each level only needs new indices. Vertices on open borders
+// and attribute seams (several vertices at one position) are kept. Each level has about half
+// the triangles of the one before, stopping when that no longer works or out_indices, with
+// room for indices_count, is full. Returns the number of levels, out_lods->indices pointing at
+// out_indices. Meant for tools and load time - it allocates scratch memory.
+uint32_t engine_mesh_build_lods(const EngineMeshDesc*, uint32_t* out_indices, EngineMeshLods* out_lods);
+
+// Bytes per vertex of a layout, 0 if it is invalid
+uint32_t engine_vertex_layout_stride(const EngineVertexLayout*);
+
+// Converts vertices into layout (SIMD where available). dst holds count * stride bytes.
+// Lets tools and loaders pack meshes once, offline, and hand the result to mesh create.
+// Large batches are split over the engine's job threads; a NULL engine works inline.
+bool    engine_vertex_encode(Engine*, const EngineVertexLayout*, const EngineVertex* vertices, uint32_t count, void* dst);
+
 typedef enum {
     ENGINE_TEXTURE_RGBA8,
     ENGINE_TEXTURE_RGB8,
     ENGINE_TEXTURE_R8,
-    // TO ADD LATER - ENGINE_TEXTURE_SRGB8_A8
+    ENGINE_TEXTURE_SRGB8_A8,   // sRGB color, linear alpha - sampling returns linear values
+    ENGINE_TEXTURE_SRGB8,
+    // Block compressed, 4x4 texel blocks stored row by row. Not every driver has every one:
+    // check engine_texture_format_supported.
+    ENGINE_TEXTURE_BC1,        // RGB with 1 bit alpha, 8 bytes a block (S3TC DXT1)
+    ENGINE_TEXTURE_BC1_SRGB,
+    ENGINE_TEXTURE_BC3,        // RGBA, 16 bytes a block (S3TC DXT5)
+    ENGINE_TEXTURE_BC3_SRGB,
+    ENGINE_TEXTURE_BC4,        // R, 8 bytes a block (RGTC1)
+    ENGINE_TEXTURE_BC5,        // RG, 16 bytes a block (RGTC2) - normal maps
+    ENGINE_TEXTURE_BC7,        // RGBA, 16 bytes a block (BPTC)
+    ENGINE_TEXTURE_BC7_SRGB,
+
+    ENGINE_TEXTURE_FORMAT_COUNT
 } EngineTextureFormat;
 
+#define ENGINE_TEXTURE_MAX_MIPS 16
+
 typedef struct {
     int width, height;
     EngineTextureFormat format;
-    const void* pixels; // Tightly packed for now - add pitch later if required...
+    const void* pixels;        // Level 0, tightly packed. With mip_count 0 an uncompressed texture
+                               // gets the rest of its chain generated by the backend.
+    int mip_count;             // When > 0, levels[0..mip_count-1] are uploaded as is and pixels is ignored
+    const void* levels[ENGINE_TEXTURE_MAX_MIPS]; // Each half the size of the last, rounded down, at least 1
 } EngineTextureDesc;
 
+typedef enum {
+    ENGINE_MIP_FILTER_BOX,     // 2x2 average
+    ENGINE_MIP_FILTER_KAISER,  // Kaiser windowed sinc, 6x6 taps - sharper, for content that minifies a lot
+} EngineMipFilter;
+
+// Bytes in one level of a texture, 0 for an invalid format or size
+size_t  engine_texture_level_size(EngineTextureFormat format, int width, int height);
+// Levels in a full chain down to 1x1, capped at ENGINE_TEXTURE_MAX_MIPS
+int     engine_texture_mip_count(int width, int height);
+// Bytes that engine_texture_generate_mips writes for a full chain below level 0
+size_t  engine_texture_mips_size(EngineTextureFormat format, int width, int height);
+
+// Builds the full mip chain of an uncompressed texture on the CPU (SIMD where available).
+// sRGB formats are filtered in linear space. Level 0 is read from desc->pixels; levels 1 and
+// down are written back to back into dst, engine_texture_mips_size bytes, and desc->levels
+// and desc->mip_count are filled in so desc can go straight to engine_texture_create.
+// Like engine_vertex_encode, uses the engine's job threads, or works inline for NULL.
+bool    engine_texture_generate_mips(Engine*, EngineTextureDesc* desc, EngineMipFilter filter, void* dst);
+
  // Basic material: 1 + shader and up to 4 textures
 typedef struct {
     ShaderHandle shader;
@@ -99,6 +266,7 @@ typedef struct {
     int depth_test;
     int depth_write;
     int blend;
+    int no_instancing; // Opt out of merging repeated draws into instanced draw calls
 } EngineMaterialDesc;
 
 typedef struct {
@@ -108,29 +276,191 @@ typedef struct {
     float view_position[3];
 } EngineCamera;
 
+typedef enum {
+    ENGINE_SHADER_INVALID = 0,   // Stale or never created
+    ENGINE_SHADER_COMPILING,
+    ENGINE_SHADER_READY,
+    ENGINE_SHADER_FAILED,
+} EngineShaderStatus;
+
+// Counters for the last completed frame. With a render thread that is the newest frame it has
+// presented, usually the one before the last recorded.
+typedef struct {
+    uint32_t draws_submitted;       // engine_draw calls accepted into the queue
+    uint32_t draws_bucketed;        // Of those, recorded through engine_bucket_draw
+    uint32_t draws_visible;         // engine_draw and bucket draws that passed frustum culling
+    uint32_t draws_culled;          // Their bounds were outside the camera frustum - never queued
+    uint32_t draws_occluded;        // In the frustum but behind occluders - never queued either
+    uint32_t occluder_triangles;    // Rasterized into the occlusion buffer
+    uint32_t lod_draws[ENGINE_MESH_MAX_LODS];     // Visible draws at each level of detail
+    uint32_t lod_triangles[ENGINE_MESH_MAX_LODS]; // And their triangles
+    uint32_t draws_rejected;        // Dropped for stale handles or a full frame arena
+    uint32_t batches;               // Runs of draws sharing shader, material and mesh
+    uint32_t draw_calls;            // Draw calls issued to the backend
+    uint32_t draws_instanced;       // Draws merged into instanced draw calls
+    uint32_t state_changes;         // Program, material and vertex array binds issued
+    uint32_t state_changes_skipped; // Binds avoided by sorting, versus binding all three per draw
+    uint32_t gl_calls_issued;       // State calls that reached the driver
+    uint32_t gl_calls_elided;       // State calls dropped by the backend's state cache
+    float    cpu_frame_ms;          // engine_begin_frame to end of submission, excluding present
+    float    present_ms;            // Time spent presenting (swap, vsync wait)
+    float    frame_wait_ms;         // engine_begin_frame blocked waiting for the render thread
+    float    render_thread_ms;      // Render thread replaying and submitting the frame, excluding present
+    float    frame_interval_ms;     // Between the last two presents
+    float    frame_interval_max_ms; // Longest of the last 64 intervals - pacing hitches show up here
+    uint32_t heap_allocs;           // Heap allocations during the frame, debug builds only
+    uint32_t frame_arena_used;      // Bytes of frame scratch used
+    uint32_t stream_bytes;          // Per-frame GPU data written in place: instances, uniforms, transient meshes
+    uint32_t stream_waits;          // 1 when the CPU had to wait for the GPU to free streaming memory
+    uint64_t mesh_bytes;            // Vertex and index memory of live meshes, as stored
+    uint64_t mesh_bytes_full;       // What the same meshes would take as EngineVertex with 32 bit indices
+    uint64_t texture_bytes;         // Memory of live textures including mips, as stored
+    uint64_t texture_bytes_full;    // What the same textures and levels would take as RGBA8
+    float    shader_create_ms;      // Main thread time creating shaders since startup, finishing background compiles included
+    uint32_t shader_cache_hits;     // Programs loaded from the shader cache since startup
+    uint32_t shader_cache_misses;   // Programs compiled from source with the cache enabled
+    uint32_t shaders_pending;       // Still compiling, drawn with the placeholder
+} EngineRenderStats;
+
+// Commands recorded by ENGINE_RENDERER_NULL. Draw state commands are recorded in replay
+// order, after sorting and batching, as a GPU backend would issue them.
+typedef enum {
+    ENGINE_CMD_BEGIN_FRAME,      // width, height
+    ENGINE_CMD_END_FRAME,
+    ENGINE_CMD_PRESENT,
+    ENGINE_CMD_CLEAR,            // packed RGBA8
+    ENGINE_CMD_CREATE_MESH,      // handle, vertex count, index count
+    ENGINE_CMD_DESTROY_MESH,     // handle
+    ENGINE_CMD_CREATE_SHADER,    // handle
+    ENGINE_CMD_DESTROY_SHADER,   // handle
+    ENGINE_CMD_CREATE_TEXTURE,   // handle, width, height
+    ENGINE_CMD_DESTROY_TEXTURE,  // handle
+    ENGINE_CMD_CREATE_MATERIAL,  // handle, shader
+    ENGINE_CMD_DESTROY_MATERIAL, // handle
+    ENGINE_CMD_SET_CAMERA,
+    ENGINE_CMD_SET_UNIFORM,      // material, name hash, float count
+    ENGINE_CMD_SUBMIT,           // mesh, material
+    ENGINE_CMD_BIND_SHADER,      // shader
+    ENGINE_CMD_BIND_MATERIAL,    // material
+    ENGINE_CMD_BIND_MESH,        // mesh
+    ENGINE_CMD_DRAW,             // mesh, material, instance count
+    ENGINE_CMD_DRAW_TRANSIENT,   // material, vertex count, index count
+} EngineCommandOp;
+
+typedef struct {
+    uint32_t op;
+    uint32_t args[3];
+} EngineCommand;
+
+// Local space bounds, computed from the vertices when a mesh is created
+typedef struct {
+    float center[3];
+    float radius;        // Sphere around center reaching the farthest vertex
+    float min[3];        // AABB
+    float max[3];
+} EngineBounds;
+
 // Create methods
 MeshHandle engine_mesh_create(Engine*, const EngineMeshDesc*);
 void    engine_mesh_destroy(Engine*, MeshHandle);
+bool    engine_mesh_bounds(const Engine*, MeshHandle, EngineBounds* out_bounds);
 
+// Shaders compile in the background: the handle is usable at once, and draws with it show a
+// flat placeholder until the program is linked. Compile errors are reported when they are
+// found, after which the shader's draws are dropped.
 ShaderHandle engine_shader_create(Engine*, const char* vs_source, const char* fs_source);
 void    engine_shader_destroy(Engine*, ShaderHandle);
+EngineShaderStatus engine_shader_status(const Engine*, ShaderHandle);
 
 TextureHandle engine_texture_create(Engine*, const EngineTextureDesc*);
 void    engine_texture_destroy(Engine*, TextureHandle);
+bool    engine_texture_format_supported(const Engine*, EngineTextureFormat format);
 
 MaterialHandle engine_material_create(Engine*, const EngineMaterialDesc*);
 void    engine_material_destroy(Engine*, MaterialHandle);
 
-// Per Frame
+// Per Frame - draws are queued, sorted by state and submitted in engine_end_frame.
+// Set the camera before drawing; it is used for depth ordering and culling. In
+// engine_end_frame every draw's mesh bounds are tested against the frustum of the camera
+// last set, on the job threads, and only visible draws reach the renderer. With
+// EngineConfig.occlusion_culling, draws behind the ENGINE_MESH_OCCLUDER meshes, rasterized
+// on the CPU, are dropped too. Transient draws are not culled.
 void    engine_set_camera(Engine*, const EngineCamera*);
 void    engine_draw(Engine*, MeshHandle, MaterialHandle, const float model[16]);
 
+// Meshes with a LOD chain are drawn at the coarsest level whose error, projected at the
+// nearest point of the mesh's bounds, covers at most EngineConfig.lod_error_pixels. A level is
+// picked when the draw is recorded. engine_draw has no memory of earlier frames. Here lod
+// holds the level this instance drew last and gets the new one. A coarser level is then only
+// taken once its error is a quarter under the limit, so an instance near a switch distance
+// does not flicker between two levels.
+void    engine_draw_lod(Engine*, MeshHandle, MaterialHandle, const float model[16], uint32_t* lod);
+
+// Transform hierarchy. A node holds a translation, rotation and scale relative to its parent.
+// engine_update_transforms recomputes world matrices only for nodes whose own local transform
+// or parent changed, or under an ancestor that did, in one pass over arrays sorted by depth,
+// each depth spread over the job threads. engine_node_world and engine_draw_node run it
+// themselves when something changed; call it before recording draw buckets, which do not.
+typedef struct {
+    float translation[3];
+    float rotation[4];    // Unit quaternion x, y, z, w
+    float scale[3];
+} EngineTransform;
+
+NodeHandle engine_node_create(Engine*, NodeHandle parent); // Parent 0 for a root. Starts at the identity.
+void    engine_node_destroy(Engine*, NodeHandle);          // Its whole subtree goes with it
+bool    engine_node_set_parent(Engine*, NodeHandle, NodeHandle parent); // False if parent is below the node
+void    engine_node_set_local(Engine*, NodeHandle, const EngineTransform*);
+bool    engine_node_get_local(const Engine*, NodeHandle, EngineTransform* out);
+const float* engine_node_world(Engine*, NodeHandle);       // NULL for stale handles
+void    engine_update_transforms(Engine*);
+
+// engine_draw with the node's world matrix
+void    engine_draw_node(Engine*, MeshHandle, MaterialHandle, NodeHandle);
+
+// Geometry that lives for one frame, allocated straight from GPU visible memory - there is
+// no staging copy and no driver sync. Write the vertices and indices (relative to the first
+// vertex) in order and do not read them back: the memory may be uncached. Returns false when
+// the frame's streaming memory is used up.
+typedef struct {
+    EngineVertex* vertices;
+    uint32_t*     indices;
+    uint32_t      vertex_count;
+    uint32_t      index_count;
+    uint32_t      vertex_offset; // Placement in the backend's buffer
+    uint32_t      index_offset;
+} EngineTransientMesh;
+
+bool    engine_transient_mesh_alloc(Engine*, uint32_t vertex_count, uint32_t index_count, EngineTransientMesh* out);
+
+// Draws a transient mesh allocated this frame. These are not sorted or instanced; they are
+// issued after the queued draws, in submission order.
+void    engine_draw_transient(Engine*, const EngineTransientMesh*, MaterialHandle, const float model[16]);
+
+// Draw recording from several threads. Each bucket is used by one thread at a time, so
+// threads recording into different buckets need no locking; engine_end_frame merges every
+// bucket into the frame, sorts it with the engine_draw calls and replays it on the calling
+// thread. While buckets are recorded, the camera must already be set for the frame and no
+// mesh, shader or material may be created or destroyed.
+typedef struct EngineDrawBucket EngineDrawBucket;
+
+EngineDrawBucket* engine_draw_bucket(Engine*, uint32_t index); // NULL past EngineConfig.draw_buckets
+void    engine_bucket_draw(EngineDrawBucket*, MeshHandle, MaterialHandle, const float model[16]);
+void    engine_bucket_draw_node(EngineDrawBucket*, MeshHandle, MaterialHandle, NodeHandle);
+void    engine_bucket_draw_lod(EngineDrawBucket*, MeshHandle, MaterialHandle, const float model[16], uint32_t* lod);
+
 // Optionally set per-material uniforms (common case: a few floats)
 void    engine_set_uniform_f(Engine*, MaterialHandle, const char* name, const float* vals, int count);
 
 Engine* engine_create(const EngineConfig* cfg);
 void    engine_shutdown(Engine* e);
 
+// With EngineConfig.render_thread the renderer and its GL context live on a thread of their
+// own. engine_end_frame hands the frame over and returns without presenting; the render
+// thread submits and presents it while the next frame is simulated and recorded, and
+// engine_begin_frame blocks only when the render thread is still on the frame before the
+// last. Nothing else changes for the caller - resource data is copied when the create call
+// is made - except that stats, shader status and the command log trail by a frame or so.
 void    engine_begin_frame(Engine* e);   // polls input/events, computes dt
 void    engine_end_frame(Engine* e);     // presents
 
@@ -147,4 +477,170 @@ bool    engine_was_key_released(const Engine* e, EngineKey key); // released thi
 
 void*   engine_get_user_data(const Engine* e); // optional convenience
 
+void    engine_get_render_stats(const Engine* e, EngineRenderStats* out_stats);
+
+// Level of the last frame's CPU occlusion depth pyramid (0 full size, NDC z, bottom row first); false when culling is off
+bool    engine_occlusion_depth(const Engine*, uint32_t level, const float** out_depth, uint32_t* out_width, uint32_t* out_height);
+
+// Rolling timings of one profiler zone over the last 128 frames. GPU zones lag the CPU by
+// up to three frames, since their results are only read once they are ready.
+typedef struct {
+    const char* name;
+    float    last_ms;
+    float    min_ms;
+    float    avg_ms;
+    float    p99_ms;
+    uint32_t samples;  // Frames in the window in which the zone ran
+} EngineProfileZone;
+
+// Profiling is compiled in with the ENGINE_PROFILER CMake option. Enabling takes effect at
+// the next engine_begin_frame.
+void     engine_profiler_set_enabled(Engine* e, bool enabled);
+uint32_t engine_profiler_get_summary(const Engine* e, EngineProfileZone* out_zones, uint32_t max_zones);
+bool     engine_profiler_write_trace(const Engine* e, const char* path); // Chrome trace JSON
+
+// User zones, nestable and usable from any thread. name must be a string literal.
+void     engine_profile_begin(const char* name);
+void     engine_profile_end(void);
+
+// Work-stealing job system: one worker per core, sized by EngineConfig.job_threads, shared by
+// the engine's own parallel work (mip generation, vertex encoding, ...) and user code. Jobs
+// may submit and wait on further jobs; a waiting thread runs queued jobs rather than
+// blocking. Jobs should not block on I/O or locks held across frames - use
+// engine_load_file_async for files. Any thread may submit. The calls also work without an
+// engine and then run the jobs on the calling thread.
+typedef void (*EngineJobFn)(void* data);
+typedef void (*EngineRangeFn)(void* data, uint32_t begin, uint32_t end);
+
+typedef struct {
+    EngineJobFn fn;
+    void*       data;
+} EngineJobDesc;
+
+// Counts the jobs still to finish. Zero it before the first run and wait on it before it
+// goes out of scope; one counter can track several runs.
+typedef struct {
+    uint32_t pending;
+} EngineJobCounter;
+
+void     engine_jobs_run(Engine* e, const EngineJobDesc* jobs, uint32_t count, EngineJobCounter* counter);
+void     engine_jobs_wait(Engine* e, EngineJobCounter* counter);
+bool     engine_jobs_done(const EngineJobCounter* counter);
+
+// Calls fn over [0, count) in ranges of at least min_range on all job threads, the calling
+// one included, and returns once every range is done
+void     engine_parallel_for(Engine* e, uint32_t count, uint32_t min_range, EngineRangeFn fn, void* data);
+
+uint32_t engine_job_thread_count(const Engine* e); // Workers plus the thread that created the engine
+// 0 on the thread that created the engine, 1..count-1 on workers, UINT32_MAX elsewhere - stable
+// per thread, so it can pick a draw bucket or other per-thread scratch
+uint32_t engine_job_thread_index(const Engine* e);
+
+// Entity component system. Entities with the same set of components share an archetype, which
+// keeps them in 16 KiB chunks: an array of entity handles, then one array per component. A
+// query walks the chunks of every matching archetype in order, with no pointer per entity.
+// Components are plain data registered by size. Adding or removing one moves the entity to
+// another archetype, and destroying an entity moves another into its place, so component
+// pointers only hold until the next such structural change.
+enum {
+    ENGINE_COMPONENT_TRANSFORM  = 1, // EngineTransform, drawn with T * R * S as the model matrix
+    ENGINE_COMPONENT_RENDERABLE = 2, // EngineRenderable
+};
+
+typedef struct {
+    MeshHandle     mesh;
+    MaterialHandle material;
+    uint32_t       lod;      // Level drawn last, kept by engine_draw_entities (engine_draw_lod)
+} EngineRenderable;
+
+// size and align as sizeof and _Alignof give them; 0 once 64 are registered
+ComponentId  engine_component_register(Engine*, uint32_t size, uint32_t align);
+// Components start zeroed, but for a transform, which starts at the identity
+EntityHandle engine_entity_create(Engine*, const ComponentId* components, uint32_t count);
+void    engine_entity_destroy(Engine*, EntityHandle);
+bool    engine_entity_add(Engine*, EntityHandle, ComponentId);
+bool    engine_entity_remove(Engine*, EntityHandle, ComponentId);
+void*   engine_entity_get(Engine*, EntityHandle, ComponentId); // NULL without the component
+
+// Matches the entities that have every with component and no without component. The
+// callback gets one chunk at a time: columns[i] is the array of the i-th with component,
+// count entries long. Archetypes are matched once, and again only when new ones appear.
+#define ENGINE_QUERY_MAX_TERMS 8
+
+typedef struct {
+    void*               columns[ENGINE_QUERY_MAX_TERMS];
+    const EntityHandle* entities;
+    uint32_t            count;
+} EngineQueryChunk;
+
+typedef void (*EngineQueryFn)(void* user, const EngineQueryChunk* chunk);
+typedef struct EngineQuery EngineQuery;
+
+EngineQuery* engine_query_create(Engine*, const ComponentId* with, uint32_t with_count, const ComponentId* without,
+                                 uint32_t without_count);
+void     engine_query_destroy(Engine*, EngineQuery*);
+uint32_t engine_query_count(Engine*, EngineQuery*);
+void     engine_query_each(Engine*, EngineQuery*, EngineQueryFn fn, void* user);
+
+// Queues the matching chunks on the job threads in a few ranges each and returns; wait with
+// engine_jobs_wait. Until then make no structural change and do not run the query again.
+// fn may write any component of its own chunk.
+void     engine_query_schedule(Engine*, EngineQuery*, EngineQueryFn fn, void* user, EngineJobCounter* counter);
+
+// engine_draw_lod for every entity with a transform and a renderable, which keeps its level
+// in EngineRenderable.lod. With a draw bucket per job thread, the chunks are recorded on all
+// of them.
+void     engine_draw_entities(Engine*);
+
+// Read-only memory mapped file. Empty files give a view with size 0 and no data.
+typedef struct {
+    const void* data;
+    size_t      size;
+    void*       internal;
+} EngineFileView;
+
+bool    engine_file_map(const char* path, EngineFileView* out_view);
+void    engine_file_unmap(EngineFileView* view);
+
+// Called on the main thread from engine_begin_frame. The callback owns the view and must
+// release it with engine_file_unmap, now or later; ok is false (and the view empty) when
+// the file could not be opened.
+typedef void (*EngineFileLoadFn)(void* user, const char* path, EngineFileView view, bool ok);
+
+// Maps and prefaults the file on an I/O thread. Returns false if the request was rejected
+// (too many in flight, path too long); the callback is not called then.
+bool    engine_load_file_async(Engine* e, const char* path, EngineFileLoadFn callback, void* user);
+
+// Baked asset pack, written offline by tools/asset_baker. The file is mapped and its table
+// of contents bounds checked once; after that the descriptors point straight into the
+// mapping, already in the form the create functions take - nothing is parsed or copied.
+// They stay valid until engine_pack_close. Backends copy what they need at create time, so
+// a pack can be closed as soon as its assets are created.
+typedef struct EnginePack EnginePack;
+
+typedef enum {
+    ENGINE_PACK_MESH = 1,
+    ENGINE_PACK_TEXTURE,
+    ENGINE_PACK_SHADER,
+} EnginePackAssetType;
+
+EnginePack* engine_pack_open(const char* path);
+// Takes ownership of the view, e.g. one delivered by engine_load_file_async, and releases
+// it on failure as well
+EnginePack* engine_pack_open_view(EngineFileView* view);
+void        engine_pack_close(EnginePack* pack);
+
+uint32_t    engine_pack_asset_count(const EnginePack* pack);
+const char* engine_pack_asset_name(const EnginePack* pack, uint32_t index, EnginePackAssetType* out_type);
+
+// Lookups hash the name and binary search the table of contents. Each returns false when
+// there is no asset of that name and type.
+bool    engine_pack_mesh(const EnginePack* pack, const char* name, EngineMeshDesc* out_desc);
+bool    engine_pack_texture(const EnginePack* pack, const char* name, EngineTextureDesc* out_desc);
+bool    engine_pack_shader(const EnginePack* pack, const char* name, const char** out_vs_source, const char** out_fs_source);
+
+// Commands recorded during the last completed frame. Only ENGINE_RENDERER_NULL records;
+// other renderers return 0. The log stays valid until the next engine_end_frame.
+uint32_t engine_get_command_log(const Engine* e, const EngineCommand** out_commands);
+
 #endif // ENGINE_H
\ No newline at end of file
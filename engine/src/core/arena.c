@@ -0,0 +1,89 @@
+//
+// Created by Cain Martin on 2025/08/21.
+//
+
+#include <string.h>
+#include "arena.h"
+#include "memory.h"
+
+bool arena_init(Arena* arena, size_t size)
+{
+    memset(arena, 0, sizeof *arena);
+    arena->base = mem_alloc(size);
+    if (!arena->base) return false;
+    arena->size = size;
+    return true;
+}
+
+void arena_shutdown(Arena* arena)
+{
+    mem_free(arena->base);
+    memset(arena, 0, sizeof *arena);
+}
+
+void arena_reset(Arena* arena)
+{
+    arena->offset = 0;
+}
+
+void* arena_alloc(Arena* arena, size_t size, size_t align)
+{
+    // Align the address rather than the offset so alignments above malloc's are honoured
+    const uintptr_t base = (uintptr_t)arena->base;
+    const uintptr_t aligned = (base + arena->offset + (align - 1)) & ~(uintptr_t)(align - 1);
+    const size_t offset = (size_t)(aligned - base);
+
+    if (offset > arena->size || size > arena->size - offset) return NULL;
+
+    arena->offset = offset + size;
+    if (arena->offset > arena->high_water) arena->high_water = arena->offset;
+
+    return (void*)aligned;
+}
+
+bool arena_resize(Arena* arena, void* ptr, size_t old_size, size_t new_size)
+{
+    if (!ptr) return false;
+    const size_t offset = (size_t)((uint8_t*)ptr - arena->base);
+    if (offset + old_size != arena->offset) return false;
+    if (new_size > arena->size - offset) return false;
+
+    arena->offset = offset + new_size;
+    if (arena->offset > arena->high_water) arena->high_water = arena->offset;
+    return true;
+}
+
+bool frame_arena_init(FrameArena* frame_arena, size_t size_per_frame)
+{
+    frame_arena->index = 0;
+    if (!arena_init(&frame_arena->frames[0], size_per_frame)) return false;
+    if (!arena_init(&frame_arena->frames[1], size_per_frame)) {
+        arena_shutdown(&frame_arena->frames[0]);
+        return false;
+    }
+    return true;
+}
+
+void frame_arena_shutdown(FrameArena* frame_arena)
+{
+    arena_shutdown(&frame_arena->frames[0]);
+    arena_shutdown(&frame_arena->frames[1]);
+}
+
+Arena* frame_arena_begin(FrameArena* frame_arena)
+{
+    frame_arena->index ^= 1;
+    Arena* arena = &frame_arena->frames[frame_arena->index];
+    arena_reset(arena);
+    return arena;
+}
+
+Arena* frame_arena_current(FrameArena* frame_arena)
+{
+    return &frame_arena->frames[frame_arena->index];
+}
+
+Arena* frame_arena_previous(FrameArena* frame_arena)
+{
+    return &frame_arena->frames[frame_arena->index ^ 1];
+}
@@ -0,0 +1,47 @@
+//
+// Created by Cain Martin on 2025/08/21.
+//
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Linear (bump) allocator. Allocations are freed all at once by arena_reset.
+typedef struct Arena
+{
+    uint8_t* base;
+    size_t   size;
+    size_t   offset;
+    size_t   high_water;
+} Arena;
+
+bool  arena_init(Arena* arena, size_t size);
+void  arena_shutdown(Arena* arena);
+void  arena_reset(Arena* arena);
+
+// Returns NULL when the arena is exhausted. align must be a power of two.
+void* arena_alloc(Arena* arena, size_t size, size_t align);
+
+// Grows or shrinks ptr in place when it is the arena's most recent allocation. Returns false
+// (and changes nothing) otherwise or when the arena is exhausted.
+bool  arena_resize(Arena* arena, void* ptr, size_t old_size, size_t new_size);
+
+// Two arenas used on alternate frames. frame_arena_begin resets only the half it switches
+// to, so anything allocated last frame stays valid until the end of this one - long
+// enough for a consumer that runs a frame behind.
+typedef struct FrameArena
+{
+    Arena    frames[2];
+    uint32_t index;
+} FrameArena;
+
+bool   frame_arena_init(FrameArena* frame_arena, size_t size_per_frame);
+void   frame_arena_shutdown(FrameArena* frame_arena);
+Arena* frame_arena_begin(FrameArena* frame_arena); // Switches halves, returns the reset one
+Arena* frame_arena_current(FrameArena* frame_arena);
+Arena* frame_arena_previous(FrameArena* frame_arena);
+
+#endif //ARENA_H
@@ -0,0 +1,79 @@
+//
+// Created by Cain Martin on 2025/08/27.
+//
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// C99 has no <stdatomic.h>, so these wrap the compiler intrinsics. Loads acquire, stores
+// release, read-modify-writes are acquire-release unless the name says relaxed.
+
+#define CACHE_LINE_SIZE 64
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+#include <intrin.h>
+
+static inline uint32_t atomic_load_u32(const volatile uint32_t* p) { uint32_t v = *p; _ReadWriteBarrier(); return v; }
+static inline void     atomic_store_u32(volatile uint32_t* p, uint32_t v) { _ReadWriteBarrier(); *p = v; }
+static inline uint32_t atomic_fetch_add_u32(volatile uint32_t* p, uint32_t v) { return (uint32_t)_InterlockedExchangeAdd((volatile long*)p, (long)v); }
+static inline uint32_t atomic_exchange_u32(volatile uint32_t* p, uint32_t v) { return (uint32_t)_InterlockedExchange((volatile long*)p, (long)v); }
+static inline bool     atomic_cas_u32(volatile uint32_t* p, uint32_t* expected, uint32_t desired)
+{
+    const uint32_t prev = (uint32_t)_InterlockedCompareExchange((volatile long*)p, (long)desired, (long)*expected);
+    if (prev == *expected) return true;
+    *expected = prev;
+    return false;
+}
+
+static inline uint64_t atomic_load_u64(const volatile uint64_t* p) { uint64_t v = *p; _ReadWriteBarrier(); return v; }
+static inline void     atomic_store_u64(volatile uint64_t* p, uint64_t v) { _ReadWriteBarrier(); *p = v; }
+static inline uint64_t atomic_fetch_add_u64(volatile uint64_t* p, uint64_t v) { return (uint64_t)_InterlockedExchangeAdd64((volatile long long*)p, (long long)v); }
+static inline uint64_t atomic_fetch_add_relaxed_u64(volatile uint64_t* p, uint64_t v) { return atomic_fetch_add_u64(p, v); }
+static inline bool     atomic_cas_u64(volatile uint64_t* p, uint64_t* expected, uint64_t desired)
+{
+    const uint64_t prev = (uint64_t)_InterlockedCompareExchange64((volatile long long*)p, (long long)desired, (long long)*expected);
+    if (prev == *expected) return true;
+    *expected = prev;
+    return false;
+}
+
+static inline void     atomic_fence(void) { _mm_mfence(); }
+static inline void     cpu_relax(void) { _mm_pause(); }
+
+#else
+
+static inline uint32_t atomic_load_u32(const volatile uint32_t* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static inline void     atomic_store_u32(volatile uint32_t* p, uint32_t v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static inline uint32_t atomic_fetch_add_u32(volatile uint32_t* p, uint32_t v) { return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL); }
+static inline uint32_t atomic_exchange_u32(volatile uint32_t* p, uint32_t v) { return __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL); }
+static inline bool     atomic_cas_u32(volatile uint32_t* p, uint32_t* expected, uint32_t desired)
+{
+    return __atomic_compare_exchange_n(p, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline uint64_t atomic_load_u64(const volatile uint64_t* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static inline void     atomic_store_u64(volatile uint64_t* p, uint64_t v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static inline uint64_t atomic_fetch_add_u64(volatile uint64_t* p, uint64_t v) { return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL); }
+static inline uint64_t atomic_fetch_add_relaxed_u64(volatile uint64_t* p, uint64_t v) { return __atomic_fetch_add(p, v, __ATOMIC_RELAXED); }
+static inline bool     atomic_cas_u64(volatile uint64_t* p, uint64_t* expected, uint64_t desired)
+{
+    return __atomic_compare_exchange_n(p, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline void     atomic_fence(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline void     cpu_relax(void) { __builtin_ia32_pause(); }
+#elif defined(__aarch64__)
+static inline void     cpu_relax(void) { __asm__ __volatile__("yield"); }
+#else
+static inline void     cpu_relax(void) { }
+#endif
+
+#endif
+
+#endif //ATOMIC_H
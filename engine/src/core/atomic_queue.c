@@ -0,0 +1,73 @@
+//
+// Created by Cain Martin on 2025/08/27.
+//
+
+#include <string.h>
+#include "atomic_queue.h"
+#include "memory.h"
+
+bool atomic_queue_init(AtomicQueue* queue, uint32_t capacity)
+{
+    memset(queue, 0, sizeof *queue);
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) return false;
+
+    queue->cells = mem_alloc_aligned(capacity * sizeof(AtomicQueueCell), CACHE_LINE_SIZE);
+    if (!queue->cells) return false;
+
+    for (uint32_t i = 0; i < capacity; ++i) {
+        queue->cells[i].sequence = i;
+        queue->cells[i].value = NULL;
+    }
+    queue->mask = capacity - 1;
+    return true;
+}
+
+void atomic_queue_shutdown(AtomicQueue* queue)
+{
+    mem_free_aligned(queue->cells);
+    queue->cells = NULL;
+}
+
+bool atomic_queue_push(AtomicQueue* queue, void* value)
+{
+    uint32_t pos = atomic_load_u32(&queue->push_pos);
+    for (;;) {
+        AtomicQueueCell* cell = &queue->cells[pos & queue->mask];
+        const int32_t diff = (int32_t)(atomic_load_u32(&cell->sequence) - pos);
+
+        if (diff == 0) {
+            // The cell is free for this lap - claim it by advancing the position
+            if (atomic_cas_u32(&queue->push_pos, &pos, pos + 1)) {
+                cell->value = value;
+                atomic_store_u32(&cell->sequence, pos + 1);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // Still holds last lap's value: full
+        } else {
+            pos = atomic_load_u32(&queue->push_pos);
+        }
+    }
+}
+
+bool atomic_queue_pop(AtomicQueue* queue, void** out_value)
+{
+    uint32_t pos = atomic_load_u32(&queue->pop_pos);
+    for (;;) {
+        AtomicQueueCell* cell = &queue->cells[pos & queue->mask];
+        const int32_t diff = (int32_t)(atomic_load_u32(&cell->sequence) - (pos + 1));
+
+        if (diff == 0) {
+            if (atomic_cas_u32(&queue->pop_pos, &pos, pos + 1)) {
+                *out_value = cell->value;
+                // Hand the cell to the producer one lap ahead
+                atomic_store_u32(&cell->sequence, pos + queue->mask + 1);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // Nothing published here yet: empty
+        } else {
+            pos = atomic_load_u32(&queue->pop_pos);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+//
+// Created by Cain Martin on 2025/08/27.
+//
+
+#ifndef ATOMIC_QUEUE_H
+#define ATOMIC_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "atomic.h"
+
+// Bounded lock-free multi-producer multi-consumer queue of pointers (Vyukov's ring). Each
+// cell carries a sequence number that tells producers and consumers whose turn it is, so a
+// push or pop is one compare-and-swap on the shared position plus a store to the cell.
+typedef struct AtomicQueueCell
+{
+    uint32_t sequence;
+    void*    value;
+} AtomicQueueCell;
+
+typedef struct AtomicQueue
+{
+    AtomicQueueCell* cells;
+    uint32_t         mask;
+    // Producers and consumers each hammer one position; keep them on separate lines
+    uint8_t          pad0[CACHE_LINE_SIZE];
+    uint32_t         push_pos;
+    uint8_t          pad1[CACHE_LINE_SIZE - sizeof(uint32_t)];
+    uint32_t         pop_pos;
+    uint8_t          pad2[CACHE_LINE_SIZE - sizeof(uint32_t)];
+} AtomicQueue;
+
+// capacity must be a power of two
+bool atomic_queue_init(AtomicQueue* queue, uint32_t capacity);
+void atomic_queue_shutdown(AtomicQueue* queue);
+
+// Both return false instead of blocking, when full or empty respectively
+bool atomic_queue_push(AtomicQueue* queue, void* value);
+bool atomic_queue_pop(AtomicQueue* queue, void** out_value);
+
+#endif //ATOMIC_QUEUE_H
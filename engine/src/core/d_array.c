@@ -2,4 +2,105 @@
 // Created by Cain Martin on 2025/08/19.
 //
 
+#include <string.h>
+#include "arena.h"
 #include "d_array.h"
+#include "memory.h"
+
+bool d_array_init(DArray* array, uint32_t elem_size, uint32_t align, struct Arena* arena)
+{
+    memset(array, 0, sizeof *array);
+    if (align == 0) align = D_ARRAY_SIMD_ALIGN;
+    if (elem_size == 0 || (align & (align - 1)) != 0) return false;
+
+    array->elem_size = elem_size;
+    array->align = align;
+    array->arena = arena;
+    return true;
+}
+
+void d_array_free(DArray* array)
+{
+    if (!array->arena) mem_free_aligned(array->data);
+    array->data = NULL;
+    array->count = 0;
+    array->capacity = 0;
+}
+
+static bool d_array_set_capacity(DArray* array, uint32_t capacity)
+{
+    const size_t old_bytes = (size_t)array->capacity * array->elem_size;
+    const size_t new_bytes = (size_t)capacity * array->elem_size;
+    uint8_t* data;
+
+    if (array->arena) {
+        // Most growth happens to the array that allocated last, which can extend in place
+        if (array->data && arena_resize(array->arena, array->data, old_bytes, new_bytes)) {
+            array->capacity = capacity;
+            return true;
+        }
+        data = arena_alloc(array->arena, new_bytes, array->align);
+    } else {
+        data = mem_alloc_aligned(new_bytes, array->align);
+    }
+    if (!data) return false;
+
+    if (array->count) memcpy(data, array->data, (size_t)array->count * array->elem_size);
+    if (!array->arena) mem_free_aligned(array->data);
+
+    array->data = data;
+    array->capacity = capacity;
+    return true;
+}
+
+bool d_array_reserve(DArray* array, uint32_t capacity)
+{
+    if (capacity <= array->capacity) return true;
+
+    uint32_t grown = array->capacity ? array->capacity : D_ARRAY_MIN_CAPACITY;
+    while (grown < capacity) {
+        if (grown > UINT32_MAX / 2) { grown = capacity; break; }
+        grown *= 2;
+    }
+    return d_array_set_capacity(array, grown);
+}
+
+bool d_array_resize(DArray* array, uint32_t count)
+{
+    if (!d_array_reserve(array, count)) return false;
+    if (count > array->count)
+        memset(d_array_at(array, array->count), 0, (size_t)(count - array->count) * array->elem_size);
+    array->count = count;
+    return true;
+}
+
+void d_array_shrink(DArray* array)
+{
+    if (array->arena || array->count == array->capacity) return;
+    if (array->count == 0) {
+        d_array_free(array);
+        return;
+    }
+    d_array_set_capacity(array, array->count);
+}
+
+void* d_array_push(DArray* array)
+{
+    if (array->count == array->capacity && !d_array_reserve(array, array->count + 1)) return NULL;
+    return d_array_at(array, array->count++);
+}
+
+bool d_array_append(DArray* array, const void* elements, uint32_t count)
+{
+    if (count > UINT32_MAX - array->count || !d_array_reserve(array, array->count + count)) return false;
+    memcpy(d_array_at(array, array->count), elements, (size_t)count * array->elem_size);
+    array->count += count;
+    return true;
+}
+
+void d_array_swap_remove(DArray* array, uint32_t index)
+{
+    if (index >= array->count) return;
+    const uint32_t last = --array->count;
+    if (index != last) memcpy(d_array_at(array, index), d_array_at(array, last), array->elem_size);
+}
@@ -5,4 +5,54 @@
 #ifndef D_ARRAY_H
 #define D_ARRAY_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct Arena;
+
+#define D_ARRAY_MIN_CAPACITY 16
+#define D_ARRAY_SIMD_ALIGN   16 // SSE/NEON loads
+#define D_ARRAY_AVX_ALIGN    32
+
+// Growable array of fixed-size elements. Storage comes from the heap (through core/memory)
+// or, with an arena, from that arena - an arena-backed array needs no d_array_free and dies
+// with the arena's next reset. The base address is always aligned to align, so loops over
+// float elements can use aligned vector loads.
+typedef struct DArray
+{
+    uint8_t*      data;
+    uint32_t      count;
+    uint32_t      capacity;
+    uint32_t      elem_size;
+    uint32_t      align;
+    struct Arena* arena;
+} DArray;
+
+// align must be a power of two; 0 picks D_ARRAY_SIMD_ALIGN
+bool  d_array_init(DArray* array, uint32_t elem_size, uint32_t align, struct Arena* arena);
+void  d_array_free(DArray* array);
+
+// Capacity doubles when full. reserve and resize never shrink; shrink releases the unused
+// tail of a heap array (arena arrays keep theirs).
+bool  d_array_reserve(DArray* array, uint32_t capacity);
+bool  d_array_resize(DArray* array, uint32_t count); // New elements are zeroed
+void  d_array_shrink(DArray* array);
+
+// Returns the new, uninitialised element, or NULL when storage is exhausted
+void* d_array_push(DArray* array);
+bool  d_array_append(DArray* array, const void* elements, uint32_t count);
+
+// O(1) removal: the last element moves into index, so order is not preserved
+void  d_array_swap_remove(DArray* array, uint32_t index);
+
+static inline void  d_array_clear(DArray* array) { array->count = 0; }
+static inline void* d_array_at(const DArray* array, uint32_t index)
+{
+    return array->data + (size_t)index * array->elem_size;
+}
+
+// Typed view of the storage, e.g. D_ARRAY_DATA(&positions, float)[i]
+#define D_ARRAY_DATA(array, type) ((type*)(array)->data)
+
 #endif //D_ARRAY_H
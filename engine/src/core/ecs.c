@@ -0,0 +1,384 @@
+//
+// Created by Cain Martin on 2025/09/07.
+//
+
+#include <string.h>
+#include "ecs.h"
+#include "memory.h"
+
+#define ECS_NO_ARCHETYPE UINT32_MAX
+#define ECS_QUERY_RANGES 4  // Jobs per job thread a scheduled query is split into
+#define ECS_JOB_BATCH    64 // Jobs submitted at once
+
+static EcsArchetype* archetype_at(const EcsWorld* world, uint32_t index)
+{
+    return D_ARRAY_DATA(&world->archetypes, EcsArchetype*)[index];
+}
+
+static EcsChunk* chunk_at(const EcsArchetype* archetype, uint32_t index)
+{
+    return D_ARRAY_DATA(&archetype->chunks, EcsChunk*)[index];
+}
+
+static uint32_t* chunk_entities(EcsChunk* chunk)
+{
+    return (uint32_t*)((uint8_t*)chunk + ECS_CHUNK_HEADER);
+}
+
+static uint8_t* chunk_component(const EcsArchetype* archetype, EcsChunk* chunk, uint32_t column, uint32_t size, uint32_t row)
+{
+    return (uint8_t*)chunk + archetype->offset[column] + (size_t)row * size;
+}
+
+bool ecs_init(EcsWorld* world, uint32_t max_entities)
+{
+    memset(world, 0, sizeof *world);
+    if (!handle_pool_init(&world->entities, max_entities)) return false;
+    world->locations = mem_alloc((size_t)max_entities * sizeof(EcsLocation));
+    if (!world->locations || !d_array_init(&world->archetypes, sizeof(EcsArchetype*), 0, NULL)
+        || !hash_map_init(&world->archetype_by_mask, sizeof(uint32_t), 0, NULL)) {
+        ecs_free(world);
+        return false;
+    }
+    return true;
+}
+
+void ecs_free(EcsWorld* world)
+{
+    for (uint32_t i = 0; i < world->archetypes.count; ++i) {
+        EcsArchetype* archetype = archetype_at(world, i);
+        for (uint32_t c = 0; c < archetype->chunks.count; ++c) mem_free_aligned(chunk_at(archetype, c));
+        d_array_free(&archetype->chunks);
+        mem_free(archetype);
+    }
+    d_array_free(&world->archetypes);
+    hash_map_free(&world->archetype_by_mask);
+    mem_free(world->locations);
+    handle_pool_shutdown(&world->entities);
+    memset(world, 0, sizeof *world);
+}
+
+uint32_t ecs_register(EcsWorld* world, uint32_t size, uint32_t align)
+{
+    if (align == 0) align = 1;
+    if (world->component_count >= ECS_MAX_COMPONENTS || align > 64 || (align & (align - 1)) || size % align) return 0;
+    if (size > ECS_CHUNK_SIZE - ECS_CHUNK_HEADER - sizeof(uint32_t) - 64) return 0;
+    world->component_size[world->component_count] = size;
+    world->component_align[world->component_count] = align;
+    return ++world->component_count;
+}
+
+// Sizes the chunk for the worst case alignment padding, then places the columns
+static bool archetype_layout(const EcsWorld* world, EcsArchetype* archetype)
+{
+    uint32_t per_entity = sizeof(uint32_t), padding = 0;
+    for (uint32_t c = 0; c < archetype->column_count; ++c) {
+        per_entity += world->component_size[archetype->component[c]];
+        padding += world->component_align[archetype->component[c]] - 1;
+    }
+    const uint32_t usable = ECS_CHUNK_SIZE - ECS_CHUNK_HEADER;
+    if (padding + per_entity > usable) return false;
+
+    archetype->chunk_capacity = (usable - padding) / per_entity;
+    uint32_t offset = ECS_CHUNK_HEADER + archetype->chunk_capacity * (uint32_t)sizeof(uint32_t);
+    for (uint32_t c = 0; c < archetype->column_count; ++c) {
+        const uint32_t align = world->component_align[archetype->component[c]];
+        offset = (offset + align - 1) & ~(align - 1);
+        archetype->offset[c] = offset;
+        offset += archetype->chunk_capacity * world->component_size[archetype->component[c]];
+    }
+    return true;
+}
+
+static uint32_t archetype_get(EcsWorld* world, EcsMask mask)
+{
+    const uint32_t* found = hash_map_get(&world->archetype_by_mask, mask);
+    if (found) return *found;
+
+    EcsArchetype* archetype = mem_calloc(1, sizeof *archetype);
+    if (!archetype) return ECS_NO_ARCHETYPE;
+    archetype->mask = mask;
+    memset(archetype->column_of, ECS_NO_COLUMN, sizeof archetype->column_of);
+    for (uint32_t c = 0; c < ECS_MAX_COMPONENTS; ++c) {
+        if (!((mask >> c) & 1)) continue;
+        archetype->column_of[c] = (uint8_t)archetype->column_count;
+        archetype->component[archetype->column_count++] = (uint8_t)c;
+    }
+
+    const uint32_t index = world->archetypes.count;
+    EcsArchetype** slot = NULL;
+    uint32_t* value = NULL;
+    if (archetype_layout(world, archetype) && d_array_init(&archetype->chunks, sizeof(EcsChunk*), 0, NULL)
+        && (slot = d_array_push(&world->archetypes)) != NULL) {
+        value = hash_map_insert(&world->archetype_by_mask, mask, NULL);
+        if (!value) world->archetypes.count--;
+    }
+    if (!value) {
+        d_array_free(&archetype->chunks);
+        mem_free(archetype);
+        return ECS_NO_ARCHETYPE;
+    }
+    *slot = archetype;
+    *value = index;
+    return index;
+}
+
+// Always at the end of the last chunk, starting a new one when that is full
+static bool row_alloc(EcsArchetype* archetype, uint32_t* out_chunk, uint32_t* out_row)
+{
+    uint32_t chunks = archetype->chunks.count;
+    if (!chunks || chunk_at(archetype, chunks - 1)->count == archetype->chunk_capacity) {
+        EcsChunk* chunk = mem_alloc_aligned(ECS_CHUNK_SIZE, 64);
+        EcsChunk** slot = chunk ? d_array_push(&archetype->chunks) : NULL;
+        if (!slot) {
+            mem_free_aligned(chunk);
+            return false;
+        }
+        chunk->count = 0;
+        *slot = chunk;
+        chunks++;
+    }
+    EcsChunk* chunk = chunk_at(archetype, chunks - 1);
+    *out_chunk = chunks - 1;
+    *out_row = chunk->count++;
+    archetype->entity_count++;
+    return true;
+}
+
+// Fills the hole with the archetype's last entity, freeing the last chunk once it is empty
+static void row_remove(EcsWorld* world, EcsArchetype* archetype, uint32_t chunk_index, uint32_t row)
+{
+    EcsChunk* hole = chunk_at(archetype, chunk_index);
+    EcsChunk* tail = chunk_at(archetype, archetype->chunks.count - 1);
+    const uint32_t last = tail->count - 1;
+    if (hole != tail || row != last) {
+        const uint32_t moved = chunk_entities(tail)[last];
+        chunk_entities(hole)[row] = moved;
+        for (uint32_t c = 0; c < archetype->column_count; ++c) {
+            const uint32_t size = world->component_size[archetype->component[c]];
+            memcpy(chunk_component(archetype, hole, c, size, row), chunk_component(archetype, tail, c, size, last), size);
+        }
+        EcsLocation* location = &world->locations[handle_index(moved)];
+        location->chunk = chunk_index;
+        location->row = row;
+    }
+    archetype->entity_count--;
+    if (--tail->count == 0) {
+        mem_free_aligned(tail);
+        archetype->chunks.count--;
+    }
+}
+
+uint32_t ecs_create(EcsWorld* world, const uint32_t* components, uint32_t count)
+{
+    EcsMask mask = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (components[i] == 0 || components[i] > world->component_count) return 0;
+        mask |= (EcsMask)1 << (components[i] - 1);
+    }
+    const uint32_t entity = handle_pool_alloc(&world->entities, NULL);
+    if (!entity) return 0;
+    const uint32_t index = archetype_get(world, mask);
+
+    EcsArchetype* archetype = index != ECS_NO_ARCHETYPE ? archetype_at(world, index) : NULL;
+    uint32_t chunk_index, row;
+    if (!archetype || !row_alloc(archetype, &chunk_index, &row)) {
+        handle_pool_release(&world->entities, entity, NULL, NULL);
+        return 0;
+    }
+    EcsChunk* chunk = chunk_at(archetype, chunk_index);
+    chunk_entities(chunk)[row] = entity;
+    for (uint32_t c = 0; c < archetype->column_count; ++c) {
+        const uint32_t size = world->component_size[archetype->component[c]];
+        memset(chunk_component(archetype, chunk, c, size, row), 0, size);
+    }
+
+    EcsLocation* location = &world->locations[handle_index(entity)];
+    location->archetype = index;
+    location->chunk = chunk_index;
+    location->row = row;
+    return entity;
+}
+
+void ecs_destroy(EcsWorld* world, uint32_t entity)
+{
+    if (!handle_pool_is_valid(&world->entities, entity)) return;
+    const EcsLocation* location = &world->locations[handle_index(entity)];
+    row_remove(world, archetype_at(world, location->archetype), location->chunk, location->row);
+    handle_pool_release(&world->entities, entity, NULL, NULL);
+}
+
+static bool move_to(EcsWorld* world, uint32_t entity, EcsMask mask)
+{
+    EcsLocation* location = &world->locations[handle_index(entity)];
+    EcsArchetype* from = archetype_at(world, location->archetype);
+    if (from->mask == mask) return true;
+    const uint32_t index = archetype_get(world, mask);
+    if (index == ECS_NO_ARCHETYPE) return false;
+
+    EcsArchetype* to = archetype_at(world, index);
+    uint32_t chunk_index, row;
+    if (!row_alloc(to, &chunk_index, &row)) return false;
+    EcsChunk* src = chunk_at(from, location->chunk);
+    EcsChunk* dst = chunk_at(to, chunk_index);
+    chunk_entities(dst)[row] = entity;
+    for (uint32_t c = 0; c < to->column_count; ++c) {
+        const uint32_t component = to->component[c], size = world->component_size[component];
+        uint8_t* data = chunk_component(to, dst, c, size, row);
+        if (from->column_of[component] != ECS_NO_COLUMN)
+            memcpy(data, chunk_component(from, src, from->column_of[component], size, location->row), size);
+        else
+            memset(data, 0, size);
+    }
+
+    row_remove(world, from, location->chunk, location->row);
+    location->archetype = index;
+    location->chunk = chunk_index;
+    location->row = row;
+    return true;
+}
+
+bool ecs_add(EcsWorld* world, uint32_t entity, uint32_t component)
+{
+    if (!handle_pool_is_valid(&world->entities, entity) || component == 0 || component > world->component_count) return false;
+    const EcsMask mask = archetype_at(world, world->locations[handle_index(entity)].archetype)->mask;
+    return move_to(world, entity, mask | (EcsMask)1 << (component - 1));
+}
+
+bool ecs_remove(EcsWorld* world, uint32_t entity, uint32_t component)
+{
+    if (!handle_pool_is_valid(&world->entities, entity) || component == 0 || component > world->component_count) return false;
+    const EcsMask mask = archetype_at(world, world->locations[handle_index(entity)].archetype)->mask;
+    return move_to(world, entity, mask & ~((EcsMask)1 << (component - 1)));
+}
+
+void* ecs_get(const EcsWorld* world, uint32_t entity, uint32_t component)
+{
+    if (!handle_pool_is_valid(&world->entities, entity) || component == 0 || component > world->component_count) return NULL;
+    const EcsLocation* location = &world->locations[handle_index(entity)];
+    const EcsArchetype* archetype = archetype_at(world, location->archetype);
+    const uint32_t column = archetype->column_of[component - 1];
+    if (column == ECS_NO_COLUMN) return NULL;
+    return chunk_component(archetype, chunk_at(archetype, location->chunk), column, world->component_size[component - 1], location->row);
+}
+
+bool ecs_query_init(const EcsWorld* world, EngineQuery* query, const uint32_t* with, uint32_t with_count,
+                    const uint32_t* without, uint32_t without_count)
+{
+    memset(query, 0, sizeof *query);
+    if (with_count > ENGINE_QUERY_MAX_TERMS) return false;
+    for (uint32_t i = 0; i < with_count; ++i) {
+        if (with[i] == 0 || with[i] > world->component_count) return false;
+        query->with |= (EcsMask)1 << (with[i] - 1);
+        query->terms[query->term_count++] = (uint8_t)(with[i] - 1);
+    }
+    for (uint32_t i = 0; i < without_count; ++i) {
+        if (without[i] == 0 || without[i] > world->component_count) return false;
+        query->without |= (EcsMask)1 << (without[i] - 1);
+    }
+    if (!d_array_init(&query->matched, sizeof(uint32_t), 0, NULL) || !d_array_init(&query->refs, sizeof(EcsChunkRef), 0, NULL)) {
+        ecs_query_free(query);
+        return false;
+    }
+    return true;
+}
+
+void ecs_query_free(EngineQuery* query)
+{
+    d_array_free(&query->matched);
+    d_array_free(&query->refs);
+}
+
+// Picks up the archetypes created since the query last ran
+static void query_match(const EcsWorld* world, EngineQuery* query)
+{
+    for (; query->archetypes_seen < world->archetypes.count; ++query->archetypes_seen) {
+        const EcsMask mask = archetype_at(world, query->archetypes_seen)->mask;
+        if ((mask & query->with) != query->with || (mask & query->without)) continue;
+        uint32_t* slot = d_array_push(&query->matched);
+        if (!slot) return; // Tried again next time
+        *slot = query->archetypes_seen;
+    }
+}
+
+static void chunk_view(const EngineQuery* query, const EcsArchetype* archetype, EcsChunk* chunk, EngineQueryChunk* out)
+{
+    for (uint32_t t = 0; t < query->term_count; ++t)
+        out->columns[t] = (uint8_t*)chunk + archetype->offset[archetype->column_of[query->terms[t]]];
+    out->entities = chunk_entities(chunk);
+    out->count = chunk->count;
+}
+
+uint32_t ecs_query_count(const EcsWorld* world, EngineQuery* query)
+{
+    query_match(world, query);
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < query->matched.count; ++i)
+        count += archetype_at(world, D_ARRAY_DATA(&query->matched, uint32_t)[i])->entity_count;
+    return count;
+}
+
+void ecs_query_each(const EcsWorld* world, EngineQuery* query, EngineQueryFn fn, void* user)
+{
+    query_match(world, query);
+    for (uint32_t i = 0; i < query->matched.count; ++i) {
+        const EcsArchetype* archetype = archetype_at(world, D_ARRAY_DATA(&query->matched, uint32_t)[i]);
+        for (uint32_t c = 0; c < archetype->chunks.count; ++c) {
+            EngineQueryChunk view;
+            chunk_view(query, archetype, chunk_at(archetype, c), &view);
+            fn(user, &view);
+        }
+    }
+}
+
+static void query_range(void* data, uint32_t begin, uint32_t end)
+{
+    const EngineQuery* query = data;
+    const EcsChunkRef* refs = D_ARRAY_DATA(&query->refs, EcsChunkRef);
+    for (uint32_t i = begin; i < end; ++i) {
+        EngineQueryChunk view;
+        chunk_view(query, refs[i].archetype, refs[i].chunk, &view);
+        query->fn(query->user, &view);
+    }
+}
+
+void ecs_query_schedule(const EcsWorld* world, EngineQuery* query, JobSystem* jobs, EngineQueryFn fn, void* user,
+                        EngineJobCounter* counter)
+{
+    query_match(world, query);
+    query->fn = fn;
+    query->user = user;
+
+    // The chunk list is flattened so the ranges split it evenly, archetypes regardless
+    d_array_clear(&query->refs);
+    for (uint32_t i = 0; i < query->matched.count; ++i) {
+        const EcsArchetype* archetype = archetype_at(world, D_ARRAY_DATA(&query->matched, uint32_t)[i]);
+        for (uint32_t c = 0; c < archetype->chunks.count; ++c) {
+            EcsChunkRef* ref = d_array_push(&query->refs);
+            if (ref) {
+                ref->archetype = archetype;
+                ref->chunk = chunk_at(archetype, c);
+                continue;
+            }
+            EngineQueryChunk view; // Out of memory: this one runs here instead
+            chunk_view(query, archetype, chunk_at(archetype, c), &view);
+            fn(user, &view);
+        }
+    }
+
+    const uint32_t count = query->refs.count;
+    uint32_t ranges = job_system_thread_count(jobs) * ECS_QUERY_RANGES;
+    if (ranges > count) ranges = count;
+    Job batch[ECS_JOB_BATCH];
+    uint32_t begin = 0, queued = 0;
+    for (uint32_t i = 0; i < ranges; ++i) {
+        const uint32_t end = begin + count / ranges + (i < count % ranges ? 1 : 0);
+        const Job job = { NULL, query_range, query, begin, end, counter };
+        batch[queued++] = job;
+        if (queued == ECS_JOB_BATCH || i + 1 == ranges) {
+            job_system_submit(jobs, batch, queued);
+            queued = 0;
+        }
+        begin = end;
+    }
+}
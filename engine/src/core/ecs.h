@@ -0,0 +1,113 @@
+//
+// Created by Cain Martin on 2025/09/07.
+//
+
+#ifndef ECS_H
+#define ECS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+#include "d_array.h"
+#include "handle_pool.h"
+#include "hash_map.h"
+#include "job_system.h"
+
+#define ECS_CHUNK_SIZE     (16u * 1024u)
+#define ECS_CHUNK_HEADER   64u // Keeps the first column cache line aligned
+#define ECS_MAX_COMPONENTS 64  // One bit each in an archetype's mask
+#define ECS_NO_COLUMN      0xFF
+
+typedef uint64_t EcsMask;
+
+// 16 KiB block: this header, then one array of count entity handles, then one array per
+// component of the archetype, each at the archetype's offset from the chunk's start
+typedef struct EcsChunk
+{
+    uint32_t count;
+} EcsChunk;
+
+// Every entity with exactly one set of components. Its chunks are all full but the last, so
+// removing an entity moves the archetype's last entity into the hole.
+typedef struct EcsArchetype
+{
+    EcsMask  mask;
+    uint32_t column_count;
+    uint8_t  column_of[ECS_MAX_COMPONENTS]; // Component index -> column, ECS_NO_COLUMN if absent
+    uint8_t  component[ECS_MAX_COMPONENTS]; // Column -> component index, ascending
+    uint32_t offset[ECS_MAX_COMPONENTS];    // Column -> byte offset in a chunk
+    uint32_t chunk_capacity;                // Entities per chunk
+    DArray   chunks;                        // EcsChunk*
+    uint32_t entity_count;
+} EcsArchetype;
+
+typedef struct EcsLocation
+{
+    uint32_t archetype;
+    uint32_t chunk;
+    uint32_t row;
+} EcsLocation;
+
+// Entity handles come from a HandlePool; components are ids 1..ECS_MAX_COMPONENTS, index id - 1.
+// Archetypes are created on first use and never removed, so their indexes stay valid for the
+// world's lifetime.
+typedef struct EcsWorld
+{
+    HandlePool   entities;
+    EcsLocation* locations;        // By entity slot
+    uint32_t     component_size[ECS_MAX_COMPONENTS];
+    uint32_t     component_align[ECS_MAX_COMPONENTS];
+    uint32_t     component_count;
+    DArray       archetypes;       // EcsArchetype*
+    HashMap      archetype_by_mask; // -> uint32_t index into archetypes
+} EcsWorld;
+
+bool     ecs_init(EcsWorld* world, uint32_t max_entities);
+void     ecs_free(EcsWorld* world);
+
+// 0 when every id is taken or the component would not fit a chunk. align is at most 64 and
+// divides size, as sizeof and _Alignof of any C type do.
+uint32_t ecs_register(EcsWorld* world, uint32_t size, uint32_t align);
+
+// Components start zeroed. 0 when full or an id is not registered.
+uint32_t ecs_create(EcsWorld* world, const uint32_t* components, uint32_t count);
+void     ecs_destroy(EcsWorld* world, uint32_t entity);
+
+// Move the entity to the archetype with or without the component. Added ones start zeroed.
+bool     ecs_add(EcsWorld* world, uint32_t entity, uint32_t component);
+bool     ecs_remove(EcsWorld* world, uint32_t entity, uint32_t component);
+void*    ecs_get(const EcsWorld* world, uint32_t entity, uint32_t component);
+
+// The archetypes a query matches are found once, plus any created since it last ran
+typedef struct EcsChunkRef
+{
+    const EcsArchetype* archetype;
+    EcsChunk*           chunk;
+} EcsChunkRef;
+
+struct EngineQuery
+{
+    EcsMask       with;
+    EcsMask       without;
+    uint32_t      term_count;
+    uint8_t       terms[ENGINE_QUERY_MAX_TERMS]; // Component indexes in the order asked for
+    uint32_t      archetypes_seen;
+    DArray        matched;                       // uint32_t archetype indexes
+    DArray        refs;                          // EcsChunkRef, the chunks of a scheduled run
+    EngineQueryFn fn;
+    void*         user;
+};
+
+bool     ecs_query_init(const EcsWorld* world, EngineQuery* query, const uint32_t* with, uint32_t with_count,
+                        const uint32_t* without, uint32_t without_count);
+void     ecs_query_free(EngineQuery* query);
+uint32_t ecs_query_count(const EcsWorld* world, EngineQuery* query);
+
+// Calls fn once per matching chunk, on the calling thread
+void     ecs_query_each(const EcsWorld* world, EngineQuery* query, EngineQueryFn fn, void* user);
+
+// Queues the matching chunks as jobs in ranges and returns; counter tracks them
+void     ecs_query_schedule(const EcsWorld* world, EngineQuery* query, JobSystem* jobs, EngineQueryFn fn, void* user,
+                            EngineJobCounter* counter);
+
+#endif //ECS_H
@@ -2,96 +2,439 @@
 // Created by Cain Martin on 2025/08/08.
 //
 
-#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include "../../include/engine.h"
 #include "engine_internal.h"
+#include "file_io.h"
+#include "arena.h"
+#include "atomic.h"
+#include "d_array.h"
+#include "ecs.h"
+#include "job_system.h"
+#include "mat4.h"
+#include "memory.h"
+#include "profiler.h"
+#include "transform_graph.h"
 #include "../platform/platform.h"
+#include "../platform/thread.h"
+#include "../graphics/culling.h"
+#include "../graphics/draw_queue.h"
+#include "../graphics/mesh_lod.h"
+#include "../graphics/mesh_optimize.h"
+#include "../graphics/mesh_simplify.h"
+#include "../graphics/mip_generator.h"
+#include "../graphics/occlusion.h"
+#include "../graphics/render_thread.h"
 #include "../graphics/renderer.h"
+#include "../graphics/texture_format.h"
+#include "../graphics/vertex_format.h"
 
 struct InputSystem; // Forward from input.c
 
+#define ENGINE_FRAME_ARENA_SIZE (16u * 1024u * 1024u) // Per frame
+#define ENGINE_IO_THREADS       2
+#define ENGINE_MAX_DRAW_BUCKETS 256
+#define ENGINE_JOB_BATCH        64  // EngineJobDesc converted per submit
+#define ENGINE_CULL_RANGE       1024 // Draws per culling job at least
+#define ENGINE_TRANSFORM_NODES  16384
+#define ENGINE_MAX_ENTITIES     65536
+
+// Padded to whole cache lines, so threads bumping neighbouring buckets' counts do not share one
+struct EngineDrawBucket {
+    Engine*    engine;
+    DrawBucket draws;
+    uint8_t    pad[CACHE_LINE_SIZE - (sizeof(Engine*) + sizeof(DrawBucket)) % CACHE_LINE_SIZE];
+};
+
 struct Engine {
     Platform*              platform;
     const PlatformAPI*     plat_api;
     Renderer*              renderer;
     const RendererAPI*     rend_api;
     InputSystem*           input;
+    FileLoader*            loader;
+    JobSystem*             jobs;
+    EngineDrawBucket*      buckets;       // Cache line aligned
+    uint32_t               bucket_count;
+    uint32_t               bucketed_draws; // Recorded into all buckets last frame, before culling
+    DArray                 draws;         // DrawItem, engine_draw calls held for culling
+    BoundsTable            bounds;        // Mesh bounds by handle slot
+    Frustum                frustum;
+    EngineCamera           camera;
+    bool                   culling;       // Off until the first engine_set_camera
+    LodTable               lods;          // Levels, errors and triangles of every mesh by handle slot
+    LodCamera              lod_camera;    // Rebuilt with the camera and the framebuffer size
+    float                  lod_error_pixels;
+    int                    fb_height;
+    Occlusion*             occlusion;     // EngineConfig.occlusion_culling
+    TransformGraph         transforms;
+    EcsWorld               ecs;
+    EngineQuery            draw_query;    // Transform and renderable
+    uint32_t               draws_visible; // Last frame
+    uint32_t               draws_culled;
+    uint32_t               draws_occluded;
+    uint32_t               occluder_triangles;
+    uint32_t               lod_draws[ENGINE_MESH_MAX_LODS];     // Last frame, visible draws only
+    uint32_t               lod_triangles[ENGINE_MESH_MAX_LODS];
+    FrameArena             frame_arena;
     float                  delta_time;
     double                 last_time;
     double                 elapsed;
+    double                 frame_start;
+    float                  cpu_frame_ms;  // begin_frame to the start of present, last frame
+    float                  present_ms;
+    FramePacing            pacing;        // Without a render thread, which keeps its own
+    bool                   render_thread;
+    uint64_t               frame_heap_allocs; // mem_heap_alloc_count at begin_frame
+    uint32_t               heap_allocs;
+    uint32_t               frame_arena_used;
     bool                   should_quit;
     void*                  user_data;
 };
 
 Engine* engine_create(const EngineConfig* cfg) {
-    Engine* engine = calloc(1, sizeof *engine);
-    if (!engine) return NULL;
+    mem_set_allocator(cfg->allocator);
+    profiler_init();
+    profiler_set_thread_name("main");
+    profiler_set_enabled(cfg->profiler != 0);
 
-    engine->plat_api = platform_get_api();
-    engine->platform = engine->plat_api->create(cfg->width, cfg->height, cfg->title, cfg->vsync ? 1 : 0);
-    if (!engine->platform)
+    Engine* engine = mem_calloc(1, sizeof *engine);
+    if (!engine) goto fail;
+
+    if (cfg->renderer == ENGINE_RENDERER_OPENGL && cfg->platform == ENGINE_PLATFORM_HEADLESS)
     {
-        engine->plat_api->destroy(engine->platform);
-        free(engine);
-        return NULL;
+        fprintf(stderr, "engine_create: the OpenGL renderer needs a windowed platform\n");
+        goto fail;
     }
 
-    engine->rend_api = get_renderer_api();
+    engine->input = input_create();
+    if (!engine->input) goto fail;
+
+    engine->plat_api = cfg->platform == ENGINE_PLATFORM_HEADLESS ? null_platform_get_api() : platform_get_api();
+    engine->platform = engine->plat_api->create(cfg->width, cfg->height, cfg->title, cfg->vsync ? 1 : 0);
+    if (!engine->platform) goto fail;
+
+    const size_t frame_arena_size = cfg->frame_arena_size ? cfg->frame_arena_size : ENGINE_FRAME_ARENA_SIZE;
+    if (!frame_arena_init(&engine->frame_arena, frame_arena_size)) goto fail;
+
+    // Workers come up before the renderer, which encodes vertices on them
+    const uint32_t cores = thread_cpu_count();
+    const uint32_t workers = cfg->job_threads > 0 ? (uint32_t)cfg->job_threads
+                           : cfg->job_threads == 0 && cores > 1 ? cores - 1 : 0;
+    engine->jobs = job_system_create(workers);
+    if (!engine->jobs) goto fail;
+
+    const RendererAPI* backend = cfg->renderer == ENGINE_RENDERER_NULL ? get_null_renderer_api() : get_renderer_api();
+    engine->render_thread = cfg->render_thread != 0;
+    engine->rend_api = engine->render_thread ? get_render_thread_api() : backend;
 
     RendererCreateInfo renderer_create_info =
     {
         .platform_api = engine->plat_api,
         .platform = engine->platform,
+        .frame_arena = &engine->frame_arena,
         .fb_width = cfg->width,
-        .fb_height = cfg->height
+        .fb_height = cfg->height,
+        .shader_cache_dir = cfg->shader_cache_dir,
+        .backend = backend,
+        .jobs = engine->jobs
     };
 
     engine->renderer = engine->rend_api->create(&renderer_create_info);
-    if (!engine->renderer)
-    {
-        engine->plat_api->destroy(engine->platform);
-        free(engine);
-        return NULL;
+    if (!engine->renderer) goto fail;
+
+    if (cfg->draw_buckets > 0) {
+        const uint32_t count = cfg->draw_buckets < ENGINE_MAX_DRAW_BUCKETS ? (uint32_t)cfg->draw_buckets : ENGINE_MAX_DRAW_BUCKETS;
+        engine->buckets = mem_alloc_aligned(count * sizeof(EngineDrawBucket), CACHE_LINE_SIZE);
+        if (engine->buckets) {
+            memset(engine->buckets, 0, count * sizeof(EngineDrawBucket));
+            for (uint32_t i = 0; i < count; ++i) engine->buckets[i].engine = engine;
+            engine->bucket_count = count;
+        } else {
+            fprintf(stderr, "engine_create: no memory for %u draw buckets\n", count);
+        }
+    }
+
+    // Without either, draws go to the renderer unculled
+    if (!d_array_init(&engine->draws, sizeof(DrawItem), D_ARRAY_SIMD_ALIGN, NULL)
+        || !bounds_table_init(&engine->bounds, R_MAX_MESHES))
+        fprintf(stderr, "engine_create: no memory for culling, drawing everything\n");
+    if (!lod_table_init(&engine->lods, R_MAX_MESHES))
+        fprintf(stderr, "engine_create: no memory for LOD selection, drawing LOD 0\n");
+    engine->lod_error_pixels = cfg->lod_error_pixels;
+    engine->fb_height = cfg->height;
+    const uint32_t nodes = cfg->transform_nodes > 0 ? (uint32_t)cfg->transform_nodes : ENGINE_TRANSFORM_NODES;
+    if (!transform_graph_init(&engine->transforms, nodes))
+        fprintf(stderr, "engine_create: no memory for %u transform nodes\n", nodes);
+    const uint32_t entities = cfg->max_entities > 0 ? (uint32_t)cfg->max_entities : ENGINE_MAX_ENTITIES;
+    const ComponentId drawn[2] = { ENGINE_COMPONENT_TRANSFORM, ENGINE_COMPONENT_RENDERABLE };
+    if (!ecs_init(&engine->ecs, entities)
+        || ecs_register(&engine->ecs, sizeof(EngineTransform), sizeof(float)) != ENGINE_COMPONENT_TRANSFORM
+        || ecs_register(&engine->ecs, sizeof(EngineRenderable), sizeof(uint32_t)) != ENGINE_COMPONENT_RENDERABLE
+        || !ecs_query_init(&engine->ecs, &engine->draw_query, drawn, 2, NULL, 0))
+        fprintf(stderr, "engine_create: no memory for %u entities\n", entities);
+    if (cfg->occlusion_culling) {
+        engine->occlusion = occlusion_create(R_MAX_MESHES);
+        if (!engine->occlusion) fprintf(stderr, "engine_create: no memory for occlusion culling, disabled\n");
     }
 
-    engine->input    = input_create();
     engine->user_data = cfg->user_data;
 
+    // Not fatal - without I/O threads engine_load_file_async just rejects requests
+    engine->loader = file_loader_create(cfg->io_threads > 0 ? (uint32_t)cfg->io_threads : ENGINE_IO_THREADS);
+
     engine->last_time = engine->plat_api->time_now_seconds();
     engine->elapsed   = 0.0;
 
     return engine;
+
+fail:
+    // Everything the engine set up before the failure, then what engine_shutdown would undo
+    if (engine) {
+        job_system_destroy(engine->jobs);
+        if (engine->platform) engine->plat_api->destroy(engine->platform);
+        frame_arena_shutdown(&engine->frame_arena);
+        input_destroy(engine->input);
+        mem_free(engine);
+    }
+    profiler_shutdown();
+    mem_set_allocator(NULL);
+    return NULL;
 }
 
 void engine_shutdown(Engine* e) {
     if (!e) return;
+    file_loader_destroy(e->loader);
+    for (uint32_t i = 0; i < e->bucket_count; ++i) draw_bucket_free(&e->buckets[i].draws);
+    mem_free_aligned(e->buckets);
+    d_array_free(&e->draws);
+    bounds_table_free(&e->bounds);
+    lod_table_free(&e->lods);
+    occlusion_destroy(e->occlusion);
+    transform_graph_free(&e->transforms);
+    ecs_query_free(&e->draw_query);
+    ecs_free(&e->ecs);
     input_destroy(e->input);
     e->rend_api->destroy(e->renderer);
+    job_system_destroy(e->jobs);
     e->plat_api->destroy(e->platform);
-    free(e);
+    frame_arena_shutdown(&e->frame_arena);
+    mem_free(e);
+    profiler_shutdown();
+    mem_set_allocator(NULL);
 }
 
 void engine_begin_frame(Engine* e) {
+    profiler_frame_begin();
+    PROFILE_BEGIN("frame");
+    e->frame_heap_allocs = mem_heap_alloc_count();
+    frame_arena_begin(&e->frame_arena);
     input_begin_frame(e->input);
 
+    PROFILE_BEGIN("poll_events");
     bool quit = false;
     e->plat_api->poll_events(e->platform, e->input, &quit);
     if (quit) e->should_quit = true;
+    PROFILE_END();
 
     double now = e->plat_api->time_now_seconds();
     e->delta_time = (float)(now - e->last_time);
     e->elapsed += (now - e->last_time);
     e->last_time = now;
+    e->frame_start = now;
+
+    if (e->loader) {
+        PROFILE_BEGIN("file_callbacks");
+        file_loader_drain(e->loader);
+        PROFILE_END();
+    }
 
     int w = 0;
     int h = 0;
     e->plat_api->get_drawable_size(e->platform, &w, &h);
+    if (h != e->fb_height) {
+        e->fb_height = h;
+        if (e->culling) lod_camera_from(&e->camera, h, e->lod_error_pixels, &e->lod_camera);
+    }
     e->rend_api->begin_frame(e->renderer, w, h);
+
+    // Which thread fills which bucket depends on work stealing, so any one bucket may get
+    // every draw: reserving each for last frame's total keeps recording from allocating
+    for (uint32_t b = 0; b < e->bucket_count; ++b) draw_bucket_reserve(&e->buckets[b].draws, e->bucketed_draws);
+}
+
+// Draws held until they are culled: engine_draw's list, then one per bucket
+typedef struct CullList
+{
+    const DrawItem* items;
+    uint32_t        count;
+    uint8_t*        visible; // One flag per item, NULL when every item is drawn
+} CullList;
+
+typedef struct CullJob
+{
+    const Engine*   engine;
+    const DrawItem* items;
+    uint8_t*        visible;
+    uint32_t        hidden;  // Flags cleared by this pass
+} CullJob;
+
+static void frustum_range(void* data, uint32_t begin, uint32_t end)
+{
+    CullJob* job = data;
+    const Engine* e = job->engine;
+    const uint32_t visible = cull_draws(&e->bounds, &e->frustum, job->items + begin, end - begin, job->visible + begin);
+    atomic_fetch_add_u32(&job->hidden, end - begin - visible);
+}
+
+static void occlusion_range(void* data, uint32_t begin, uint32_t end)
+{
+    CullJob* job = data;
+    const Engine* e = job->engine;
+    uint32_t hidden = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        EngineBounds bounds;
+        if (!job->visible[i] || !bounds_table_get(&e->bounds, job->items[i].mesh, &bounds)) continue;
+        if (!occlusion_test(e->occlusion, &bounds, job->items[i].model)) {
+            job->visible[i] = 0;
+            hidden++;
+        }
+    }
+    atomic_fetch_add_u32(&job->hidden, hidden);
+}
+
+static uint32_t cull_pass(Engine* e, const CullList* list, EngineRangeFn fn)
+{
+    CullJob job = { e, list->items, list->visible, 0 };
+    job_system_parallel_for(e->jobs, list->count, ENGINE_CULL_RANGE, fn, &job);
+    return job.hidden;
+}
+
+// Frustum culls every list, then rasterizes the occluders left in view and tests the
+// remaining draws against them
+static void engine_cull(Engine* e, CullList* lists, uint32_t list_count)
+{
+    e->draws_visible = 0;
+    e->draws_culled = 0;
+    e->draws_occluded = 0;
+    e->occluder_triangles = 0;
+    for (uint32_t l = 0; l < list_count; ++l) e->draws_visible += lists[l].count;
+    if (!e->culling || !e->bounds.capacity) return;
+
+    Arena* arena = frame_arena_current(&e->frame_arena);
+    for (uint32_t l = 0; l < list_count; ++l) {
+        if (!lists[l].count) continue;
+        lists[l].visible = arena_alloc(arena, lists[l].count, D_ARRAY_SIMD_ALIGN);
+        if (lists[l].visible) e->draws_culled += cull_pass(e, &lists[l], frustum_range);
+    }
+
+    if (e->occlusion) {
+        occlusion_begin(e->occlusion, &e->camera);
+        for (uint32_t l = 0; l < list_count; ++l) {
+            for (uint32_t i = 0; lists[l].visible && i < lists[l].count; ++i)
+                if (lists[l].visible[i]) occlusion_add_draw(e->occlusion, lists[l].items[i].mesh, lists[l].items[i].model);
+        }
+        occlusion_rasterize(e->occlusion, e->jobs);
+        e->occluder_triangles = occlusion_triangle_count(e->occlusion);
+
+        PROFILE_BEGIN("occlusion_test");
+        for (uint32_t l = 0; e->occluder_triangles && l < list_count; ++l)
+            if (lists[l].visible) e->draws_occluded += cull_pass(e, &lists[l], occlusion_range);
+        PROFILE_END();
+    }
+    e->draws_visible -= e->draws_culled + e->draws_occluded;
+}
+
+// Draws and triangles per level over what survived culling
+static void count_lods(Engine* e, const DrawItem* items, uint32_t count, const uint8_t* visible)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        if (visible && !visible[i]) continue;
+        const uint32_t lod = items[i].lod < ENGINE_MESH_MAX_LODS ? items[i].lod : ENGINE_MESH_MAX_LODS - 1;
+        e->lod_draws[lod]++;
+        e->lod_triangles[lod] += lod_table_triangles(&e->lods, items[i].mesh, lod);
+    }
 }
 
 void engine_end_frame(Engine* e) {
-    e->rend_api->end_frame(e->renderer);
-    e->rend_api->present(e->renderer);
+    PROFILE_BEGIN("cull");
+    CullList lists[1 + ENGINE_MAX_DRAW_BUCKETS];
+    lists[0].items = D_ARRAY_DATA(&e->draws, DrawItem);
+    lists[0].count = e->draws.count;
+    lists[0].visible = NULL;
+    e->bucketed_draws = 0;
+    for (uint32_t b = 0; b < e->bucket_count; ++b) {
+        lists[1 + b].items = e->buckets[b].draws.items;
+        lists[1 + b].count = e->buckets[b].draws.count;
+        lists[1 + b].visible = NULL;
+        e->bucketed_draws += e->buckets[b].draws.count;
+    }
+    engine_cull(e, lists, 1 + e->bucket_count);
+
+    // Buckets are compacted in place, keys and items together
+    for (uint32_t b = 0; b < e->bucket_count; ++b) {
+        DrawBucket* bucket = &e->buckets[b].draws;
+        const uint8_t* visible = lists[1 + b].visible;
+        if (!visible) continue;
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < bucket->count; ++i) {
+            if (!visible[i]) continue;
+            bucket->keys[kept] = bucket->keys[i];
+            bucket->items[kept] = bucket->items[i];
+            kept++;
+        }
+        bucket->count = kept;
+    }
+    PROFILE_END();
+
+    PROFILE_BEGIN("queue_draws");
+    memset(e->lod_draws, 0, sizeof e->lod_draws);
+    memset(e->lod_triangles, 0, sizeof e->lod_triangles);
+    count_lods(e, lists[0].items, lists[0].count, lists[0].visible);
+    for (uint32_t b = 0; b < e->bucket_count; ++b) count_lods(e, e->buckets[b].draws.items, e->buckets[b].draws.count, NULL);
+
+    const DrawItem* items = lists[0].items;
+    for (uint32_t i = 0; i < lists[0].count; ++i)
+        if (!lists[0].visible || lists[0].visible[i])
+            e->rend_api->draw(e->renderer, items[i].mesh, items[i].material, items[i].model, items[i].lod);
+    d_array_clear(&e->draws);
+    PROFILE_END();
+
+    if (e->bucket_count) {
+        PROFILE_BEGIN("merge_buckets");
+        for (uint32_t i = 0; i < e->bucket_count; ++i)
+            if (e->buckets[i].draws.count || e->buckets[i].draws.rejected)
+                e->rend_api->merge_draws(e->renderer, &e->buckets[i].draws);
+        PROFILE_END();
+    }
+
+    if (e->render_thread) {
+        // Submission and present happen on the render thread, which times them itself
+        PROFILE_BEGIN("render_hand_over");
+        e->rend_api->end_frame(e->renderer);
+        PROFILE_END();
+        e->cpu_frame_ms = (float)((e->plat_api->time_now_seconds() - e->frame_start) * 1000.0);
+    } else {
+        PROFILE_BEGIN("render_submit");
+        e->rend_api->end_frame(e->renderer);
+        PROFILE_END();
+
+        PROFILE_BEGIN("present");
+        const double present_start = e->plat_api->time_now_seconds();
+        e->rend_api->present(e->renderer);
+        const double present_end = e->plat_api->time_now_seconds();
+        PROFILE_END();
+
+        e->cpu_frame_ms = (float)((present_start - e->frame_start) * 1000.0);
+        e->present_ms = (float)((present_end - present_start) * 1000.0);
+        frame_pacing_present(&e->pacing, present_end);
+    }
+    e->heap_allocs = (uint32_t)(mem_heap_alloc_count() - e->frame_heap_allocs);
+    e->frame_arena_used = (uint32_t)frame_arena_current(&e->frame_arena)->offset;
+
+    PROFILE_END(); // frame
+    profiler_frame_end();
 }
 
 void engine_clear(Engine* e, float r, float g, float b, float a) {
@@ -106,20 +449,458 @@ bool engine_was_key_pressed(const Engine* e, EngineKey k) { return input_was_pre
 bool engine_was_key_released(const Engine* e, EngineKey k) { return input_was_released(e->input, k); }
 void* engine_get_user_data(const Engine* e) { return e->user_data; }
 
+void engine_get_render_stats(const Engine* e, EngineRenderStats* out_stats)
+{
+    e->rend_api->get_stats(e->renderer, out_stats);
+    out_stats->cpu_frame_ms = e->cpu_frame_ms;
+    if (!e->render_thread) {
+        out_stats->present_ms = e->present_ms;
+        out_stats->render_thread_ms = 0.0f;
+        out_stats->frame_wait_ms = 0.0f;
+        frame_pacing_stats(&e->pacing, out_stats);
+    }
+    out_stats->draws_visible = e->draws_visible;
+    out_stats->draws_culled = e->draws_culled;
+    out_stats->draws_occluded = e->draws_occluded;
+    out_stats->occluder_triangles = e->occluder_triangles;
+    memcpy(out_stats->lod_draws, e->lod_draws, sizeof out_stats->lod_draws);
+    memcpy(out_stats->lod_triangles, e->lod_triangles, sizeof out_stats->lod_triangles);
+    out_stats->heap_allocs = e->heap_allocs;
+    out_stats->frame_arena_used = e->frame_arena_used;
+}
+
+uint32_t engine_get_command_log(const Engine* e, const EngineCommand** out_commands)
+{
+    if (!e || !out_commands) return 0;
+    *out_commands = NULL;
+    if (!e->rend_api->get_command_log) return 0;
+    return e->rend_api->get_command_log(e->renderer, out_commands);
+}
+
+void engine_set_camera(Engine* engine, const EngineCamera* camera)
+{
+    if (!engine || !camera) return;
+    frustum_from_camera(camera, &engine->frustum);
+    lod_camera_from(camera, engine->fb_height, engine->lod_error_pixels, &engine->lod_camera);
+    engine->camera = *camera;
+    engine->culling = true;
+    engine->rend_api->set_camera(engine->renderer, camera);
+}
+
+void engine_set_uniform_f(Engine* engine, MaterialHandle material, const char* name, const float* vals, int count)
+{
+    if (!engine || !material || !name || !vals) return;
+    engine->rend_api->material_set_uniform_f(engine->renderer, material, name, vals, count);
+}
+
+void engine_draw(Engine* engine, MeshHandle mesh, MaterialHandle material, const float model[16])
+{
+    engine_draw_lod(engine, mesh, material, model, NULL);
+}
+
+void engine_draw_lod(Engine* engine, MeshHandle mesh, MaterialHandle material, const float model[16], uint32_t* lod)
+{
+    if (!engine || !mesh || !material || !model) return;
+    const uint32_t level = lod_select(&engine->lods, &engine->lod_camera, mesh, model, lod ? *lod : LOD_NONE);
+    if (lod) *lod = level;
+    DrawItem* item = d_array_push(&engine->draws);
+    if (!item) {
+        engine->rend_api->draw(engine->renderer, mesh, material, model, level);
+        return;
+    }
+    memcpy(item->model, model, sizeof item->model);
+    item->mesh = mesh;
+    item->material = material;
+    item->lod = level;
+}
+
+NodeHandle engine_node_create(Engine* engine, NodeHandle parent)
+{
+    return engine ? transform_graph_create(&engine->transforms, parent) : 0;
+}
+
+void engine_node_destroy(Engine* engine, NodeHandle node)
+{
+    if (engine) transform_graph_destroy(&engine->transforms, node);
+}
+
+bool engine_node_set_parent(Engine* engine, NodeHandle node, NodeHandle parent)
+{
+    return engine && transform_graph_set_parent(&engine->transforms, node, parent);
+}
+
+void engine_node_set_local(Engine* engine, NodeHandle node, const EngineTransform* local)
+{
+    if (engine && local) transform_graph_set_local(&engine->transforms, node, local);
+}
+
+bool engine_node_get_local(const Engine* engine, NodeHandle node, EngineTransform* out)
+{
+    return engine && out && transform_graph_get_local(&engine->transforms, node, out);
+}
+
+const float* engine_node_world(Engine* engine, NodeHandle node)
+{
+    if (!engine) return NULL;
+    transform_graph_update(&engine->transforms, engine->jobs);
+    return transform_graph_world(&engine->transforms, node);
+}
+
+void engine_update_transforms(Engine* engine)
+{
+    if (engine) transform_graph_update(&engine->transforms, engine->jobs);
+}
+
+void engine_draw_node(Engine* engine, MeshHandle mesh, MaterialHandle material, NodeHandle node)
+{
+    engine_draw(engine, mesh, material, engine_node_world(engine, node));
+}
+
+EngineDrawBucket* engine_draw_bucket(Engine* engine, uint32_t index)
+{
+    if (!engine || index >= engine->bucket_count) return NULL;
+    return &engine->buckets[index];
+}
+
+void engine_bucket_draw(EngineDrawBucket* bucket, MeshHandle mesh, MaterialHandle material, const float model[16])
+{
+    engine_bucket_draw_lod(bucket, mesh, material, model, NULL);
+}
+
+void engine_bucket_draw_lod(EngineDrawBucket* bucket, MeshHandle mesh, MaterialHandle material, const float model[16], uint32_t* lod)
+{
+    if (!bucket || !mesh || !material || !model) return;
+    const Engine* engine = bucket->engine;
+    uint64_t key;
+    if (!engine->rend_api->draw_key(engine->renderer, mesh, material, model, &key)) {
+        bucket->draws.rejected++;
+        return;
+    }
+    const uint32_t level = lod_select(&engine->lods, &engine->lod_camera, mesh, model, lod ? *lod : LOD_NONE);
+    if (lod) *lod = level;
+    draw_bucket_push(&bucket->draws, key, mesh, material, model, level);
+}
+
+void engine_bucket_draw_node(EngineDrawBucket* bucket, MeshHandle mesh, MaterialHandle material, NodeHandle node)
+{
+    if (bucket) engine_bucket_draw(bucket, mesh, material, transform_graph_world(&bucket->engine->transforms, node));
+}
+
+bool engine_transient_mesh_alloc(Engine* engine, uint32_t vertex_count, uint32_t index_count, EngineTransientMesh* out)
+{
+    if (!engine || !out || vertex_count == 0 || index_count == 0) return false;
+    return engine->rend_api->transient_alloc(engine->renderer, vertex_count, index_count, out);
+}
+
+void engine_draw_transient(Engine* engine, const EngineTransientMesh* mesh, MaterialHandle material, const float model[16])
+{
+    if (!engine || !mesh || !material || !model) return;
+    engine->rend_api->draw_transient(engine->renderer, mesh, material, model);
+}
+
+
+void engine_profiler_set_enabled(Engine* e, bool enabled)
+{
+    if (!e) return;
+    profiler_set_enabled(enabled);
+}
+
+uint32_t engine_profiler_get_summary(const Engine* e, EngineProfileZone* out_zones, uint32_t max_zones)
+{
+    if (!e || !out_zones) return 0;
+    return profiler_summary(out_zones, max_zones);
+}
+
+bool engine_profiler_write_trace(const Engine* e, const char* path)
+{
+    if (!e || !path) return false;
+    return profiler_write_trace(path);
+}
+
+void engine_profile_begin(const char* name)
+{
+    PROFILE_BEGIN(name);
+}
+
+void engine_profile_end(void)
+{
+    PROFILE_END();
+}
+
+bool engine_file_map(const char* path, EngineFileView* out_view)
+{
+    if (!path || !out_view) return false;
+    return file_view_open(path, out_view);
+}
+
+void engine_file_unmap(EngineFileView* view)
+{
+    if (view) file_view_close(view);
+}
+
+void engine_jobs_run(Engine* e, const EngineJobDesc* jobs, uint32_t count, EngineJobCounter* counter)
+{
+    if (!jobs) return;
+    Job batch[ENGINE_JOB_BATCH];
+    while (count > 0) {
+        const uint32_t n = count < ENGINE_JOB_BATCH ? count : ENGINE_JOB_BATCH;
+        for (uint32_t i = 0; i < n; ++i) {
+            const Job job = { jobs[i].fn, NULL, jobs[i].data, 0, 0, counter };
+            batch[i] = job;
+        }
+        job_system_submit(e ? e->jobs : NULL, batch, n);
+        jobs += n;
+        count -= n;
+    }
+}
+
+void engine_jobs_wait(Engine* e, EngineJobCounter* counter)
+{
+    if (counter) job_system_wait(e ? e->jobs : NULL, counter);
+}
+
+bool engine_jobs_done(const EngineJobCounter* counter)
+{
+    return !counter || atomic_load_u32(&counter->pending) == 0;
+}
+
+void engine_parallel_for(Engine* e, uint32_t count, uint32_t min_range, EngineRangeFn fn, void* data)
+{
+    if (fn) job_system_parallel_for(e ? e->jobs : NULL, count, min_range, fn, data);
+}
+
+ComponentId engine_component_register(Engine* engine, uint32_t size, uint32_t align)
+{
+    return engine ? ecs_register(&engine->ecs, size, align) : 0;
+}
+
+static void entity_init_transform(Engine* engine, EntityHandle entity)
+{
+    EngineTransform* transform = ecs_get(&engine->ecs, entity, ENGINE_COMPONENT_TRANSFORM);
+    if (!transform) return;
+    const EngineTransform identity = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+    *transform = identity;
+}
+
+EntityHandle engine_entity_create(Engine* engine, const ComponentId* components, uint32_t count)
+{
+    if (!engine || (count && !components)) return 0;
+    const EntityHandle entity = ecs_create(&engine->ecs, components, count);
+    if (entity) entity_init_transform(engine, entity);
+    return entity;
+}
+
+void engine_entity_destroy(Engine* engine, EntityHandle entity)
+{
+    if (engine) ecs_destroy(&engine->ecs, entity);
+}
+
+bool engine_entity_add(Engine* engine, EntityHandle entity, ComponentId component)
+{
+    if (!engine) return false;
+    const bool had = ecs_get(&engine->ecs, entity, component) != NULL;
+    if (!ecs_add(&engine->ecs, entity, component)) return false;
+    if (!had && component == ENGINE_COMPONENT_TRANSFORM) entity_init_transform(engine, entity);
+    return true;
+}
+
+bool engine_entity_remove(Engine* engine, EntityHandle entity, ComponentId component)
+{
+    return engine && ecs_remove(&engine->ecs, entity, component);
+}
+
+void* engine_entity_get(Engine* engine, EntityHandle entity, ComponentId component)
+{
+    return engine ? ecs_get(&engine->ecs, entity, component) : NULL;
+}
+
+EngineQuery* engine_query_create(Engine* engine, const ComponentId* with, uint32_t with_count, const ComponentId* without,
+                                 uint32_t without_count)
+{
+    if (!engine || (with_count && !with) || (without_count && !without)) return NULL;
+    EngineQuery* query = mem_alloc(sizeof *query);
+    if (!query) return NULL;
+    if (!ecs_query_init(&engine->ecs, query, with, with_count, without, without_count)) {
+        mem_free(query);
+        return NULL;
+    }
+    return query;
+}
+
+void engine_query_destroy(Engine* engine, EngineQuery* query)
+{
+    (void)engine;
+    if (!query) return;
+    ecs_query_free(query);
+    mem_free(query);
+}
+
+uint32_t engine_query_count(Engine* engine, EngineQuery* query)
+{
+    return engine && query ? ecs_query_count(&engine->ecs, query) : 0;
+}
+
+void engine_query_each(Engine* engine, EngineQuery* query, EngineQueryFn fn, void* user)
+{
+    if (engine && query && fn) ecs_query_each(&engine->ecs, query, fn, user);
+}
+
+void engine_query_schedule(Engine* engine, EngineQuery* query, EngineQueryFn fn, void* user, EngineJobCounter* counter)
+{
+    if (engine && query && fn) ecs_query_schedule(&engine->ecs, query, engine->jobs, fn, user, counter);
+}
+
+typedef struct EntityDraw
+{
+    Engine* engine;
+    bool    bucketed; // Each job thread into its own bucket
+} EntityDraw;
+
+static void draw_entity_chunk(void* user, const EngineQueryChunk* chunk)
+{
+    const EntityDraw* draw = user;
+    const EngineTransform* transforms = chunk->columns[0];
+    EngineRenderable* renderables = chunk->columns[1];
+    EngineDrawBucket* bucket = draw->bucketed ? engine_draw_bucket(draw->engine, job_system_thread_index(draw->engine->jobs)) : NULL;
+    for (uint32_t i = 0; i < chunk->count; ++i) {
+        float model[16];
+        mat4_from_trs(transforms[i].translation, transforms[i].rotation, transforms[i].scale, model);
+        if (bucket) engine_bucket_draw_lod(bucket, renderables[i].mesh, renderables[i].material, model, &renderables[i].lod);
+        else engine_draw_lod(draw->engine, renderables[i].mesh, renderables[i].material, model, &renderables[i].lod);
+    }
+}
+
+void engine_draw_entities(Engine* engine)
+{
+    if (!engine) return;
+    PROFILE_BEGIN("draw_entities");
+    const uint32_t threads = job_system_thread_count(engine->jobs);
+    EntityDraw draw = { engine, threads > 1 && engine->bucket_count >= threads };
+    if (draw.bucketed) {
+        EngineJobCounter counter = { 0 };
+        ecs_query_schedule(&engine->ecs, &engine->draw_query, engine->jobs, draw_entity_chunk, &draw, &counter);
+        job_system_wait(engine->jobs, &counter);
+    } else {
+        ecs_query_each(&engine->ecs, &engine->draw_query, draw_entity_chunk, &draw);
+    }
+    PROFILE_END();
+}
+
+uint32_t engine_job_thread_count(const Engine* e) { return job_system_thread_count(e ? e->jobs : NULL); }
+uint32_t engine_job_thread_index(const Engine* e) { return job_system_thread_index(e ? e->jobs : NULL); }
+
+bool engine_load_file_async(Engine* e, const char* path, EngineFileLoadFn callback, void* user)
+{
+    if (!e || !e->loader || !path || !callback) return false;
+    return file_loader_submit(e->loader, path, callback, user);
+}
 
 // Create methods
+
+// Culling, occlusion and LOD selection learn about a mesh the renderer has just created
+static void mesh_register(Engine* engine, MeshHandle handle, const EngineMeshDesc* desc, const EngineBounds* bounds)
+{
+    if (!handle) return;
+    if (bounds) bounds_table_set(&engine->bounds, handle, bounds);
+    lod_table_set(&engine->lods, handle, desc, bounds);
+    if (engine->occlusion && (desc->flags & ENGINE_MESH_OCCLUDER)) occlusion_add_mesh(engine->occlusion, handle, desc);
+}
+
 MeshHandle engine_mesh_create(Engine* engine, const EngineMeshDesc* desc)
 {
-    if (!engine || !desc) return 0;
-    return (MeshHandle)engine->rend_api->mesh_create(engine->renderer, desc);
+    if (!engine || !desc || !mesh_lods_valid(desc, "engine_mesh_create")) return 0;
+    const bool unpacked = desc->vertices && !desc->packed_vertices;
+    const bool optimize = (desc->flags & ENGINE_MESH_OPTIMIZE) && unpacked;
+    const bool build_lods = (desc->flags & ENGINE_MESH_LODS) && unpacked && desc->lods.count == 0;
+    if (optimize && desc->lods.count) {
+        fprintf(stderr, "engine_mesh_create: ENGINE_MESH_OPTIMIZE would renumber the vertices the LODs index\n");
+        return 0;
+    }
+
+    EngineBounds bounds;
+    const bool has_bounds = mesh_bounds_compute(desc, &bounds);
+    if (!optimize && !build_lods) {
+        const MeshHandle handle = (MeshHandle)engine->rend_api->mesh_create(engine->renderer, desc);
+        mesh_register(engine, handle, desc, has_bounds ? &bounds : NULL);
+        return handle;
+    }
+
+    EngineMeshDesc built = *desc;
+    EngineVertex* vertices = optimize ? mem_alloc((size_t)desc->vertex_count * sizeof(EngineVertex)) : NULL;
+    uint32_t* indices = optimize ? mem_alloc((size_t)desc->indices_count * sizeof(uint32_t)) : NULL;
+    uint32_t* lod_indices = build_lods ? mem_alloc((size_t)desc->indices_count * sizeof(uint32_t)) : NULL;
+    bool ok = (!optimize || (vertices && indices)) && (!build_lods || lod_indices);
+    if (ok && optimize) {
+        built.vertex_count = engine_mesh_optimize(desc, vertices, indices, desc->optimize_stats);
+        built.vertices = vertices;
+        built.indices = indices;
+        ok = built.vertex_count != 0;
+    }
+    // A mesh too small or too rough to simplify just gets no levels
+    if (ok && build_lods) engine_mesh_build_lods(&built, lod_indices, &built.lods);
+    built.flags &= ~(uint32_t)(ENGINE_MESH_OPTIMIZE | ENGINE_MESH_LODS);
+
+    const MeshHandle handle = ok ? (MeshHandle)engine->rend_api->mesh_create(engine->renderer, &built) : 0;
+    mesh_register(engine, handle, &built, has_bounds ? &bounds : NULL);
+    mem_free(vertices);
+    mem_free(indices);
+    mem_free(lod_indices);
+    return handle;
+}
+
+uint32_t engine_mesh_optimize(const EngineMeshDesc* desc, EngineVertex* out_vertices, uint32_t* out_indices, EngineMeshOptimizeStats* out_stats)
+{
+    if (!desc || !desc->vertices || !desc->indices || !out_vertices || !out_indices) return 0;
+    memmove(out_vertices, desc->vertices, (size_t)desc->vertex_count * sizeof(EngineVertex));
+    memmove(out_indices, desc->indices, (size_t)desc->indices_count * sizeof(uint32_t));
+    return mesh_optimize(out_vertices, desc->vertex_count, out_indices, desc->indices_count, out_stats);
+}
+
+uint32_t engine_mesh_build_lods(const EngineMeshDesc* desc, uint32_t* out_indices, EngineMeshLods* out_lods)
+{
+    if (!out_lods) return 0;
+    memset(out_lods, 0, sizeof *out_lods);
+    if (!desc || !desc->vertices || !desc->indices || desc->indices_count % 3 != 0 || !out_indices) return 0;
+    return mesh_build_lods(desc->vertices, desc->vertex_count, desc->indices, desc->indices_count, out_indices, out_lods);
+}
+
+uint32_t engine_vertex_layout_stride(const EngineVertexLayout* layout)
+{
+    VertexFormat format;
+    if (!layout || !vertex_format_get(layout, &format)) return 0;
+    return format.stride;
+}
+
+bool engine_vertex_encode(Engine* engine, const EngineVertexLayout* layout, const EngineVertex* vertices, uint32_t count, void* dst)
+{
+    VertexFormat format;
+    if (!layout || !vertices || !dst || !vertex_format_get(layout, &format)) return false;
+    vertex_encode(engine ? engine->jobs : NULL, layout, vertices, count, dst);
+    return true;
 }
 
 void engine_mesh_destroy(Engine* engine, MeshHandle handle)
 {
     if (!engine || !handle) return;
+    bounds_table_remove(&engine->bounds, handle);
+    lod_table_remove(&engine->lods, handle);
+    if (engine->occlusion) occlusion_remove_mesh(engine->occlusion, handle);
     return engine->rend_api->mesh_destroy(engine->renderer, handle);
 }
 
+bool engine_occlusion_depth(const Engine* engine, uint32_t level, const float** out_depth, uint32_t* out_width, uint32_t* out_height)
+{
+    if (!engine || !engine->occlusion || !out_depth) return false;
+    *out_depth = occlusion_depth(engine->occlusion, level, out_width, out_height);
+    return *out_depth != NULL;
+}
+
+bool engine_mesh_bounds(const Engine* engine, MeshHandle handle, EngineBounds* out_bounds)
+{
+    if (!engine || !out_bounds) return false;
+    return bounds_table_get(&engine->bounds, handle, out_bounds);
+}
+
 ShaderHandle engine_shader_create(Engine* engine, const char* vs_source, const char* fs_source)
 {
     if (!engine || !vs_source || !fs_source) return 0;
@@ -132,6 +913,12 @@ void engine_shader_destroy(Engine* engine, ShaderHandle handle)
     return engine->rend_api->shader_destroy(engine->renderer, handle);
 }
 
+EngineShaderStatus engine_shader_status(const Engine* engine, ShaderHandle handle)
+{
+    if (!engine || !handle) return ENGINE_SHADER_INVALID;
+    return engine->rend_api->shader_status(engine->renderer, handle);
+}
+
 TextureHandle engine_texture_create(Engine* engine, const EngineTextureDesc* desc)
 {
     if (!engine || !desc) return 0;
@@ -144,6 +931,37 @@ void engine_texture_destroy(Engine* engine, TextureHandle handle)
     return engine->rend_api->texture_destroy(engine->renderer, handle);
 }
 
+bool engine_texture_format_supported(const Engine* engine, EngineTextureFormat format)
+{
+    if (!engine || (unsigned)format >= ENGINE_TEXTURE_FORMAT_COUNT) return false;
+    return engine->rend_api->texture_format_supported(engine->renderer, format);
+}
+
+size_t engine_texture_level_size(EngineTextureFormat format, int width, int height)
+{
+    if (width <= 0 || height <= 0) return 0;
+    return texture_level_size(format, (uint32_t)width, (uint32_t)height);
+}
+
+int engine_texture_mip_count(int width, int height)
+{
+    if (width <= 0 || height <= 0) return 0;
+    return (int)texture_mip_count((uint32_t)width, (uint32_t)height);
+}
+
+size_t engine_texture_mips_size(EngineTextureFormat format, int width, int height)
+{
+    if (width <= 0 || height <= 0) return 0;
+    const uint32_t w = (uint32_t)width, h = (uint32_t)height;
+    return (size_t)texture_chain_size(format, w, h, 1, texture_mip_count(w, h));
+}
+
+bool engine_texture_generate_mips(Engine* engine, EngineTextureDesc* desc, EngineMipFilter filter, void* dst)
+{
+    if (!desc) return false;
+    return mip_generate_chain(engine ? engine->jobs : NULL, desc, filter, dst);
+}
+
 MaterialHandle engine_material_create(Engine* engine, const EngineMaterialDesc* desc)
 {
     if (!engine || !desc) return 0;
@@ -2,33 +2,299 @@
 // Created by Cain Martin on 2025/08/07.
 //
 
-#include <stdlib.h>
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // mmap, posix_madvise
+#endif
+
 #include <stdio.h>
+#include <string.h>
+#include "atomic.h"
+#include "atomic_queue.h"
 #include "file_io.h"
+#include "memory.h"
+#include "pool.h"
+#include "profiler.h"
+#include "../platform/thread.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define FILE_LOADER_MAX_PATH    512
+#define FILE_LOADER_QUEUE_SIZE  1024 // In flight requests, power of two
+#define FILE_LOADER_PAGE_SIZE   4096
 
 char* read_file(const char* path, size_t* size)
 {
-    FILE* file = fopen(path, "r");
-    if (!file) return NULL;
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Unable to open file %s\n", path);
+        return NULL;
+    }
 
-    fseek(file, 0, SEEK_END);
-    const size_t file_size = ftell(file);
-    rewind(file);
+    long file_size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) file_size = ftell(file);
+    if (file_size < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fprintf(stderr, "Unable to size file %s\n", path);
+        fclose(file);
+        return NULL;
+    }
 
-    char* buffer = malloc(file_size + 1);
-    if (!buffer)
-    {
+    char* buffer = mem_alloc((size_t)file_size + 1);
+    if (!buffer) {
+        fprintf(stderr, "Out of memory reading %s (%ld bytes)\n", path, file_size);
         fclose(file);
-        fprintf(stderr, "Unable to open file %s\n", path);
         return NULL;
     }
 
-    fread(buffer, 1, file_size, file);
+    const size_t read = fread(buffer, 1, (size_t)file_size, file);
+    fclose(file);
+    if (read != (size_t)file_size) {
+        fprintf(stderr, "Short read on %s (%zu of %ld bytes)\n", path, read, file_size);
+        mem_free(buffer);
+        return NULL;
+    }
 
     buffer[file_size] = '\0';
-    *size = file_size;
+    if (size) *size = (size_t)file_size;
+    return buffer;
+}
 
-    fclose(file);
+bool file_view_open(const char* path, EngineFileView* out_view)
+{
+    memset(out_view, 0, sizeof *out_view);
 
-    return buffer;
-}
\ No newline at end of file
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "Unable to open file %s\n", path);
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return true; // Nothing to map - an empty view
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file); // The mapping keeps the file open
+    if (!mapping) return false;
+
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    out_view->data = data;
+    out_view->size = (size_t)size.QuadPart;
+    out_view->internal = mapping;
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Unable to open file %s\n", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Unable to map file %s\n", path);
+        return false;
+    }
+
+    out_view->data = data;
+    out_view->size = (size_t)st.st_size;
+#endif
+
+    return true;
+}
+
+void file_view_close(EngineFileView* view)
+{
+    if (!view->data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(view->data);
+    CloseHandle(view->internal);
+#else
+    munmap((void*)view->data, view->size);
+#endif
+    memset(view, 0, sizeof *view);
+}
+
+// Async loading
+
+typedef struct FileRequest
+{
+    char             path[FILE_LOADER_MAX_PATH];
+    EngineFileLoadFn callback;
+    void*            user;
+    EngineFileView   view;
+    bool             ok;
+} FileRequest;
+
+struct FileLoader
+{
+    AtomicQueue pending;   // Main thread -> workers
+    AtomicQueue completed; // Workers -> main thread
+    Semaphore*  wake;      // One post per pending request, plus one per worker at shutdown
+    Pool        requests;  // Main thread only
+    Thread**    threads;
+    uint32_t    thread_count;
+    uint32_t    in_flight; // Submitted but not yet drained, main thread only
+    uint32_t    quit;
+};
+
+static int file_loader_worker(void* arg)
+{
+    FileLoader* loader = arg;
+    profiler_set_thread_name("io");
+
+    for (;;) {
+        semaphore_wait(loader->wake);
+        if (atomic_load_u32(&loader->quit)) break;
+
+        void* item;
+        if (!atomic_queue_pop(&loader->pending, &item)) continue;
+        FileRequest* request = item;
+
+        PROFILE_BEGIN("file_load");
+        request->ok = file_view_open(request->path, &request->view);
+        if (request->ok && request->view.data) {
+            // Fault the pages in here so the callback reads from memory, not the disk
+#ifndef _WIN32
+            posix_madvise((void*)request->view.data, request->view.size, POSIX_MADV_WILLNEED);
+#endif
+            const volatile uint8_t* bytes = request->view.data;
+            uint8_t sink = 0;
+            for (size_t at = 0; at < request->view.size; at += FILE_LOADER_PAGE_SIZE) sink ^= bytes[at];
+            (void)sink;
+        }
+        PROFILE_END();
+
+        // Submission caps the requests in flight at the queue size, so this cannot fail
+        atomic_queue_push(&loader->completed, request);
+    }
+    return 0;
+}
+
+FileLoader* file_loader_create(uint32_t thread_count)
+{
+    if (thread_count == 0) thread_count = 1;
+
+    FileLoader* loader = mem_calloc(1, sizeof *loader);
+    if (!loader) return NULL;
+
+    loader->threads = mem_calloc(thread_count, sizeof(Thread*));
+    loader->wake = semaphore_create(0);
+    const bool ok = loader->threads && loader->wake
+        && atomic_queue_init(&loader->pending, FILE_LOADER_QUEUE_SIZE)
+        && atomic_queue_init(&loader->completed, FILE_LOADER_QUEUE_SIZE)
+        && pool_init(&loader->requests, sizeof(FileRequest), 8, 64);
+    if (!ok) {
+        file_loader_destroy(loader);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < thread_count; ++i) {
+        loader->threads[i] = thread_create(file_loader_worker, "engine_io", loader);
+        if (!loader->threads[i]) {
+            fprintf(stderr, "file_loader_create: could not start I/O thread %u\n", i);
+            break;
+        }
+        loader->thread_count++;
+    }
+    if (loader->thread_count == 0) {
+        file_loader_destroy(loader);
+        return NULL;
+    }
+
+    return loader;
+}
+
+void file_loader_destroy(FileLoader* loader)
+{
+    if (!loader) return;
+
+    atomic_store_u32(&loader->quit, 1);
+    for (uint32_t i = 0; i < loader->thread_count; ++i) semaphore_post(loader->wake);
+    for (uint32_t i = 0; i < loader->thread_count; ++i) thread_join(loader->threads[i]);
+
+    // Nothing runs any more - release what never reached its callback
+    void* item;
+    if (loader->completed.cells) {
+        while (atomic_queue_pop(&loader->completed, &item)) file_view_close(&((FileRequest*)item)->view);
+    }
+
+    atomic_queue_shutdown(&loader->pending);
+    atomic_queue_shutdown(&loader->completed);
+    pool_shutdown(&loader->requests);
+    semaphore_destroy(loader->wake);
+    mem_free(loader->threads);
+    mem_free(loader);
+}
+
+bool file_loader_submit(FileLoader* loader, const char* path, EngineFileLoadFn callback, void* user)
+{
+    const size_t length = strlen(path);
+    if (length >= FILE_LOADER_MAX_PATH) {
+        fprintf(stderr, "file_loader_submit: path longer than %d bytes: %s\n", FILE_LOADER_MAX_PATH - 1, path);
+        return false;
+    }
+
+    if (loader->in_flight == FILE_LOADER_QUEUE_SIZE) {
+        fprintf(stderr, "file_loader_submit: more than %d requests in flight, %s rejected\n", FILE_LOADER_QUEUE_SIZE, path);
+        return false;
+    }
+
+    FileRequest* request = pool_alloc(&loader->requests);
+    if (!request) return false;
+
+    memcpy(request->path, path, length + 1);
+    request->callback = callback;
+    request->user = user;
+    request->ok = false;
+    memset(&request->view, 0, sizeof request->view);
+
+    atomic_queue_push(&loader->pending, request);
+    loader->in_flight++;
+    semaphore_post(loader->wake);
+    return true;
+}
+
+uint32_t file_loader_drain(FileLoader* loader)
+{
+    uint32_t delivered = 0;
+    void* item;
+    while (atomic_queue_pop(&loader->completed, &item)) {
+        FileRequest* request = item;
+        // The callback owns the view from here, including on failure (an empty view)
+        request->callback(request->user, request->path, request->view, request->ok);
+        pool_free(&loader->requests, request);
+        loader->in_flight--;
+        delivered++;
+    }
+    return delivered;
+}
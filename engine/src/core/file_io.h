@@ -5,8 +5,30 @@
 #ifndef FILE_IO_H_H
 #define FILE_IO_H_H
 
+#include <stdbool.h>
 #include <stdio.h>
+#include "../../include/engine.h"
 
+// Returns a NUL terminated copy of the file, released with mem_free. Reads in binary mode,
+// so size is the file's size on disk.
 char* read_file(const char* path, size_t* size);
 
+// Read-only zero-copy view of a whole file (see EngineFileView)
+bool file_view_open(const char* path, EngineFileView* out_view);
+void file_view_close(EngineFileView* view);
+
+// Small pool of I/O threads that map files off the main thread. Requests are submitted and
+// their callbacks run on the thread that calls file_loader_drain; the workers only map and
+// prefault. Completions come back through a lock-free queue, so draining never blocks.
+typedef struct FileLoader FileLoader;
+
+FileLoader* file_loader_create(uint32_t thread_count);
+void        file_loader_destroy(FileLoader* loader); // Drops requests not yet delivered
+
+// Returns false when the request queue is full or the path is too long
+bool        file_loader_submit(FileLoader* loader, const char* path, EngineFileLoadFn callback, void* user);
+
+// Runs the callbacks of every completed request, returns how many ran
+uint32_t    file_loader_drain(FileLoader* loader);
+
 #endif //FILE_IO_H_H
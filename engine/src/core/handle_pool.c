@@ -0,0 +1,90 @@
+//
+// Created by Cain Martin on 2025/08/20.
+//
+
+#include <string.h>
+#include "handle_pool.h"
+#include "memory.h"
+
+bool handle_pool_init(HandlePool* pool, uint32_t capacity)
+{
+    memset(pool, 0, sizeof *pool);
+    if (capacity == 0 || capacity > HANDLE_MAX_CAPACITY) return false;
+
+    // One block for all per-slot arrays, sized once up front - no allocation per handle
+    const size_t u32_bytes = (size_t)capacity * sizeof(uint32_t);
+    const size_t gen_bytes = (size_t)capacity * sizeof(uint16_t);
+    uint8_t* block = mem_alloc(u32_bytes * 3 + gen_bytes);
+    if (!block) return false;
+
+    pool->sparse     = (uint32_t*)block;
+    pool->dense      = (uint32_t*)(block + u32_bytes);
+    pool->free_slots = (uint32_t*)(block + u32_bytes * 2);
+    pool->generation = (uint16_t*)(block + u32_bytes * 3);
+    pool->capacity   = capacity;
+
+    // Hand out low slots first so live handles stay compact
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+        pool->sparse[i] = HANDLE_POOL_INVALID;
+        pool->generation[i] = 1;
+        pool->free_slots[i] = capacity - 1 - i;
+    }
+    pool->free_count = capacity;
+
+    return true;
+}
+
+void handle_pool_shutdown(HandlePool* pool)
+{
+    mem_free(pool->sparse);
+    memset(pool, 0, sizeof *pool);
+}
+
+uint32_t handle_pool_alloc(HandlePool* pool, uint32_t* out_dense)
+{
+    if (pool->free_count == 0) return 0;
+
+    const uint32_t slot = pool->free_slots[--pool->free_count];
+    const uint32_t dense = pool->count++;
+
+    pool->sparse[slot] = dense;
+    pool->dense[dense] = slot;
+
+    if (out_dense) *out_dense = dense;
+    return ((uint32_t)pool->generation[slot] << HANDLE_INDEX_BITS) | slot;
+}
+
+bool handle_pool_release(HandlePool* pool, uint32_t handle, uint32_t* out_removed, uint32_t* out_moved_from)
+{
+    const uint32_t removed = handle_pool_lookup(pool, handle);
+    if (removed == HANDLE_POOL_INVALID) return false;
+
+    const uint32_t slot = handle_index(handle);
+    const uint32_t last = --pool->count;
+
+    // Swap the last live entry into the hole to keep the dense range packed
+    const uint32_t moved_slot = pool->dense[last];
+    pool->dense[removed] = moved_slot;
+    pool->sparse[moved_slot] = removed;
+
+    pool->sparse[slot] = HANDLE_POOL_INVALID;
+
+    // Bump the generation so outstanding copies of this handle go stale. Skip 0 on wrap so
+    // a handle is never 0.
+    uint16_t gen = (uint16_t)((pool->generation[slot] + 1) & HANDLE_GEN_MASK);
+    pool->generation[slot] = gen ? gen : 1;
+
+    pool->free_slots[pool->free_count++] = slot;
+
+    if (out_removed) *out_removed = removed;
+    if (out_moved_from) *out_moved_from = last;
+    return true;
+}
+
+uint32_t handle_pool_handle_at(const HandlePool* pool, uint32_t dense_index)
+{
+    if (dense_index >= pool->count) return 0;
+    const uint32_t slot = pool->dense[dense_index];
+    return ((uint32_t)pool->generation[slot] << HANDLE_INDEX_BITS) | slot;
+}
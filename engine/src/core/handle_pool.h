@@ -0,0 +1,66 @@
+//
+// Created by Cain Martin on 2025/08/20.
+//
+
+#ifndef HANDLE_POOL_H
+#define HANDLE_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Handles are 32 bits: the low bits index a slot, the high bits hold the slot's generation.
+// Generations start at 1, so a valid handle is never 0 and 0 can be used as "no handle".
+#define HANDLE_INDEX_BITS 20
+#define HANDLE_INDEX_MASK ((1u << HANDLE_INDEX_BITS) - 1u)
+#define HANDLE_GEN_BITS   (32 - HANDLE_INDEX_BITS)
+#define HANDLE_GEN_MASK   ((1u << HANDLE_GEN_BITS) - 1u)
+#define HANDLE_MAX_CAPACITY HANDLE_INDEX_MASK
+
+#define HANDLE_POOL_INVALID UINT32_MAX
+
+static inline uint32_t handle_index(uint32_t handle) { return handle & HANDLE_INDEX_MASK; }
+static inline uint32_t handle_generation(uint32_t handle) { return handle >> HANDLE_INDEX_BITS; }
+
+// Slot table with a sparse -> dense indirection. Live entries are always packed into
+// [0, count) so the owner can keep its data in parallel (SoA) arrays indexed by the dense
+// index and walk them linearly. Removal swaps the last entry into the hole.
+typedef struct HandlePool
+{
+    uint32_t  capacity;
+    uint32_t  count;      // Live handles, also the length of the owner's dense arrays
+    uint32_t  free_count;
+    uint16_t* generation; // Per slot
+    uint32_t* sparse;     // Slot -> dense index, HANDLE_POOL_INVALID while the slot is free
+    uint32_t* dense;      // Dense index -> slot
+    uint32_t* free_slots; // Stack of free slots
+} HandlePool;
+
+bool handle_pool_init(HandlePool* pool, uint32_t capacity);
+void handle_pool_shutdown(HandlePool* pool);
+
+// Returns 0 when the pool is full. out_dense receives the dense index of the new entry,
+// which is always the old count.
+uint32_t handle_pool_alloc(HandlePool* pool, uint32_t* out_dense);
+
+// Releases the handle. The caller must move its dense data from out_moved_from to
+// out_removed when they differ. Returns false for stale or invalid handles.
+bool handle_pool_release(HandlePool* pool, uint32_t handle, uint32_t* out_removed, uint32_t* out_moved_from);
+
+// Rebuilds the handle of the entry currently stored at a dense index.
+uint32_t handle_pool_handle_at(const HandlePool* pool, uint32_t dense_index);
+
+// Dense index for a live handle, HANDLE_POOL_INVALID for stale or invalid handles.
+static inline uint32_t handle_pool_lookup(const HandlePool* pool, uint32_t handle)
+{
+    const uint32_t index = handle_index(handle);
+    if (index >= pool->capacity || pool->generation[index] != handle_generation(handle))
+        return HANDLE_POOL_INVALID;
+    return pool->sparse[index];
+}
+
+static inline bool handle_pool_is_valid(const HandlePool* pool, uint32_t handle)
+{
+    return handle_pool_lookup(pool, handle) != HANDLE_POOL_INVALID;
+}
+
+#endif //HANDLE_POOL_H
@@ -0,0 +1,143 @@
+//
+// Created by Cain Martin on 2025/08/26.
+//
+
+#include <string.h>
+#include "hash_map.h"
+
+#define HASH_MAP_MIN_SLOTS 16
+
+bool hash_map_init(HashMap* map, uint32_t value_size, uint32_t align, struct Arena* arena)
+{
+    map->count = 0;
+    return d_array_init(&map->keys, sizeof(uint64_t), 0, arena)
+        && d_array_init(&map->used, 1, 0, arena)
+        && d_array_init(&map->values, value_size, align, arena);
+}
+
+void hash_map_free(HashMap* map)
+{
+    d_array_free(&map->keys);
+    d_array_free(&map->used);
+    d_array_free(&map->values);
+    map->count = 0;
+}
+
+// Slot holding key, or the empty slot where it would go
+static uint32_t hash_map_probe(const HashMap* map, uint64_t key)
+{
+    const uint32_t mask = map->keys.count - 1;
+    const uint64_t* keys = D_ARRAY_DATA(&map->keys, uint64_t);
+    const uint8_t* used = map->used.data;
+
+    uint32_t slot = (uint32_t)hash_u64(key) & mask;
+    while (used[slot] && keys[slot] != key) slot = (slot + 1) & mask;
+    return slot;
+}
+
+static bool hash_map_rehash(HashMap* map, uint32_t slots)
+{
+    HashMap grown;
+    if (!hash_map_init(&grown, map->values.elem_size, map->values.align, map->keys.arena)) return false;
+    if (!d_array_resize(&grown.keys, slots) || !d_array_resize(&grown.used, slots)
+        || !d_array_resize(&grown.values, slots)) {
+        hash_map_free(&grown);
+        return false;
+    }
+
+    const uint64_t* keys = D_ARRAY_DATA(&map->keys, uint64_t);
+    for (uint32_t i = 0; i < map->keys.count; ++i) {
+        if (!map->used.data[i]) continue;
+        const uint32_t slot = hash_map_probe(&grown, keys[i]);
+        D_ARRAY_DATA(&grown.keys, uint64_t)[slot] = keys[i];
+        grown.used.data[slot] = 1;
+        memcpy(d_array_at(&grown.values, slot), d_array_at(&map->values, i), map->values.elem_size);
+    }
+
+    grown.count = map->count;
+    hash_map_free(map);
+    *map = grown;
+    return true;
+}
+
+bool hash_map_reserve(HashMap* map, uint32_t count)
+{
+    uint32_t slots = map->keys.count ? map->keys.count : HASH_MAP_MIN_SLOTS;
+    while ((uint64_t)count * 4 > (uint64_t)slots * 3) {
+        if (slots > UINT32_MAX / 2) return false;
+        slots *= 2;
+    }
+    return slots == map->keys.count || hash_map_rehash(map, slots);
+}
+
+void* hash_map_insert(HashMap* map, uint64_t key, bool* out_inserted)
+{
+    if (out_inserted) *out_inserted = false;
+
+    // An existing key is found before growing, so inserting it again moves nothing
+    const uint32_t slots = map->keys.count;
+    uint32_t slot = slots ? hash_map_probe(map, key) : 0;
+    if (slots && map->used.data[slot]) return d_array_at(&map->values, slot);
+
+    if (!hash_map_reserve(map, map->count + 1)) return NULL;
+    if (map->keys.count != slots) slot = hash_map_probe(map, key);
+    D_ARRAY_DATA(&map->keys, uint64_t)[slot] = key;
+    map->used.data[slot] = 1;
+    map->count++;
+    if (out_inserted) *out_inserted = true;
+    return d_array_at(&map->values, slot);
+}
+
+void* hash_map_get(const HashMap* map, uint64_t key)
+{
+    if (map->count == 0) return NULL;
+    const uint32_t slot = hash_map_probe(map, key);
+    return map->used.data[slot] ? d_array_at(&map->values, slot) : NULL;
+}
+
+bool hash_map_remove(HashMap* map, uint64_t key)
+{
+    if (map->count == 0) return false;
+
+    uint32_t hole = hash_map_probe(map, key);
+    if (!map->used.data[hole]) return false;
+
+    // Backward shift: pull later entries of the probe run into the hole unless that would
+    // move them in front of their home slot
+    const uint32_t mask = map->keys.count - 1;
+    uint64_t* keys = D_ARRAY_DATA(&map->keys, uint64_t);
+    uint8_t* used = map->used.data;
+    for (uint32_t next = (hole + 1) & mask; used[next]; next = (next + 1) & mask) {
+        const uint32_t home = (uint32_t)hash_u64(keys[next]) & mask;
+        const uint32_t from_home = (next - home) & mask;
+        const uint32_t from_hole = (next - hole) & mask;
+        if (from_home < from_hole) continue;
+
+        keys[hole] = keys[next];
+        memcpy(d_array_at(&map->values, hole), d_array_at(&map->values, next), map->values.elem_size);
+        hole = next;
+    }
+
+    used[hole] = 0;
+    map->count--;
+    return true;
+}
+
+void hash_map_clear(HashMap* map)
+{
+    if (map->used.count) memset(map->used.data, 0, map->used.count);
+    map->count = 0;
+}
+
+bool hash_map_next(const HashMap* map, uint32_t* cursor, uint64_t* out_key, void** out_value)
+{
+    for (uint32_t i = *cursor; i < map->used.count; ++i) {
+        if (!map->used.data[i]) continue;
+        if (out_key) *out_key = D_ARRAY_DATA(&map->keys, uint64_t)[i];
+        if (out_value) *out_value = d_array_at(&map->values, i);
+        *cursor = i + 1;
+        return true;
+    }
+    *cursor = map->used.count;
+    return false;
+}
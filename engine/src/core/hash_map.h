@@ -0,0 +1,49 @@
+//
+// Created by Cain Martin on 2025/08/26.
+//
+
+#ifndef HASH_MAP_H
+#define HASH_MAP_H
+
+#include "d_array.h"
+
+// Open-addressing map from 64-bit keys to fixed-size values. Linear probing over a power of
+// two table kept at most 3/4 full; removal shifts the following entries back instead of
+// leaving tombstones, so probe lengths do not degrade with churn. Hash string keys before
+// inserting them (FNV-1a or similar) - the map mixes the bits again.
+typedef struct HashMap
+{
+    DArray   keys;
+    DArray   used;   // One byte per slot
+    DArray   values;
+    uint32_t count;
+} HashMap;
+
+bool  hash_map_init(HashMap* map, uint32_t value_size, uint32_t align, struct Arena* arena);
+void  hash_map_free(HashMap* map);
+bool  hash_map_reserve(HashMap* map, uint32_t count);
+
+// Returns the key's value, adding an uninitialised one if the key is new. NULL on exhaustion.
+// Pointers are invalidated by any insert that grows the table, and by removals.
+void* hash_map_insert(HashMap* map, uint64_t key, bool* out_inserted);
+void* hash_map_get(const HashMap* map, uint64_t key);
+bool  hash_map_remove(HashMap* map, uint64_t key);
+void  hash_map_clear(HashMap* map);
+
+// Visits every entry: start with *cursor = 0, stop when it returns false
+bool  hash_map_next(const HashMap* map, uint32_t* cursor, uint64_t* out_key, void** out_value);
+
+static inline uint32_t hash_map_count(const HashMap* map) { return map->count; }
+
+// 64-bit finaliser (splitmix64), spreads clustered keys such as handles or pointers
+static inline uint64_t hash_u64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+#endif //HASH_MAP_H
@@ -4,9 +4,9 @@
 
 #include <string.h>
 #include <stdbool.h>
-#include <stdlib.h>
 
 #include "../../include/engine.h"
+#include "memory.h"
 
 typedef struct InputSystem
 {
@@ -17,12 +17,12 @@ typedef struct InputSystem
 
 InputSystem* input_create(void)
 {
-    return calloc(1, sizeof(InputSystem));
+    return mem_calloc(1, sizeof(InputSystem));
 }
 
 void input_destroy(InputSystem* input)
 {
-    free(input);
+    mem_free(input);
 }
 
 void input_begin_frame(InputSystem* input)
@@ -0,0 +1,402 @@
+//
+// Created by Cain Martin on 2025/09/03.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "atomic.h"
+#include "job_system.h"
+#include "memory.h"
+#include "profiler.h"
+#include "../platform/thread.h"
+
+#define JOB_DEQUE_SIZE     4096 // Per thread, power of two
+#define JOB_INJECT_SIZE    1024 // Jobs from other threads, power of two
+#define JOB_MAX_WORKERS    63
+#define JOB_SPIN_ROUNDS    256  // Failed steal rounds before a worker or a waiter sleeps
+#define JOB_RANGES_PER_THREAD 4 // parallel_for granularity, so stealing can even out uneven ranges
+
+// Chase-Lev deque (Le, Pop, Cohen, Zappa Nardelli 2013). The owner moves bottom, thieves
+// move top; the two only race for the last job, settled by a compare-and-swap on top.
+typedef struct JobDeque
+{
+    uint64_t top;
+    uint8_t  pad0[CACHE_LINE_SIZE - sizeof(uint64_t)];
+    uint64_t bottom;
+    uint8_t  pad1[CACHE_LINE_SIZE - sizeof(uint64_t)];
+    Job      jobs[JOB_DEQUE_SIZE];
+} JobDeque;
+
+typedef struct JobWorker
+{
+    JobDeque   deque;      // First, so it keeps the allocation's cache line alignment
+    JobSystem* system;
+    Thread*    thread;
+    Semaphore* wake;       // Its own, for sleeping in job_system_wait
+    uint32_t   index;      // 0 is the creating thread, 1.. the workers that started
+    uint32_t   rng;        // Victim selection
+} JobWorker;
+
+struct JobSystem
+{
+    JobWorker* workers;     // slot_count of them, cache line aligned
+    uint32_t   slot_count;  // Fixed before any worker starts; slots whose thread failed stay empty
+    uint32_t   thread_count;
+    Semaphore* wake;
+    uint32_t   sleepers;    // Workers registered to sleep and not yet woken
+    uint64_t   waiting;     // Slots asleep in job_system_wait, one bit each
+    uint32_t   quit;
+
+    Mutex*     inject_lock;
+    Job        inject[JOB_INJECT_SIZE];
+    uint32_t   inject_head;
+    uint32_t   inject_count; // Read without the lock to skip it when empty
+};
+
+static THREAD_LOCAL JobWorker* t_worker;
+
+static JobWorker* job_self(const JobSystem* jobs)
+{
+    return t_worker && t_worker->system == jobs ? t_worker : NULL;
+}
+
+// Deque
+
+static bool deque_push(JobDeque* deque, const Job* job)
+{
+    const uint64_t b = atomic_load_u64(&deque->bottom);
+    const uint64_t t = atomic_load_u64(&deque->top);
+    if (b - t >= JOB_DEQUE_SIZE) return false;
+    deque->jobs[b & (JOB_DEQUE_SIZE - 1)] = *job;
+    atomic_store_u64(&deque->bottom, b + 1);
+    return true;
+}
+
+static bool deque_pop(JobDeque* deque, Job* out)
+{
+    const uint64_t b = atomic_load_u64(&deque->bottom) - 1;
+    atomic_store_u64(&deque->bottom, b);
+    atomic_fence();
+    uint64_t t = atomic_load_u64(&deque->top);
+
+    if ((int64_t)(b - t) < 0) {
+        atomic_store_u64(&deque->bottom, b + 1);
+        return false;
+    }
+    *out = deque->jobs[b & (JOB_DEQUE_SIZE - 1)];
+    if (b != t) return true;
+
+    // The last job: a thief may be taking it at the same time
+    const bool won = atomic_cas_u64(&deque->top, &t, t + 1);
+    atomic_store_u64(&deque->bottom, b + 1);
+    return won;
+}
+
+static bool deque_steal(JobDeque* deque, Job* out)
+{
+    uint64_t t = atomic_load_u64(&deque->top);
+    atomic_fence();
+    const uint64_t b = atomic_load_u64(&deque->bottom);
+    if ((int64_t)(b - t) <= 0) return false;
+
+    // The copy is only kept if top still points at it; otherwise another thread has the job
+    *out = deque->jobs[t & (JOB_DEQUE_SIZE - 1)];
+    return atomic_cas_u64(&deque->top, &t, t + 1);
+}
+
+// Scheduling
+
+static bool inject_push(JobSystem* jobs, const Job* job)
+{
+    mutex_lock(jobs->inject_lock);
+    const bool ok = jobs->inject_count < JOB_INJECT_SIZE;
+    if (ok) {
+        jobs->inject[(jobs->inject_head + jobs->inject_count) & (JOB_INJECT_SIZE - 1)] = *job;
+        atomic_store_u32(&jobs->inject_count, jobs->inject_count + 1);
+    }
+    mutex_unlock(jobs->inject_lock);
+    return ok;
+}
+
+static bool inject_pop(JobSystem* jobs, Job* out)
+{
+    if (atomic_load_u32(&jobs->inject_count) == 0) return false;
+
+    mutex_lock(jobs->inject_lock);
+    const bool ok = jobs->inject_count > 0;
+    if (ok) {
+        *out = jobs->inject[jobs->inject_head];
+        jobs->inject_head = (jobs->inject_head + 1) & (JOB_INJECT_SIZE - 1);
+        atomic_store_u32(&jobs->inject_count, jobs->inject_count - 1);
+    }
+    mutex_unlock(jobs->inject_lock);
+    return ok;
+}
+
+// Own deque first, then the shared queue, then every other thread's deque from a random start
+static bool job_next(JobSystem* jobs, JobWorker* self, Job* out)
+{
+    if (self && deque_pop(&self->deque, out)) return true;
+    if (inject_pop(jobs, out)) return true;
+
+    uint32_t start = 0;
+    if (self) {
+        self->rng ^= self->rng << 13;
+        self->rng ^= self->rng >> 17;
+        self->rng ^= self->rng << 5;
+        start = self->rng;
+    }
+    for (uint32_t i = 0; i < jobs->slot_count; ++i) {
+        JobWorker* victim = &jobs->workers[(start + i) % jobs->slot_count];
+        if (victim != self && deque_steal(&victim->deque, out)) return true;
+    }
+    return false;
+}
+
+// Every waiter is woken to look at its counter. Each has its own semaphore, since a post on a
+// shared one can be taken by a thread that goes back to sleep before the waiter runs.
+static void job_wake_waiters(JobSystem* jobs)
+{
+    uint64_t waiting = atomic_load_u64(&jobs->waiting);
+    while (waiting && !atomic_cas_u64(&jobs->waiting, &waiting, 0)) {}
+    for (uint32_t i = 0; i < jobs->slot_count; ++i)
+        if (waiting & (1ull << i)) semaphore_post(jobs->workers[i].wake);
+}
+
+static void job_wake(JobSystem* jobs, uint32_t count)
+{
+    // Pairs with the fences in job_worker_main and job_wait_sleep: either the sleeper sees the
+    // new jobs or this sees the sleeper
+    atomic_fence();
+    uint32_t sleepers = atomic_load_u32(&jobs->sleepers);
+    while (count > 0 && sleepers > 0) {
+        if (atomic_cas_u32(&jobs->sleepers, &sleepers, sleepers - 1)) {
+            semaphore_post(jobs->wake);
+            sleepers--;
+            count--;
+        }
+    }
+    // Waiters run jobs too, and may be the only threads left awake to take these
+    if (count > 0 && atomic_load_u64(&jobs->waiting)) job_wake_waiters(jobs);
+}
+
+static bool job_visible(const JobSystem* jobs)
+{
+    if (atomic_load_u32(&jobs->inject_count)) return true;
+    for (uint32_t i = 0; i < jobs->slot_count; ++i) {
+        const JobDeque* deque = &jobs->workers[i].deque;
+        if ((int64_t)(atomic_load_u64(&deque->bottom) - atomic_load_u64(&deque->top)) > 0) return true;
+    }
+    return false;
+}
+
+static void job_run(JobSystem* jobs, const Job* job)
+{
+    PROFILE_BEGIN("job");
+    if (job->fn) job->fn(job->data);
+    else if (job->range) job->range(job->data, job->begin, job->end);
+    PROFILE_END();
+    if (!job->counter || atomic_fetch_add_u32(&job->counter->pending, UINT32_MAX) != 1 || !jobs) return;
+
+    // Pairs with the fence in job_wait_sleep
+    atomic_fence();
+    if (atomic_load_u64(&jobs->waiting)) job_wake_waiters(jobs);
+}
+
+// Register, then look once more, so a counter finished or a job pushed in between is not
+// slept through
+static void job_wait_sleep(JobSystem* jobs, JobWorker* self, const EngineJobCounter* counter)
+{
+    const uint64_t bit = 1ull << (self - jobs->workers);
+    uint64_t waiting = atomic_load_u64(&jobs->waiting);
+    while (!atomic_cas_u64(&jobs->waiting, &waiting, waiting | bit)) {}
+    atomic_fence();
+    if (atomic_load_u32(&counter->pending) != 0 && !job_visible(jobs)) {
+        semaphore_wait(self->wake);
+        return;
+    }
+    // Take the bit back. If a waker already cleared it, its post is on the way.
+    waiting = atomic_load_u64(&jobs->waiting);
+    while ((waiting & bit) && !atomic_cas_u64(&jobs->waiting, &waiting, waiting & ~bit)) {}
+    if (!(waiting & bit)) semaphore_wait(self->wake);
+}
+
+static int job_worker_main(void* arg)
+{
+    JobWorker* self = arg;
+    JobSystem* jobs = self->system;
+    t_worker = self;
+    profiler_set_thread_name("jobs");
+
+    uint32_t idle = 0;
+    while (!atomic_load_u32(&jobs->quit)) {
+        Job job;
+        if (job_next(jobs, self, &job)) {
+            job_run(jobs, &job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < JOB_SPIN_ROUNDS) {
+            cpu_relax();
+            continue;
+        }
+
+        // Register, then look once more, so a job pushed in between is not slept through
+        idle = 0;
+        atomic_fetch_add_u32(&jobs->sleepers, 1);
+        atomic_fence();
+        if (!job_visible(jobs) && !atomic_load_u32(&jobs->quit)) {
+            semaphore_wait(jobs->wake);
+            continue;
+        }
+        // Take the registration back. If a waker already claimed it, its post is on the way.
+        uint32_t sleepers = atomic_load_u32(&jobs->sleepers);
+        bool cancelled = false;
+        while (sleepers > 0 && !(cancelled = atomic_cas_u32(&jobs->sleepers, &sleepers, sleepers - 1))) {}
+        if (!cancelled) semaphore_wait(jobs->wake);
+    }
+    return 0;
+}
+
+JobSystem* job_system_create(uint32_t worker_count)
+{
+    if (worker_count > JOB_MAX_WORKERS) worker_count = JOB_MAX_WORKERS;
+
+    JobSystem* jobs = mem_calloc(1, sizeof *jobs);
+    if (!jobs) return NULL;
+
+    jobs->workers = mem_alloc_aligned((worker_count + 1) * sizeof(JobWorker), CACHE_LINE_SIZE);
+    jobs->wake = semaphore_create(0);
+    jobs->inject_lock = mutex_create();
+    bool ok = jobs->workers && jobs->wake && jobs->inject_lock;
+    if (jobs->workers) {
+        memset(jobs->workers, 0, (worker_count + 1) * sizeof(JobWorker));
+        for (uint32_t i = 0; i <= worker_count && ok; ++i) {
+            jobs->workers[i].system = jobs;
+            jobs->workers[i].rng = 0x9e3779b9u * (i + 1);
+            jobs->workers[i].wake = semaphore_create(0);
+            ok = jobs->workers[i].wake != NULL;
+        }
+    }
+    if (!ok) {
+        for (uint32_t i = 0; jobs->workers && i <= worker_count; ++i) semaphore_destroy(jobs->workers[i].wake);
+        semaphore_destroy(jobs->wake);
+        mutex_destroy(jobs->inject_lock);
+        mem_free_aligned(jobs->workers);
+        mem_free(jobs);
+        return NULL;
+    }
+
+    // The creating thread is worker 0; it runs jobs when it waits
+    jobs->slot_count = worker_count + 1;
+    t_worker = &jobs->workers[0];
+    uint32_t started = 1;
+    for (uint32_t i = 1; i <= worker_count; ++i) {
+        jobs->workers[i].index = started; // Dense even if a thread failed to start
+        jobs->workers[i].thread = thread_create(job_worker_main, "engine_jobs", &jobs->workers[i]);
+        if (jobs->workers[i].thread) started++;
+        else fprintf(stderr, "job_system_create: could not start worker %u\n", i);
+    }
+    jobs->thread_count = started;
+    return jobs;
+}
+
+void job_system_destroy(JobSystem* jobs)
+{
+    if (!jobs) return;
+
+    // Drain on this thread, then stop the workers
+    Job job;
+    while (job_next(jobs, job_self(jobs), &job)) job_run(jobs, &job);
+
+    atomic_store_u32(&jobs->quit, 1);
+    for (uint32_t i = 1; i < jobs->thread_count; ++i) semaphore_post(jobs->wake);
+    for (uint32_t i = 1; i < jobs->slot_count; ++i)
+        if (jobs->workers[i].thread) thread_join(jobs->workers[i].thread);
+
+    if (t_worker && t_worker->system == jobs) t_worker = NULL;
+    for (uint32_t i = 0; i < jobs->slot_count; ++i) semaphore_destroy(jobs->workers[i].wake);
+    semaphore_destroy(jobs->wake);
+    mutex_destroy(jobs->inject_lock);
+    mem_free_aligned(jobs->workers);
+    mem_free(jobs);
+}
+
+void job_system_submit(JobSystem* jobs, const Job* batch, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+        if (batch[i].counter) atomic_fetch_add_u32(&batch[i].counter->pending, 1);
+
+    if (!jobs) {
+        for (uint32_t i = 0; i < count; ++i) job_run(NULL, &batch[i]);
+        return;
+    }
+
+    JobWorker* self = job_self(jobs);
+    uint32_t queued = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (self ? deque_push(&self->deque, &batch[i]) : inject_push(jobs, &batch[i])) queued++;
+        else job_run(jobs, &batch[i]); // Full: running it here is slower but always makes progress
+    }
+    job_wake(jobs, queued);
+}
+
+void job_system_wait(JobSystem* jobs, EngineJobCounter* counter)
+{
+    JobWorker* self = jobs ? job_self(jobs) : NULL;
+    uint32_t idle = 0;
+    while (atomic_load_u32(&counter->pending) != 0) {
+        Job job;
+        if (jobs && job_next(jobs, self, &job)) {
+            job_run(jobs, &job);
+            idle = 0;
+        } else if (!self || ++idle < JOB_SPIN_ROUNDS) {
+            cpu_relax(); // Threads the system does not know have no semaphore to sleep on
+        } else {
+            // The counter's last jobs are running elsewhere: sleep until one of them finishes
+            // it or more jobs arrive
+            idle = 0;
+            job_wait_sleep(jobs, self, counter);
+        }
+    }
+}
+
+void job_system_parallel_for(JobSystem* jobs, uint32_t count, uint32_t min_range, EngineRangeFn fn, void* data)
+{
+    if (count == 0) return;
+    if (min_range == 0) min_range = 1;
+
+    const uint32_t threads = job_system_thread_count(jobs);
+    uint32_t ranges = (count + min_range - 1) / min_range;
+    if (ranges > threads * JOB_RANGES_PER_THREAD) ranges = threads * JOB_RANGES_PER_THREAD;
+    if (ranges <= 1 || threads == 1) {
+        fn(data, 0, count);
+        return;
+    }
+
+    // The calling thread takes the first range itself rather than queueing and popping it
+    EngineJobCounter counter = { 0 };
+    Job batch[JOB_RANGES_PER_THREAD * (JOB_MAX_WORKERS + 1)];
+    const uint32_t step = count / ranges, extra = count % ranges;
+    uint32_t begin = 0;
+    for (uint32_t i = 0; i < ranges; ++i) {
+        const uint32_t end = begin + step + (i < extra ? 1 : 0);
+        const Job job = { NULL, fn, data, begin, end, &counter };
+        batch[i] = job;
+        begin = end;
+    }
+    job_system_submit(jobs, batch + 1, ranges - 1);
+    fn(data, batch[0].begin, batch[0].end);
+    job_system_wait(jobs, &counter);
+}
+
+uint32_t job_system_thread_count(const JobSystem* jobs)
+{
+    return jobs ? jobs->thread_count : 1;
+}
+
+uint32_t job_system_thread_index(const JobSystem* jobs)
+{
+    const JobWorker* self = jobs ? job_self(jobs) : NULL;
+    return self ? self->index : UINT32_MAX;
+}
@@ -0,0 +1,48 @@
+//
+// Created by Cain Martin on 2025/09/03.
+//
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+
+// Worker threads with one Chase-Lev deque each. A thread pushes and pops its own jobs at
+// the bottom of its deque, last in first out, and idle threads steal from the top of the
+// others', so the common case touches no shared cache line. Threads the system does not
+// know (I/O, the render thread) submit through a locked queue instead.
+//
+// The thread that creates the system gets a deque too and runs jobs whenever it waits on a
+// counter, as does every other waiting thread, so waiting inside a job is fine. With no
+// workers, jobs simply run on the waiting thread. A NULL system is accepted everywhere and
+// runs everything inline, so code shared with the tools needs no second path.
+typedef struct JobSystem JobSystem;
+
+typedef struct Job
+{
+    EngineJobFn       fn;       // Either fn(data)
+    EngineRangeFn     range;    // or range(data, begin, end)
+    void*             data;
+    uint32_t          begin;
+    uint32_t          end;
+    EngineJobCounter* counter;  // Decremented when the job has run, may be NULL
+} Job;
+
+JobSystem* job_system_create(uint32_t worker_count);
+void       job_system_destroy(JobSystem* jobs); // Runs what is still queued first
+
+// Adds count to the counters, then queues the jobs. Jobs that do not fit run at once.
+void       job_system_submit(JobSystem* jobs, const Job* batch, uint32_t count);
+
+// Runs queued jobs until the counter reaches zero
+void       job_system_wait(JobSystem* jobs, EngineJobCounter* counter);
+
+// Runs fn over [0, count) in ranges of at least min_range and returns when all are done
+void       job_system_parallel_for(JobSystem* jobs, uint32_t count, uint32_t min_range, EngineRangeFn fn, void* data);
+
+uint32_t   job_system_thread_count(const JobSystem* jobs);  // Workers plus the creating thread
+uint32_t   job_system_thread_index(const JobSystem* jobs);  // UINT32_MAX off the system's threads
+
+#endif //JOB_SYSTEM_H
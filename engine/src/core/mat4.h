@@ -0,0 +1,58 @@
+//
+// Created by Cain Martin on 2025/09/06.
+//
+
+#ifndef MAT4_H
+#define MAT4_H
+
+#include "simd.h"
+
+// Column major 4x4 matrices as float[16], the layout engine.h uses: row r of column c is
+// m[c * 4 + r].
+
+// out = a * b. out must not alias a or b.
+static inline void mat4_mul(const float a[16], const float b[16], float out[16])
+{
+#ifdef ENGINE_SSE2
+    // Each column of out is the columns of a weighted by one column of b
+    const __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+    for (int c = 0; c < 4; ++c) {
+        const __m128 col = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[c * 4])), _mm_mul_ps(a1, _mm_set1_ps(b[c * 4 + 1]))),
+                                      _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b[c * 4 + 2])), _mm_mul_ps(a3, _mm_set1_ps(b[c * 4 + 3]))));
+        _mm_storeu_ps(out + c * 4, col);
+    }
+#else
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            out[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1] + a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+        }
+    }
+#endif
+}
+
+// translation * rotation * scale, the rotation a unit quaternion (x, y, z, w)
+static inline void mat4_from_trs(const float t[3], const float q[4], const float s[3], float out[16])
+{
+    const float x = q[0], y = q[1], z = q[2], w = q[3];
+    const float xx = x * x, yy = y * y, zz = z * z;
+    const float xy = x * y, xz = x * z, yz = y * z, wx = w * x, wy = w * y, wz = w * z;
+
+    out[0]  = (1.0f - 2.0f * (yy + zz)) * s[0];
+    out[1]  = 2.0f * (xy + wz) * s[0];
+    out[2]  = 2.0f * (xz - wy) * s[0];
+    out[3]  = 0.0f;
+    out[4]  = 2.0f * (xy - wz) * s[1];
+    out[5]  = (1.0f - 2.0f * (xx + zz)) * s[1];
+    out[6]  = 2.0f * (yz + wx) * s[1];
+    out[7]  = 0.0f;
+    out[8]  = 2.0f * (xz + wy) * s[2];
+    out[9]  = 2.0f * (yz - wx) * s[2];
+    out[10] = (1.0f - 2.0f * (xx + yy)) * s[2];
+    out[11] = 0.0f;
+    out[12] = t[0];
+    out[13] = t[1];
+    out[14] = t[2];
+    out[15] = 1.0f;
+}
+
+#endif //MAT4_H
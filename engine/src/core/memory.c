@@ -0,0 +1,84 @@
+//
+// Created by Cain Martin on 2025/08/26.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "atomic.h"
+#include "memory.h"
+
+static EngineAllocator g_allocator;
+static bool g_has_allocator;
+
+#ifndef NDEBUG
+static uint64_t g_alloc_count; // Bumped from any thread that allocates
+#define COUNT_ALLOC() ((void)atomic_fetch_add_relaxed_u64(&g_alloc_count, 1))
+#else
+#define COUNT_ALLOC() ((void)0)
+#endif
+
+void mem_set_allocator(const EngineAllocator* allocator)
+{
+    g_has_allocator = allocator && allocator->alloc && allocator->realloc && allocator->free;
+    if (g_has_allocator) g_allocator = *allocator;
+}
+
+void* mem_alloc(size_t size)
+{
+    COUNT_ALLOC();
+    return g_has_allocator ? g_allocator.alloc(g_allocator.user, size) : malloc(size);
+}
+
+void* mem_calloc(size_t count, size_t size)
+{
+    if (!g_has_allocator) {
+        COUNT_ALLOC();
+        return calloc(count, size);
+    }
+
+    if (size != 0 && count > SIZE_MAX / size) return NULL;
+    void* ptr = mem_alloc(count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void* mem_realloc(void* ptr, size_t size)
+{
+    COUNT_ALLOC();
+    return g_has_allocator ? g_allocator.realloc(g_allocator.user, ptr, size) : realloc(ptr, size);
+}
+
+void mem_free(void* ptr)
+{
+    if (!ptr) return;
+    if (g_has_allocator) g_allocator.free(g_allocator.user, ptr);
+    else free(ptr);
+}
+
+void* mem_alloc_aligned(size_t size, size_t align)
+{
+    // Over-allocate and keep the original pointer just below the aligned block
+    if (align < sizeof(void*)) align = sizeof(void*);
+    if (size > SIZE_MAX - align - sizeof(void*)) return NULL;
+
+    uint8_t* raw = mem_alloc(size + align - 1 + sizeof(void*));
+    if (!raw) return NULL;
+
+    const uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + align - 1) & ~(uintptr_t)(align - 1);
+    ((void**)aligned)[-1] = raw;
+    return (void*)aligned;
+}
+
+void mem_free_aligned(void* ptr)
+{
+    if (ptr) mem_free(((void**)ptr)[-1]);
+}
+
+uint64_t mem_heap_alloc_count(void)
+{
+#ifndef NDEBUG
+    return atomic_load_u64(&g_alloc_count);
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,29 @@
+//
+// Created by Cain Martin on 2025/08/26.
+//
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+
+// Every heap allocation in the engine goes through these, so a user allocator set in
+// EngineConfig sees all of them. Without one they fall through to the C runtime.
+void  mem_set_allocator(const EngineAllocator* allocator); // NULL restores the default
+void* mem_alloc(size_t size);
+void* mem_calloc(size_t count, size_t size);
+void* mem_realloc(void* ptr, size_t size);
+void  mem_free(void* ptr);
+
+// For storage that needs more than the allocator's natural alignment (SIMD loads).
+// align must be a power of two; release with mem_free_aligned.
+void* mem_alloc_aligned(size_t size, size_t align);
+void  mem_free_aligned(void* ptr);
+
+// Number of mem_alloc/mem_calloc/mem_realloc calls so far. Debug builds only - always 0
+// with NDEBUG defined.
+uint64_t mem_heap_alloc_count(void);
+
+#endif //MEMORY_H
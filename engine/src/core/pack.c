@@ -0,0 +1,225 @@
+//
+// Created by Cain Martin on 2025/08/31.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "file_io.h"
+#include "memory.h"
+#include "pack_format.h"
+#include "../graphics/texture_format.h"
+#include "../graphics/vertex_format.h"
+
+#if PACK_LODS != ENGINE_MESH_MAX_LODS - 1
+#error "PackMesh must hold every level of an EngineMeshLods"
+#endif
+
+struct EnginePack
+{
+    EngineFileView   view;
+    const uint8_t*   base;
+    const PackEntry* entries;
+    uint32_t         entry_count;
+    const char*      strings;
+};
+
+static bool range_ok(const EngineFileView* view, uint64_t offset, uint64_t size)
+{
+    return offset <= view->size && size <= view->size - offset;
+}
+
+static bool blob_ok(const EngineFileView* view, uint64_t offset, uint64_t size)
+{
+    return offset % PACK_ALIGN == 0 && range_ok(view, offset, size);
+}
+
+// Everything a descriptor will point at is checked here, once, so lookups can trust the table
+static bool entry_ok(const EnginePack* pack, const PackEntry* entry)
+{
+    const EngineFileView* view = &pack->view;
+    switch (entry->type) {
+        case PACK_ENTRY_MESH: {
+            const PackMesh* mesh = &entry->u.mesh;
+            const EngineVertexLayout layout = {
+                (EnginePositionFormat)mesh->position, (EngineNormalFormat)mesh->normal, (EngineUVFormat)mesh->uv
+            };
+            VertexFormat format;
+            if (!vertex_format_get(&layout, &format) || mesh->vertex_count == 0 || mesh->index_count % 3 != 0
+                || mesh->lod_count > PACK_LODS)
+                return false;
+            uint64_t index_count = mesh->index_count;
+            for (uint32_t l = 0; l < mesh->lod_count; ++l) {
+                if (mesh->lod_index_count[l] == 0 || mesh->lod_index_count[l] % 3 != 0) return false;
+                index_count += mesh->lod_index_count[l];
+            }
+            return blob_ok(view, mesh->vertices, (uint64_t)mesh->vertex_count * format.stride)
+                && blob_ok(view, mesh->indices, index_count * sizeof(uint32_t));
+        }
+        case PACK_ENTRY_TEXTURE: {
+            const PackTexture* texture = &entry->u.texture;
+            if (texture->width == 0 || texture->height == 0 || texture->width > INT32_MAX || texture->height > INT32_MAX
+                || texture->mip_count == 0 || texture->mip_count > texture_mip_count(texture->width, texture->height)
+                || !blob_ok(view, texture->mips, (uint64_t)texture->mip_count * sizeof(PackMip)))
+                return false;
+            const PackMip* mips = (const PackMip*)(pack->base + texture->mips);
+            for (uint32_t level = 0; level < texture->mip_count; ++level) {
+                const size_t size = texture_level_size((EngineTextureFormat)texture->format,
+                                                       texture_mip_extent(texture->width, level),
+                                                       texture_mip_extent(texture->height, level));
+                if (size == 0 || mips[level].size != size || !blob_ok(view, mips[level].offset, mips[level].size))
+                    return false;
+            }
+            return true;
+        }
+        case PACK_ENTRY_SHADER: {
+            const PackShader* shader = &entry->u.shader;
+            if (shader->vs_size == 0 || shader->fs_size == 0
+                || !range_ok(view, shader->vs, shader->vs_size) || !range_ok(view, shader->fs, shader->fs_size))
+                return false;
+            return pack->base[shader->vs + shader->vs_size - 1] == '\0' && pack->base[shader->fs + shader->fs_size - 1] == '\0';
+        }
+        default:
+            return false;
+    }
+}
+
+EnginePack* engine_pack_open_view(EngineFileView* view)
+{
+    if (!view) return NULL;
+
+    const PackHeader* header = view->data;
+    const char* error = NULL;
+    if (view->size < sizeof(PackHeader) || header->magic != PACK_MAGIC) error = "not an asset pack";
+    else if (header->version != PACK_VERSION) error = "pack version mismatch, rebake";
+    else if (header->file_size != view->size) error = "truncated";
+    else if (!range_ok(view, sizeof(PackHeader), (uint64_t)header->entry_count * sizeof(PackEntry))
+             || !range_ok(view, header->strings_offset, header->strings_size)
+             || header->strings_size == 0
+             || ((const char*)view->data)[header->strings_offset + header->strings_size - 1] != '\0')
+        error = "corrupt table of contents";
+
+    EnginePack* pack = NULL;
+    if (!error) {
+        pack = mem_calloc(1, sizeof(EnginePack));
+        if (!pack) error = "out of memory";
+    }
+    if (!error) {
+        pack->view = *view;
+        pack->base = view->data;
+        pack->entries = (const PackEntry*)(pack->base + sizeof(PackHeader));
+        pack->entry_count = header->entry_count;
+        pack->strings = (const char*)pack->base + header->strings_offset;
+
+        for (uint32_t i = 0; i < pack->entry_count && !error; ++i) {
+            const PackEntry* entry = &pack->entries[i];
+            if (entry->name_offset >= header->strings_size || (i > 0 && entry->name_hash < pack->entries[i - 1].name_hash)
+                || !entry_ok(pack, entry))
+                error = "corrupt entry";
+        }
+    }
+
+    if (error) {
+        fprintf(stderr, "engine_pack_open: %s\n", error);
+        mem_free(pack);
+        file_view_close(view);
+        return NULL;
+    }
+    memset(view, 0, sizeof *view);
+    return pack;
+}
+
+EnginePack* engine_pack_open(const char* path)
+{
+    EngineFileView view;
+    if (!path || !file_view_open(path, &view)) return NULL;
+    return engine_pack_open_view(&view);
+}
+
+void engine_pack_close(EnginePack* pack)
+{
+    if (!pack) return;
+    file_view_close(&pack->view);
+    mem_free(pack);
+}
+
+uint32_t engine_pack_asset_count(const EnginePack* pack)
+{
+    return pack ? pack->entry_count : 0;
+}
+
+const char* engine_pack_asset_name(const EnginePack* pack, uint32_t index, EnginePackAssetType* out_type)
+{
+    if (!pack || index >= pack->entry_count) return NULL;
+    if (out_type) *out_type = (EnginePackAssetType)pack->entries[index].type;
+    return pack->strings + pack->entries[index].name_offset;
+}
+
+static const PackEntry* pack_find(const EnginePack* pack, const char* name, PackEntryType type)
+{
+    if (!pack || !name) return NULL;
+
+    const uint64_t hash = pack_name_hash(name);
+    uint32_t lo = 0, hi = pack->entry_count;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (pack->entries[mid].name_hash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+    // Names of different types may share a hash, and so may different names
+    for (; lo < pack->entry_count && pack->entries[lo].name_hash == hash; ++lo) {
+        const PackEntry* entry = &pack->entries[lo];
+        if (entry->type == (uint32_t)type && strcmp(pack->strings + entry->name_offset, name) == 0) return entry;
+    }
+    return NULL;
+}
+
+bool engine_pack_mesh(const EnginePack* pack, const char* name, EngineMeshDesc* out_desc)
+{
+    const PackEntry* entry = pack_find(pack, name, PACK_ENTRY_MESH);
+    if (!entry || !out_desc) return false;
+
+    const PackMesh* mesh = &entry->u.mesh;
+    memset(out_desc, 0, sizeof *out_desc);
+    out_desc->layout.position = (EnginePositionFormat)mesh->position;
+    out_desc->layout.normal = (EngineNormalFormat)mesh->normal;
+    out_desc->layout.uv = (EngineUVFormat)mesh->uv;
+    if (vertex_layout_is_full(&out_desc->layout)) out_desc->vertices = (const EngineVertex*)(pack->base + mesh->vertices);
+    else out_desc->packed_vertices = pack->base + mesh->vertices;
+    out_desc->vertex_count = mesh->vertex_count;
+    out_desc->indices = (const uint32_t*)(pack->base + mesh->indices);
+    out_desc->indices_count = mesh->index_count;
+    out_desc->lods.count = mesh->lod_count;
+    if (mesh->lod_count) out_desc->lods.indices = out_desc->indices + mesh->index_count;
+    for (uint32_t l = 0; l < mesh->lod_count; ++l) {
+        out_desc->lods.indices_count[l] = mesh->lod_index_count[l];
+        out_desc->lods.error[l] = mesh->lod_error[l];
+    }
+    return true;
+}
+
+bool engine_pack_texture(const EnginePack* pack, const char* name, EngineTextureDesc* out_desc)
+{
+    const PackEntry* entry = pack_find(pack, name, PACK_ENTRY_TEXTURE);
+    if (!entry || !out_desc) return false;
+
+    const PackTexture* texture = &entry->u.texture;
+    const PackMip* mips = (const PackMip*)(pack->base + texture->mips);
+    memset(out_desc, 0, sizeof *out_desc);
+    out_desc->width = (int)texture->width;
+    out_desc->height = (int)texture->height;
+    out_desc->format = (EngineTextureFormat)texture->format;
+    out_desc->pixels = pack->base + mips[0].offset;
+    out_desc->mip_count = (int)texture->mip_count;
+    for (uint32_t level = 0; level < texture->mip_count; ++level) out_desc->levels[level] = pack->base + mips[level].offset;
+    return true;
+}
+
+bool engine_pack_shader(const EnginePack* pack, const char* name, const char** out_vs_source, const char** out_fs_source)
+{
+    const PackEntry* entry = pack_find(pack, name, PACK_ENTRY_SHADER);
+    if (!entry || !out_vs_source || !out_fs_source) return false;
+
+    *out_vs_source = (const char*)pack->base + entry->u.shader.vs;
+    *out_fs_source = (const char*)pack->base + entry->u.shader.fs;
+    return true;
+}
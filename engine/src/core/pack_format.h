@@ -0,0 +1,97 @@
+//
+// Created by Cain Martin on 2025/08/31.
+//
+
+#ifndef PACK_FORMAT_H
+#define PACK_FORMAT_H
+
+#include <stdint.h>
+
+// On-disk layout of a baked asset pack, written by tools/asset_baker and read in place by
+// engine_pack_open. Everything is little-endian and stored exactly as the engine consumes
+// it, so loading is a mapping plus a bounds check per entry:
+//
+//   PackHeader
+//   PackEntry[entry_count]   sorted by name_hash
+//   string table             NUL terminated asset names
+//   blobs                    each starting on a PACK_ALIGN boundary
+//
+// Offsets are from the start of the file. Any change to these structs bumps PACK_VERSION;
+// packs of another version are rejected rather than converted.
+
+#define PACK_MAGIC   0x4b415044u // "DPAK"
+#define PACK_VERSION 2u
+#define PACK_ALIGN   16u         // Blob alignment, enough for SIMD loads of vertex data
+#define PACK_LODS    7u          // Coarser levels a mesh can carry, ENGINE_MESH_MAX_LODS - 1
+
+typedef enum {
+    PACK_ENTRY_MESH = 1,
+    PACK_ENTRY_TEXTURE,
+    PACK_ENTRY_SHADER,
+} PackEntryType;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t strings_size;
+    uint64_t strings_offset;
+    uint64_t file_size;      // Catches truncated copies
+} PackHeader;
+
+typedef struct {
+    uint64_t vertices;       // vertex_count * engine_vertex_layout_stride(layout) bytes
+    uint64_t indices;        // index_count uint32_t, then those of each LOD in order
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t position;       // EngineVertexLayout members
+    uint32_t normal;
+    uint32_t uv;
+    uint32_t lod_count;      // EngineMeshLods
+    uint32_t lod_index_count[PACK_LODS];
+    float    lod_error[PACK_LODS];
+} PackMesh;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t size;
+} PackMip;
+
+typedef struct {
+    uint64_t mips;           // PackMip[mip_count], largest level first, at most ENGINE_TEXTURE_MAX_MIPS
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;         // EngineTextureFormat, block compressed ones included
+    uint32_t mip_count;
+} PackTexture;
+
+typedef struct {
+    uint64_t vs;             // NUL terminated GLSL
+    uint64_t fs;
+    uint32_t vs_size;        // Bytes including the terminator
+    uint32_t fs_size;
+} PackShader;
+
+typedef struct {
+    uint64_t name_hash;      // pack_name_hash of the name
+    uint32_t name_offset;    // Into the string table
+    uint32_t type;           // PackEntryType
+    union {
+        PackMesh    mesh;
+        PackTexture texture;
+        PackShader  shader;
+    } u;
+} PackEntry;
+
+// FNV-1a, 64 bit
+static inline uint64_t pack_name_hash(const char* name)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (; *name; ++name) {
+        hash ^= (uint8_t)*name;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+#endif //PACK_FORMAT_H
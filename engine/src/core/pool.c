@@ -0,0 +1,72 @@
+//
+// Created by Cain Martin on 2025/08/26.
+//
+
+#include <string.h>
+#include "memory.h"
+#include "pool.h"
+
+bool pool_init(Pool* pool, size_t elem_size, size_t align, uint32_t block_count)
+{
+    memset(pool, 0, sizeof *pool);
+    if (block_count == 0 || align == 0 || (align & (align - 1)) != 0) return false;
+
+    if (align < sizeof(void*)) align = sizeof(void*);
+    if (elem_size < sizeof(void*)) elem_size = sizeof(void*);
+
+    pool->stride = (elem_size + align - 1) & ~(align - 1);
+    pool->align = align;
+    pool->block_count = block_count;
+    return true;
+}
+
+void pool_shutdown(Pool* pool)
+{
+    void* chunk = pool->chunks;
+    while (chunk) {
+        void* next = *(void**)chunk;
+        mem_free(chunk);
+        chunk = next;
+    }
+    memset(pool, 0, sizeof *pool);
+}
+
+static bool pool_grow(Pool* pool)
+{
+    // Header holds the next chunk; elements start at the first aligned address after it
+    const size_t header = sizeof(void*);
+    uint8_t* chunk = mem_alloc(header + pool->align - 1 + pool->stride * pool->block_count);
+    if (!chunk) return false;
+
+    *(void**)chunk = pool->chunks;
+    pool->chunks = chunk;
+    pool->chunk_count++;
+
+    uint8_t* first = (uint8_t*)(((uintptr_t)chunk + header + pool->align - 1) & ~(uintptr_t)(pool->align - 1));
+
+    // Thread back to front so allocation walks the chunk in address order
+    for (uint32_t i = pool->block_count; i-- > 0;) {
+        void* elem = first + (size_t)i * pool->stride;
+        *(void**)elem = pool->free_list;
+        pool->free_list = elem;
+    }
+    return true;
+}
+
+void* pool_alloc(Pool* pool)
+{
+    if (!pool->free_list && !pool_grow(pool)) return NULL;
+
+    void* elem = pool->free_list;
+    pool->free_list = *(void**)elem;
+    pool->live++;
+    return elem;
+}
+
+void pool_free(Pool* pool, void* ptr)
+{
+    if (!ptr) return;
+    *(void**)ptr = pool->free_list;
+    pool->free_list = ptr;
+    pool->live--;
+}
@@ -0,0 +1,34 @@
+//
+// Created by Cain Martin on 2025/08/26.
+//
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-size block allocator for records that need a stable address. Blocks come from
+// chunks of block_count elements; freed elements go on an intrusive free list and are
+// handed out again before a new chunk is allocated, so steady state never touches the heap.
+typedef struct Pool
+{
+    size_t   stride;      // Element size rounded up to the alignment
+    size_t   align;
+    uint32_t block_count; // Elements per chunk
+    void*    chunks;      // Singly linked through each chunk's header
+    void*    free_list;   // Singly linked through the first word of each free element
+    uint32_t live;
+    uint32_t chunk_count;
+} Pool;
+
+// align must be a power of two. Elements are at least pointer sized.
+bool  pool_init(Pool* pool, size_t elem_size, size_t align, uint32_t block_count);
+void  pool_shutdown(Pool* pool);
+
+// Returns NULL only when a new chunk is needed and the heap is out of memory
+void* pool_alloc(Pool* pool);
+void  pool_free(Pool* pool, void* ptr);
+
+#endif //POOL_H
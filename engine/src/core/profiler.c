@@ -0,0 +1,322 @@
+//
+// Created by Cain Martin on 2025/08/28.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "atomic.h"
+#include "memory.h"
+#include "profiler.h"
+#include "../platform/clock.h"
+#include "../platform/thread.h"
+
+typedef struct ProfilerEvent
+{
+    const char* name;
+    uint64_t    start;
+    uint64_t    end;
+    uint32_t    depth;
+} ProfilerEvent;
+
+typedef struct ProfilerThread
+{
+    ProfilerEvent* ring;
+    uint32_t       ready;      // Set once ring is allocated; readers skip the slot until then
+    uint32_t       write;      // Events ever written, published after each event
+    uint32_t       summarized; // Main thread's read position
+    uint32_t       depth;
+    const char*    stack_name[PROFILER_MAX_DEPTH];
+    uint64_t       stack_start[PROFILER_MAX_DEPTH];
+    char           name[32];
+} ProfilerThread;
+
+typedef struct ProfilerZone
+{
+    const char* name;
+    float       history[PROFILER_HISTORY]; // ms per frame, negative when the zone did not run
+    float       frame_ms;
+    uint32_t    frame_calls;
+} ProfilerZone;
+
+bool g_profiler_enabled;
+
+static bool           g_pending_enabled;
+static uint32_t       g_generation;   // Bumped by init so stale thread-local slots are re-registered
+static uint32_t       g_thread_count; // Slots claimed
+static ProfilerThread g_threads[PROFILER_MAX_THREADS];
+static ProfilerThread* g_gpu_track;
+static uint64_t       g_epoch;
+static double         g_ms_per_tick;
+
+static ProfilerZone   g_zones[PROFILER_MAX_ZONES];
+static uint32_t       g_zone_count;
+static uint32_t       g_frame;
+
+static THREAD_LOCAL ProfilerThread* t_thread;
+static THREAD_LOCAL uint32_t        t_generation;
+static THREAD_LOCAL const char*     t_name;
+
+void profiler_init(void)
+{
+    memset(g_threads, 0, sizeof g_threads);
+    memset(g_zones, 0, sizeof g_zones);
+    g_thread_count = 0;
+    g_zone_count = 0;
+    g_frame = 0;
+    g_gpu_track = NULL;
+    g_epoch = clock_ticks();
+    g_ms_per_tick = 1000.0 / (double)clock_frequency();
+    atomic_fetch_add_u32(&g_generation, 1);
+}
+
+void profiler_shutdown(void)
+{
+    g_profiler_enabled = false;
+    g_pending_enabled = false;
+    const uint32_t count = atomic_load_u32(&g_thread_count);
+    for (uint32_t i = 0; i < count && i < PROFILER_MAX_THREADS; ++i) {
+        mem_free(g_threads[i].ring);
+        g_threads[i].ring = NULL;
+        g_threads[i].ready = 0;
+    }
+    atomic_fetch_add_u32(&g_generation, 1);
+}
+
+void profiler_set_enabled(bool enabled)
+{
+#ifdef ENGINE_PROFILE
+    // Applied at the next frame boundary, where no main thread zone is open
+    g_pending_enabled = enabled;
+#else
+    (void)enabled;
+#endif
+}
+
+bool profiler_enabled(void)
+{
+    return g_profiler_enabled;
+}
+
+static ProfilerThread* profiler_register(const char* name)
+{
+    const uint32_t index = atomic_fetch_add_u32(&g_thread_count, 1);
+    if (index >= PROFILER_MAX_THREADS) return NULL;
+
+    ProfilerThread* thread = &g_threads[index];
+    thread->ring = mem_alloc(PROFILER_RING_SIZE * sizeof(ProfilerEvent));
+    if (!thread->ring) return NULL;
+    snprintf(thread->name, sizeof thread->name, "%s", name);
+    atomic_store_u32(&thread->ready, 1);
+    return thread;
+}
+
+static ProfilerThread* profiler_thread(void)
+{
+    const uint32_t generation = atomic_load_u32(&g_generation);
+    if (t_generation != generation) {
+        // Registered on the first zone rather than up front, so threads that never record
+        // while the profiler is enabled never get a ring
+        char name[32];
+        if (t_name) snprintf(name, sizeof name, "%s", t_name);
+        else snprintf(name, sizeof name, "thread %llu", (unsigned long long)thread_current_id());
+        t_thread = profiler_register(name);
+        t_generation = generation;
+    }
+    return t_thread;
+}
+
+void profiler_set_thread_name(const char* name)
+{
+    t_name = name;
+    if (t_thread && t_generation == atomic_load_u32(&g_generation))
+        snprintf(t_thread->name, sizeof t_thread->name, "%s", name);
+}
+
+static void profiler_push(ProfilerThread* thread, const char* name, uint64_t start, uint64_t end, uint32_t depth)
+{
+    const uint32_t w = thread->write;
+    ProfilerEvent* event = &thread->ring[w & (PROFILER_RING_SIZE - 1)];
+    event->name = name;
+    event->start = start;
+    event->end = end;
+    event->depth = depth;
+    atomic_store_u32(&thread->write, w + 1);
+}
+
+void profiler_begin(const char* name)
+{
+    ProfilerThread* thread = profiler_thread();
+    if (!thread) return;
+
+    const uint32_t depth = thread->depth++;
+    if (depth >= PROFILER_MAX_DEPTH) return; // Still counted, so the matching end pops nothing
+    thread->stack_name[depth] = name;
+    thread->stack_start[depth] = clock_ticks();
+}
+
+void profiler_end(void)
+{
+    const uint64_t end = clock_ticks();
+    ProfilerThread* thread = profiler_thread();
+    if (!thread || thread->depth == 0) return;
+
+    const uint32_t depth = --thread->depth;
+    if (depth >= PROFILER_MAX_DEPTH) return;
+    profiler_push(thread, thread->stack_name[depth], thread->stack_start[depth], end, depth);
+}
+
+void profiler_gpu_zone(const char* name, uint64_t cpu_start_ticks, double gpu_ms)
+{
+    if (!g_profiler_enabled) return;
+    if (!g_gpu_track) {
+        g_gpu_track = profiler_register("GPU");
+        if (!g_gpu_track) return;
+    }
+    const uint64_t duration = (uint64_t)(gpu_ms / g_ms_per_tick);
+    profiler_push(g_gpu_track, name, cpu_start_ticks, cpu_start_ticks + duration, 0);
+}
+
+void profiler_frame_begin(void)
+{
+    // Written only when it changes, since zones on other threads read it without a lock
+    if (g_profiler_enabled != g_pending_enabled) g_profiler_enabled = g_pending_enabled;
+}
+
+static ProfilerZone* profiler_zone(const char* name)
+{
+    for (uint32_t i = 0; i < g_zone_count; ++i)
+        if (g_zones[i].name == name || strcmp(g_zones[i].name, name) == 0) return &g_zones[i];
+
+    if (g_zone_count == PROFILER_MAX_ZONES) return NULL;
+    ProfilerZone* zone = &g_zones[g_zone_count++];
+    zone->name = name;
+    for (uint32_t i = 0; i < PROFILER_HISTORY; ++i) zone->history[i] = -1.0f;
+    return zone;
+}
+
+void profiler_frame_end(void)
+{
+    if (!g_profiler_enabled) return;
+
+    // Fold every event finished since the last frame into its zone's total
+    const uint32_t thread_count = atomic_load_u32(&g_thread_count);
+    for (uint32_t t = 0; t < thread_count && t < PROFILER_MAX_THREADS; ++t) {
+        ProfilerThread* thread = &g_threads[t];
+        if (!atomic_load_u32(&thread->ready)) continue;
+
+        const uint32_t write = atomic_load_u32(&thread->write);
+        uint32_t from = thread->summarized;
+        if (write - from > PROFILER_RING_SIZE) from = write - PROFILER_RING_SIZE;
+
+        for (uint32_t i = from; i != write; ++i) {
+            const ProfilerEvent event = thread->ring[i & (PROFILER_RING_SIZE - 1)];
+            // The owner may have lapped the ring while this was being read
+            if (atomic_load_u32(&thread->write) - i >= PROFILER_RING_SIZE) continue;
+
+            ProfilerZone* zone = profiler_zone(event.name);
+            if (!zone) continue;
+            zone->frame_ms += (float)((double)(event.end - event.start) * g_ms_per_tick);
+            zone->frame_calls++;
+        }
+        thread->summarized = write;
+    }
+
+    const uint32_t slot = g_frame & (PROFILER_HISTORY - 1);
+    for (uint32_t i = 0; i < g_zone_count; ++i) {
+        ProfilerZone* zone = &g_zones[i];
+        zone->history[slot] = zone->frame_calls ? zone->frame_ms : -1.0f;
+        zone->frame_ms = 0.0f;
+        zone->frame_calls = 0;
+    }
+    g_frame++;
+}
+
+static int compare_float(const void* a, const void* b)
+{
+    const float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+uint32_t profiler_summary(EngineProfileZone* out_zones, uint32_t max_zones)
+{
+    const uint32_t last = (g_frame - 1) & (PROFILER_HISTORY - 1);
+    uint32_t written = 0;
+
+    for (uint32_t i = 0; i < g_zone_count && written < max_zones; ++i) {
+        const ProfilerZone* zone = &g_zones[i];
+        float samples[PROFILER_HISTORY];
+        uint32_t n = 0;
+        double total = 0.0;
+        for (uint32_t f = 0; f < PROFILER_HISTORY; ++f) {
+            if (zone->history[f] < 0.0f) continue;
+            samples[n++] = zone->history[f];
+            total += zone->history[f];
+        }
+        if (n == 0) continue;
+
+        qsort(samples, n, sizeof(float), compare_float);
+        const uint32_t p99 = (n * 99 + 99) / 100; // ceil(0.99 * n), 1-based
+
+        EngineProfileZone* out = &out_zones[written++];
+        out->name = zone->name;
+        out->last_ms = g_frame && zone->history[last] >= 0.0f ? zone->history[last] : 0.0f;
+        out->min_ms = samples[0];
+        out->avg_ms = (float)(total / n);
+        out->p99_ms = samples[p99 - 1];
+        out->samples = n;
+    }
+    return written;
+}
+
+static void write_json_string(FILE* file, const char* s)
+{
+    fputc('"', file);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') fputc('\\', file);
+        if ((unsigned char)*s >= 0x20) fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+// Chrome trace-event format: load in chrome://tracing or ui.perfetto.dev
+bool profiler_write_trace(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "profiler_write_trace: unable to open %s\n", path);
+        return false;
+    }
+
+    const double us_per_tick = g_ms_per_tick * 1000.0;
+    bool first = true;
+    fputs("{\"traceEvents\":[\n", file);
+
+    const uint32_t thread_count = atomic_load_u32(&g_thread_count);
+    for (uint32_t t = 0; t < thread_count && t < PROFILER_MAX_THREADS; ++t) {
+        const ProfilerThread* thread = &g_threads[t];
+        if (!atomic_load_u32(&thread->ready)) continue;
+
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", t);
+        write_json_string(file, thread->name);
+        fputs("}}", file);
+        first = false;
+
+        const uint32_t write = atomic_load_u32(&thread->write);
+        const uint32_t from = write > PROFILER_RING_SIZE ? write - PROFILER_RING_SIZE : 0;
+        for (uint32_t i = from; i != write; ++i) {
+            const ProfilerEvent* event = &thread->ring[i & (PROFILER_RING_SIZE - 1)];
+            fputs(",\n{\"name\":", file);
+            write_json_string(file, event->name);
+            fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                    thread == g_gpu_track ? "gpu" : "cpu",
+                    (double)(event->start - g_epoch) * us_per_tick,
+                    (double)(event->end - event->start) * us_per_tick, t);
+        }
+    }
+
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+    const bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,57 @@
+//
+// Created by Cain Martin on 2025/08/28.
+//
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+
+#define PROFILER_MAX_THREADS 32
+#define PROFILER_RING_SIZE   16384 // Events kept per thread, power of two
+#define PROFILER_MAX_DEPTH   32
+#define PROFILER_MAX_ZONES   64    // Distinct zone names in the rolling summary
+#define PROFILER_HISTORY     128   // Frames in the rolling summary, power of two
+
+// Process-wide frame profiler. Each thread records finished zones into its own ring, so
+// recording takes no locks; the main thread folds them into per-zone history at the end of
+// every frame. Zone names must be string literals (or otherwise outlive the profiler) -
+// only the pointer is stored.
+//
+// Built without ENGINE_PROFILE the macros compile to nothing. Built with it but disabled at
+// runtime, a zone costs one predictable branch.
+
+void profiler_init(void);
+void profiler_shutdown(void);
+void profiler_set_enabled(bool enabled);
+bool profiler_enabled(void);
+
+// Names the calling thread in the trace. name must outlive the thread.
+void profiler_set_thread_name(const char* name);
+
+void profiler_begin(const char* name);
+void profiler_end(void);
+
+// Called by the engine around each frame, on the main thread
+void profiler_frame_begin(void);
+void profiler_frame_end(void);
+
+// A GPU measurement from a backend, shown on its own track starting at cpu_start_ticks
+// (platform/clock.h) and included in the summary of the frame that reports it
+void profiler_gpu_zone(const char* name, uint64_t cpu_start_ticks, double gpu_ms);
+
+uint32_t profiler_summary(EngineProfileZone* out_zones, uint32_t max_zones);
+bool     profiler_write_trace(const char* path);
+
+#ifdef ENGINE_PROFILE
+extern bool g_profiler_enabled;
+#define PROFILE_BEGIN(name) do { if (g_profiler_enabled) profiler_begin(name); } while (0)
+#define PROFILE_END()       do { if (g_profiler_enabled) profiler_end(); } while (0)
+#else
+#define PROFILE_BEGIN(name) ((void)(name))
+#define PROFILE_END()       ((void)0)
+#endif
+
+#endif //PROFILER_H
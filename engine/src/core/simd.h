@@ -0,0 +1,22 @@
+//
+// Created by Cain Martin on 2025/08/29.
+//
+
+#ifndef SIMD_H
+#define SIMD_H
+
+// Compile time SIMD selection. Every x86-64 target has SSE2, so that is the baseline there;
+// F16C needs the compiler's -mf16c (or /arch:AVX2). Other targets use the scalar paths,
+// which every SIMD routine keeps for its tail anyway.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENGINE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(ENGINE_SSE2) && (defined(__F16C__) || defined(__AVX2__))
+#define ENGINE_F16C 1
+#include <immintrin.h>
+#endif
+
+#endif //SIMD_H
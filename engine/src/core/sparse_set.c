@@ -0,0 +1,87 @@
+//
+// Created by Cain Martin on 2025/08/26.
+//
+
+#include <string.h>
+#include "sparse_set.h"
+
+bool sparse_set_init(SparseSet* set, uint32_t value_size, uint32_t align, struct Arena* arena)
+{
+    return d_array_init(&set->sparse, sizeof(uint32_t), 0, arena)
+        && d_array_init(&set->keys, sizeof(uint32_t), 0, arena)
+        && d_array_init(&set->values, value_size, align, arena);
+}
+
+void sparse_set_free(SparseSet* set)
+{
+    d_array_free(&set->sparse);
+    d_array_free(&set->keys);
+    d_array_free(&set->values);
+}
+
+static uint32_t sparse_set_find(const SparseSet* set, uint32_t key)
+{
+    if (key >= set->sparse.count) return UINT32_MAX;
+    return D_ARRAY_DATA(&set->sparse, uint32_t)[key] - 1; // Absent (0) wraps to UINT32_MAX
+}
+
+void* sparse_set_insert(SparseSet* set, uint32_t key)
+{
+    const uint32_t found = sparse_set_find(set, key);
+    if (found != UINT32_MAX) return d_array_at(&set->values, found);
+
+    if (key == UINT32_MAX) return NULL;
+    if (key >= set->sparse.count) {
+        // Grow geometrically so a rising run of keys does not resize on every insert
+        uint32_t count = set->sparse.count ? set->sparse.count : D_ARRAY_MIN_CAPACITY;
+        while (count <= key) count = count > UINT32_MAX / 2 ? key + 1 : count * 2;
+        if (!d_array_resize(&set->sparse, count)) return NULL;
+    }
+
+    uint32_t* dense_key = d_array_push(&set->keys);
+    if (!dense_key) return NULL;
+    void* value = d_array_push(&set->values);
+    if (!value) {
+        set->keys.count--;
+        return NULL;
+    }
+
+    *dense_key = key;
+    D_ARRAY_DATA(&set->sparse, uint32_t)[key] = set->values.count;
+    return value;
+}
+
+void* sparse_set_get(const SparseSet* set, uint32_t key)
+{
+    const uint32_t found = sparse_set_find(set, key);
+    return found == UINT32_MAX ? NULL : d_array_at(&set->values, found);
+}
+
+bool sparse_set_remove(SparseSet* set, uint32_t key)
+{
+    const uint32_t index = sparse_set_find(set, key);
+    if (index == UINT32_MAX) return false;
+
+    uint32_t* sparse = D_ARRAY_DATA(&set->sparse, uint32_t);
+    const uint32_t last = set->values.count - 1;
+    if (index != last) {
+        const uint32_t moved_key = D_ARRAY_DATA(&set->keys, uint32_t)[last];
+        sparse[moved_key] = index + 1;
+    }
+    sparse[key] = 0;
+
+    d_array_swap_remove(&set->keys, index);
+    d_array_swap_remove(&set->values, index);
+    return true;
+}
+
+void sparse_set_clear(SparseSet* set)
+{
+    // Only the live keys' entries are non-zero, so clearing them beats wiping the whole array
+    const uint32_t* keys = D_ARRAY_DATA(&set->keys, uint32_t);
+    uint32_t* sparse = D_ARRAY_DATA(&set->sparse, uint32_t);
+    for (uint32_t i = 0; i < set->keys.count; ++i) sparse[keys[i]] = 0;
+
+    d_array_clear(&set->keys);
+    d_array_clear(&set->values);
+}
@@ -0,0 +1,31 @@
+//
+// Created by Cain Martin on 2025/08/26.
+//
+
+#ifndef SPARSE_SET_H
+#define SPARSE_SET_H
+
+#include "d_array.h"
+
+// Map from small integer keys (entity ids, handle slots) to densely packed values. Lookup is
+// two array reads, values stay contiguous for iteration, and removal swaps the last value
+// into the hole. A key keeps its meaning across removals of other keys; value pointers do not.
+typedef struct SparseSet
+{
+    DArray sparse; // key -> dense index + 1, 0 when absent
+    DArray keys;   // dense index -> key
+    DArray values; // dense values
+} SparseSet;
+
+bool  sparse_set_init(SparseSet* set, uint32_t value_size, uint32_t align, struct Arena* arena);
+void  sparse_set_free(SparseSet* set);
+
+// Returns the key's value, adding an uninitialised one if the key is new. NULL on exhaustion.
+void* sparse_set_insert(SparseSet* set, uint32_t key);
+void* sparse_set_get(const SparseSet* set, uint32_t key);
+bool  sparse_set_remove(SparseSet* set, uint32_t key);
+void  sparse_set_clear(SparseSet* set);
+
+static inline uint32_t sparse_set_count(const SparseSet* set) { return set->values.count; }
+
+#endif //SPARSE_SET_H
@@ -0,0 +1,292 @@
+//
+// Created by Cain Martin on 2025/09/06.
+//
+
+#include <string.h>
+#include "transform_graph.h"
+#include "mat4.h"
+#include "memory.h"
+#include "profiler.h"
+
+#define TRANSFORM_FLAG_DIRTY 1u   // Local transform or parent changed since the last update
+#define TRANSFORM_FLAG_MOVED 2u   // World matrix recomputed by the last update
+#define TRANSFORM_RANGE      1024 // Nodes per update job at least
+
+static const float identity[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+
+bool transform_graph_init(TransformGraph* graph, uint32_t capacity)
+{
+    memset(graph, 0, sizeof *graph);
+    if (!handle_pool_init(&graph->pool, capacity)) return false;
+
+    // One block, world matrices first for their alignment
+    const size_t n = capacity;
+    const size_t bytes = n * (16 + 3 + 4 + 3) * sizeof(float) + n * 17 * sizeof(uint32_t)
+                       + (n * 5 + 1) * sizeof(uint32_t) + n;
+    uint8_t* block = mem_alloc_aligned(bytes, 64);
+    if (!block) {
+        handle_pool_shutdown(&graph->pool);
+        return false;
+    }
+
+    graph->world       = (float*)block;
+    graph->translation = graph->world + n * 16;
+    graph->rotation    = graph->translation + n * 3;
+    graph->scale       = graph->rotation + n * 4;
+    graph->scratch     = (uint32_t*)(graph->scale + n * 3);
+    graph->position    = graph->scratch + n * 17;
+    graph->parent      = graph->position + n;
+    graph->depth       = graph->parent + n;
+    graph->slot        = graph->depth + n;
+    graph->level_end   = graph->slot + n;
+    graph->flags       = (uint8_t*)(graph->level_end + n + 1);
+    graph->capacity    = capacity;
+    graph->sorted      = true;
+    return true;
+}
+
+void transform_graph_free(TransformGraph* graph)
+{
+    handle_pool_shutdown(&graph->pool);
+    mem_free_aligned(graph->world);
+    memset(graph, 0, sizeof *graph);
+}
+
+static uint32_t node_index(const TransformGraph* graph, uint32_t node)
+{
+    if (handle_pool_lookup(&graph->pool, node) == HANDLE_POOL_INVALID) return TRANSFORM_NO_PARENT;
+    return graph->position[handle_index(node)];
+}
+
+uint32_t transform_graph_create(TransformGraph* graph, uint32_t parent)
+{
+    const uint32_t parent_index = parent ? node_index(graph, parent) : TRANSFORM_NO_PARENT;
+    if (parent && parent_index == TRANSFORM_NO_PARENT) return 0;
+    const uint32_t node = handle_pool_alloc(&graph->pool, NULL);
+    if (!node) return 0;
+
+    const uint32_t i = graph->count++;
+    graph->position[handle_index(node)] = i;
+    graph->slot[i] = handle_index(node);
+    graph->parent[i] = parent_index;
+    memcpy(graph->world + (size_t)i * 16, identity, sizeof identity);
+    memset(graph->translation + (size_t)i * 3, 0, 3 * sizeof(float));
+    const float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f }, scale[3] = { 1.0f, 1.0f, 1.0f };
+    memcpy(graph->rotation + (size_t)i * 4, rotation, sizeof rotation);
+    memcpy(graph->scale + (size_t)i * 3, scale, sizeof scale);
+    graph->flags[i] = TRANSFORM_FLAG_DIRTY;
+    graph->dirty = true;
+
+    // Appending to the deepest level, or starting the next one, keeps the order
+    if (graph->sorted) {
+        const uint32_t depth = parent_index == TRANSFORM_NO_PARENT ? 0 : graph->depth[parent_index] + 1;
+        graph->depth[i] = depth;
+        if (graph->level_count && depth == graph->level_count - 1) graph->level_end[depth] = graph->count;
+        else if (depth == graph->level_count) graph->level_end[graph->level_count++] = graph->count;
+        else graph->sorted = false;
+    }
+    return node;
+}
+
+// Moves every array into the order given by to[old index]. parent is remapped as it goes.
+static void permute(TransformGraph* graph, const uint32_t* to)
+{
+    const uint32_t count = graph->count;
+    float* fields[4] = { graph->world, graph->translation, graph->rotation, graph->scale };
+    const uint32_t widths[4] = { 16, 3, 4, 3 };
+    for (int f = 0; f < 4; ++f) {
+        float* gathered = (float*)graph->scratch;
+        for (uint32_t i = 0; i < count; ++i)
+            memcpy(gathered + (size_t)to[i] * widths[f], fields[f] + (size_t)i * widths[f], widths[f] * sizeof(float));
+        memcpy(fields[f], gathered, (size_t)count * widths[f] * sizeof(float));
+    }
+
+    // to lives past the first 16 words per node of scratch, clear of these
+    uint32_t* parent = graph->scratch;
+    uint32_t* depth = graph->scratch + count;
+    uint32_t* slot = graph->scratch + count * 2;
+    uint8_t* flags = (uint8_t*)(graph->scratch + count * 3);
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint32_t j = to[i];
+        parent[j] = graph->parent[i] == TRANSFORM_NO_PARENT ? TRANSFORM_NO_PARENT : to[graph->parent[i]];
+        depth[j] = graph->depth[i];
+        slot[j] = graph->slot[i];
+        flags[j] = graph->flags[i];
+    }
+    memcpy(graph->parent, parent, count * sizeof(uint32_t));
+    memcpy(graph->depth, depth, count * sizeof(uint32_t));
+    memcpy(graph->slot, slot, count * sizeof(uint32_t));
+    memcpy(graph->flags, flags, count);
+    for (uint32_t i = 0; i < count; ++i) graph->position[graph->slot[i]] = i;
+}
+
+static void sort_by_depth(TransformGraph* graph)
+{
+    const uint32_t count = graph->count;
+    uint32_t* to = graph->scratch + (size_t)graph->capacity * 16;
+    uint32_t* path = graph->scratch; // Free until permute
+
+    // Walk up from each node to the nearest ancestor already measured, then back down
+    for (uint32_t i = 0; i < count; ++i) graph->depth[i] = UINT32_MAX;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t length = 0, j = i;
+        while (j != TRANSFORM_NO_PARENT && graph->depth[j] == UINT32_MAX) {
+            path[length++] = j;
+            j = graph->parent[j];
+        }
+        uint32_t depth = j == TRANSFORM_NO_PARENT ? 0 : graph->depth[j] + 1;
+        while (length) graph->depth[path[--length]] = depth++;
+    }
+
+    // Counting sort, stable so siblings keep their order
+    uint32_t* start = graph->level_end;
+    uint32_t levels = 0;
+    memset(start, 0, ((size_t)count + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; ++i) {
+        start[graph->depth[i] + 1]++;
+        levels = graph->depth[i] + 1 > levels ? graph->depth[i] + 1 : levels;
+    }
+    for (uint32_t d = 1; d <= levels; ++d) start[d] += start[d - 1];
+    for (uint32_t i = 0; i < count; ++i) to[i] = start[graph->depth[i]]++;
+    // Each start has advanced to its level's end
+    graph->level_count = levels;
+
+    permute(graph, to);
+    graph->sorted = true;
+}
+
+void transform_graph_destroy(TransformGraph* graph, uint32_t node)
+{
+    if (node_index(graph, node) == TRANSFORM_NO_PARENT) return;
+    if (!graph->sorted) sort_by_depth(graph);
+    const uint32_t index = node_index(graph, node);
+
+    // Descendants come after their parents, so one pass finds the whole subtree
+    uint8_t* doomed = (uint8_t*)graph->scratch;
+    memset(doomed, 0, graph->count);
+    doomed[index] = 1;
+    for (uint32_t i = index + 1; i < graph->count; ++i)
+        doomed[i] = graph->parent[i] != TRANSFORM_NO_PARENT && doomed[graph->parent[i]];
+
+    // Compact in place; order, and so sortedness, is kept
+    uint32_t* to = graph->scratch + (size_t)graph->capacity * 16;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < graph->count; ++i) {
+        if (doomed[i]) {
+            const uint32_t slot = graph->slot[i];
+            handle_pool_release(&graph->pool, ((uint32_t)graph->pool.generation[slot] << HANDLE_INDEX_BITS) | slot, NULL, NULL);
+            continue;
+        }
+        to[i] = kept;
+        if (kept != i) {
+            memcpy(graph->world + (size_t)kept * 16, graph->world + (size_t)i * 16, 16 * sizeof(float));
+            memcpy(graph->translation + (size_t)kept * 3, graph->translation + (size_t)i * 3, 3 * sizeof(float));
+            memcpy(graph->rotation + (size_t)kept * 4, graph->rotation + (size_t)i * 4, 4 * sizeof(float));
+            memcpy(graph->scale + (size_t)kept * 3, graph->scale + (size_t)i * 3, 3 * sizeof(float));
+            graph->depth[kept] = graph->depth[i];
+            graph->slot[kept] = graph->slot[i];
+            graph->flags[kept] = graph->flags[i];
+            graph->position[graph->slot[i]] = kept;
+        }
+        graph->parent[kept] = graph->parent[i] == TRANSFORM_NO_PARENT ? TRANSFORM_NO_PARENT : to[graph->parent[i]];
+        kept++;
+    }
+    graph->count = kept;
+
+    graph->level_count = 0;
+    for (uint32_t i = 0; i < kept; ++i) {
+        if (graph->depth[i] == graph->level_count) graph->level_count++;
+        graph->level_end[graph->level_count - 1] = i + 1;
+    }
+}
+
+bool transform_graph_set_parent(TransformGraph* graph, uint32_t node, uint32_t parent)
+{
+    const uint32_t index = node_index(graph, node);
+    const uint32_t parent_index = parent ? node_index(graph, parent) : TRANSFORM_NO_PARENT;
+    if (index == TRANSFORM_NO_PARENT || (parent && parent_index == TRANSFORM_NO_PARENT)) return false;
+
+    for (uint32_t j = parent_index; j != TRANSFORM_NO_PARENT; j = graph->parent[j])
+        if (j == index) return false;
+
+    if (graph->parent[index] == parent_index) return true;
+    graph->parent[index] = parent_index;
+    graph->flags[index] |= TRANSFORM_FLAG_DIRTY;
+    graph->dirty = true;
+    graph->sorted = false;
+    return true;
+}
+
+bool transform_graph_set_local(TransformGraph* graph, uint32_t node, const EngineTransform* local)
+{
+    const uint32_t i = node_index(graph, node);
+    if (i == TRANSFORM_NO_PARENT) return false;
+    memcpy(graph->translation + (size_t)i * 3, local->translation, 3 * sizeof(float));
+    memcpy(graph->rotation + (size_t)i * 4, local->rotation, 4 * sizeof(float));
+    memcpy(graph->scale + (size_t)i * 3, local->scale, 3 * sizeof(float));
+    graph->flags[i] |= TRANSFORM_FLAG_DIRTY;
+    graph->dirty = true;
+    return true;
+}
+
+bool transform_graph_get_local(const TransformGraph* graph, uint32_t node, EngineTransform* out)
+{
+    const uint32_t i = node_index(graph, node);
+    if (i == TRANSFORM_NO_PARENT) return false;
+    memcpy(out->translation, graph->translation + (size_t)i * 3, 3 * sizeof(float));
+    memcpy(out->rotation, graph->rotation + (size_t)i * 4, 4 * sizeof(float));
+    memcpy(out->scale, graph->scale + (size_t)i * 3, 3 * sizeof(float));
+    return true;
+}
+
+typedef struct UpdateJob
+{
+    TransformGraph* graph;
+    uint32_t        first; // Of the level
+} UpdateJob;
+
+static void update_range(void* data, uint32_t begin, uint32_t end)
+{
+    const UpdateJob* job = data;
+    TransformGraph* g = job->graph;
+    for (uint32_t i = job->first + begin; i < job->first + end; ++i) {
+        const uint32_t p = g->parent[i];
+        if (!(g->flags[i] & TRANSFORM_FLAG_DIRTY) && (p == TRANSFORM_NO_PARENT || !(g->flags[p] & TRANSFORM_FLAG_MOVED))) {
+            g->flags[i] = 0;
+            continue;
+        }
+
+        float* world = g->world + (size_t)i * 16;
+        if (p == TRANSFORM_NO_PARENT) {
+            mat4_from_trs(g->translation + (size_t)i * 3, g->rotation + (size_t)i * 4, g->scale + (size_t)i * 3, world);
+        } else {
+            float local[16];
+            mat4_from_trs(g->translation + (size_t)i * 3, g->rotation + (size_t)i * 4, g->scale + (size_t)i * 3, local);
+            mat4_mul(g->world + (size_t)p * 16, local, world);
+        }
+        g->flags[i] = TRANSFORM_FLAG_MOVED;
+    }
+}
+
+void transform_graph_update(TransformGraph* graph, JobSystem* jobs)
+{
+    if (!graph->dirty) return;
+    PROFILE_BEGIN("transforms");
+    if (!graph->sorted) sort_by_depth(graph);
+
+    // A level only reads the one before it, which is complete by then
+    uint32_t first = 0;
+    for (uint32_t level = 0; level < graph->level_count; ++level) {
+        UpdateJob job = { graph, first };
+        job_system_parallel_for(jobs, graph->level_end[level] - first, TRANSFORM_RANGE, update_range, &job);
+        first = graph->level_end[level];
+    }
+    graph->dirty = false;
+    PROFILE_END();
+}
+
+const float* transform_graph_world(const TransformGraph* graph, uint32_t node)
+{
+    const uint32_t i = node_index(graph, node);
+    return i == TRANSFORM_NO_PARENT ? NULL : graph->world + (size_t)i * 16;
+}
@@ -0,0 +1,71 @@
+//
+// Created by Cain Martin on 2025/09/06.
+//
+
+#ifndef TRANSFORM_GRAPH_H
+#define TRANSFORM_GRAPH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+#include "handle_pool.h"
+#include "job_system.h"
+
+#define TRANSFORM_NO_PARENT UINT32_MAX
+
+// Transform hierarchy for engine_node_*. Node handles come from a HandlePool, but the node
+// data lives in parallel arrays of our own, sorted by depth: every root, then every child of
+// a root, and so on. Parents therefore always come before their children, and
+// transform_graph_update is a single pass in array order that recomputes a world matrix only
+// when its node's local transform changed or its parent's world matrix was just
+// recomputed. Each depth is one contiguous run, split into ranges across the job threads.
+//
+// Creating a node under the deepest level keeps the order; anything else (a new node under a
+// shallower parent, a change of parent) marks the arrays unsorted, and the next update
+// sorts them again by depth with a counting sort before the pass.
+typedef struct TransformGraph
+{
+    HandlePool pool;        // Handles only; its dense order is not ours
+    uint32_t*  position;    // Slot -> index into the arrays below
+
+    float*     world;       // 16 per node, 16 byte aligned
+    float*     translation; // 3 per node
+    float*     rotation;    // 4 per node, unit quaternion x y z w
+    float*     scale;       // 3 per node
+    uint32_t*  parent;      // Index of the parent, TRANSFORM_NO_PARENT for roots
+    uint32_t*  depth;       // Only valid while sorted
+    uint32_t*  slot;
+    uint8_t*   flags;       // Dirty and moved bits, see transform_graph.c
+    uint32_t*  level_end;   // Index past the last node of each depth
+    uint32_t   level_count;
+    uint32_t*  scratch;     // Sorting and removal, 17 words per node
+    uint32_t   count;
+    uint32_t   capacity;
+    bool       sorted;
+    bool       dirty;       // Some local transform changed since the last update
+} TransformGraph;
+
+bool     transform_graph_init(TransformGraph* graph, uint32_t capacity);
+void     transform_graph_free(TransformGraph* graph);
+
+// Returns 0 when the graph is full or the parent is stale. Parent 0 makes a root. The node
+// starts at the identity.
+uint32_t transform_graph_create(TransformGraph* graph, uint32_t parent);
+
+// Removes the node and everything below it
+void     transform_graph_destroy(TransformGraph* graph, uint32_t node);
+
+// False for stale handles and for a parent inside the node's own subtree
+bool     transform_graph_set_parent(TransformGraph* graph, uint32_t node, uint32_t parent);
+
+bool     transform_graph_set_local(TransformGraph* graph, uint32_t node, const EngineTransform* local);
+bool     transform_graph_get_local(const TransformGraph* graph, uint32_t node, EngineTransform* out);
+
+// Recomputes the world matrices that changed. Does nothing when no local transform or parent
+// did.
+void     transform_graph_update(TransformGraph* graph, JobSystem* jobs);
+
+// As of the last update; NULL for stale handles. Safe from any thread between updates.
+const float* transform_graph_world(const TransformGraph* graph, uint32_t node);
+
+#endif //TRANSFORM_GRAPH_H
@@ -0,0 +1,164 @@
+//
+// Created by Cain Martin on 2025/09/01.
+//
+
+#include "gl_program_cache.h"
+#include <stdio.h>
+#include <string.h>
+#include "../../core/memory.h"
+
+#define GL_PROGRAM_CACHE_MAGIC   0x47525047u // "GPRG"
+// Bump when shader_create changes what it does to a program before linking (attribute
+// bindings and the like), so binaries linked the old way are not picked up
+#define GL_PROGRAM_CACHE_VERSION 1u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t driver_hash;
+    uint64_t key;      // Guards against a file renamed or copied under another key
+    uint32_t format;   // From glGetProgramBinary
+    uint32_t size;     // Binary bytes following the header
+} GLProgramCacheHeader;
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static uint64_t hash_string(uint64_t hash, const char* s)
+{
+    // The terminator goes in too, so "ab" + "c" and "a" + "bc" differ
+    return fnv1a(hash, s ? s : "", s ? strlen(s) + 1 : 1);
+}
+
+static void cache_path(const GLProgramCache* cache, uint64_t key, const char* suffix, char* out, size_t out_size)
+{
+    snprintf(out, out_size, "%s/%016llx.glprog%s", cache->dir, (unsigned long long)key, suffix);
+}
+
+void gl_program_cache_init(GLProgramCache* cache, const char* dir)
+{
+    memset(cache, 0, sizeof *cache);
+    if (!dir || !dir[0]) return;
+    if (strlen(dir) + 32 >= sizeof cache->dir) {
+        fprintf(stderr, "gl_program_cache_init: path too long, cache disabled\n");
+        return;
+    }
+
+    GLint formats = 0;
+    if (GLAD_GL_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        fprintf(stderr, "gl_program_cache_init: driver has no program binary formats, cache disabled\n");
+        return;
+    }
+
+    strcpy(cache->dir, dir);
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = hash_string(hash, (const char*)glGetString(GL_VENDOR));
+    hash = hash_string(hash, (const char*)glGetString(GL_RENDERER));
+    hash = hash_string(hash, (const char*)glGetString(GL_VERSION));
+    cache->driver_hash = hash;
+    cache->enabled = true;
+}
+
+uint64_t gl_program_cache_key(const char* vs_src, const char* fs_src)
+{
+    const uint32_t version = GL_PROGRAM_CACHE_VERSION;
+    uint64_t hash = fnv1a(0xcbf29ce484222325ull, &version, sizeof version);
+    hash = hash_string(hash, vs_src);
+    return hash_string(hash, fs_src);
+}
+
+GLuint gl_program_cache_load(GLProgramCache* cache, uint64_t key)
+{
+    if (!cache->enabled) return 0;
+
+    // A missing file is the normal cold start, so no open error is printed
+    char path[GL_PROGRAM_CACHE_MAX_PATH];
+    cache_path(cache, key, "", path, sizeof path);
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        cache->misses++;
+        return 0;
+    }
+
+    GLProgramCacheHeader header;
+    void* binary = NULL;
+    bool valid = fread(&header, sizeof header, 1, file) == 1
+        && header.magic == GL_PROGRAM_CACHE_MAGIC && header.version == GL_PROGRAM_CACHE_VERSION
+        && header.driver_hash == cache->driver_hash && header.key == key && header.size > 0;
+    if (valid) {
+        binary = mem_alloc(header.size);
+        valid = binary && fread(binary, 1, header.size, file) == header.size;
+    }
+    fclose(file);
+
+    GLuint program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, binary, (GLsizei)header.size);
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            // Same strings but the driver still refuses it (GL only promises binaries work
+            // on an identical setup): compile, and let the store replace the file
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    mem_free(binary);
+
+    if (program) cache->hits++;
+    else cache->misses++;
+    return program;
+}
+
+void gl_program_cache_store(GLProgramCache* cache, uint64_t key, GLuint program)
+{
+    if (!cache->enabled) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    void* binary = mem_alloc((size_t)length);
+    if (!binary) return;
+
+    GLProgramCacheHeader header = { GL_PROGRAM_CACHE_MAGIC, GL_PROGRAM_CACHE_VERSION, cache->driver_hash, key, 0, 0 };
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, binary);
+    header.format = format;
+    header.size = (uint32_t)written;
+
+    // Written aside and renamed into place, so a crash or a second instance never leaves a
+    // half file under the real name
+    char path[GL_PROGRAM_CACHE_MAX_PATH], temp[GL_PROGRAM_CACHE_MAX_PATH];
+    cache_path(cache, key, "", path, sizeof path);
+    cache_path(cache, key, ".tmp", temp, sizeof temp);
+    FILE* file = written > 0 ? fopen(temp, "wb") : NULL;
+    const bool opened = file != NULL;
+    bool ok = opened;
+    if (opened) {
+        ok = fwrite(&header, sizeof header, 1, file) == 1 && fwrite(binary, 1, (size_t)written, file) == (size_t)written;
+        ok = fclose(file) == 0 && ok;
+    }
+    mem_free(binary);
+
+    if (ok) {
+#ifdef _WIN32
+        remove(path); // rename does not replace an existing file there
+#endif
+        ok = rename(temp, path) == 0;
+    }
+    if (!ok) {
+        if (opened) remove(temp);
+        fprintf(stderr, "gl_program_cache_store: unable to write %s\n", path);
+    }
+}
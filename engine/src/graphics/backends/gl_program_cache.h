@@ -0,0 +1,40 @@
+//
+// Created by Cain Martin on 2025/09/01.
+//
+
+#ifndef GL_PROGRAM_CACHE_H
+#define GL_PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GL_PROGRAM_CACHE_MAX_PATH 512
+
+// Linked program binaries kept on disk (glGetProgramBinary / glProgramBinary), one file per
+// vertex + fragment source pair. A file is only used when the driver that wrote it - vendor,
+// renderer and version strings - is the one running; otherwise, or when the driver rejects
+// the binary, the program is compiled from source again and the file overwritten. So a
+// driver update costs one cold start and leaves nothing stale behind.
+typedef struct GLProgramCache
+{
+    char     dir[GL_PROGRAM_CACHE_MAX_PATH];
+    uint64_t driver_hash;
+    bool     enabled;    // A directory was given and the driver has at least one binary format
+    uint32_t hits;
+    uint32_t misses;     // Compiled from source: no file, another driver's, or rejected
+} GLProgramCache;
+
+// dir must exist; NULL or empty disables the cache. Needs a current context.
+void     gl_program_cache_init(GLProgramCache* cache, const char* dir);
+
+// Identifies a program by its sources and by how the engine sets programs up before linking
+uint64_t gl_program_cache_key(const char* vs_src, const char* fs_src);
+
+// A linked program from the cache, or 0 (counted as a miss) when there is no usable binary
+GLuint   gl_program_cache_load(GLProgramCache* cache, uint64_t key);
+
+// Writes the binary of a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+void     gl_program_cache_store(GLProgramCache* cache, uint64_t key, GLuint program);
+
+#endif //GL_PROGRAM_CACHE_H
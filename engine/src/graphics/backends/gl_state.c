@@ -0,0 +1,246 @@
+//
+// Created by Cain Martin on 2025/08/23.
+//
+
+#include <stdio.h>
+#include "gl_state.h"
+
+// No real GL name reaches this, so an unknown binding never matches
+#define GL_STATE_UNKNOWN 0xffffffffu
+
+void gl_state_invalidate(GLStateCache* cache)
+{
+    cache->program      = GL_STATE_UNKNOWN;
+    cache->vao          = GL_STATE_UNKNOWN;
+    cache->framebuffer  = GL_STATE_UNKNOWN;
+    cache->array_buffer = GL_STATE_UNKNOWN;
+    cache->uniform_buffer = GL_STATE_UNKNOWN;
+    for (int i = 0; i < GL_STATE_MAX_UNIFORM_BINDINGS; ++i) cache->uniform_ranges[i].buffer = GL_STATE_UNKNOWN;
+    cache->viewport[0]  = cache->viewport[1] = cache->viewport[2] = cache->viewport[3] = -1;
+    cache->active_unit  = GL_STATE_UNKNOWN;
+    for (int i = 0; i < GL_STATE_MAX_TEXTURE_UNITS; ++i) cache->textures[i] = GL_STATE_UNKNOWN;
+    cache->blend        = -1;
+    cache->blend_src    = GL_STATE_UNKNOWN;
+    cache->blend_dst    = GL_STATE_UNKNOWN;
+    cache->depth_test   = -1;
+    cache->depth_write  = -1;
+    cache->cull         = -1;
+    cache->cull_face    = GL_STATE_UNKNOWN;
+}
+
+void gl_state_use_program(GLStateCache* cache, GLuint program)
+{
+    if (cache->program == program) { cache->calls_elided++; return; }
+    glUseProgram(program);
+    cache->program = program;
+    cache->calls_issued++;
+}
+
+void gl_state_bind_vao(GLStateCache* cache, GLuint vao)
+{
+    if (cache->vao == vao) { cache->calls_elided++; return; }
+    glBindVertexArray(vao);
+    cache->vao = vao;
+    cache->calls_issued++;
+}
+
+void gl_state_bind_framebuffer(GLStateCache* cache, GLuint framebuffer)
+{
+    if (cache->framebuffer == framebuffer) { cache->calls_elided++; return; }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    cache->framebuffer = framebuffer;
+    cache->calls_issued++;
+}
+
+void gl_state_bind_array_buffer(GLStateCache* cache, GLuint buffer)
+{
+    if (cache->array_buffer == buffer) { cache->calls_elided++; return; }
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    cache->array_buffer = buffer;
+    cache->calls_issued++;
+}
+
+void gl_state_bind_uniform_buffer(GLStateCache* cache, GLuint buffer)
+{
+    if (cache->uniform_buffer == buffer) { cache->calls_elided++; return; }
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    cache->uniform_buffer = buffer;
+    cache->calls_issued++;
+}
+
+void gl_state_bind_uniform_range(GLStateCache* cache, GLuint binding, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    if (binding >= GL_STATE_MAX_UNIFORM_BINDINGS) return;
+    if (cache->uniform_ranges[binding].buffer == buffer
+        && cache->uniform_ranges[binding].offset == offset
+        && cache->uniform_ranges[binding].size == size) {
+        cache->calls_elided++;
+        return;
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+    cache->uniform_ranges[binding].buffer = buffer;
+    cache->uniform_ranges[binding].offset = offset;
+    cache->uniform_ranges[binding].size = size;
+    cache->uniform_buffer = buffer; // Indexed binds also set the generic binding
+    cache->calls_issued++;
+}
+
+void gl_state_viewport(GLStateCache* cache, GLint x, GLint y, GLint width, GLint height)
+{
+    GLint* v = cache->viewport;
+    if (v[0] == x && v[1] == y && v[2] == width && v[3] == height) { cache->calls_elided++; return; }
+    glViewport(x, y, width, height);
+    v[0] = x; v[1] = y; v[2] = width; v[3] = height;
+    cache->calls_issued++;
+}
+
+void gl_state_bind_texture(GLStateCache* cache, GLuint unit, GLuint texture)
+{
+    if (unit >= GL_STATE_MAX_TEXTURE_UNITS) return;
+    if (cache->textures[unit] == texture) { cache->calls_elided++; return; }
+
+    if (cache->active_unit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        cache->active_unit = unit;
+        cache->calls_issued++;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    cache->textures[unit] = texture;
+    cache->calls_issued++;
+}
+
+static void set_capability(GLStateCache* cache, int8_t* shadow, GLenum cap, bool enabled)
+{
+    if (*shadow == (int8_t)enabled) { cache->calls_elided++; return; }
+    if (enabled) glEnable(cap); else glDisable(cap);
+    *shadow = (int8_t)enabled;
+    cache->calls_issued++;
+}
+
+void gl_state_blend(GLStateCache* cache, bool enabled) { set_capability(cache, &cache->blend, GL_BLEND, enabled); }
+void gl_state_depth_test(GLStateCache* cache, bool enabled) { set_capability(cache, &cache->depth_test, GL_DEPTH_TEST, enabled); }
+void gl_state_cull(GLStateCache* cache, bool enabled) { set_capability(cache, &cache->cull, GL_CULL_FACE, enabled); }
+
+void gl_state_blend_func(GLStateCache* cache, GLenum src, GLenum dst)
+{
+    if (cache->blend_src == src && cache->blend_dst == dst) { cache->calls_elided++; return; }
+    glBlendFunc(src, dst);
+    cache->blend_src = src;
+    cache->blend_dst = dst;
+    cache->calls_issued++;
+}
+
+void gl_state_depth_write(GLStateCache* cache, bool enabled)
+{
+    if (cache->depth_write == (int8_t)enabled) { cache->calls_elided++; return; }
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    cache->depth_write = (int8_t)enabled;
+    cache->calls_issued++;
+}
+
+void gl_state_cull_face(GLStateCache* cache, GLenum face)
+{
+    if (cache->cull_face == face) { cache->calls_elided++; return; }
+    glCullFace(face);
+    cache->cull_face = face;
+    cache->calls_issued++;
+}
+
+void gl_state_on_delete_program(GLStateCache* cache, GLuint program)
+{
+    // A deleted program stays current until something else is used, but its name can be
+    // reused, so forget it rather than risk eliding a bind of the new program
+    if (cache->program == program) cache->program = GL_STATE_UNKNOWN;
+}
+
+void gl_state_on_delete_vao(GLStateCache* cache, GLuint vao)
+{
+    if (cache->vao == vao) cache->vao = 0;
+}
+
+void gl_state_on_delete_buffer(GLStateCache* cache, GLuint buffer)
+{
+    if (cache->array_buffer == buffer) cache->array_buffer = 0;
+    if (cache->uniform_buffer == buffer) cache->uniform_buffer = 0;
+    for (int i = 0; i < GL_STATE_MAX_UNIFORM_BINDINGS; ++i)
+        if (cache->uniform_ranges[i].buffer == buffer) cache->uniform_ranges[i].buffer = 0;
+}
+
+void gl_state_on_delete_texture(GLStateCache* cache, GLuint texture)
+{
+    for (int i = 0; i < GL_STATE_MAX_TEXTURE_UNITS; ++i)
+        if (cache->textures[i] == texture) cache->textures[i] = 0;
+}
+
+#ifdef GL_STATE_VALIDATE
+
+static void check_binding(const char* where, const char* what, GLuint shadow, GLint actual)
+{
+    if (shadow != GL_STATE_UNKNOWN && shadow != (GLuint)actual)
+        fprintf(stderr, "gl_state (%s): %s is %d, cache has %u\n", where, what, actual, shadow);
+}
+
+static void check_capability(const char* where, const char* what, int8_t shadow, GLenum cap)
+{
+    const int actual = glIsEnabled(cap) ? 1 : 0;
+    if (shadow >= 0 && shadow != actual)
+        fprintf(stderr, "gl_state (%s): %s is %d, cache has %d\n", where, what, actual, shadow);
+}
+
+void gl_state_validate(const GLStateCache* cache, const char* where)
+{
+    GLint value = 0;
+
+    glGetIntegerv(GL_CURRENT_PROGRAM, &value);
+    check_binding(where, "program", cache->program, value);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value);
+    check_binding(where, "vertex array", cache->vao, value);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &value);
+    check_binding(where, "framebuffer", cache->framebuffer, value);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &value);
+    check_binding(where, "array buffer", cache->array_buffer, value);
+    glGetIntegerv(GL_UNIFORM_BUFFER_BINDING, &value);
+    check_binding(where, "uniform buffer", cache->uniform_buffer, value);
+    for (GLuint i = 0; i < GL_STATE_MAX_UNIFORM_BINDINGS; ++i) {
+        if (cache->uniform_ranges[i].buffer == GL_STATE_UNKNOWN) continue;
+        glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, i, &value);
+        check_binding(where, "uniform buffer range", cache->uniform_ranges[i].buffer, value);
+    }
+
+    if (cache->viewport[2] >= 0) {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        for (int i = 0; i < 4; ++i)
+            check_binding(where, "viewport", (GLuint)cache->viewport[i], viewport[i]);
+    }
+
+    GLint active = 0;
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+    if (cache->active_unit != GL_STATE_UNKNOWN)
+        check_binding(where, "active texture unit", cache->active_unit, active - GL_TEXTURE0);
+    for (GLuint unit = 0; unit < GL_STATE_MAX_TEXTURE_UNITS; ++unit) {
+        if (cache->textures[unit] == GL_STATE_UNKNOWN) continue;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &value);
+        check_binding(where, "texture unit binding", cache->textures[unit], value);
+    }
+    glActiveTexture((GLenum)active);
+
+    check_capability(where, "GL_BLEND", cache->blend, GL_BLEND);
+    check_capability(where, "GL_DEPTH_TEST", cache->depth_test, GL_DEPTH_TEST);
+    check_capability(where, "GL_CULL_FACE", cache->cull, GL_CULL_FACE);
+
+    GLboolean depth_write = GL_FALSE;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_write);
+    if (cache->depth_write >= 0 && cache->depth_write != (depth_write ? 1 : 0))
+        fprintf(stderr, "gl_state (%s): depth write is %d, cache has %d\n", where, depth_write ? 1 : 0, cache->depth_write);
+
+    glGetIntegerv(GL_BLEND_SRC_RGB, &value);
+    check_binding(where, "blend src", cache->blend_src, value);
+    glGetIntegerv(GL_BLEND_DST_RGB, &value);
+    check_binding(where, "blend dst", cache->blend_dst, value);
+    glGetIntegerv(GL_CULL_FACE_MODE, &value);
+    check_binding(where, "cull face", cache->cull_face, value);
+}
+
+#endif
@@ -0,0 +1,78 @@
+//
+// Created by Cain Martin on 2025/08/23.
+//
+
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GL_STATE_MAX_TEXTURE_UNITS 16
+#define GL_STATE_MAX_UNIFORM_BINDINGS 4
+
+// Shadow copy of the GL state the backend touches. Every bind and toggle goes through here
+// and is dropped when the shadow already holds the value. Anything in the backend that
+// changes this state behind the cache's back must call gl_state_invalidate.
+typedef struct GLStateCache
+{
+    GLuint   program;
+    GLuint   vao;
+    GLuint   framebuffer;
+    GLuint   array_buffer;
+    GLuint   uniform_buffer;
+    struct {
+        GLuint     buffer;
+        GLintptr   offset;
+        GLsizeiptr size;
+    }        uniform_ranges[GL_STATE_MAX_UNIFORM_BINDINGS];
+    GLint    viewport[4];
+    GLuint   active_unit;
+    GLuint   textures[GL_STATE_MAX_TEXTURE_UNITS];
+    int8_t   blend;       // -1 = unknown
+    GLenum   blend_src;
+    GLenum   blend_dst;
+    int8_t   depth_test;
+    int8_t   depth_write;
+    int8_t   cull;
+    GLenum   cull_face;
+
+    uint32_t calls_issued;
+    uint32_t calls_elided;
+} GLStateCache;
+
+// Forgets everything so the next call of each kind reaches the driver
+void gl_state_invalidate(GLStateCache* cache);
+
+void gl_state_use_program(GLStateCache* cache, GLuint program);
+void gl_state_bind_vao(GLStateCache* cache, GLuint vao);
+void gl_state_bind_framebuffer(GLStateCache* cache, GLuint framebuffer);
+void gl_state_bind_array_buffer(GLStateCache* cache, GLuint buffer);
+void gl_state_bind_uniform_buffer(GLStateCache* cache, GLuint buffer);
+void gl_state_bind_uniform_range(GLStateCache* cache, GLuint binding, GLuint buffer, GLintptr offset, GLsizeiptr size);
+void gl_state_viewport(GLStateCache* cache, GLint x, GLint y, GLint width, GLint height);
+void gl_state_bind_texture(GLStateCache* cache, GLuint unit, GLuint texture);
+void gl_state_blend(GLStateCache* cache, bool enabled);
+void gl_state_blend_func(GLStateCache* cache, GLenum src, GLenum dst);
+void gl_state_depth_test(GLStateCache* cache, bool enabled);
+void gl_state_depth_write(GLStateCache* cache, bool enabled);
+void gl_state_cull(GLStateCache* cache, bool enabled);
+void gl_state_cull_face(GLStateCache* cache, GLenum face);
+
+// GL silently unbinds deleted objects, and the name can be handed out again, so deletes
+// must clear any shadow binding that refers to them
+void gl_state_on_delete_program(GLStateCache* cache, GLuint program);
+void gl_state_on_delete_vao(GLStateCache* cache, GLuint vao);
+void gl_state_on_delete_buffer(GLStateCache* cache, GLuint buffer);
+void gl_state_on_delete_texture(GLStateCache* cache, GLuint texture);
+
+// With GL_STATE_VALIDATE defined, compares the shadow state against glGet* and reports
+// mismatches on stderr. Compiles to nothing otherwise.
+#ifdef GL_STATE_VALIDATE
+void gl_state_validate(const GLStateCache* cache, const char* where);
+#else
+#define gl_state_validate(cache, where) ((void)0)
+#endif
+
+#endif //GL_STATE_H
@@ -0,0 +1,132 @@
+//
+// Created by Cain Martin on 2025/08/29.
+//
+
+#include <stdio.h>
+#include "gl_state.h"
+#include "gl_stream.h"
+
+#define GL_STREAM_WAIT_NS 1000000 // Per glClientWaitSync attempt
+
+static GLbitfield persistent_flags(void)
+{
+    return GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+}
+
+bool gl_stream_init(GLStream* stream, GLStateCache* state, GLsizeiptr frame_size)
+{
+    const GLsizeiptr total = frame_size * GL_STREAM_FRAMES;
+
+    stream->frame_size = frame_size;
+    stream->offset = 0;
+    stream->frame = 0;
+    stream->base = NULL;
+    stream->mapped = NULL;
+    stream->waits = 0;
+    for (int i = 0; i < GL_STREAM_FRAMES; ++i) stream->fences[i] = NULL;
+
+    glGenBuffers(1, &stream->buffer);
+    gl_state_bind_array_buffer(state, stream->buffer);
+
+    stream->persistent = GLAD_GL_ARB_buffer_storage != 0;
+    if (stream->persistent) {
+        glBufferStorage(GL_ARRAY_BUFFER, total, NULL, persistent_flags());
+        uint8_t* base = glMapBufferRange(GL_ARRAY_BUFFER, 0, total, persistent_flags());
+        if (base) {
+            stream->base = base;
+            stream->mapped = base;
+            return true;
+        }
+
+        // Immutable storage cannot be respecified - start over with a mutable buffer
+        fprintf(stderr, "gl_stream: persistent map failed, using unsynchronized mapping\n");
+        gl_state_on_delete_buffer(state, stream->buffer);
+        glDeleteBuffers(1, &stream->buffer);
+        glGenBuffers(1, &stream->buffer);
+        gl_state_bind_array_buffer(state, stream->buffer);
+        stream->persistent = false;
+    }
+
+    glBufferData(GL_ARRAY_BUFFER, total, NULL, GL_STREAM_DRAW);
+    return glGetError() == GL_NO_ERROR;
+}
+
+void gl_stream_shutdown(GLStream* stream, GLStateCache* state)
+{
+    for (int i = 0; i < GL_STREAM_FRAMES; ++i) {
+        if (stream->fences[i]) glDeleteSync(stream->fences[i]);
+        stream->fences[i] = NULL;
+    }
+    if (stream->buffer) {
+        // Deleting a buffer unmaps it
+        gl_state_on_delete_buffer(state, stream->buffer);
+        glDeleteBuffers(1, &stream->buffer);
+    }
+    stream->buffer = 0;
+    stream->base = NULL;
+    stream->mapped = NULL;
+}
+
+void gl_stream_begin_frame(GLStream* stream, GLStateCache* state)
+{
+    stream->frame = (stream->frame + 1) % GL_STREAM_FRAMES;
+    stream->offset = 0;
+
+    GLsync fence = stream->fences[stream->frame];
+    if (fence) {
+        // Normally signalled long ago; only a GPU more than two frames behind makes this wait
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            stream->waits++;
+            do {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_STREAM_WAIT_NS);
+            } while (status == GL_TIMEOUT_EXPIRED);
+        }
+        glDeleteSync(fence);
+        stream->fences[stream->frame] = NULL;
+    }
+
+    const GLintptr region = (GLintptr)stream->frame * stream->frame_size;
+    if (stream->persistent) {
+        // The mapping covers every region; mapped always points at the current one
+        stream->mapped = stream->base + region;
+        return;
+    }
+
+    // The fence already proved the GPU is done with this region, so skip the driver's sync
+    gl_state_bind_array_buffer(state, stream->buffer);
+    stream->mapped = glMapBufferRange(GL_ARRAY_BUFFER, region, stream->frame_size,
+                                      GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                                      GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+}
+
+void* gl_stream_alloc(GLStream* stream, GLsizeiptr size, GLsizeiptr align, GLintptr* out_offset)
+{
+    if (!stream->mapped || size <= 0) return NULL;
+
+    const GLsizeiptr region = (GLsizeiptr)stream->frame * stream->frame_size;
+    // Align the buffer offset, which is what the GL checks
+    const GLsizeiptr absolute = (region + stream->offset + align - 1) / align * align;
+    const GLsizeiptr offset = absolute - region;
+    if (offset + size > stream->frame_size) return NULL;
+
+    stream->offset = offset + size;
+    *out_offset = (GLintptr)absolute;
+    return stream->mapped + offset;
+}
+
+void gl_stream_flush(GLStream* stream, GLStateCache* state)
+{
+    if (stream->persistent || !stream->mapped) return;
+
+    gl_state_bind_array_buffer(state, stream->buffer);
+    if (stream->offset) glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, stream->offset);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    stream->mapped = NULL;
+}
+
+void gl_stream_end_frame(GLStream* stream)
+{
+    if (stream->fences[stream->frame]) glDeleteSync(stream->fences[stream->frame]);
+    stream->fences[stream->frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
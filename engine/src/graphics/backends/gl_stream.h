@@ -0,0 +1,54 @@
+//
+// Created by Cain Martin on 2025/08/29.
+//
+
+#ifndef GL_STREAM_H
+#define GL_STREAM_H
+
+#include <glad/glad.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GL_STREAM_FRAMES     3
+#define GL_STREAM_FRAME_SIZE (8 * 1024 * 1024) // Bytes per frame region
+
+struct GLStateCache;
+
+// One buffer split into a region per frame in flight, for data written once per frame:
+// instance matrices, uniform blocks and transient geometry. The CPU writes straight into
+// mapped memory and the region is fenced when the frame is submitted, so it is only reused
+// after the GPU has finished reading it - the driver never has to sync or copy.
+//
+// With ARB_buffer_storage the whole buffer stays persistently and coherently mapped.
+// Without it, each frame maps its own region unsynchronized (the fence already guarantees
+// the GPU is done with it) and unmaps it in gl_stream_flush before drawing.
+typedef struct GLStream
+{
+    GLuint     buffer;
+    uint8_t*   base;       // Whole buffer when persistently mapped
+    uint8_t*   mapped;     // Start of the current frame's region, NULL while unmapped
+    GLsizeiptr frame_size;
+    GLsizeiptr offset;     // Bytes used in the current region
+    uint32_t   frame;
+    GLsync     fences[GL_STREAM_FRAMES];
+    bool       persistent;
+    uint32_t   waits;      // Frames that had to wait on a fence, since init
+} GLStream;
+
+bool  gl_stream_init(GLStream* stream, struct GLStateCache* state, GLsizeiptr frame_size);
+void  gl_stream_shutdown(GLStream* stream, struct GLStateCache* state);
+
+// Moves to the next region, waiting for the GPU only if it still reads from it
+void  gl_stream_begin_frame(GLStream* stream, struct GLStateCache* state);
+
+// Returns a write pointer, and the allocation's offset in the buffer, or NULL when the
+// region is full or already flushed this frame. align need not be a power of two.
+void* gl_stream_alloc(GLStream* stream, GLsizeiptr size, GLsizeiptr align, GLintptr* out_offset);
+
+// Makes this frame's writes visible to the GPU. Call before the first draw that reads them.
+void  gl_stream_flush(GLStream* stream, struct GLStateCache* state);
+
+// Fences the region once the frame's last draw that reads it has been issued
+void  gl_stream_end_frame(GLStream* stream);
+
+#endif //GL_STREAM_H
@@ -0,0 +1,61 @@
+//
+// Created by Cain Martin on 2025/08/28.
+//
+
+#include "gl_timer.h"
+#include "../../core/profiler.h"
+#include "../../platform/clock.h"
+
+void gl_timer_init(GLTimer* timer)
+{
+    glGenQueries(GL_TIMER_FRAMES * GL_TIMER_MAX_ZONES, &timer->queries[0][0]);
+    for (int f = 0; f < GL_TIMER_FRAMES; ++f) timer->count[f] = 0;
+    timer->frame = 0;
+    timer->open = false;
+}
+
+void gl_timer_shutdown(GLTimer* timer)
+{
+    if (timer->open) glEndQuery(GL_TIME_ELAPSED);
+    glDeleteQueries(GL_TIMER_FRAMES * GL_TIMER_MAX_ZONES, &timer->queries[0][0]);
+}
+
+void gl_timer_begin_frame(GLTimer* timer)
+{
+    gl_timer_end(timer);
+    timer->frame++;
+
+    const uint32_t f = timer->frame % GL_TIMER_FRAMES;
+    for (uint32_t z = 0; z < timer->count[f]; ++z) {
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(timer->queries[f][z], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(timer->queries[f][z], GL_QUERY_RESULT, &ns);
+        profiler_gpu_zone(timer->names[f][z], timer->cpu_start[f][z], (double)ns / 1.0e6);
+    }
+    timer->count[f] = 0;
+}
+
+void gl_timer_begin(GLTimer* timer, const char* name)
+{
+    gl_timer_end(timer);
+    if (!profiler_enabled()) return;
+
+    const uint32_t f = timer->frame % GL_TIMER_FRAMES;
+    if (timer->count[f] == GL_TIMER_MAX_ZONES) return;
+
+    const uint32_t z = timer->count[f]++;
+    timer->names[f][z] = name;
+    timer->cpu_start[f][z] = clock_ticks();
+    glBeginQuery(GL_TIME_ELAPSED, timer->queries[f][z]);
+    timer->open = true;
+}
+
+void gl_timer_end(GLTimer* timer)
+{
+    if (!timer->open) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    timer->open = false;
+}
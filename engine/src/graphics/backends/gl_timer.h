@@ -0,0 +1,37 @@
+//
+// Created by Cain Martin on 2025/08/28.
+//
+
+#ifndef GL_TIMER_H
+#define GL_TIMER_H
+
+#include <glad/glad.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GL_TIMER_FRAMES    3 // Frames of queries in flight before a result is needed
+#define GL_TIMER_MAX_ZONES 8 // Per frame
+
+// GPU zones measured with GL_TIME_ELAPSED queries. Each frame uses its own set of query
+// objects and results are read GL_TIMER_FRAMES frames later, only if the driver reports them
+// available - a result that is still not ready is dropped, never waited for. Time elapsed
+// queries cannot nest, so beginning a zone ends the open one.
+typedef struct GLTimer
+{
+    GLuint      queries[GL_TIMER_FRAMES][GL_TIMER_MAX_ZONES];
+    const char* names[GL_TIMER_FRAMES][GL_TIMER_MAX_ZONES];
+    uint64_t    cpu_start[GL_TIMER_FRAMES][GL_TIMER_MAX_ZONES];
+    uint32_t    count[GL_TIMER_FRAMES];
+    uint32_t    frame;
+    bool        open;
+} GLTimer;
+
+void gl_timer_init(GLTimer* timer);
+void gl_timer_shutdown(GLTimer* timer);
+
+// Collects the results of the frame whose queries are about to be reused
+void gl_timer_begin_frame(GLTimer* timer);
+void gl_timer_begin(GLTimer* timer, const char* name);
+void gl_timer_end(GLTimer* timer);
+
+#endif //GL_TIMER_H
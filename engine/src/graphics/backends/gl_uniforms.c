@@ -0,0 +1,176 @@
+//
+// Created by Cain Martin on 2025/08/24.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "gl_uniforms.h"
+
+static bool type_shape(GLenum type, int* rows, int* cols)
+{
+    switch (type) {
+        case GL_FLOAT:      *rows = 1; *cols = 1; return true;
+        case GL_FLOAT_VEC2: *rows = 2; *cols = 1; return true;
+        case GL_FLOAT_VEC3: *rows = 3; *cols = 1; return true;
+        case GL_FLOAT_VEC4: *rows = 4; *cols = 1; return true;
+        case GL_FLOAT_MAT2: *rows = 2; *cols = 2; return true;
+        case GL_FLOAT_MAT3: *rows = 3; *cols = 3; return true;
+        case GL_FLOAT_MAT4: *rows = 4; *cols = 4; return true;
+        default: return false;
+    }
+}
+
+uint32_t gl_uniform_hash(const char* name)
+{
+    uint32_t h = 2166136261u;
+    while (*name) {
+        h ^= (uint8_t)*name++;
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+static bool table_insert(GLUniformTable* table, const GLUniform* uniform, int* used)
+{
+    if (*used >= GL_UNIFORM_TABLE_SLOTS * 3 / 4) return false;
+
+    uint32_t i = uniform->hash & (GL_UNIFORM_TABLE_SLOTS - 1);
+    while (table->slots[i].hash != 0) {
+        if (table->slots[i].hash == uniform->hash) return false; // Collision - keep the first
+        i = (i + 1) & (GL_UNIFORM_TABLE_SLOTS - 1);
+    }
+
+    table->slots[i] = *uniform;
+    (*used)++;
+    return true;
+}
+
+void gl_uniform_table_build(GLUniformTable* table, GLuint program)
+{
+    memset(table, 0, sizeof *table);
+
+    const GLuint frame_block = glGetUniformBlockIndex(program, GL_FRAME_BLOCK_NAME);
+    if (frame_block != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, frame_block, GL_FRAME_BLOCK_BINDING);
+        table->has_frame_block = 1;
+    }
+
+    GLuint material_block = glGetUniformBlockIndex(program, GL_MATERIAL_BLOCK_NAME);
+    if (material_block != GL_INVALID_INDEX) {
+        GLint size = 0;
+        glGetActiveUniformBlockiv(program, material_block, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+        if (size > GL_MATERIAL_BLOCK_MAX_SIZE) {
+            fprintf(stderr, "%s is %d bytes, the limit is %d - ignoring it\n", GL_MATERIAL_BLOCK_NAME, size, GL_MATERIAL_BLOCK_MAX_SIZE);
+            material_block = GL_INVALID_INDEX;
+        } else {
+            glUniformBlockBinding(program, material_block, GL_MATERIAL_BLOCK_BINDING);
+            table->block_size = (uint16_t)size;
+        }
+    }
+
+    GLint active = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &active);
+
+    int used = 0;
+    for (GLint u = 0; u < active; ++u) {
+        char name[128];
+        GLsizei length = 0;
+        GLint array_size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, (GLuint)u, sizeof name, &length, &array_size, &type, name);
+
+        const GLuint index = (GLuint)u;
+        GLint block = -1, offset = 0, array_stride = 0, matrix_stride = 0;
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+
+        // FrameData belongs to the engine, and an oversized MaterialData was rejected above
+        if (block >= 0 && (GLuint)block != material_block) continue;
+
+        if (block >= 0) {
+            glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &offset);
+            glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_ARRAY_STRIDE, &array_stride);
+            glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_MATRIX_STRIDE, &matrix_stride);
+        }
+
+        // Arrays reflect as "name[0]"; members of a block with an instance name reflect as
+        // "Block.name". Both are set by the bare name.
+        char* bracket = strchr(name, '[');
+        if (bracket) *bracket = '\0';
+        const char* key = name;
+        if (block >= 0) {
+            const char* dot = strrchr(name, '.');
+            if (dot) key = dot + 1;
+        }
+
+        const GLUniform uniform = {
+            .hash          = gl_uniform_hash(key),
+            .location      = block >= 0 ? -1 : glGetUniformLocation(program, name),
+            .type          = type,
+            .offset        = (uint16_t)offset,
+            .array_size    = (uint16_t)array_size,
+            .array_stride  = (uint16_t)array_stride,
+            .matrix_stride = (uint16_t)matrix_stride,
+            .in_block      = block >= 0,
+        };
+
+        if (!table_insert(table, &uniform, &used))
+            fprintf(stderr, "Uniform '%s' not cached (table full or hash collision)\n", key);
+    }
+}
+
+int gl_uniform_table_find(const GLUniformTable* table, const char* name)
+{
+    return gl_uniform_table_find_hash(table, gl_uniform_hash(name));
+}
+
+int gl_uniform_table_find_hash(const GLUniformTable* table, uint32_t hash)
+{
+    uint32_t i = hash & (GL_UNIFORM_TABLE_SLOTS - 1);
+    while (table->slots[i].hash != 0) {
+        if (table->slots[i].hash == hash) return (int)i;
+        i = (i + 1) & (GL_UNIFORM_TABLE_SLOTS - 1);
+    }
+    return -1;
+}
+
+bool gl_uniform_write_std140(const GLUniform* uniform, uint8_t* block, const float* vals, int count)
+{
+    int rows, cols;
+    if (!type_shape(uniform->type, &rows, &cols)) return false;
+
+    const int components = rows * cols;
+    const int total = components * uniform->array_size;
+    if (count > total) count = total;
+
+    for (int f = 0; f < count; ++f) {
+        const int element = f / components;
+        const int c = f % components;
+        const size_t dst = uniform->offset
+            + (size_t)element * uniform->array_stride
+            + (size_t)(c / rows) * uniform->matrix_stride
+            + (size_t)(c % rows) * sizeof(float);
+        memcpy(block + dst, &vals[f], sizeof(float));
+    }
+    return true;
+}
+
+void gl_uniform_apply(const GLUniform* uniform, const float* vals, int count)
+{
+    int rows, cols;
+    if (!type_shape(uniform->type, &rows, &cols)) return;
+
+    GLsizei elements = (GLsizei)(count / (rows * cols));
+    if (elements > uniform->array_size) elements = uniform->array_size;
+    if (elements == 0) return;
+
+    switch (uniform->type) {
+        case GL_FLOAT:      glUniform1fv(uniform->location, elements, vals); break;
+        case GL_FLOAT_VEC2: glUniform2fv(uniform->location, elements, vals); break;
+        case GL_FLOAT_VEC3: glUniform3fv(uniform->location, elements, vals); break;
+        case GL_FLOAT_VEC4: glUniform4fv(uniform->location, elements, vals); break;
+        case GL_FLOAT_MAT2: glUniformMatrix2fv(uniform->location, elements, GL_FALSE, vals); break;
+        case GL_FLOAT_MAT3: glUniformMatrix3fv(uniform->location, elements, GL_FALSE, vals); break;
+        case GL_FLOAT_MAT4: glUniformMatrix4fv(uniform->location, elements, GL_FALSE, vals); break;
+        default: break;
+    }
+}
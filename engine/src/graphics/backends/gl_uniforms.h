@@ -0,0 +1,70 @@
+//
+// Created by Cain Martin on 2025/08/24.
+//
+
+#ifndef GL_UNIFORMS_H
+#define GL_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Uniform blocks the engine fills. Shaders opt in by declaring them:
+//   layout(std140) uniform FrameData    { mat4 u_view; mat4 u_projection; mat4 u_inverse_projection; vec4 u_view_position; };
+//   layout(std140) uniform MaterialData { ...per material parameters... };
+#define GL_FRAME_BLOCK_NAME       "FrameData"
+#define GL_MATERIAL_BLOCK_NAME    "MaterialData"
+#define GL_FRAME_BLOCK_BINDING    0
+#define GL_MATERIAL_BLOCK_BINDING 1
+#define GL_MATERIAL_BLOCK_MAX_SIZE 256
+
+#define GL_UNIFORM_TABLE_SLOTS 64 // Power of two, kept at most 3/4 full
+#define GL_UNIFORM_MAX_FLOATS  16 // Largest value a loose uniform can stage (one mat4)
+
+// std140 layout of FrameData
+typedef struct GLFrameBlock
+{
+    float view[16];
+    float projection[16];
+    float inverse_projection[16];
+    float view_position[4];
+} GLFrameBlock;
+
+typedef struct GLUniform
+{
+    uint32_t hash;          // FNV-1a of the name, 0 marks an empty slot
+    GLint    location;      // Loose uniforms only, -1 for block members
+    GLenum   type;
+    uint16_t offset;        // Block members: byte offset into MaterialData
+    uint16_t array_size;
+    uint16_t array_stride;
+    uint16_t matrix_stride;
+    uint8_t  in_block;
+} GLUniform;
+
+// Name -> uniform table for one program, built once at link time from glGetActiveUniform.
+// Lookups hash the name and probe the table; no GL call is made per lookup.
+typedef struct GLUniformTable
+{
+    GLUniform slots[GL_UNIFORM_TABLE_SLOTS];
+    uint16_t  block_size; // Size of MaterialData, 0 when the program has none
+    uint8_t   has_frame_block;
+} GLUniformTable;
+
+uint32_t gl_uniform_hash(const char* name);
+
+// Reflects the linked program into the table and assigns the engine block bindings
+void gl_uniform_table_build(GLUniformTable* table, GLuint program);
+
+// Returns the slot index for name, or -1
+int gl_uniform_table_find(const GLUniformTable* table, const char* name);
+int gl_uniform_table_find_hash(const GLUniformTable* table, uint32_t hash); // hash from gl_uniform_hash
+
+// Writes up to count floats for a block member into a std140 block, honouring the
+// array and matrix strides. Returns false for non-float uniforms.
+bool gl_uniform_write_std140(const GLUniform* uniform, uint8_t* block, const float* vals, int count);
+
+// Uploads a loose (non-block) float uniform on the currently used program
+void gl_uniform_apply(const GLUniform* uniform, const float* vals, int count);
+
+#endif //GL_UNIFORMS_H
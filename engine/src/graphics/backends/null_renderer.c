@@ -0,0 +1,594 @@
+//
+// Created by Cain Martin on 2025/08/25.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../core/arena.h"
+#include "../../core/d_array.h"
+#include "../../core/memory.h"
+#include "../../core/handle_pool.h"
+#include "../../core/profiler.h"
+#include "../draw_queue.h"
+#include "../mesh_lod.h"
+#include "../renderer.h"
+#include "../texture_format.h"
+#include "../vertex_format.h"
+
+// Headless renderer. Resources get real handles and the full queue -> sort -> batch path
+// runs, but instead of reaching a driver every call is appended to a command log. Used to
+// benchmark and regression test the CPU side of a frame on machines without a GPU.
+
+#define NULL_LOG_MIN_CAPACITY 4096
+
+typedef struct NullRenderer
+{
+    FrameArena*       frame_arena;
+
+    HandlePool        meshes;
+    uint32_t*         mesh_index_count;
+    uint32_t*         mesh_vertex_count;
+    uint8_t*          mesh_vertex_stride;
+    uint64_t          mesh_bytes;
+    uint64_t          mesh_bytes_full;
+
+    HandlePool        shaders;
+    uint8_t*          shader_instanced;
+
+    HandlePool        textures;
+    uint64_t*         texture_size;      // Bytes as stored, and as RGBA8, including mips
+    uint64_t*         texture_size_full;
+    uint64_t          texture_bytes;
+    uint64_t          texture_bytes_full;
+
+    HandlePool        materials;
+    R_Handle*         material_shader;
+    R_Handle          (*material_textures)[R_MAX_MATERIAL_TEXTURES];
+    uint8_t*          material_texture_count;
+    uint8_t*          material_blend;
+    uint8_t*          material_no_instancing;
+
+    DrawQueue         queue;
+    DArray            transients; // NullTransientDraw, from the frame arena
+    EngineCamera      camera;
+
+    // Commands are appended to log and handed over to last_log at end_frame, so resource
+    // calls made between frames show up in the next frame's log
+    DArray            log;
+    DArray            last_log;
+
+    EngineRenderStats frame_stats;
+    EngineRenderStats stats;
+} NullRenderer;
+
+typedef struct NullTransientDraw
+{
+    R_Handle material;
+    uint32_t vertex_count;
+    uint32_t index_count;
+} NullTransientDraw;
+
+static void record(NullRenderer* r, EngineCommandOp op, uint32_t a, uint32_t b, uint32_t c)
+{
+    // Grows during the first frames only - the buffers are reused afterwards
+    EngineCommand* cmd = d_array_push(&r->log);
+    if (!cmd) return;
+    cmd->op = (uint32_t)op;
+    cmd->args[0] = a;
+    cmd->args[1] = b;
+    cmd->args[2] = c;
+}
+
+static void null_destroy(Renderer* renderer)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    if (!r) return;
+
+    handle_pool_shutdown(&r->meshes);
+    handle_pool_shutdown(&r->shaders);
+    handle_pool_shutdown(&r->textures);
+    handle_pool_shutdown(&r->materials);
+    mem_free(r->mesh_index_count);
+    mem_free(r->mesh_vertex_count);
+    mem_free(r->mesh_vertex_stride);
+    mem_free(r->shader_instanced);
+    mem_free(r->texture_size);
+    mem_free(r->texture_size_full);
+    mem_free(r->material_shader);
+    mem_free(r->material_textures);
+    mem_free(r->material_texture_count);
+    mem_free(r->material_blend);
+    mem_free(r->material_no_instancing);
+    d_array_free(&r->log);
+    d_array_free(&r->last_log);
+    mem_free(r);
+}
+
+static Renderer* null_create(RendererCreateInfo* create_info)
+{
+    NullRenderer* r = mem_calloc(1, sizeof(*r));
+    if (!r) return NULL;
+
+    r->frame_arena = create_info->frame_arena;
+
+    bool ok = handle_pool_init(&r->meshes, R_MAX_MESHES)
+        && handle_pool_init(&r->shaders, R_MAX_SHADERS)
+        && handle_pool_init(&r->textures, R_MAX_TEXTURES)
+        && handle_pool_init(&r->materials, R_MAX_MATERIALS);
+
+    r->mesh_index_count       = mem_calloc(R_MAX_MESHES, sizeof(uint32_t));
+    r->mesh_vertex_count      = mem_calloc(R_MAX_MESHES, sizeof(uint32_t));
+    r->mesh_vertex_stride     = mem_calloc(R_MAX_MESHES, sizeof(uint8_t));
+    r->shader_instanced       = mem_calloc(R_MAX_SHADERS, sizeof(uint8_t));
+    r->texture_size           = mem_calloc(R_MAX_TEXTURES, sizeof(uint64_t));
+    r->texture_size_full      = mem_calloc(R_MAX_TEXTURES, sizeof(uint64_t));
+    r->material_shader        = mem_calloc(R_MAX_MATERIALS, sizeof(R_Handle));
+    r->material_textures      = mem_calloc(R_MAX_MATERIALS, sizeof(*r->material_textures));
+    r->material_texture_count = mem_calloc(R_MAX_MATERIALS, sizeof(uint8_t));
+    r->material_blend         = mem_calloc(R_MAX_MATERIALS, sizeof(uint8_t));
+    r->material_no_instancing = mem_calloc(R_MAX_MATERIALS, sizeof(uint8_t));
+
+    ok = ok && r->mesh_index_count && r->mesh_vertex_count && r->mesh_vertex_stride && r->shader_instanced && r->material_shader
+        && r->texture_size && r->texture_size_full
+        && r->material_textures && r->material_texture_count && r->material_blend
+        && r->material_no_instancing
+        && d_array_init(&r->log, sizeof(EngineCommand), 0, NULL)
+        && d_array_init(&r->last_log, sizeof(EngineCommand), 0, NULL)
+        && d_array_reserve(&r->log, NULL_LOG_MIN_CAPACITY)
+        && d_array_reserve(&r->last_log, NULL_LOG_MIN_CAPACITY);
+    if (!ok) {
+        null_destroy((Renderer*)r);
+        return NULL;
+    }
+
+    return (Renderer*)r;
+}
+
+static void null_begin(Renderer* renderer, int fb_w, int fb_h)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    memset(&r->frame_stats, 0, sizeof r->frame_stats);
+    draw_queue_begin(&r->queue, frame_arena_current(r->frame_arena));
+    d_array_init(&r->transients, sizeof(NullTransientDraw), 0, frame_arena_current(r->frame_arena));
+    record(r, ENGINE_CMD_BEGIN_FRAME, (uint32_t)fb_w, (uint32_t)fb_h, 0);
+}
+
+static bool resolve_draw(void* backend, const DrawItem* item, DrawResolved* out)
+{
+    const NullRenderer* r = backend;
+
+    out->material = handle_pool_lookup(&r->materials, item->material);
+    out->mesh = handle_pool_lookup(&r->meshes, item->mesh);
+    if (out->material == HANDLE_POOL_INVALID || out->mesh == HANDLE_POOL_INVALID) return false;
+
+    out->shader_handle = r->material_shader[out->material];
+    out->shader = handle_pool_lookup(&r->shaders, out->shader_handle);
+    if (out->shader == HANDLE_POOL_INVALID) return false;
+
+    out->instanced = r->shader_instanced[out->shader] != 0;
+    out->no_instancing = r->material_no_instancing[out->material] != 0;
+    return true;
+}
+
+static void null_end(Renderer* renderer)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    EngineRenderStats* stats = &r->frame_stats;
+    DrawQueue* q = &r->queue;
+
+    DrawBatches b;
+    PROFILE_BEGIN("draw_sort");
+    const bool built = draw_queue_build_runs(q, resolve_draw, r, NULL, &b);
+    PROFILE_END();
+    if (!built) {
+        stats->draws_rejected += stats->draws_submitted;
+        stats->draws_submitted = 0;
+        b.run_count = 0;
+    } else {
+        stats->draws_rejected += b.rejected;
+        stats->draws_submitted -= b.rejected;
+        stats->batches = b.batches;
+    }
+
+    // Same bind elision as the GPU backends, recorded instead of issued
+    uint32_t bound_shader = HANDLE_POOL_INVALID, bound_material = HANDLE_POOL_INVALID, bound_mesh = HANDLE_POOL_INVALID;
+    for (uint32_t i = 0; i < b.run_count; ++i) {
+        const DrawRun* run = &b.runs[i];
+        const DrawItem* item = &q->items[run->item];
+
+        if (run->shader != bound_shader) {
+            record(r, ENGINE_CMD_BIND_SHADER, handle_pool_handle_at(&r->shaders, run->shader), 0, 0);
+            bound_shader = run->shader;
+            stats->state_changes++;
+        }
+        if (run->material != bound_material) {
+            record(r, ENGINE_CMD_BIND_MATERIAL, item->material, 0, 0);
+            bound_material = run->material;
+            stats->state_changes++;
+        }
+        if (run->mesh != bound_mesh) {
+            record(r, ENGINE_CMD_BIND_MESH, item->mesh, 0, 0);
+            bound_mesh = run->mesh;
+            stats->state_changes++;
+        }
+
+        record(r, ENGINE_CMD_DRAW, item->mesh, item->material, run->count);
+        if (run->instanced && run->count > 1) stats->draws_instanced += run->count;
+        stats->draw_calls++;
+    }
+
+    // Transient meshes follow in submission order, all from one vertex array
+    bool transient_bound = false;
+    for (uint32_t i = 0; i < r->transients.count; ++i) {
+        const NullTransientDraw* t = d_array_at(&r->transients, i);
+        const uint32_t mat = handle_pool_lookup(&r->materials, t->material);
+        const uint32_t sh = mat != HANDLE_POOL_INVALID ? handle_pool_lookup(&r->shaders, r->material_shader[mat]) : HANDLE_POOL_INVALID;
+        if (sh == HANDLE_POOL_INVALID) {
+            stats->draws_rejected++;
+            stats->draws_submitted--;
+            continue;
+        }
+
+        if (sh != bound_shader) {
+            record(r, ENGINE_CMD_BIND_SHADER, r->material_shader[mat], 0, 0);
+            bound_shader = sh;
+            stats->state_changes++;
+        }
+        if (mat != bound_material) {
+            record(r, ENGINE_CMD_BIND_MATERIAL, t->material, 0, 0);
+            bound_material = mat;
+            stats->state_changes++;
+        }
+        if (!transient_bound) {
+            transient_bound = true;
+            stats->state_changes++;
+        }
+
+        record(r, ENGINE_CMD_DRAW_TRANSIENT, t->material, t->vertex_count, t->index_count);
+        stats->draw_calls++;
+    }
+
+    stats->state_changes_skipped = stats->draws_submitted * 3 - stats->state_changes;
+    stats->draws_rejected += q->dropped;
+    record(r, ENGINE_CMD_END_FRAME, 0, 0, 0);
+
+    stats->mesh_bytes = r->mesh_bytes;
+    stats->mesh_bytes_full = r->mesh_bytes_full;
+    stats->texture_bytes = r->texture_bytes;
+    stats->texture_bytes_full = r->texture_bytes_full;
+    r->stats = r->frame_stats;
+}
+
+static void null_present(Renderer* renderer)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    record(r, ENGINE_CMD_PRESENT, 0, 0, 0);
+
+    // Hand the frame's log over and start the next one in the old buffer, grown to match so
+    // the second frame does not size it again - with a render thread that frame lands late
+    const DArray log = r->last_log;
+    r->last_log = r->log;
+    r->log = log;
+    d_array_clear(&r->log);
+    d_array_reserve(&r->log, r->last_log.capacity);
+}
+
+static void null_clear(Renderer* renderer, float red, float green, float blue, float alpha)
+{
+    const float c[4] = { red, green, blue, alpha };
+    uint32_t packed = 0;
+    for (int i = 0; i < 4; ++i) {
+        const float v = c[i] < 0.0f ? 0.0f : c[i] > 1.0f ? 1.0f : c[i];
+        packed |= (uint32_t)(v * 255.0f + 0.5f) << (i * 8);
+    }
+    record((NullRenderer*)renderer, ENGINE_CMD_CLEAR, packed, 0, 0);
+}
+
+// Resources
+
+static R_Handle null_mesh_create(Renderer* renderer, const EngineMeshDesc* desc)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    if ((!desc->vertices && !desc->packed_vertices) || desc->vertex_count == 0 || !desc->indices || desc->indices_count == 0)
+        return 0;
+
+    VertexFormat format;
+    if (!vertex_format_get(&desc->layout, &format)) return 0;
+
+    uint32_t i;
+    const R_Handle handle = handle_pool_alloc(&r->meshes, &i);
+    if (!handle) return 0;
+    // Every level of the LOD chain shares the index buffer a real backend would fill
+    MeshLodRanges lods;
+    r->mesh_index_count[i] = mesh_lod_ranges(desc, &lods);
+    r->mesh_vertex_count[i] = desc->vertex_count;
+    r->mesh_vertex_stride[i] = (uint8_t)format.stride;
+
+    const uint64_t indices = r->mesh_index_count[i];
+    r->mesh_bytes += (uint64_t)desc->vertex_count * format.stride + indices * r_index_size(desc->vertex_count);
+    r->mesh_bytes_full += (uint64_t)desc->vertex_count * sizeof(EngineVertex) + indices * sizeof(uint32_t);
+
+    record(r, ENGINE_CMD_CREATE_MESH, handle, desc->vertex_count, desc->indices_count);
+    return handle;
+}
+
+static void null_mesh_destroy(Renderer* renderer, R_Handle handle)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    uint32_t dst, src;
+    if (!handle_pool_release(&r->meshes, handle, &dst, &src)) {
+        fprintf(stderr, "mesh_destroy: stale or invalid handle 0x%08x\n", handle);
+        return;
+    }
+
+    // dst still holds the destroyed mesh until the move below
+    const uint64_t vertices = r->mesh_vertex_count[dst], indices = r->mesh_index_count[dst];
+    r->mesh_bytes -= vertices * r->mesh_vertex_stride[dst] + indices * r_index_size((uint32_t)vertices);
+    r->mesh_bytes_full -= vertices * sizeof(EngineVertex) + indices * sizeof(uint32_t);
+
+    r->mesh_index_count[dst] = r->mesh_index_count[src];
+    r->mesh_vertex_count[dst] = r->mesh_vertex_count[src];
+    r->mesh_vertex_stride[dst] = r->mesh_vertex_stride[src];
+    record(r, ENGINE_CMD_DESTROY_MESH, handle, 0, 0);
+}
+
+static R_Handle null_shader_create(Renderer* renderer, const char* vs_src, const char* fs_src)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    (void)fs_src;
+
+    uint32_t i;
+    const R_Handle handle = handle_pool_alloc(&r->shaders, &i);
+    if (!handle) return 0;
+
+    // No reflection without a compiler - mirror the GL backend's rule from the source
+    r->shader_instanced[i] = strstr(vs_src, "a_instance_model") != NULL;
+
+    record(r, ENGINE_CMD_CREATE_SHADER, handle, 0, 0);
+    return handle;
+}
+
+static void null_shader_destroy(Renderer* renderer, R_Handle handle)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    uint32_t dst, src;
+    if (!handle_pool_release(&r->shaders, handle, &dst, &src)) {
+        fprintf(stderr, "shader_destroy: stale or invalid handle 0x%08x\n", handle);
+        return;
+    }
+    r->shader_instanced[dst] = r->shader_instanced[src];
+    record(r, ENGINE_CMD_DESTROY_SHADER, handle, 0, 0);
+}
+
+static EngineShaderStatus null_shader_status(Renderer* renderer, R_Handle handle)
+{
+    const NullRenderer* r = (const NullRenderer*)renderer;
+    return handle_pool_is_valid(&r->shaders, handle) ? ENGINE_SHADER_READY : ENGINE_SHADER_INVALID;
+}
+
+static R_Handle null_texture_create(Renderer* renderer, const EngineTextureDesc* desc)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    uint32_t mip_count;
+    bool generate;
+    if (!texture_desc_validate(desc, &mip_count, &generate)) return 0;
+
+    uint32_t i;
+    const R_Handle handle = handle_pool_alloc(&r->textures, &i);
+    if (!handle) return 0;
+
+    const uint32_t width = (uint32_t)desc->width, height = (uint32_t)desc->height;
+    r->texture_size[i] = texture_chain_size(desc->format, width, height, 0, mip_count);
+    r->texture_size_full[i] = texture_chain_size(ENGINE_TEXTURE_RGBA8, width, height, 0, mip_count);
+    r->texture_bytes += r->texture_size[i];
+    r->texture_bytes_full += r->texture_size_full[i];
+
+    record(r, ENGINE_CMD_CREATE_TEXTURE, handle, (uint32_t)desc->width, (uint32_t)desc->height);
+    return handle;
+}
+
+static void null_texture_destroy(Renderer* renderer, R_Handle handle)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    uint32_t dst, src;
+    if (!handle_pool_release(&r->textures, handle, &dst, &src)) {
+        fprintf(stderr, "texture_destroy: stale or invalid handle 0x%08x\n", handle);
+        return;
+    }
+    r->texture_bytes -= r->texture_size[dst];
+    r->texture_bytes_full -= r->texture_size_full[dst];
+    r->texture_size[dst] = r->texture_size[src];
+    r->texture_size_full[dst] = r->texture_size_full[src];
+    record(r, ENGINE_CMD_DESTROY_TEXTURE, handle, 0, 0);
+}
+
+// Nothing to upload to, so every format is accepted
+static bool null_texture_format_supported(Renderer* renderer, EngineTextureFormat format)
+{
+    (void)renderer;
+    return (unsigned)format < ENGINE_TEXTURE_FORMAT_COUNT;
+}
+
+static R_Handle null_material_create(Renderer* renderer, const EngineMaterialDesc* desc)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+
+    if (!handle_pool_is_valid(&r->shaders, desc->shader)) return 0;
+    if (desc->texture_count < 0 || desc->texture_count > R_MAX_MATERIAL_TEXTURES) return 0;
+    for (int t = 0; t < desc->texture_count; ++t)
+        if (!handle_pool_is_valid(&r->textures, desc->texture[t])) return 0;
+
+    uint32_t i;
+    const R_Handle handle = handle_pool_alloc(&r->materials, &i);
+    if (!handle) return 0;
+
+    r->material_shader[i] = desc->shader;
+    for (int t = 0; t < R_MAX_MATERIAL_TEXTURES; ++t)
+        r->material_textures[i][t] = t < desc->texture_count ? desc->texture[t] : 0;
+    r->material_texture_count[i] = (uint8_t)desc->texture_count;
+    r->material_blend[i]         = desc->blend ? 1 : 0;
+    r->material_no_instancing[i] = desc->no_instancing ? 1 : 0;
+
+    record(r, ENGINE_CMD_CREATE_MATERIAL, handle, desc->shader, 0);
+    return handle;
+}
+
+static void null_material_destroy(Renderer* renderer, R_Handle handle)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    uint32_t dst, src;
+    if (!handle_pool_release(&r->materials, handle, &dst, &src)) {
+        fprintf(stderr, "material_destroy: stale or invalid handle 0x%08x\n", handle);
+        return;
+    }
+    r->material_shader[dst] = r->material_shader[src];
+    memcpy(r->material_textures[dst], r->material_textures[src], sizeof r->material_textures[dst]);
+    r->material_texture_count[dst] = r->material_texture_count[src];
+    r->material_blend[dst]         = r->material_blend[src];
+    r->material_no_instancing[dst] = r->material_no_instancing[src];
+    record(r, ENGINE_CMD_DESTROY_MATERIAL, handle, 0, 0);
+}
+
+// State
+static void null_set_camera(Renderer* renderer, const EngineCamera* camera)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    r->camera = *camera;
+    record(r, ENGINE_CMD_SET_CAMERA, 0, 0, 0);
+}
+
+static bool null_draw_key(Renderer* renderer, R_Handle mesh, R_Handle material, const float model[16], uint64_t* out_key)
+{
+    const NullRenderer* r = (const NullRenderer*)renderer;
+    const uint32_t mat = handle_pool_lookup(&r->materials, material);
+    if (mat == HANDLE_POOL_INVALID || !handle_pool_is_valid(&r->meshes, mesh)) return false;
+
+    *out_key = draw_key_make(
+        r->material_blend[mat] != 0,
+        handle_index(r->material_shader[mat]),
+        draw_key_texture_hash(r->material_textures[mat], r->material_texture_count[mat]),
+        handle_index(material),
+        handle_index(mesh),
+        draw_key_view_depth(r->camera.view, model));
+    return true;
+}
+
+static void null_draw(Renderer* renderer, R_Handle mesh, R_Handle material, const float model[16], uint32_t lod)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    uint64_t key;
+    if (!null_draw_key(renderer, mesh, material, model, &key)) {
+        r->frame_stats.draws_rejected++;
+        return;
+    }
+    if (draw_queue_push(&r->queue, key, mesh, material, model, lod)) {
+        r->frame_stats.draws_submitted++;
+        record(r, ENGINE_CMD_SUBMIT, mesh, material, 0);
+    }
+}
+
+// Bucketed draws are logged when they are merged, in bucket order
+static void null_merge_draws(Renderer* renderer, DrawBucket* bucket)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    const uint32_t first = r->queue.count;
+    const uint32_t merged = draw_queue_merge(&r->queue, bucket);
+    for (uint32_t i = first; i < first + merged; ++i)
+        record(r, ENGINE_CMD_SUBMIT, r->queue.items[i].mesh, r->queue.items[i].material, 0);
+    r->frame_stats.draws_submitted += merged;
+    r->frame_stats.draws_bucketed += merged;
+    r->frame_stats.draws_rejected += bucket->rejected;
+    bucket->rejected = 0;
+}
+
+static bool null_transient_alloc(Renderer* renderer, uint32_t vertex_count, uint32_t index_count, EngineTransientMesh* out)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    Arena* arena = frame_arena_current(r->frame_arena);
+
+    out->vertices = arena_alloc(arena, (size_t)vertex_count * sizeof(EngineVertex), 16);
+    out->indices = arena_alloc(arena, (size_t)index_count * sizeof(uint32_t), 4);
+    if (!out->vertices || !out->indices) return false;
+
+    out->vertex_count = vertex_count;
+    out->index_count = index_count;
+    out->vertex_offset = 0;
+    out->index_offset = 0;
+    r->frame_stats.stream_bytes += vertex_count * (uint32_t)sizeof(EngineVertex) + index_count * (uint32_t)sizeof(uint32_t);
+    return true;
+}
+
+static void null_draw_transient(Renderer* renderer, const EngineTransientMesh* mesh, R_Handle material, const float model[16])
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    (void)model;
+
+    NullTransientDraw* t = handle_pool_is_valid(&r->materials, material) ? d_array_push(&r->transients) : NULL;
+    if (!t) {
+        r->frame_stats.draws_rejected++;
+        return;
+    }
+    t->material = material;
+    t->vertex_count = mesh->vertex_count;
+    t->index_count = mesh->index_count;
+    r->frame_stats.draws_submitted++;
+}
+
+static void null_get_stats(Renderer* renderer, EngineRenderStats* out_stats)
+{
+    *out_stats = ((NullRenderer*)renderer)->stats;
+}
+
+static uint32_t null_get_command_log(Renderer* renderer, const EngineCommand** out_commands)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    *out_commands = D_ARRAY_DATA(&r->last_log, EngineCommand);
+    return r->last_log.count;
+}
+
+static void null_material_set_uniform_f(Renderer* renderer, R_Handle mat, const char* name, const float* val, int count)
+{
+    NullRenderer* r = (NullRenderer*)renderer;
+    (void)val;
+    if (!handle_pool_is_valid(&r->materials, mat)) return;
+
+    // FNV-1a, so logs can be compared without storing names
+    uint32_t h = 2166136261u;
+    for (const char* c = name; *c; ++c) {
+        h ^= (uint8_t)*c;
+        h *= 16777619u;
+    }
+    record(r, ENGINE_CMD_SET_UNIFORM, mat, h, (uint32_t)count);
+}
+
+static const RendererAPI api = {
+    .create = null_create,
+    .destroy = null_destroy,
+    .begin_frame = null_begin,
+    .end_frame = null_end,
+    .clear = null_clear,
+    .present = null_present,
+    // Resources
+    .mesh_create = null_mesh_create,
+    .mesh_destroy = null_mesh_destroy,
+    .shader_create = null_shader_create,
+    .shader_status = null_shader_status,
+    .shader_destroy = null_shader_destroy,
+    .texture_create = null_texture_create,
+    .texture_destroy = null_texture_destroy,
+    .texture_format_supported = null_texture_format_supported,
+    .material_create = null_material_create,
+    .material_destroy = null_material_destroy,
+    .set_camera = null_set_camera,
+    .draw = null_draw,
+    .draw_key = null_draw_key,
+    .merge_draws = null_merge_draws,
+    .get_stats = null_get_stats,
+    .transient_alloc = null_transient_alloc,
+    .draw_transient = null_draw_transient,
+    .get_command_log = null_get_command_log,
+    .material_set_uniform_f = null_material_set_uniform_f,
+};
+
+const RendererAPI* get_null_renderer_api(void) { return &api; }
@@ -3,58 +3,778 @@
 //
 
 #include <glad/glad.h>
+#include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
-#include <sys/proc.h>
+#include <string.h>
+#include "../../core/arena.h"
+#include "../../core/d_array.h"
+#include "../../core/memory.h"
+#include "../../core/pool.h"
+#include "../../core/profiler.h"
+#include "../../core/handle_pool.h"
+#include "../../core/job_system.h"
+#include "../../platform/clock.h"
 #include "../../platform/platform.h"
+#include "../draw_queue.h"
+#include "../mesh_lod.h"
 #include "../renderer.h"
+#include "../texture_format.h"
+#include "../vertex_format.h"
+#include "gl_program_cache.h"
+#include "gl_state.h"
+#include "gl_stream.h"
+#include "gl_timer.h"
+#include "gl_uniforms.h"
+
+// Shaders that declare "in mat4 a_instance_model" get it bound to locations 4..7 and are
+// drawn instanced; anything else gets u_model per draw.
+#define GL_INSTANCE_ATTRIB 4
+#define GL_INSTANCE_MIN_CAPACITY 1024
+
+#define GL_MAX_LOOSE_UNIFORMS 4
+
+// The placeholder program takes a shader slot past the R_MAX_SHADERS left for the user
+#define GL_SHADER_SLOTS (R_MAX_SHADERS + 1)
+
+// Value of a uniform outside MaterialData, applied with glUniform* when the material binds
+typedef struct GLLooseUniform
+{
+    uint8_t slot;  // Index into the shader's uniform table
+    uint8_t count;
+    float   vals[GL_UNIFORM_MAX_FLOATS];
+} GLLooseUniform;
+
+// Uniform set on a material while its shader compiles, staged once the program's layout is known
+typedef struct GLDeferredUniform
+{
+    R_Handle material;
+    uint32_t hash;  // gl_uniform_hash of the name
+    uint8_t  count;
+    float    vals[GL_UNIFORM_MAX_FLOATS];
+} GLDeferredUniform;
+
+// A transient mesh draw, replayed from the stream after the sorted queue
+typedef struct GLTransientDraw
+{
+    float    model[16];
+    R_Handle material;
+    uint32_t mat;          // Material table index, resolved at flush
+    GLint    base_vertex;
+    GLintptr index_offset;
+    GLsizei  index_count;
+    GLintptr model_offset; // a_instance_model in the stream, for instanced shaders
+} GLTransientDraw;
+
+// Resource tables are structure-of-arrays indexed by the handle pool's dense index, so
+// every live resource of a kind sits in [0, pool.count) and can be walked linearly.
+typedef struct GLMeshTable
+{
+    HandlePool     pool;
+    GLuint*        vao;
+    GLuint*        vbo;
+    GLuint*        ibo;
+    GLsizei*       index_count; // Every level of the LOD chain
+    GLenum*        index_type;
+    MeshLodRanges* lods;
+    uint32_t*      vertex_count;
+    uint8_t*       vertex_stride;
+} GLMeshTable;
+
+// New shaders link in the background and draw with the placeholder program until ready.
+// Failed ones keep their handle, but their draws are dropped.
+typedef enum {
+    GL_SHADER_READY = 0,
+    GL_SHADER_COMPILING,
+    GL_SHADER_FAILED,
+} GLShaderStatus;
+
+typedef struct GLShaderTable
+{
+    HandlePool pool;
+    GLuint*    program;
+    GLint*     loc_model;      // u_model
+    GLint*     loc_view;       // u_view
+    GLint*     loc_projection; // u_projection
+    uint8_t*   instanced;      // Declares a_instance_model, so draws can be instanced
+    GLUniformTable** uniforms;     // Records live in uniform_pool, so swap-remove moves a pointer
+    Pool       uniform_pool;
+    uint8_t*   status;         // GLShaderStatus
+    GLuint     (*stages)[2];   // Vertex and fragment shader objects while compiling
+    uint64_t*  cache_key;      // Program cache key, to store the binary once linked
+} GLShaderTable;
+
+typedef struct GLTextureTable
+{
+    HandlePool pool;
+    GLuint*    texture;
+    uint64_t*  size;       // Bytes as stored, and as RGBA8, including mips
+    uint64_t*  size_full;
+} GLTextureTable;
+
+typedef struct GLMaterialTable
+{
+    HandlePool pool;
+    R_Handle*  shader;
+    R_Handle   (*textures)[R_MAX_MATERIAL_TEXTURES];
+    uint8_t*   texture_count;
+    uint8_t*   depth_test;
+    uint8_t*   depth_write;
+    uint8_t*   blend;
+    uint8_t*   no_instancing;
+
+    // Staged MaterialData contents, copied into the frame's uniform buffer when drawn
+    uint8_t    (*block)[GL_MATERIAL_BLOCK_MAX_SIZE];
+    uint16_t*  block_size;
+    uint32_t*  block_frame;  // Frame the block was last copied in
+    uint32_t*  block_offset; // Its offset in that frame's uniform buffer
+    GLLooseUniform (*loose)[GL_MAX_LOOSE_UNIFORMS];
+    uint8_t*   loose_count;
+} GLMaterialTable;
 
 typedef struct GLRenderer
 {
     const PlatformAPI* plat;
     Platform*          platform;
     int                w,h;
+    GLStateCache       state;
+    GLTimer            timer;
+
+    GLMeshTable        meshes;
+    GLShaderTable      shaders;
+    GLTextureTable     textures;
+    GLMaterialTable    materials;
+
+    FrameArena*        frame_arena;
+    JobSystem*         jobs;              // Vertex encoding at mesh create
+    DrawQueue          queue;
+    DArray             transients;        // GLTransientDraw, from the frame arena
+    GLStream           stream;            // Instances, uniforms and transient meshes, written in place
+    bool               streaming;
+    GLuint             transient_vao;     // Sources vertices and indices from the stream
+    GLuint             instance_vbo;      // Fallback when the stream is full, orphaned per frame
+    uint32_t           instance_capacity; // In matrices
+    GLuint             ubo;               // Fallback for FrameData + MaterialData, orphaned per frame
+    GLsizeiptr         ubo_capacity;
+    GLint              ubo_align;
+    GLuint             frame_ubo;         // Where this frame's uniform blocks landed
+    GLintptr           frame_ubo_base;
+    uint32_t           frame_index;
+    EngineCamera       camera;
+    uint64_t           mesh_bytes;
+    uint64_t           mesh_bytes_full;
+    uint64_t           texture_bytes;
+    uint64_t           texture_bytes_full;
+    GLProgramCache     program_cache;
+    uint64_t           shader_create_ticks;
+    bool               parallel_compile;  // Link completion can be polled (KHR/ARB_parallel_shader_compile)
+    uint32_t           shaders_pending;
+    R_Handle           placeholder;       // Drawn in place of shaders still compiling
+    DArray             deferred_uniforms; // GLDeferredUniform, heap
+    EngineRenderStats  frame_stats; // Being accumulated
+    EngineRenderStats  stats;       // Last completed frame
 } GLRenderer;
 
+static bool gl_tables_init(GLRenderer* r)
+{
+    if (!handle_pool_init(&r->meshes.pool, R_MAX_MESHES)) return false;
+    r->meshes.vao         = mem_calloc(R_MAX_MESHES, sizeof(GLuint));
+    r->meshes.vbo         = mem_calloc(R_MAX_MESHES, sizeof(GLuint));
+    r->meshes.ibo         = mem_calloc(R_MAX_MESHES, sizeof(GLuint));
+    r->meshes.index_count = mem_calloc(R_MAX_MESHES, sizeof(GLsizei));
+    r->meshes.index_type    = mem_calloc(R_MAX_MESHES, sizeof(GLenum));
+    r->meshes.lods          = mem_calloc(R_MAX_MESHES, sizeof(MeshLodRanges));
+    r->meshes.vertex_count  = mem_calloc(R_MAX_MESHES, sizeof(uint32_t));
+    r->meshes.vertex_stride = mem_calloc(R_MAX_MESHES, sizeof(uint8_t));
+
+    if (!handle_pool_init(&r->shaders.pool, GL_SHADER_SLOTS)) return false;
+    r->shaders.program        = mem_calloc(GL_SHADER_SLOTS, sizeof(GLuint));
+    r->shaders.loc_model      = mem_calloc(GL_SHADER_SLOTS, sizeof(GLint));
+    r->shaders.loc_view       = mem_calloc(GL_SHADER_SLOTS, sizeof(GLint));
+    r->shaders.loc_projection = mem_calloc(GL_SHADER_SLOTS, sizeof(GLint));
+    r->shaders.instanced      = mem_calloc(GL_SHADER_SLOTS, sizeof(uint8_t));
+    r->shaders.uniforms       = mem_calloc(GL_SHADER_SLOTS, sizeof(GLUniformTable*));
+    r->shaders.status         = mem_calloc(GL_SHADER_SLOTS, sizeof(uint8_t));
+    r->shaders.stages         = mem_calloc(GL_SHADER_SLOTS, sizeof(*r->shaders.stages));
+    r->shaders.cache_key      = mem_calloc(GL_SHADER_SLOTS, sizeof(uint64_t));
+    if (!pool_init(&r->shaders.uniform_pool, sizeof(GLUniformTable), 16, 64)) return false;
+
+    if (!handle_pool_init(&r->textures.pool, R_MAX_TEXTURES)) return false;
+    r->textures.texture   = mem_calloc(R_MAX_TEXTURES, sizeof(GLuint));
+    r->textures.size      = mem_calloc(R_MAX_TEXTURES, sizeof(uint64_t));
+    r->textures.size_full = mem_calloc(R_MAX_TEXTURES, sizeof(uint64_t));
+
+    if (!handle_pool_init(&r->materials.pool, R_MAX_MATERIALS)) return false;
+    r->materials.shader        = mem_calloc(R_MAX_MATERIALS, sizeof(R_Handle));
+    r->materials.textures      = mem_calloc(R_MAX_MATERIALS, sizeof(*r->materials.textures));
+    r->materials.texture_count = mem_calloc(R_MAX_MATERIALS, sizeof(uint8_t));
+    r->materials.depth_test    = mem_calloc(R_MAX_MATERIALS, sizeof(uint8_t));
+    r->materials.depth_write   = mem_calloc(R_MAX_MATERIALS, sizeof(uint8_t));
+    r->materials.blend         = mem_calloc(R_MAX_MATERIALS, sizeof(uint8_t));
+    r->materials.no_instancing = mem_calloc(R_MAX_MATERIALS, sizeof(uint8_t));
+    r->materials.block         = mem_calloc(R_MAX_MATERIALS, sizeof(*r->materials.block));
+    r->materials.block_size    = mem_calloc(R_MAX_MATERIALS, sizeof(uint16_t));
+    r->materials.block_frame   = mem_calloc(R_MAX_MATERIALS, sizeof(uint32_t));
+    r->materials.block_offset  = mem_calloc(R_MAX_MATERIALS, sizeof(uint32_t));
+    r->materials.loose         = mem_calloc(R_MAX_MATERIALS, sizeof(*r->materials.loose));
+    r->materials.loose_count   = mem_calloc(R_MAX_MATERIALS, sizeof(uint8_t));
+
+    return r->meshes.vao && r->meshes.vbo && r->meshes.ibo && r->meshes.index_count
+        && r->meshes.index_type && r->meshes.lods && r->meshes.vertex_count && r->meshes.vertex_stride
+        && r->shaders.program && r->shaders.loc_model && r->shaders.loc_view && r->shaders.loc_projection
+        && r->shaders.instanced && r->shaders.uniforms
+        && r->shaders.status && r->shaders.stages && r->shaders.cache_key
+        && r->textures.texture && r->textures.size && r->textures.size_full
+        && r->materials.shader && r->materials.textures && r->materials.texture_count
+        && r->materials.depth_test && r->materials.depth_write && r->materials.blend
+        && r->materials.no_instancing && r->materials.block && r->materials.block_size
+        && r->materials.block_frame && r->materials.block_offset
+        && r->materials.loose && r->materials.loose_count;
+}
+
+static void gl_tables_shutdown(GLRenderer* r)
+{
+    // Release whatever the user leaked - the dense ranges hold exactly the live objects
+    if (r->meshes.vao) {
+        const GLsizei n = (GLsizei)r->meshes.pool.count;
+        glDeleteVertexArrays(n, r->meshes.vao);
+        glDeleteBuffers(n, r->meshes.vbo);
+        glDeleteBuffers(n, r->meshes.ibo);
+    }
+    for (uint32_t i = 0; r->shaders.program && i < r->shaders.pool.count; ++i) {
+        if (r->shaders.status[i] == GL_SHADER_COMPILING) {
+            glDeleteShader(r->shaders.stages[i][0]);
+            glDeleteShader(r->shaders.stages[i][1]);
+        }
+        glDeleteProgram(r->shaders.program[i]);
+    }
+    if (r->textures.texture)
+        glDeleteTextures((GLsizei)r->textures.pool.count, r->textures.texture);
+
+    mem_free(r->meshes.vao);
+    mem_free(r->meshes.vbo);
+    mem_free(r->meshes.ibo);
+    mem_free(r->meshes.index_count);
+    mem_free(r->meshes.index_type);
+    mem_free(r->meshes.lods);
+    mem_free(r->meshes.vertex_count);
+    mem_free(r->meshes.vertex_stride);
+    handle_pool_shutdown(&r->meshes.pool);
+
+    mem_free(r->shaders.program);
+    mem_free(r->shaders.loc_model);
+    mem_free(r->shaders.loc_view);
+    mem_free(r->shaders.loc_projection);
+    mem_free(r->shaders.instanced);
+    mem_free(r->shaders.uniforms);
+    mem_free(r->shaders.status);
+    mem_free(r->shaders.stages);
+    mem_free(r->shaders.cache_key);
+    pool_shutdown(&r->shaders.uniform_pool);
+    handle_pool_shutdown(&r->shaders.pool);
+
+    mem_free(r->textures.texture);
+    mem_free(r->textures.size);
+    mem_free(r->textures.size_full);
+    handle_pool_shutdown(&r->textures.pool);
+
+    mem_free(r->materials.shader);
+    mem_free(r->materials.textures);
+    mem_free(r->materials.texture_count);
+    mem_free(r->materials.depth_test);
+    mem_free(r->materials.depth_write);
+    mem_free(r->materials.blend);
+    mem_free(r->materials.no_instancing);
+    mem_free(r->materials.block);
+    mem_free(r->materials.block_size);
+    mem_free(r->materials.block_frame);
+    mem_free(r->materials.block_offset);
+    mem_free(r->materials.loose);
+    mem_free(r->materials.loose_count);
+    handle_pool_shutdown(&r->materials.pool);
+}
+
+static void point_instance_attribs(GLintptr offset)
+{
+    const GLsizei stride = sizeof(float) * 16;
+    for (int c = 0; c < 4; ++c)
+        glVertexAttribPointer(GL_INSTANCE_ATTRIB + c, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + c * 4 * sizeof(float)));
+}
+
+static void vertex_attrib(GLuint location, GLint size, GLenum type, GLboolean normalized, const VertexFormat* format, int attribute)
+{
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, size, type, normalized, (GLsizei)format->stride, (void*)(uintptr_t)format->offset[attribute]);
+}
+
+// Default pipeline layout for the bound vertex array: vertices in layout from the bound
+// array buffer at locations 0 = position, 1 = normal, 2 = uv, and the per instance model
+// matrix from instance_buffer, one vec4 column per location. Instance offsets are
+// re-pointed per draw. Attributes the layout leaves out stay disabled and read as 0.
+static void setup_vertex_attribs(GLRenderer* r, const EngineVertexLayout* layout, GLuint instance_buffer)
+{
+    VertexFormat format;
+    vertex_format_get(layout, &format); // Validated by the caller
+
+    if (layout->position == ENGINE_POSITION_HALF3) vertex_attrib(0, 3, GL_HALF_FLOAT, GL_FALSE, &format, 0);
+    else vertex_attrib(0, 3, GL_FLOAT, GL_FALSE, &format, 0);
+
+    switch (layout->normal) {
+        case ENGINE_NORMAL_FLOAT3:         vertex_attrib(1, 3, GL_FLOAT, GL_FALSE, &format, 1); break;
+        case ENGINE_NORMAL_INT_2_10_10_10: vertex_attrib(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, &format, 1); break;
+        case ENGINE_NORMAL_OCT16:          vertex_attrib(1, 2, GL_SHORT, GL_TRUE, &format, 1); break;
+        default: break;
+    }
+
+    switch (layout->uv) {
+        case ENGINE_UV_FLOAT2:  vertex_attrib(2, 2, GL_FLOAT, GL_FALSE, &format, 2); break;
+        case ENGINE_UV_UNORM16: vertex_attrib(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, &format, 2); break;
+        default: break;
+    }
+
+    gl_state_bind_array_buffer(&r->state, instance_buffer);
+    for (int c = 0; c < 4; ++c) {
+        glEnableVertexAttribArray(GL_INSTANCE_ATTRIB + c);
+        glVertexAttribDivisor(GL_INSTANCE_ATTRIB + c, 1);
+    }
+    point_instance_attribs(0);
+}
+
+static R_Handle placeholder_create(GLRenderer* r); // With the shader functions below
+
 static Renderer* gl_create(RendererCreateInfo* create_info)
 {
-    GLRenderer* renderer = malloc(sizeof(*renderer));
+    GLRenderer* renderer = mem_calloc(1, sizeof(*renderer));
     if (!renderer) { return NULL;}
 
     renderer->plat = create_info->platform_api;
     renderer->platform = create_info->platform;
     renderer->w = create_info->fb_width;
     renderer->h = create_info->fb_height;
+    renderer->frame_arena = create_info->frame_arena;
+    renderer->jobs = create_info->jobs;
 
     // Load GL after context is current
     if (gladLoadGLLoader((GLADloadproc)renderer->plat->get_gl_proc) == 0) {
-        free(renderer);
+        mem_free(renderer);
         return NULL;
     }
 
+    if (!gl_tables_init(renderer)) {
+        gl_tables_shutdown(renderer);
+        mem_free(renderer);
+        return NULL;
+    }
+
+    gl_state_invalidate(&renderer->state);
+
+    // Every mesh VAO sources a_instance_model from this buffer, so it is never left empty
+    renderer->instance_capacity = GL_INSTANCE_MIN_CAPACITY;
+    glGenBuffers(1, &renderer->instance_vbo);
+    gl_state_bind_array_buffer(&renderer->state, renderer->instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, renderer->instance_capacity * sizeof(float) * 16, NULL, GL_STREAM_DRAW);
+
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &renderer->ubo_align);
+    if (renderer->ubo_align < 16) renderer->ubo_align = 16;
+    glGenBuffers(1, &renderer->ubo);
+
+    // The orphaned buffers above remain the overflow path when the stream is unavailable
+    renderer->streaming = gl_stream_init(&renderer->stream, &renderer->state, GL_STREAM_FRAME_SIZE);
+    if (renderer->streaming) {
+        glGenVertexArrays(1, &renderer->transient_vao);
+        gl_state_bind_vao(&renderer->state, renderer->transient_vao);
+        gl_state_bind_array_buffer(&renderer->state, renderer->stream.buffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->stream.buffer);
+        const EngineVertexLayout full = { 0 };
+        setup_vertex_attribs(renderer, &full, renderer->stream.buffer);
+    } else {
+        fprintf(stderr, "gl_create: streaming buffer unavailable, per frame data will be orphaned and copied\n");
+    }
+
+    gl_timer_init(&renderer->timer);
+    gl_program_cache_init(&renderer->program_cache, create_info->shader_cache_dir);
+    d_array_init(&renderer->deferred_uniforms, sizeof(GLDeferredUniform), 0, NULL);
+
+    // The count is a hint; all ones leaves the number of compiler threads to the driver
+    if (GLAD_GL_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    else if (GLAD_GL_ARB_parallel_shader_compile) glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+    renderer->parallel_compile = GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+
+    // Linked here, so no user shader pays for it or loses a slot to it
+    renderer->placeholder = placeholder_create(renderer);
+    if (!renderer->placeholder) fprintf(stderr, "gl_create: placeholder shader failed, compiling shaders will not draw\n");
+
     return (Renderer*)renderer;
 }
 
 static void gl_destroy(Renderer* renderer)
 {
-    free(renderer);
+    GLRenderer* r = (GLRenderer*)renderer;
+    if (!r) return;
+    glDeleteBuffers(1, &r->instance_vbo);
+    glDeleteBuffers(1, &r->ubo);
+    if (r->streaming) {
+        gl_state_on_delete_vao(&r->state, r->transient_vao);
+        glDeleteVertexArrays(1, &r->transient_vao);
+        gl_stream_shutdown(&r->stream, &r->state);
+    }
+    gl_timer_shutdown(&r->timer);
+    d_array_free(&r->deferred_uniforms);
+    gl_tables_shutdown(r);
+    mem_free(r);
 }
 
+static void poll_shaders(GLRenderer* r); // With the shader functions below
+
 static void gl_begin(Renderer* renderer, int fb_w, int fb_h)
 {
-    (void)renderer;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glViewport(0, 0, fb_w, fb_h);
-    glEnable(GL_DEPTH_TEST);
-    glDepthMask(GL_TRUE);
-    glDisable(GL_BLEND);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    GLRenderer* r = (GLRenderer*)renderer;
+    r->w = fb_w;
+    r->h = fb_h;
+    r->frame_index++;
+    memset(&r->frame_stats, 0, sizeof r->frame_stats);
+    draw_queue_begin(&r->queue, frame_arena_current(r->frame_arena));
+    d_array_init(&r->transients, sizeof(GLTransientDraw), 0, frame_arena_current(r->frame_arena));
+
+    r->state.calls_issued = 0;
+    r->state.calls_elided = 0;
+    gl_state_validate(&r->state, "begin_frame");
+
+    gl_timer_begin_frame(&r->timer);
+    poll_shaders(r);
+    if (r->streaming) {
+        const uint32_t waits = r->stream.waits;
+        gl_stream_begin_frame(&r->stream, &r->state);
+        r->frame_stats.stream_waits = r->stream.waits - waits;
+    }
+    gl_timer_begin(&r->timer, "gpu_clear");
+
+    // Frame defaults - after the first frame these are almost always elided
+    gl_state_bind_framebuffer(&r->state, 0);
+    gl_state_viewport(&r->state, 0, 0, fb_w, fb_h);
+    gl_state_depth_test(&r->state, true);
+    gl_state_depth_write(&r->state, true);
+    gl_state_blend(&r->state, false);
+    gl_state_cull(&r->state, true);
+    gl_state_cull_face(&r->state, GL_BACK);
     // Do not clear here - allow user to call engine_clear
 }
 
+static void bind_material(GLRenderer* r, uint32_t mat)
+{
+    const GLMaterialTable* m = &r->materials;
+
+    for (int t = 0; t < m->texture_count[mat]; ++t) {
+        const uint32_t tex = handle_pool_lookup(&r->textures.pool, m->textures[mat][t]);
+        gl_state_bind_texture(&r->state, (GLuint)t, tex != HANDLE_POOL_INVALID ? r->textures.texture[tex] : 0);
+    }
+
+    if (m->block_size[mat])
+        gl_state_bind_uniform_range(&r->state, GL_MATERIAL_BLOCK_BINDING, r->frame_ubo, r->frame_ubo_base + m->block_offset[mat], m->block_size[mat]);
+
+    // Loose uniforms live in the program, which the caller has already bound
+    if (m->loose_count[mat]) {
+        const uint32_t sh = handle_pool_lookup(&r->shaders.pool, m->shader[mat]);
+        for (int l = 0; l < m->loose_count[mat]; ++l) {
+            const GLLooseUniform* u = &m->loose[mat][l];
+            gl_uniform_apply(&r->shaders.uniforms[sh]->slots[u->slot], u->vals, u->count);
+        }
+    }
+
+    gl_state_depth_test(&r->state, m->depth_test[mat] != 0);
+    gl_state_depth_write(&r->state, m->depth_write[mat] != 0);
+    gl_state_blend(&r->state, m->blend[mat] != 0);
+    if (m->blend[mat]) gl_state_blend_func(&r->state, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+// Fallback when the instance matrices did not fit in the stream
+static void upload_instances(GLRenderer* r, const float (*instances)[16], uint32_t count)
+{
+    const GLsizeiptr stride = sizeof(float) * 16;
+
+    gl_state_bind_array_buffer(&r->state, r->instance_vbo);
+    while (r->instance_capacity < count) r->instance_capacity *= 2;
+
+    // Orphan the previous frame's storage so the driver never waits on in-flight draws
+    glBufferData(GL_ARRAY_BUFFER, r->instance_capacity * stride, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * stride, instances);
+}
+
+static uint32_t align_up(uint32_t value, uint32_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+// Writes FrameData and the MaterialData of every material drawn this frame into one block in
+// the stream. When the stream is full the block is staged in the frame arena instead and
+// uploaded with a single glBufferSubData.
+static void upload_uniforms(GLRenderer* r, const uint32_t* materials, uint32_t material_count, uint32_t size)
+{
+    GLintptr base = 0;
+    uint8_t* staging = r->streaming ? gl_stream_alloc(&r->stream, size, r->ubo_align, &base) : NULL;
+    const bool streamed = staging != NULL;
+    if (!staging) staging = arena_alloc(r->queue.arena, size, 16);
+    if (!staging) return;
+
+    GLFrameBlock* frame = (GLFrameBlock*)staging;
+    memcpy(frame->view, r->camera.view, sizeof frame->view);
+    memcpy(frame->projection, r->camera.projection, sizeof frame->projection);
+    memcpy(frame->inverse_projection, r->camera.inverse_projection, sizeof frame->inverse_projection);
+    memcpy(frame->view_position, r->camera.view_position, sizeof r->camera.view_position);
+    frame->view_position[3] = 1.0f;
+
+    const GLMaterialTable* m = &r->materials;
+    for (uint32_t i = 0; i < material_count; ++i) {
+        const uint32_t mat = materials[i];
+        memcpy(staging + m->block_offset[mat], m->block[mat], m->block_size[mat]);
+    }
+
+    if (streamed) {
+        r->frame_ubo = r->stream.buffer;
+        r->frame_ubo_base = base;
+        gl_state_bind_uniform_range(&r->state, GL_FRAME_BLOCK_BINDING, r->frame_ubo, base, sizeof(GLFrameBlock));
+        return;
+    }
+
+    gl_state_bind_uniform_buffer(&r->state, r->ubo);
+    if (r->ubo_capacity < (GLsizeiptr)size) {
+        r->ubo_capacity = r->ubo_capacity ? r->ubo_capacity : 64 * 1024;
+        while (r->ubo_capacity < (GLsizeiptr)size) r->ubo_capacity *= 2;
+    }
+    glBufferData(GL_UNIFORM_BUFFER, r->ubo_capacity, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, size, staging);
+
+    r->frame_ubo = r->ubo;
+    r->frame_ubo_base = 0;
+    gl_state_bind_uniform_range(&r->state, GL_FRAME_BLOCK_BINDING, r->ubo, 0, sizeof(GLFrameBlock));
+}
+
+// Reserves a MaterialData range for the first use of a material this frame
+static uint32_t reserve_material_block(GLRenderer* r, uint32_t mat, uint32_t* materials, uint32_t* count, uint32_t ubo_size)
+{
+    GLMaterialTable* m = &r->materials;
+    if (!m->block_size[mat] || m->block_frame[mat] == r->frame_index) return ubo_size;
+
+    m->block_frame[mat] = r->frame_index;
+    m->block_offset[mat] = ubo_size;
+    materials[(*count)++] = mat;
+    return ubo_size + align_up(m->block_size[mat], (uint32_t)r->ubo_align);
+}
+
+// Table index of the program that draws for a shader: the placeholder while it compiles, and
+// HANDLE_POOL_INVALID once it has failed or been destroyed
+static uint32_t draw_shader(const GLRenderer* r, R_Handle shader)
+{
+    const uint32_t sh = handle_pool_lookup(&r->shaders.pool, shader);
+    if (sh == HANDLE_POOL_INVALID || r->shaders.status[sh] == GL_SHADER_READY) return sh;
+    if (r->shaders.status[sh] == GL_SHADER_FAILED) return HANDLE_POOL_INVALID;
+    return handle_pool_lookup(&r->shaders.pool, r->placeholder);
+}
+
+static bool resolve_draw(void* backend, const DrawItem* item, DrawResolved* out)
+{
+    const GLRenderer* r = backend;
+
+    out->material = handle_pool_lookup(&r->materials.pool, item->material);
+    out->mesh = handle_pool_lookup(&r->meshes.pool, item->mesh);
+    if (out->material == HANDLE_POOL_INVALID || out->mesh == HANDLE_POOL_INVALID) return false;
+
+    out->shader_handle = r->materials.shader[out->material];
+    out->shader = draw_shader(r, out->shader_handle);
+    if (out->shader == HANDLE_POOL_INVALID) return false;
+
+    out->instanced = r->shaders.instanced[out->shader] != 0;
+    out->no_instancing = r->materials.no_instancing[out->material] != 0;
+    return true;
+}
+
+// Resolves this frame's transient draws, rejecting those whose material or shader died
+static void resolve_transients(GLRenderer* r)
+{
+    EngineRenderStats* stats = &r->frame_stats;
+    for (uint32_t i = 0; i < r->transients.count; ++i) {
+        GLTransientDraw* t = d_array_at(&r->transients, i);
+        t->mat = handle_pool_lookup(&r->materials.pool, t->material);
+        if (t->mat != HANDLE_POOL_INVALID && draw_shader(r, r->materials.shader[t->mat]) != HANDLE_POOL_INVALID) continue;
+        t->mat = HANDLE_POOL_INVALID;
+        stats->draws_rejected++;
+        stats->draws_submitted--;
+    }
+}
+
+// Replays the sorted queue. Runs of the same mesh and material become one instanced draw
+// when the shader reads a_instance_model, and program, material and vertex array binds only
+// happen when the value changes between runs, which the sort makes rare. Transient meshes
+// follow in submission order.
+static void flush_queue(GLRenderer* r)
+{
+    DrawQueue* q = &r->queue;
+    EngineRenderStats* stats = &r->frame_stats;
+    const uint32_t transient_count = r->transients.count;
+    if (q->count == 0 && transient_count == 0) return;
+
+    // Instance matrices are packed straight into the stream when it has room
+    const GLsizeiptr instance_stride = sizeof(float) * 16;
+    GLintptr instance_base = 0;
+    float (*instances)[16] = r->streaming && q->count
+        ? gl_stream_alloc(&r->stream, q->count * instance_stride, instance_stride, &instance_base)
+        : NULL;
+
+    DrawBatches b;
+    PROFILE_BEGIN("draw_sort");
+    uint32_t* ubo_materials = arena_alloc(q->arena, (q->count + transient_count) * sizeof(uint32_t), 4);
+    const bool built = draw_queue_build_runs(q, resolve_draw, r, instances, &b);
+    resolve_transients(r);
+    PROFILE_END();
+    if (!built || !ubo_materials) {
+        stats->draws_rejected += stats->draws_submitted;
+        stats->draws_submitted = 0;
+        return;
+    }
+    stats->draws_rejected += b.rejected;
+    stats->draws_submitted -= b.rejected;
+    stats->batches = b.batches;
+
+    const DrawRun* runs = b.runs;
+    const uint32_t run_count = b.run_count;
+    const GLTransientDraw* transients = D_ARRAY_DATA(&r->transients, GLTransientDraw);
+
+    uint32_t ubo_size = align_up(sizeof(GLFrameBlock), (uint32_t)r->ubo_align);
+    uint32_t ubo_material_count = 0;
+    for (uint32_t i = 0; i < run_count; ++i)
+        ubo_size = reserve_material_block(r, runs[i].material, ubo_materials, &ubo_material_count, ubo_size);
+    for (uint32_t i = 0; i < transient_count; ++i)
+        if (transients[i].mat != HANDLE_POOL_INVALID)
+            ubo_size = reserve_material_block(r, transients[i].mat, ubo_materials, &ubo_material_count, ubo_size);
+
+    PROFILE_BEGIN("upload");
+    gl_timer_begin(&r->timer, "gpu_upload");
+    GLuint instance_buffer = r->stream.buffer;
+    if (b.any_instanced && !instances) {
+        upload_instances(r, (const float (*)[16])b.instances, b.instance_count);
+        instance_buffer = r->instance_vbo;
+        instance_base = 0;
+    }
+    upload_uniforms(r, ubo_materials, ubo_material_count, ubo_size);
+    // Nothing else is written this frame - make it all visible before the first draw
+    if (r->streaming) gl_stream_flush(&r->stream, &r->state);
+    PROFILE_END();
+
+    PROFILE_BEGIN("replay");
+    gl_timer_begin(&r->timer, "gpu_draw");
+
+    const uint32_t none = HANDLE_POOL_INVALID;
+    uint32_t bound_shader = none, bound_material = none, bound_mesh = none;
+
+    // Instance attributes of every vertex array are re-pointed into this buffer per run
+    if (b.any_instanced) gl_state_bind_array_buffer(&r->state, instance_buffer);
+
+    for (uint32_t i = 0; i < run_count; ++i) {
+        const DrawRun* run = &runs[i];
+
+        if (run->shader != bound_shader) {
+            gl_state_use_program(&r->state, r->shaders.program[run->shader]);
+            glUniformMatrix4fv(r->shaders.loc_view[run->shader], 1, GL_FALSE, r->camera.view);
+            glUniformMatrix4fv(r->shaders.loc_projection[run->shader], 1, GL_FALSE, r->camera.projection);
+            bound_shader = run->shader;
+            stats->state_changes++;
+        }
+
+        if (run->material != bound_material) {
+            bind_material(r, run->material);
+            bound_material = run->material;
+            stats->state_changes++;
+        }
+
+        if (run->mesh != bound_mesh) {
+            gl_state_bind_vao(&r->state, r->meshes.vao[run->mesh]);
+            bound_mesh = run->mesh;
+            stats->state_changes++;
+        }
+
+        // Every draw of a run shares its first item's level
+        uint32_t first_index, index_count;
+        mesh_lod_range(&r->meshes.lods[run->mesh], q->items[run->item].lod, &first_index, &index_count);
+        const GLenum index_type = r->meshes.index_type[run->mesh];
+        const void* indices = (const void*)((uintptr_t)first_index * (index_type == GL_UNSIGNED_SHORT ? 2u : 4u));
+        if (run->instanced) {
+            point_instance_attribs(instance_base + (GLintptr)run->first * instance_stride);
+            glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)index_count, index_type, indices, (GLsizei)run->count);
+            if (run->count > 1) stats->draws_instanced += run->count;
+        } else {
+            glUniformMatrix4fv(r->shaders.loc_model[run->shader], 1, GL_FALSE, q->items[run->item].model);
+            glDrawElements(GL_TRIANGLES, (GLsizei)index_count, index_type, indices);
+        }
+        stats->draw_calls++;
+    }
+
+    if (transient_count) {
+        gl_state_bind_vao(&r->state, r->transient_vao);
+        gl_state_bind_array_buffer(&r->state, r->stream.buffer);
+        stats->state_changes++;
+    }
+
+    for (uint32_t i = 0; i < transient_count; ++i) {
+        const GLTransientDraw* t = &transients[i];
+        if (t->mat == none) continue;
+        const uint32_t sh = draw_shader(r, r->materials.shader[t->mat]);
+
+        if (sh != bound_shader) {
+            gl_state_use_program(&r->state, r->shaders.program[sh]);
+            glUniformMatrix4fv(r->shaders.loc_view[sh], 1, GL_FALSE, r->camera.view);
+            glUniformMatrix4fv(r->shaders.loc_projection[sh], 1, GL_FALSE, r->camera.projection);
+            bound_shader = sh;
+            stats->state_changes++;
+        }
+
+        if (t->mat != bound_material) {
+            bind_material(r, t->mat);
+            bound_material = t->mat;
+            stats->state_changes++;
+        }
+
+        const void* indices = (const void*)t->index_offset;
+        if (r->shaders.instanced[sh]) {
+            point_instance_attribs(t->model_offset);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, t->index_count, GL_UNSIGNED_INT, indices, 1, t->base_vertex);
+        } else {
+            glUniformMatrix4fv(r->shaders.loc_model[sh], 1, GL_FALSE, t->model);
+            glDrawElementsBaseVertex(GL_TRIANGLES, t->index_count, GL_UNSIGNED_INT, indices, t->base_vertex);
+        }
+        stats->draw_calls++;
+    }
+
+    stats->state_changes_skipped = stats->draws_submitted * 3 - stats->state_changes;
+    PROFILE_END();
+
+    gl_state_validate(&r->state, "flush");
+}
+
 static void gl_end(Renderer* renderer)
 {
-    (void)renderer;
+    GLRenderer* r = (GLRenderer*)renderer;
+
+    flush_queue(r);
+    gl_timer_end(&r->timer);
+    if (r->streaming) {
+        // Nothing drawn from here on reads the stream, so its region can be fenced
+        gl_stream_flush(&r->stream, &r->state);
+        gl_stream_end_frame(&r->stream);
+        r->frame_stats.stream_bytes = (uint32_t)r->stream.offset;
+    }
+
+    r->frame_stats.draws_rejected += r->queue.dropped;
+    r->frame_stats.gl_calls_issued = r->state.calls_issued;
+    r->frame_stats.gl_calls_elided = r->state.calls_elided;
+    r->frame_stats.mesh_bytes = r->mesh_bytes;
+    r->frame_stats.mesh_bytes_full = r->mesh_bytes_full;
+    r->frame_stats.texture_bytes = r->texture_bytes;
+    r->frame_stats.texture_bytes_full = r->texture_bytes_full;
+    r->frame_stats.shader_create_ms = (float)((double)r->shader_create_ticks * 1000.0 / (double)clock_frequency());
+    r->frame_stats.shader_cache_hits = r->program_cache.hits;
+    r->frame_stats.shader_cache_misses = r->program_cache.misses;
+    r->frame_stats.shaders_pending = r->shaders_pending;
+    r->stats = r->frame_stats;
     // Swap happens in the platform layer
 }
 
@@ -66,61 +786,746 @@ static void present(Renderer* renderer)
 
 static void gl_clear(Renderer* renderer, float red, float green, float blue, float alpha)
 {
-    (void)renderer;
+    GLRenderer* r = (GLRenderer*)renderer;
+    // glClear honours the depth mask, which the last material drawn may have turned off
+    gl_state_depth_write(&r->state, true);
     glClearColor(red, green, blue, alpha);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
 // Resources
 
-R_Handle mesh_create(Renderer* renderer, const EngineMeshDesc* desc)
+static R_Handle mesh_create(Renderer* renderer, const EngineMeshDesc* desc)
 {
-    return 0;
+    GLRenderer* r = (GLRenderer*)renderer;
+    if ((!desc->vertices && !desc->packed_vertices) || desc->vertex_count == 0 || !desc->indices || desc->indices_count == 0)
+        return 0;
+
+    VertexFormat format;
+    if (!vertex_format_get(&desc->layout, &format)) {
+        fprintf(stderr, "mesh_create: invalid vertex layout\n");
+        return 0;
+    }
+
+    uint32_t i;
+    const R_Handle handle = handle_pool_alloc(&r->meshes.pool, &i);
+    if (!handle) {
+        fprintf(stderr, "mesh_create: mesh table full (%d)\n", R_MAX_MESHES);
+        return 0;
+    }
+
+    // Encode on the way in unless the caller packed the vertices already
+    const GLsizeiptr vertex_bytes = (GLsizeiptr)desc->vertex_count * (GLsizeiptr)format.stride;
+    const void* vertex_data = desc->packed_vertices ? desc->packed_vertices : (const void*)desc->vertices;
+    const bool encode = !desc->packed_vertices && !vertex_layout_is_full(&desc->layout);
+    void* encoded = encode ? mem_alloc((size_t)vertex_bytes) : NULL;
+
+    // LOD levels follow LOD 0 in the same buffer, so a level is just a range of it
+    MeshLodRanges lods;
+    const uint32_t index_count = mesh_lod_ranges(desc, &lods);
+    const uint32_t index_size = r_index_size(desc->vertex_count);
+    const GLsizeiptr index_bytes = (GLsizeiptr)index_count * index_size;
+    const void* index_data = desc->indices;
+    const bool copy_indices = index_size == 2 || lods.count > 1;
+    void* copied_indices = copy_indices ? mem_alloc((size_t)index_bytes) : NULL;
+
+    if ((encode && !encoded) || (copy_indices && !copied_indices)) {
+        mem_free(encoded);
+        mem_free(copied_indices);
+        uint32_t dst, src;
+        handle_pool_release(&r->meshes.pool, handle, &dst, &src);
+        return 0;
+    }
+    if (encoded) {
+        vertex_encode(r->jobs, &desc->layout, desc->vertices, desc->vertex_count, encoded);
+        vertex_data = encoded;
+    }
+    if (copied_indices) {
+        mesh_lod_write_indices(desc, copied_indices, index_size);
+        index_data = copied_indices;
+    }
+
+    glGenVertexArrays(1, &r->meshes.vao[i]);
+    glGenBuffers(1, &r->meshes.vbo[i]);
+    glGenBuffers(1, &r->meshes.ibo[i]);
+    r->meshes.index_count[i] = (GLsizei)index_count;
+    r->meshes.index_type[i] = index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    r->meshes.lods[i] = lods;
+    r->meshes.vertex_count[i] = desc->vertex_count;
+    r->meshes.vertex_stride[i] = (uint8_t)format.stride;
+
+    gl_state_bind_vao(&r->state, r->meshes.vao[i]);
+
+    gl_state_bind_array_buffer(&r->state, r->meshes.vbo[i]);
+    glBufferData(GL_ARRAY_BUFFER, vertex_bytes, vertex_data, GL_STATIC_DRAW);
+    mem_free(encoded);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, r->meshes.ibo[i]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_bytes, index_data, GL_STATIC_DRAW);
+    mem_free(copied_indices);
+
+    setup_vertex_attribs(r, &desc->layout, r->instance_vbo);
+
+    r->mesh_bytes += (uint64_t)vertex_bytes + (uint64_t)index_bytes;
+    r->mesh_bytes_full += (uint64_t)desc->vertex_count * sizeof(EngineVertex) + (uint64_t)index_count * sizeof(uint32_t);
+
+    return handle;
+}
+
+static void mesh_destroy(Renderer* renderer, R_Handle handle)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+    GLMeshTable* t = &r->meshes;
+
+    const uint32_t i = handle_pool_lookup(&t->pool, handle);
+    if (i == HANDLE_POOL_INVALID) {
+        fprintf(stderr, "mesh_destroy: stale or invalid handle 0x%08x\n", handle);
+        return;
+    }
+
+    gl_state_on_delete_vao(&r->state, t->vao[i]);
+    gl_state_on_delete_buffer(&r->state, t->vbo[i]);
+    glDeleteVertexArrays(1, &t->vao[i]);
+    glDeleteBuffers(1, &t->vbo[i]);
+    glDeleteBuffers(1, &t->ibo[i]);
+
+    const uint64_t vertices = t->vertex_count[i], indices = (uint64_t)t->index_count[i];
+    r->mesh_bytes -= vertices * t->vertex_stride[i] + indices * r_index_size((uint32_t)vertices);
+    r->mesh_bytes_full -= vertices * sizeof(EngineVertex) + indices * sizeof(uint32_t);
+
+    uint32_t dst, src;
+    handle_pool_release(&t->pool, handle, &dst, &src);
+    t->vao[dst]           = t->vao[src];
+    t->vbo[dst]           = t->vbo[src];
+    t->ibo[dst]           = t->ibo[src];
+    t->index_count[dst]   = t->index_count[src];
+    t->index_type[dst]    = t->index_type[src];
+    t->lods[dst]          = t->lods[src];
+    t->vertex_count[dst]  = t->vertex_count[src];
+    t->vertex_stride[dst] = t->vertex_stride[src];
+}
+
+// Compiles and links without asking for the result, which would wait for the driver. The
+// shader objects stay attached until program_end_link.
+static GLuint program_begin_link(const GLRenderer* r, const char* vs_src, const char* fs_src, GLuint stages[2])
+{
+    stages[0] = glCreateShader(GL_VERTEX_SHADER);
+    stages[1] = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(stages[0], 1, &vs_src, NULL);
+    glShaderSource(stages[1], 1, &fs_src, NULL);
+    glCompileShader(stages[0]);
+    glCompileShader(stages[1]);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, stages[0]);
+    glAttachShader(program, stages[1]);
+    glBindAttribLocation(program, GL_INSTANCE_ATTRIB, "a_instance_model");
+    if (r->program_cache.enabled) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
+    return program;
+}
+
+// Waits for the link unless the driver has reported it complete, releases the shader
+// objects and reports errors. Returns false when the program is unusable.
+static bool program_end_link(GLuint program, const GLuint stages[2])
+{
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        for (int s = 0; s < 2; ++s) {
+            GLint compiled = GL_FALSE;
+            glGetShaderiv(stages[s], GL_COMPILE_STATUS, &compiled);
+            if (compiled) continue;
+            glGetShaderInfoLog(stages[s], sizeof log, NULL, log);
+            fprintf(stderr, "%s shader compile failed:\n%s\n", s == 0 ? "Vertex" : "Fragment", log);
+        }
+        glGetProgramInfoLog(program, sizeof log, NULL, log);
+        fprintf(stderr, "Shader link failed:\n%s\n", log);
+    }
+
+    for (int s = 0; s < 2; ++s) {
+        glDetachShader(program, stages[s]);
+        glDeleteShader(stages[s]);
+    }
+    return ok == GL_TRUE;
+}
+
+static GLint uniform_location(const GLUniformTable* table, const char* name)
+{
+    const int slot = gl_uniform_table_find(table, name);
+    return slot >= 0 ? table->slots[slot].location : -1;
+}
+
+// Takes ownership of program. Its uniform table stays empty until shader_finish.
+static R_Handle shader_add(GLRenderer* r, GLuint program, uint32_t* out_index)
+{
+    GLUniformTable* table = pool_alloc(&r->shaders.uniform_pool);
+    const R_Handle handle = table ? handle_pool_alloc(&r->shaders.pool, out_index) : 0;
+    if (!handle) {
+        pool_free(&r->shaders.uniform_pool, table);
+        glDeleteProgram(program);
+        return 0;
+    }
+    memset(table, 0, sizeof *table);
+
+    const uint32_t i = *out_index;
+    r->shaders.program[i]        = program;
+    r->shaders.uniforms[i]       = table;
+    r->shaders.status[i]         = GL_SHADER_COMPILING;
+    r->shaders.stages[i][0]      = 0;
+    r->shaders.stages[i][1]      = 0;
+    r->shaders.cache_key[i]      = 0;
+    r->shaders.loc_model[i]      = -1;
+    r->shaders.loc_view[i]       = -1;
+    r->shaders.loc_projection[i] = -1;
+    r->shaders.instanced[i]      = 0;
+    return handle;
 }
 
-void mesh_destroy(Renderer* renderer, R_Handle handle)
+// Reflects a linked program and makes the shader drawable
+static void shader_finish(GLRenderer* r, uint32_t i)
 {
+    const GLuint program = r->shaders.program[i];
+    GLUniformTable* table = r->shaders.uniforms[i];
+    gl_uniform_table_build(table, program);
+
+    // Engine provided loose uniforms, for shaders that do not use FrameData. Locations of -1
+    // (unused) are ignored by glUniform*.
+    r->shaders.loc_model[i]      = uniform_location(table, "u_model");
+    r->shaders.loc_view[i]       = uniform_location(table, "u_view");
+    r->shaders.loc_projection[i] = uniform_location(table, "u_projection");
+    r->shaders.instanced[i]      = glGetAttribLocation(program, "a_instance_model") == GL_INSTANCE_ATTRIB;
+
+    // Material textures go to units 0..3 as u_texture0..u_texture3
+    gl_state_use_program(&r->state, program);
+    for (int t = 0; t < R_MAX_MATERIAL_TEXTURES; ++t) {
+        char name[] = "u_texture0";
+        name[sizeof name - 2] = (char)('0' + t);
+        glUniform1i(uniform_location(table, name), t);
+    }
+    r->shaders.status[i] = GL_SHADER_READY;
 }
 
-R_Handle shader_create(Renderer* renderer, const char* vs_src, const char* fs_src)
+// Stages a value through the shader's uniform table. False when it had no room.
+static bool material_stage_uniform(GLRenderer* r, uint32_t mat, uint32_t sh, uint32_t hash, const float* val, int count)
 {
-    return 0;
+    GLMaterialTable* m = &r->materials;
+    const GLUniformTable* table = r->shaders.uniforms[sh];
+    const int slot = gl_uniform_table_find_hash(table, hash);
+    if (slot < 0) return true;
+
+    const GLUniform* uniform = &table->slots[slot];
+    if (uniform->in_block) {
+        gl_uniform_write_std140(uniform, m->block[mat], val, count);
+        return true;
+    }
+
+    int l = 0;
+    while (l < m->loose_count[mat] && m->loose[mat][l].slot != slot) ++l;
+    if (l == GL_MAX_LOOSE_UNIFORMS) return false;
+    if (l == m->loose_count[mat]) m->loose_count[mat]++;
+
+    GLLooseUniform* loose = &m->loose[mat][l];
+    loose->slot = (uint8_t)slot;
+    loose->count = (uint8_t)(count < GL_UNIFORM_MAX_FLOATS ? count : GL_UNIFORM_MAX_FLOATS);
+    memcpy(loose->vals, val, loose->count * sizeof(float));
+    return true;
 }
 
-void shader_destroy(Renderer* renderer, R_Handle handle)
+// A shader just became ready: its materials learn the MaterialData size and get the
+// uniforms that were set while it compiled. Entries of dead materials are dropped on the way.
+static void shader_bind_materials(GLRenderer* r, R_Handle shader, uint32_t sh)
 {
+    GLMaterialTable* m = &r->materials;
+    for (uint32_t i = 0; i < m->pool.count; ++i)
+        if (m->shader[i] == shader) m->block_size[i] = r->shaders.uniforms[sh]->block_size;
+
+    for (uint32_t d = 0; d < r->deferred_uniforms.count;) {
+        const GLDeferredUniform* u = d_array_at(&r->deferred_uniforms, d);
+        const uint32_t mat = handle_pool_lookup(&m->pool, u->material);
+        if (mat != HANDLE_POOL_INVALID && m->shader[mat] != shader
+            && handle_pool_is_valid(&r->shaders.pool, m->shader[mat])) {
+            ++d;
+            continue;
+        }
+        if (mat != HANDLE_POOL_INVALID && m->shader[mat] == shader
+            && !material_stage_uniform(r, mat, sh, u->hash, u->vals, u->count))
+            fprintf(stderr, "material_set_uniform_f: more than %d uniforms outside %s, one set while compiling ignored\n",
+                    GL_MAX_LOOSE_UNIFORMS, GL_MATERIAL_BLOCK_NAME);
+        d_array_swap_remove(&r->deferred_uniforms, d);
+    }
 }
 
-R_Handle texture_create(Renderer* renderer, const EngineTextureDesc* desc)
+// Called once per frame. With parallel shader compile the driver is asked whether each link
+// is done, which never waits; without it a link gets one frame of head start and is then
+// finished, waiting only if the driver is still busy with it.
+static void poll_shaders(GLRenderer* r)
 {
-    return 0;
+    if (r->shaders_pending == 0) return;
+
+    PROFILE_BEGIN("shader_poll");
+    const uint64_t start = clock_ticks();
+    GLShaderTable* t = &r->shaders;
+    for (uint32_t i = 0; i < t->pool.count; ++i) {
+        if (t->status[i] != GL_SHADER_COMPILING) continue;
+        if (r->parallel_compile) {
+            GLint done = GL_FALSE;
+            glGetProgramiv(t->program[i], GL_COMPLETION_STATUS_KHR, &done);
+            if (!done) continue;
+        }
+
+        r->shaders_pending--;
+        if (!program_end_link(t->program[i], t->stages[i])) {
+            t->status[i] = GL_SHADER_FAILED;
+            shader_bind_materials(r, handle_pool_handle_at(&t->pool, i), i); // Drops their deferred uniforms
+            continue;
+        }
+        gl_program_cache_store(&r->program_cache, t->cache_key[i], t->program[i]);
+        shader_finish(r, i);
+        shader_bind_materials(r, handle_pool_handle_at(&t->pool, i), i);
+    }
+    r->shader_create_ticks += clock_ticks() - start;
+    PROFILE_END();
 }
 
-void texture_destroy(Renderer* renderer, R_Handle handle)
+// Flat grey, instanced so pending draws still merge, and reading nothing but positions so it
+// works with every vertex layout
+static const char* placeholder_vs =
+    "#version 330 core\n"
+    "layout(location = 0) in vec3 a_position;\n"
+    "in mat4 a_instance_model;\n"
+    "uniform mat4 u_view;\n"
+    "uniform mat4 u_projection;\n"
+    "void main() { gl_Position = u_projection * u_view * a_instance_model * vec4(a_position, 1.0); }\n";
+static const char* placeholder_fs =
+    "#version 330 core\n"
+    "out vec4 o_color;\n"
+    "void main() { o_color = vec4(0.5, 0.5, 0.5, 1.0); }\n";
+
+// Linked on the spot at startup, the one shader creation that waits
+static R_Handle placeholder_create(GLRenderer* r)
 {
+    GLuint stages[2];
+    const GLuint program = program_begin_link(r, placeholder_vs, placeholder_fs, stages);
+    if (!program_end_link(program, stages)) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    uint32_t i;
+    const R_Handle handle = shader_add(r, program, &i);
+    if (handle) shader_finish(r, i);
+    return handle;
+}
 
+static R_Handle shader_create(Renderer* renderer, const char* vs_src, const char* fs_src)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+    if (r->shaders.pool.free_count == 0) {
+        fprintf(stderr, "shader_create: shader table full (%d)\n", R_MAX_SHADERS);
+        return 0;
+    }
+
+    // A cache hit is ready at once; anything else links in the background
+    const uint64_t start = clock_ticks();
+    const uint64_t key = r->program_cache.enabled ? gl_program_cache_key(vs_src, fs_src) : 0;
+    uint32_t i;
+    R_Handle handle;
+    const GLuint cached = gl_program_cache_load(&r->program_cache, key);
+    if (cached) {
+        handle = shader_add(r, cached, &i);
+        if (handle) shader_finish(r, i);
+    } else {
+        GLuint stages[2];
+        const GLuint program = program_begin_link(r, vs_src, fs_src, stages);
+        handle = shader_add(r, program, &i);
+        if (handle) {
+            r->shaders.stages[i][0] = stages[0];
+            r->shaders.stages[i][1] = stages[1];
+            r->shaders.cache_key[i] = key;
+            r->shaders_pending++;
+        } else {
+            glDeleteShader(stages[0]);
+            glDeleteShader(stages[1]);
+        }
+    }
+    r->shader_create_ticks += clock_ticks() - start;
+    return handle;
 }
 
-R_Handle material_create(Renderer* renderer, const EngineMaterialDesc* desc)
+static void shader_destroy(Renderer* renderer, R_Handle handle)
 {
-    return 0;
+    GLRenderer* r = (GLRenderer*)renderer;
+    GLShaderTable* t = &r->shaders;
+
+    const uint32_t i = handle_pool_lookup(&t->pool, handle);
+    if (i == HANDLE_POOL_INVALID) {
+        fprintf(stderr, "shader_destroy: stale or invalid handle 0x%08x\n", handle);
+        return;
+    }
+
+    if (t->status[i] == GL_SHADER_COMPILING) {
+        glDeleteShader(t->stages[i][0]);
+        glDeleteShader(t->stages[i][1]);
+        r->shaders_pending--;
+    }
+    gl_state_on_delete_program(&r->state, t->program[i]);
+    glDeleteProgram(t->program[i]);
+    pool_free(&t->uniform_pool, t->uniforms[i]);
+
+    uint32_t dst, src;
+    handle_pool_release(&t->pool, handle, &dst, &src);
+    t->program[dst]        = t->program[src];
+    t->loc_model[dst]      = t->loc_model[src];
+    t->loc_view[dst]       = t->loc_view[src];
+    t->loc_projection[dst] = t->loc_projection[src];
+    t->instanced[dst]      = t->instanced[src];
+    t->uniforms[dst]       = t->uniforms[src];
+    t->status[dst]         = t->status[src];
+    t->stages[dst][0]      = t->stages[src][0];
+    t->stages[dst][1]      = t->stages[src][1];
+    t->cache_key[dst]      = t->cache_key[src];
 }
 
-void material_destroy(Renderer* renderer, R_Handle handle)
+static EngineShaderStatus shader_status(Renderer* renderer, R_Handle handle)
 {
+    const GLRenderer* r = (const GLRenderer*)renderer;
+    const uint32_t i = handle_pool_lookup(&r->shaders.pool, handle);
+    if (i == HANDLE_POOL_INVALID) return ENGINE_SHADER_INVALID;
+    switch (r->shaders.status[i]) {
+        case GL_SHADER_READY:     return ENGINE_SHADER_READY;
+        case GL_SHADER_COMPILING: return ENGINE_SHADER_COMPILING;
+        default:                  return ENGINE_SHADER_FAILED;
+    }
+}
 
+typedef struct GLTextureFormat
+{
+    GLint  internal_format;
+    GLenum format;         // Of uncompressed uploads; 0 for block compressed formats
+} GLTextureFormat;
+
+static bool texture_format_to_gl(EngineTextureFormat format, GLTextureFormat* out)
+{
+    static const GLTextureFormat formats[ENGINE_TEXTURE_FORMAT_COUNT] = {
+        [ENGINE_TEXTURE_RGBA8]     = { GL_RGBA8,                                  GL_RGBA },
+        [ENGINE_TEXTURE_RGB8]      = { GL_RGB8,                                   GL_RGB  },
+        [ENGINE_TEXTURE_R8]        = { GL_R8,                                     GL_RED  },
+        [ENGINE_TEXTURE_SRGB8_A8]  = { GL_SRGB8_ALPHA8,                           GL_RGBA },
+        [ENGINE_TEXTURE_SRGB8]     = { GL_SRGB8,                                  GL_RGB  },
+        [ENGINE_TEXTURE_BC1]       = { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,          0 },
+        [ENGINE_TEXTURE_BC1_SRGB]  = { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,    0 },
+        [ENGINE_TEXTURE_BC3]       = { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,          0 },
+        [ENGINE_TEXTURE_BC3_SRGB]  = { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,    0 },
+        [ENGINE_TEXTURE_BC4]       = { GL_COMPRESSED_RED_RGTC1,                   0 },
+        [ENGINE_TEXTURE_BC5]       = { GL_COMPRESSED_RG_RGTC2,                    0 },
+        [ENGINE_TEXTURE_BC7]       = { GL_COMPRESSED_RGBA_BPTC_UNORM,             0 },
+        [ENGINE_TEXTURE_BC7_SRGB]  = { GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,       0 },
+    };
+    if ((unsigned)format >= ENGINE_TEXTURE_FORMAT_COUNT) return false;
+    *out = formats[format];
+    return true;
+}
+
+// RGTC is core since 3.0; S3TC and BPTC are extensions on a 3.3 context
+static bool gl_texture_format_supported(Renderer* renderer, EngineTextureFormat format)
+{
+    (void)renderer;
+    switch (format) {
+        case ENGINE_TEXTURE_BC1:
+        case ENGINE_TEXTURE_BC3:
+            return GLAD_GL_EXT_texture_compression_s3tc != 0;
+        case ENGINE_TEXTURE_BC1_SRGB:
+        case ENGINE_TEXTURE_BC3_SRGB:
+            return GLAD_GL_EXT_texture_compression_s3tc != 0 && GLAD_GL_EXT_texture_sRGB != 0;
+        case ENGINE_TEXTURE_BC7:
+        case ENGINE_TEXTURE_BC7_SRGB:
+            return GLAD_GL_ARB_texture_compression_bptc != 0;
+        default:
+            return (unsigned)format < ENGINE_TEXTURE_FORMAT_COUNT;
+    }
+}
+
+static R_Handle texture_create(Renderer* renderer, const EngineTextureDesc* desc)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+
+    GLTextureFormat gl_format;
+    uint32_t mip_count;
+    bool generate;
+    if (!texture_desc_validate(desc, &mip_count, &generate) || !texture_format_to_gl(desc->format, &gl_format))
+        return 0;
+    if (!gl_texture_format_supported(renderer, desc->format)) {
+        fprintf(stderr, "texture_create: format %d is not supported by this driver\n", (int)desc->format);
+        return 0;
+    }
+
+    uint32_t i;
+    const R_Handle handle = handle_pool_alloc(&r->textures.pool, &i);
+    if (!handle) {
+        fprintf(stderr, "texture_create: texture table full (%d)\n", R_MAX_TEXTURES);
+        return 0;
+    }
+
+    glGenTextures(1, &r->textures.texture[i]);
+    gl_state_bind_texture(&r->state, 0, r->textures.texture[i]);
+
+    // Tightly packed rows - RGB8 and R8 rows are not 4 byte aligned in general
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    const uint32_t width = (uint32_t)desc->width, height = (uint32_t)desc->height;
+    const uint32_t upload_count = generate ? 1 : mip_count;
+    for (uint32_t level = 0; level < upload_count; ++level) {
+        const GLsizei w = (GLsizei)texture_mip_extent(width, level), h = (GLsizei)texture_mip_extent(height, level);
+        const void* pixels = desc->mip_count > 0 ? desc->levels[level] : desc->pixels;
+        if (gl_format.format) {
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, gl_format.internal_format, w, h, 0, gl_format.format, GL_UNSIGNED_BYTE, pixels);
+        } else {
+            const size_t size = texture_level_size(desc->format, (uint32_t)w, (uint32_t)h);
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, (GLenum)gl_format.internal_format, w, h, 0, (GLsizei)size, pixels);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // A supplied chain may stop short of 1x1; without the cap the texture would be incomplete
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)mip_count - 1);
+    if (generate) glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mip_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    r->textures.size[i] = texture_chain_size(desc->format, width, height, 0, mip_count);
+    r->textures.size_full[i] = texture_chain_size(ENGINE_TEXTURE_RGBA8, width, height, 0, mip_count);
+    r->texture_bytes += r->textures.size[i];
+    r->texture_bytes_full += r->textures.size_full[i];
+    return handle;
+}
+
+static void texture_destroy(Renderer* renderer, R_Handle handle)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+    GLTextureTable* t = &r->textures;
+
+    const uint32_t i = handle_pool_lookup(&t->pool, handle);
+    if (i == HANDLE_POOL_INVALID) {
+        fprintf(stderr, "texture_destroy: stale or invalid handle 0x%08x\n", handle);
+        return;
+    }
+
+    gl_state_on_delete_texture(&r->state, t->texture[i]);
+    glDeleteTextures(1, &t->texture[i]);
+
+    r->texture_bytes -= t->size[i];
+    r->texture_bytes_full -= t->size_full[i];
+
+    uint32_t dst, src;
+    handle_pool_release(&t->pool, handle, &dst, &src);
+    t->texture[dst] = t->texture[src];
+    t->size[dst] = t->size[src];
+    t->size_full[dst] = t->size_full[src];
+}
+
+static R_Handle material_create(Renderer* renderer, const EngineMaterialDesc* desc)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+
+    if (!handle_pool_is_valid(&r->shaders.pool, desc->shader)) return 0;
+    if (desc->texture_count < 0 || desc->texture_count > R_MAX_MATERIAL_TEXTURES) return 0;
+    for (int t = 0; t < desc->texture_count; ++t)
+        if (!handle_pool_is_valid(&r->textures.pool, desc->texture[t])) return 0;
+
+    uint32_t i;
+    const R_Handle handle = handle_pool_alloc(&r->materials.pool, &i);
+    if (!handle) {
+        fprintf(stderr, "material_create: material table full (%d)\n", R_MAX_MATERIALS);
+        return 0;
+    }
+
+    GLMaterialTable* m = &r->materials;
+    m->shader[i] = desc->shader;
+    for (int t = 0; t < R_MAX_MATERIAL_TEXTURES; ++t)
+        m->textures[i][t] = t < desc->texture_count ? desc->texture[t] : 0;
+    m->texture_count[i] = (uint8_t)desc->texture_count;
+    m->depth_test[i]    = desc->depth_test ? 1 : 0;
+    m->depth_write[i]   = desc->depth_write ? 1 : 0;
+    m->blend[i]         = desc->blend ? 1 : 0;
+    m->no_instancing[i] = desc->no_instancing ? 1 : 0;
+
+    const uint32_t sh = handle_pool_lookup(&r->shaders.pool, desc->shader);
+    m->block_size[i]   = r->shaders.uniforms[sh]->block_size;
+    m->block_frame[i]  = 0;
+    m->loose_count[i]  = 0;
+    memset(m->block[i], 0, sizeof m->block[i]);
+
+    return handle;
+}
+
+static void material_destroy(Renderer* renderer, R_Handle handle)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+    GLMaterialTable* m = &r->materials;
+
+    uint32_t dst, src;
+    if (!handle_pool_release(&m->pool, handle, &dst, &src)) {
+        fprintf(stderr, "material_destroy: stale or invalid handle 0x%08x\n", handle);
+        return;
+    }
+
+    m->shader[dst] = m->shader[src];
+    memcpy(m->textures[dst], m->textures[src], sizeof m->textures[dst]);
+    m->texture_count[dst] = m->texture_count[src];
+    m->depth_test[dst]    = m->depth_test[src];
+    m->depth_write[dst]   = m->depth_write[src];
+    m->blend[dst]         = m->blend[src];
+    m->no_instancing[dst] = m->no_instancing[src];
+    memcpy(m->block[dst], m->block[src], m->block_size[src]);
+    m->block_size[dst]    = m->block_size[src];
+    m->block_frame[dst]   = m->block_frame[src];
+    m->block_offset[dst]  = m->block_offset[src];
+    memcpy(m->loose[dst], m->loose[src], m->loose_count[src] * sizeof(GLLooseUniform));
+    m->loose_count[dst]   = m->loose_count[src];
 }
 
 // State
-void set_camera(Renderer* renderer, const EngineCamera* camera)
+static void set_camera(Renderer* renderer, const EngineCamera* camera)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+    r->camera = *camera;
+}
+
+// Rejects stale handles up front; flush re-checks in case they die before end of frame
+static bool gl_draw_key(Renderer* renderer, R_Handle mesh, R_Handle material, const float model[16], uint64_t* out_key)
+{
+    const GLRenderer* r = (const GLRenderer*)renderer;
+    const uint32_t mat = handle_pool_lookup(&r->materials.pool, material);
+    if (mat == HANDLE_POOL_INVALID || !handle_pool_is_valid(&r->meshes.pool, mesh)) return false;
+
+    const GLMaterialTable* m = &r->materials;
+    *out_key = draw_key_make(
+        m->blend[mat] != 0,
+        handle_index(m->shader[mat]),
+        draw_key_texture_hash(m->textures[mat], m->texture_count[mat]),
+        handle_index(material),
+        handle_index(mesh),
+        draw_key_view_depth(r->camera.view, model));
+    return true;
+}
+
+static void gl_draw(Renderer* renderer, R_Handle mesh, R_Handle material, const float model[16], uint32_t lod)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+    uint64_t key;
+    if (!gl_draw_key(renderer, mesh, material, model, &key)) {
+        r->frame_stats.draws_rejected++;
+        return;
+    }
+    if (draw_queue_push(&r->queue, key, mesh, material, model, lod))
+        r->frame_stats.draws_submitted++;
+}
+
+static void gl_merge_draws(Renderer* renderer, DrawBucket* bucket)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+    const uint32_t merged = draw_queue_merge(&r->queue, bucket);
+    r->frame_stats.draws_submitted += merged;
+    r->frame_stats.draws_bucketed += merged;
+    r->frame_stats.draws_rejected += bucket->rejected;
+    bucket->rejected = 0;
+}
+
+static bool gl_transient_alloc(Renderer* renderer, uint32_t vertex_count, uint32_t index_count, EngineTransientMesh* out)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+    if (!r->streaming) return false;
+
+    // Vertices are aligned to a whole vertex so their offset becomes the draw's base vertex
+    GLintptr vertex_offset, index_offset;
+    EngineVertex* vertices = gl_stream_alloc(&r->stream, (GLsizeiptr)vertex_count * (GLsizeiptr)sizeof(EngineVertex),
+                                             sizeof(EngineVertex), &vertex_offset);
+    uint32_t* indices = vertices ? gl_stream_alloc(&r->stream, (GLsizeiptr)index_count * (GLsizeiptr)sizeof(uint32_t),
+                                                   sizeof(uint32_t), &index_offset) : NULL;
+    if (!indices) return false;
+
+    out->vertices = vertices;
+    out->indices = indices;
+    out->vertex_count = vertex_count;
+    out->index_count = index_count;
+    out->vertex_offset = (uint32_t)vertex_offset;
+    out->index_offset = (uint32_t)index_offset;
+    return true;
+}
+
+static void gl_draw_transient(Renderer* renderer, const EngineTransientMesh* mesh, R_Handle material, const float model[16])
 {
+    GLRenderer* r = (GLRenderer*)renderer;
+
+    const uint32_t mat = handle_pool_lookup(&r->materials.pool, material);
+    const uint32_t sh = mat != HANDLE_POOL_INVALID ? draw_shader(r, r->materials.shader[mat]) : HANDLE_POOL_INVALID;
+    if (!r->streaming || sh == HANDLE_POOL_INVALID) {
+        r->frame_stats.draws_rejected++;
+        return;
+    }
+
+    // Instanced shaders read the model matrix as an attribute, so it goes in the stream too
+    GLintptr model_offset = 0;
+    bool placed = true;
+    if (r->shaders.instanced[sh]) {
+        float* dst = gl_stream_alloc(&r->stream, sizeof(float) * 16, sizeof(float) * 16, &model_offset);
+        if (dst) memcpy(dst, model, sizeof(float) * 16);
+        placed = dst != NULL;
+    }
 
+    GLTransientDraw* t = placed ? d_array_push(&r->transients) : NULL;
+    if (!t) {
+        r->frame_stats.draws_rejected++;
+        return;
+    }
+    memcpy(t->model, model, sizeof t->model);
+    t->model_offset = model_offset;
+    t->material = material;
+    t->base_vertex = (GLint)(mesh->vertex_offset / sizeof(EngineVertex));
+    t->index_offset = (GLintptr)mesh->index_offset;
+    t->index_count = (GLsizei)mesh->index_count;
+    r->frame_stats.draws_submitted++;
+}
+
+static void gl_get_stats(Renderer* renderer, EngineRenderStats* out_stats)
+{
+    GLRenderer* r = (GLRenderer*)renderer;
+    *out_stats = r->stats;
 }
 
-// Uniforms by name
-void material_set_uniform_f(Renderer* renderer, R_Handle mat, const char* name, const float* val, int count)
+// Uniforms by name. The name is resolved through the shader's hashed table; values are
+// staged on the material and reach GL when the material is next drawn. While the shader
+// compiles there is no table yet, so values wait on the side until it is ready.
+static void material_set_uniform_f(Renderer* renderer, R_Handle mat, const char* name, const float* val, int count)
 {
+    GLRenderer* r = (GLRenderer*)renderer;
+    GLMaterialTable* m = &r->materials;
+
+    const uint32_t i = handle_pool_lookup(&m->pool, mat);
+    if (i == HANDLE_POOL_INVALID || count <= 0) return;
+    const uint32_t sh = handle_pool_lookup(&r->shaders.pool, m->shader[i]);
+    if (sh == HANDLE_POOL_INVALID) return;
+
+    const uint32_t hash = gl_uniform_hash(name);
+    if (r->shaders.status[sh] == GL_SHADER_COMPILING) {
+        GLDeferredUniform* u = NULL;
+        for (uint32_t d = 0; d < r->deferred_uniforms.count && !u; ++d) {
+            GLDeferredUniform* other = d_array_at(&r->deferred_uniforms, d);
+            if (other->material == mat && other->hash == hash) u = other;
+        }
+        if (!u) u = d_array_push(&r->deferred_uniforms);
+        if (!u) return;
+        u->material = mat;
+        u->hash = hash;
+        u->count = (uint8_t)(count < GL_UNIFORM_MAX_FLOATS ? count : GL_UNIFORM_MAX_FLOATS);
+        memcpy(u->vals, val, u->count * sizeof(float));
+        return;
+    }
 
+    if (!material_stage_uniform(r, i, sh, hash, val, count))
+        fprintf(stderr, "material_set_uniform_f: more than %d uniforms outside %s, '%s' ignored\n", GL_MAX_LOOSE_UNIFORMS, GL_MATERIAL_BLOCK_NAME, name);
 }
 
 
@@ -136,11 +1541,19 @@ static const RendererAPI api = {
     .mesh_destroy = mesh_destroy,
     .shader_create = shader_create,
     .shader_destroy = shader_destroy,
+    .shader_status = shader_status,
     .texture_create = texture_create,
     .texture_destroy = texture_destroy,
+    .texture_format_supported = gl_texture_format_supported,
     .material_create = material_create,
     .material_destroy = material_destroy,
     .set_camera = set_camera,
+    .draw = gl_draw,
+    .draw_key = gl_draw_key,
+    .merge_draws = gl_merge_draws,
+    .get_stats = gl_get_stats,
+    .transient_alloc = gl_transient_alloc,
+    .draw_transient = gl_draw_transient,
     .material_set_uniform_f = material_set_uniform_f,
 };
 
@@ -0,0 +1,247 @@
+//
+// Created by Cain Martin on 2025/09/04.
+//
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include "culling.h"
+#include "vertex_format.h"
+#include "../core/handle_pool.h"
+#include "../core/memory.h"
+#include "../core/simd.h"
+
+#define BOUNDS_FIELDS 10 // Float arrays in a BoundsTable
+
+void frustum_from_camera(const EngineCamera* camera, Frustum* out)
+{
+    // Column major: m[c * 4 + r] = sum over k of projection[k * 4 + r] * view[c * 4 + k]
+    float m[16];
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k) sum += camera->projection[k * 4 + r] * camera->view[c * 4 + k];
+            m[c * 4 + r] = sum;
+        }
+    }
+
+    // Each plane is the last row plus or minus one of the others
+    for (int p = 0; p < 6; ++p) {
+        const int row = p / 2;
+        const float sign = p & 1 ? -1.0f : 1.0f;
+        float* plane = out->planes[p];
+        for (int c = 0; c < 4; ++c) plane[c] = m[c * 4 + 3] + sign * m[c * 4 + row];
+
+        const float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (int c = 0; c < 4; ++c) plane[c] /= length;
+        } else {
+            plane[0] = plane[1] = plane[2] = 0.0f;
+            plane[3] = 1.0f;
+        }
+    }
+}
+
+bool mesh_bounds_compute(const EngineMeshDesc* desc, EngineBounds* out)
+{
+    const bool packed = desc->packed_vertices != NULL;
+    VertexFormat format;
+    if (desc->vertex_count == 0 || (!packed && !desc->vertices)) return false;
+    if (packed && !vertex_format_get(&desc->layout, &format)) return false;
+
+    float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = 0; i < desc->vertex_count; ++i) {
+        float p[3];
+        if (packed) vertex_decode_position(&desc->layout, desc->packed_vertices, i, p);
+        else memcpy(p, desc->vertices[i].pos, sizeof p);
+        for (int c = 0; c < 3; ++c) {
+            lo[c] = p[c] < lo[c] ? p[c] : lo[c];
+            hi[c] = p[c] > hi[c] ? p[c] : hi[c];
+        }
+    }
+
+    float radius_sq = 0.0f;
+    for (int c = 0; c < 3; ++c) {
+        out->min[c] = lo[c];
+        out->max[c] = hi[c];
+        out->center[c] = (lo[c] + hi[c]) * 0.5f;
+    }
+    for (uint32_t i = 0; i < desc->vertex_count; ++i) {
+        float p[3];
+        if (packed) vertex_decode_position(&desc->layout, desc->packed_vertices, i, p);
+        else memcpy(p, desc->vertices[i].pos, sizeof p);
+        const float dx = p[0] - out->center[0], dy = p[1] - out->center[1], dz = p[2] - out->center[2];
+        const float d = dx * dx + dy * dy + dz * dz;
+        radius_sq = d > radius_sq ? d : radius_sq;
+    }
+    out->radius = sqrtf(radius_sq);
+    return true;
+}
+
+bool bounds_table_init(BoundsTable* table, uint32_t capacity)
+{
+    memset(table, 0, sizeof *table);
+    uint8_t* block = mem_calloc(capacity, sizeof(R_Handle) + BOUNDS_FIELDS * sizeof(float));
+    if (!block) return false;
+
+    float** fields[BOUNDS_FIELDS] = {
+        &table->center_x, &table->center_y, &table->center_z, &table->radius,
+        &table->min_x, &table->min_y, &table->min_z, &table->max_x, &table->max_y, &table->max_z,
+    };
+    table->handle = (R_Handle*)block;
+    for (int f = 0; f < BOUNDS_FIELDS; ++f)
+        *fields[f] = (float*)(block + (size_t)capacity * (sizeof(R_Handle) + (size_t)f * sizeof(float)));
+    table->capacity = capacity;
+    return true;
+}
+
+void bounds_table_free(BoundsTable* table)
+{
+    mem_free(table->handle);
+    memset(table, 0, sizeof *table);
+}
+
+void bounds_table_set(BoundsTable* table, R_Handle mesh, const EngineBounds* bounds)
+{
+    const uint32_t slot = handle_index(mesh);
+    if (!mesh || slot >= table->capacity) return;
+    table->handle[slot] = mesh;
+    table->center_x[slot] = bounds->center[0];
+    table->center_y[slot] = bounds->center[1];
+    table->center_z[slot] = bounds->center[2];
+    table->radius[slot] = bounds->radius;
+    table->min_x[slot] = bounds->min[0];
+    table->min_y[slot] = bounds->min[1];
+    table->min_z[slot] = bounds->min[2];
+    table->max_x[slot] = bounds->max[0];
+    table->max_y[slot] = bounds->max[1];
+    table->max_z[slot] = bounds->max[2];
+}
+
+void bounds_table_remove(BoundsTable* table, R_Handle mesh)
+{
+    const uint32_t slot = handle_index(mesh);
+    if (slot < table->capacity && table->handle[slot] == mesh) table->handle[slot] = 0;
+}
+
+bool bounds_table_get(const BoundsTable* table, R_Handle mesh, EngineBounds* out)
+{
+    const uint32_t slot = handle_index(mesh);
+    if (!mesh || slot >= table->capacity || table->handle[slot] != mesh) return false;
+    out->center[0] = table->center_x[slot];
+    out->center[1] = table->center_y[slot];
+    out->center[2] = table->center_z[slot];
+    out->radius = table->radius[slot];
+    out->min[0] = table->min_x[slot];
+    out->min[1] = table->min_y[slot];
+    out->min[2] = table->min_z[slot];
+    out->max[0] = table->max_x[slot];
+    out->max[1] = table->max_y[slot];
+    out->max[2] = table->max_z[slot];
+    return true;
+}
+
+static bool cull_one(const BoundsTable* table, const Frustum* frustum, const DrawItem* item)
+{
+    const uint32_t slot = handle_index(item->mesh);
+    if (slot >= table->capacity || table->handle[slot] != item->mesh) return true;
+
+    const float* m = item->model;
+    const float x = table->center_x[slot], y = table->center_y[slot], z = table->center_z[slot];
+    const float wx = m[0] * x + m[4] * y + m[8] * z + m[12];
+    const float wy = m[1] * x + m[5] * y + m[9] * z + m[13];
+    const float wz = m[2] * x + m[6] * y + m[10] * z + m[14];
+
+    float scale_sq = 0.0f;
+    for (int c = 0; c < 3; ++c) {
+        const float s = m[c * 4] * m[c * 4] + m[c * 4 + 1] * m[c * 4 + 1] + m[c * 4 + 2] * m[c * 4 + 2];
+        scale_sq = s > scale_sq ? s : scale_sq;
+    }
+    const float radius = table->radius[slot] * sqrtf(scale_sq);
+
+    for (int p = 0; p < 6; ++p) {
+        const float* plane = frustum->planes[p];
+        if (plane[0] * wx + plane[1] * wy + plane[2] * wz + plane[3] < -radius) return false;
+    }
+    return true;
+}
+
+#ifdef ENGINE_SSE2
+// Four items: the matrices are transposed so each register holds one element of all four,
+// and each bit of the returned mask is one item
+static uint32_t cull_four(const BoundsTable* table, const Frustum* frustum, const DrawItem* items)
+{
+    float cx[4], cy[4], cz[4], cr[4];
+    uint32_t unknown = 0;
+    for (int j = 0; j < 4; ++j) {
+        const uint32_t slot = handle_index(items[j].mesh);
+        if (slot < table->capacity && table->handle[slot] == items[j].mesh) {
+            cx[j] = table->center_x[slot];
+            cy[j] = table->center_y[slot];
+            cz[j] = table->center_z[slot];
+            cr[j] = table->radius[slot];
+        } else {
+            cx[j] = cy[j] = cz[j] = cr[j] = 0.0f;
+            unknown |= 1u << j;
+        }
+    }
+
+    __m128 col[4][4]; // [column][row], across the four items
+    for (int c = 0; c < 4; ++c) {
+        __m128 a = _mm_loadu_ps(items[0].model + c * 4), b = _mm_loadu_ps(items[1].model + c * 4);
+        __m128 d = _mm_loadu_ps(items[2].model + c * 4), e = _mm_loadu_ps(items[3].model + c * 4);
+        _MM_TRANSPOSE4_PS(a, b, d, e);
+        col[c][0] = a;
+        col[c][1] = b;
+        col[c][2] = d;
+        col[c][3] = e;
+    }
+
+    const __m128 x = _mm_loadu_ps(cx), y = _mm_loadu_ps(cy), z = _mm_loadu_ps(cz);
+    __m128 world[3];
+    for (int r = 0; r < 3; ++r) {
+        world[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col[0][r], x), _mm_mul_ps(col[1][r], y)),
+                              _mm_add_ps(_mm_mul_ps(col[2][r], z), col[3][r]));
+    }
+
+    __m128 scale_sq = _mm_setzero_ps();
+    for (int c = 0; c < 3; ++c) {
+        const __m128 s = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col[c][0], col[c][0]), _mm_mul_ps(col[c][1], col[c][1])),
+                                    _mm_mul_ps(col[c][2], col[c][2]));
+        scale_sq = _mm_max_ps(scale_sq, s);
+    }
+    const __m128 neg_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(_mm_loadu_ps(cr), _mm_sqrt_ps(scale_sq)));
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < 6; ++p) {
+        const float* plane = frustum->planes[p];
+        const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), world[0]),
+                                               _mm_mul_ps(_mm_set1_ps(plane[1]), world[1])),
+                                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[2]), world[2]), _mm_set1_ps(plane[3])));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(d, neg_radius));
+    }
+    return (uint32_t)_mm_movemask_ps(inside) | unknown;
+}
+#endif
+
+uint32_t cull_draws(const BoundsTable* table, const Frustum* frustum, const DrawItem* items, uint32_t count,
+                    uint8_t* visible)
+{
+    uint32_t visible_count = 0, i = 0;
+
+#ifdef ENGINE_SSE2
+    for (; i + 4 <= count; i += 4) {
+        const uint32_t mask = cull_four(table, frustum, items + i);
+        for (uint32_t j = 0; j < 4; ++j) {
+            visible[i + j] = (uint8_t)((mask >> j) & 1);
+            visible_count += (mask >> j) & 1;
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        visible[i] = cull_one(table, frustum, &items[i]) ? 1 : 0;
+        visible_count += visible[i];
+    }
+    return visible_count;
+}
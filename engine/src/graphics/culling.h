@@ -0,0 +1,60 @@
+//
+// Created by Cain Martin on 2025/09/04.
+//
+
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+#include "draw_queue.h"
+
+// Planes of the view volume, normals pointing in: a point p is inside a plane when
+// dot(xyz, p) + w >= 0. Normalized, so that value is a distance.
+typedef struct Frustum
+{
+    float planes[6][4]; // Left, right, bottom, top, near, far
+} Frustum;
+
+// Planes of projection * view (Gribb and Hartmann). A zero camera gives planes that
+// contain everything.
+void frustum_from_camera(const EngineCamera* camera, Frustum* out);
+
+// Local space AABB and the sphere around it, reaching the farthest vertex. False for a mesh
+// with no vertices or an invalid layout.
+bool mesh_bounds_compute(const EngineMeshDesc* desc, EngineBounds* out);
+
+// Mesh bounds by handle slot, one array per field, so the culling loop gathers only the
+// sphere fields. Entries carry the handle they were set for, so a stale or unknown handle
+// finds nothing rather than another mesh's bounds.
+typedef struct BoundsTable
+{
+    R_Handle* handle;   // 0 when the slot has no bounds
+    float*    center_x;
+    float*    center_y;
+    float*    center_z;
+    float*    radius;
+    float*    min_x;
+    float*    min_y;
+    float*    min_z;
+    float*    max_x;
+    float*    max_y;
+    float*    max_z;
+    uint32_t  capacity;
+} BoundsTable;
+
+bool bounds_table_init(BoundsTable* table, uint32_t capacity);
+void bounds_table_free(BoundsTable* table);
+void bounds_table_set(BoundsTable* table, R_Handle mesh, const EngineBounds* bounds);
+void bounds_table_remove(BoundsTable* table, R_Handle mesh);
+bool bounds_table_get(const BoundsTable* table, R_Handle mesh, EngineBounds* out);
+
+// Tests each item's bounding sphere, moved by its model matrix and grown by its largest axis
+// scale, against the frustum: visible[i] is 1 when some of it may be inside, 0 when it is
+// certainly outside. Meshes without bounds count as visible. Four items at a time with SSE2.
+// Returns the number visible.
+uint32_t cull_draws(const BoundsTable* table, const Frustum* frustum, const DrawItem* items, uint32_t count,
+                    uint8_t* visible);
+
+#endif //CULLING_H
@@ -0,0 +1,310 @@
+//
+// Created by Cain Martin on 2025/08/21.
+//
+
+#include <string.h>
+#include "draw_queue.h"
+#include "../core/arena.h"
+#include "../core/handle_pool.h"
+#include "../core/memory.h"
+
+#if R_MAX_MESHES > (1 << 14)
+#error "The sort key's mesh field must hold every mesh slot"
+#endif
+
+#define DRAW_QUEUE_MIN_CAPACITY 1024
+
+static bool draw_queue_grow(DrawQueue* queue, uint32_t capacity)
+{
+    uint64_t* keys = arena_alloc(queue->arena, capacity * sizeof(uint64_t), 8);
+    DrawItem* items = arena_alloc(queue->arena, capacity * sizeof(DrawItem), 16);
+    if (!keys || !items) return false;
+
+    // The old block stays in the arena until the frame resets - the reserve hint keeps
+    // this to the first frames of a bigger scene
+    if (queue->count) {
+        memcpy(keys, queue->keys, queue->count * sizeof(uint64_t));
+        memcpy(items, queue->items, queue->count * sizeof(DrawItem));
+    }
+
+    queue->keys = keys;
+    queue->items = items;
+    queue->capacity = capacity;
+    return true;
+}
+
+void draw_queue_begin(DrawQueue* queue, struct Arena* arena)
+{
+    if (queue->count > queue->reserve_hint) queue->reserve_hint = queue->count;
+
+    queue->arena = arena;
+    queue->keys = NULL;
+    queue->items = NULL;
+    queue->order = NULL;
+    queue->count = 0;
+    queue->capacity = 0;
+    queue->dropped = 0;
+
+    uint32_t capacity = DRAW_QUEUE_MIN_CAPACITY;
+    while (capacity < queue->reserve_hint) capacity *= 2;
+    draw_queue_grow(queue, capacity);
+}
+
+bool draw_queue_push(DrawQueue* queue, uint64_t key, R_Handle mesh, R_Handle material, const float model[16], uint32_t lod)
+{
+    if (queue->count == queue->capacity
+        && !draw_queue_grow(queue, queue->capacity ? queue->capacity * 2 : DRAW_QUEUE_MIN_CAPACITY)) {
+        queue->dropped++;
+        return false;
+    }
+
+    const uint32_t i = queue->count++;
+    queue->keys[i] = key;
+    DrawItem* item = &queue->items[i];
+    memcpy(item->model, model, sizeof item->model);
+    item->mesh = mesh;
+    item->material = material;
+    item->lod = lod;
+    return true;
+}
+
+bool draw_bucket_reserve(DrawBucket* bucket, uint32_t capacity)
+{
+    if (capacity <= bucket->capacity) return true;
+
+    uint32_t grown = bucket->capacity ? bucket->capacity : DRAW_QUEUE_MIN_CAPACITY;
+    while (grown < capacity) grown = grown > UINT32_MAX / 2 ? capacity : grown * 2;
+    uint64_t* keys = mem_alloc(grown * sizeof(uint64_t));
+    DrawItem* items = mem_alloc_aligned(grown * sizeof(DrawItem), 16);
+    if (!keys || !items) {
+        mem_free(keys);
+        mem_free_aligned(items);
+        return false;
+    }
+    if (bucket->count) {
+        memcpy(keys, bucket->keys, bucket->count * sizeof(uint64_t));
+        memcpy(items, bucket->items, bucket->count * sizeof(DrawItem));
+    }
+    mem_free(bucket->keys);
+    mem_free_aligned(bucket->items);
+    bucket->keys = keys;
+    bucket->items = items;
+    bucket->capacity = grown;
+    return true;
+}
+
+bool draw_bucket_push(DrawBucket* bucket, uint64_t key, R_Handle mesh, R_Handle material, const float model[16], uint32_t lod)
+{
+    if (bucket->count == bucket->capacity && !draw_bucket_reserve(bucket, bucket->count + 1)) {
+        bucket->rejected++;
+        return false;
+    }
+
+    const uint32_t i = bucket->count++;
+    bucket->keys[i] = key;
+    DrawItem* item = &bucket->items[i];
+    memcpy(item->model, model, sizeof item->model);
+    item->mesh = mesh;
+    item->material = material;
+    item->lod = lod;
+    return true;
+}
+
+void draw_bucket_free(DrawBucket* bucket)
+{
+    mem_free(bucket->keys);
+    mem_free_aligned(bucket->items);
+    memset(bucket, 0, sizeof *bucket);
+}
+
+uint32_t draw_queue_merge(DrawQueue* queue, DrawBucket* bucket)
+{
+    uint32_t n = bucket->count;
+    if (queue->count + n > queue->capacity) {
+        uint32_t capacity = queue->capacity ? queue->capacity : DRAW_QUEUE_MIN_CAPACITY;
+        while (capacity < queue->count + n) capacity *= 2;
+        if (!draw_queue_grow(queue, capacity)) n = queue->capacity - queue->count;
+    }
+
+    if (n) {
+        memcpy(queue->keys + queue->count, bucket->keys, n * sizeof(uint64_t));
+        memcpy(queue->items + queue->count, bucket->items, n * sizeof(DrawItem));
+        queue->count += n;
+    }
+    queue->dropped += bucket->count - n;
+    bucket->count = 0;
+    return n;
+}
+
+// LSD radix sort, 8 bits per pass. All histograms are built in one read of the keys, and
+// passes where every key shares the same byte are skipped - with a handful of shaders and
+// materials most of the high bytes are constant.
+static void radix_sort_u64(uint64_t* keys, uint32_t* values, uint64_t* tmp_keys, uint32_t* tmp_values, uint32_t n)
+{
+    uint32_t hist[8][256];
+    memset(hist, 0, sizeof hist);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        const uint64_t k = keys[i];
+        for (int b = 0; b < 8; ++b)
+            hist[b][(k >> (b * 8)) & 0xff]++;
+    }
+
+    uint64_t* src_k = keys;
+    uint32_t* src_v = values;
+    uint64_t* dst_k = tmp_keys;
+    uint32_t* dst_v = tmp_values;
+
+    for (int b = 0; b < 8; ++b) {
+        const int shift = b * 8;
+        if (hist[b][(src_k[0] >> shift) & 0xff] == n) continue;
+
+        uint32_t sum = 0;
+        for (int d = 0; d < 256; ++d) {
+            const uint32_t c = hist[b][d];
+            hist[b][d] = sum;
+            sum += c;
+        }
+
+        for (uint32_t i = 0; i < n; ++i) {
+            const uint32_t dst = hist[b][(src_k[i] >> shift) & 0xff]++;
+            dst_k[dst] = src_k[i];
+            dst_v[dst] = src_v[i];
+        }
+
+        uint64_t* tk = src_k; src_k = dst_k; dst_k = tk;
+        uint32_t* tv = src_v; src_v = dst_v; dst_v = tv;
+    }
+
+    if (src_k != keys) {
+        memcpy(keys, src_k, n * sizeof(uint64_t));
+        memcpy(values, src_v, n * sizeof(uint32_t));
+    }
+}
+
+void draw_queue_sort(DrawQueue* queue)
+{
+    const uint32_t n = queue->count;
+    if (n == 0) return;
+
+    queue->order = arena_alloc(queue->arena, n * sizeof(uint32_t), 4);
+    uint64_t* tmp_keys = arena_alloc(queue->arena, n * sizeof(uint64_t), 8);
+    uint32_t* tmp_values = arena_alloc(queue->arena, n * sizeof(uint32_t), 4);
+    if (!queue->order || !tmp_keys || !tmp_values) {
+        // Out of frame memory - draw unsorted rather than not at all
+        queue->order = (uint32_t*)queue->keys;
+        for (uint32_t i = 0; i < n; ++i) queue->order[i] = i;
+        queue->keys = NULL;
+        return;
+    }
+
+    for (uint32_t i = 0; i < n; ++i) queue->order[i] = i;
+    radix_sort_u64(queue->keys, queue->order, tmp_keys, tmp_values, n);
+}
+
+bool draw_queue_build_runs(DrawQueue* queue, DrawResolveFn resolve, void* backend, float (*instances)[16], DrawBatches* out)
+{
+    memset(out, 0, sizeof *out);
+    if (queue->count == 0) return true;
+
+    draw_queue_sort(queue);
+
+    out->runs = arena_alloc(queue->arena, queue->count * sizeof(DrawRun), 8);
+    out->instances = instances ? instances : arena_alloc(queue->arena, queue->count * sizeof(*out->instances), 16);
+    if (!out->runs) return false;
+
+    R_Handle prev_shader = 0, prev_material = 0, prev_mesh = 0;
+    uint32_t prev_lod = 0;
+
+    for (uint32_t n = 0; n < queue->count; ++n) {
+        const uint32_t item_index = queue->order[n];
+        const DrawItem* item = &queue->items[item_index];
+
+        DrawResolved res;
+        if (!resolve(backend, item, &res)) {
+            out->rejected++;
+            continue;
+        }
+
+        const bool same_state = res.shader_handle == prev_shader && item->material == prev_material && item->mesh == prev_mesh;
+        if (!same_state) out->batches++;
+        const bool same_lod = same_state && item->lod == prev_lod;
+
+        // Without instance storage everything falls back to one draw per item
+        const bool instanced = out->instances && res.instanced;
+        const uint32_t slot = out->instance_count++;
+
+        if (instanced && same_lod && !res.no_instancing) {
+            out->runs[out->run_count - 1].count++;
+        } else {
+            out->runs[out->run_count++] = (DrawRun){
+                .first = slot, .count = 1, .item = item_index,
+                .mesh = res.mesh, .material = res.material, .shader = res.shader,
+                .instanced = instanced
+            };
+        }
+
+        if (instanced) {
+            memcpy(out->instances[slot], item->model, sizeof out->instances[slot]);
+            out->any_instanced = true;
+        }
+
+        prev_shader = res.shader_handle;
+        prev_material = item->material;
+        prev_mesh = item->mesh;
+        prev_lod = item->lod;
+    }
+
+    return true;
+}
+
+uint64_t draw_key_make(
+    bool translucent,
+    uint32_t shader_slot,
+    uint32_t texture_hash,
+    uint32_t material_slot,
+    uint32_t mesh_slot,
+    float view_depth)
+{
+    // Positive IEEE floats order the same as their bit patterns, so the top 16 bits make a
+    // range-free depth bucket. Anything behind the eye collapses to 0.
+    uint32_t bits = 0;
+    if (view_depth > 0.0f) memcpy(&bits, &view_depth, sizeof bits);
+    const uint64_t depth = bits >> 16;
+
+    // Opaque depth only orders draws of the same state, so 13 bits of it are enough
+    if (!translucent) {
+        return ((uint64_t)(shader_slot & 0xfff) << 51)
+            | ((uint64_t)(texture_hash & 0xfff) << 39)
+            | ((uint64_t)(material_slot & 0xfff) << 27)
+            | ((uint64_t)(mesh_slot & 0x3fff) << 13)
+            | (depth >> 3);
+    }
+
+    // Translucent depth decides what blends over what and keeps all 16; the texture hash
+    // gives up the bits instead
+    return (1ull << 63)
+        | ((uint64_t)(0xffff - depth) << 47)
+        | ((uint64_t)(shader_slot & 0xfff) << 35)
+        | ((uint64_t)(texture_hash & 0x1ff) << 26)
+        | ((uint64_t)(material_slot & 0xfff) << 14)
+        | (uint64_t)(mesh_slot & 0x3fff);
+}
+
+float draw_key_view_depth(const float view[16], const float model[16])
+{
+    // -z of the model translation in view space (column major, right handed)
+    return -(view[2] * model[12] + view[6] * model[13] + view[10] * model[14] + view[14]);
+}
+
+uint32_t draw_key_texture_hash(const R_Handle* textures, int count)
+{
+    if (count == 0) return 0;
+
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < count; ++i) {
+        h ^= handle_index(textures[i]);
+        h *= 16777619u;
+    }
+    return (h ^ (h >> 12) ^ (h >> 24)) & 0xfff;
+}
@@ -0,0 +1,128 @@
+//
+// Created by Cain Martin on 2025/08/21.
+//
+
+#ifndef DRAW_QUEUE_H
+#define DRAW_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "renderer.h"
+
+struct Arena;
+
+typedef struct DrawItem
+{
+    float    model[16];
+    R_Handle mesh;
+    R_Handle material;
+    uint32_t lod;      // Level of the mesh's LOD chain, past the last draws the coarsest
+} DrawItem;
+
+// Per-frame list of draw submissions. Storage comes from the frame arena, so the queue
+// must be re-begun after the arena is reset.
+typedef struct DrawQueue
+{
+    struct Arena* arena;
+    uint64_t*     keys;
+    DrawItem*     items;
+    uint32_t*     order;        // Item indices in key order, valid after draw_queue_sort
+    uint32_t      count;
+    uint32_t      capacity;
+    uint32_t      reserve_hint; // Last frame's count, so steady state reserves once per frame
+    uint32_t      dropped;      // Submissions lost to arena exhaustion this frame
+} DrawQueue;
+
+// Draws recorded by one thread, for draw_queue_merge on the render thread. Storage is heap
+// memory kept across frames: once the capacity fits a frame, recording allocates nothing
+// and touches no memory another thread writes.
+typedef struct DrawBucket
+{
+    uint64_t* keys;
+    DrawItem* items;
+    uint32_t  count;
+    uint32_t  capacity;
+    uint32_t  rejected; // Stale handles, or no memory to grow
+} DrawBucket;
+
+// A backend's view of a queued draw, filled in by its resolve callback
+typedef struct DrawResolved
+{
+    uint32_t mesh;          // Backend table indices
+    uint32_t material;
+    uint32_t shader;
+    R_Handle shader_handle;
+    bool     instanced;     // The shader reads a_instance_model
+    bool     no_instancing; // The material opted out of merging
+} DrawResolved;
+
+// Returns false when any resource behind the draw has been destroyed since it was queued
+typedef bool (*DrawResolveFn)(void* backend, const DrawItem* item, DrawResolved* out);
+
+// Sorted draws submitted with one draw call. Instanced runs cover consecutive draws of the
+// same mesh, LOD and material; everything else is a run of one.
+typedef struct DrawRun
+{
+    uint32_t first;    // Position in sorted order, also the slot in DrawBatches.instances
+    uint32_t count;
+    uint32_t item;     // Queue item of the first draw
+    uint32_t mesh;
+    uint32_t material;
+    uint32_t shader;
+    bool     instanced;
+} DrawRun;
+
+typedef struct DrawBatches
+{
+    DrawRun*  runs;
+    uint32_t  run_count;
+    float     (*instances)[16]; // Model matrices of instanced draws, in sorted order
+    uint32_t  instance_count;   // Slots spanned, including those of non-instanced draws
+    bool      any_instanced;
+    uint32_t  batches;          // Runs of draws sharing shader, material and mesh
+    uint32_t  rejected;         // Draws whose resources died before the flush
+} DrawBatches;
+
+void draw_queue_begin(DrawQueue* queue, struct Arena* arena);
+bool draw_queue_push(DrawQueue* queue, uint64_t key, R_Handle mesh, R_Handle material, const float model[16], uint32_t lod);
+
+// Grows the bucket to hold at least capacity draws, keeping those recorded. Reserving before
+// recording keeps pushes from allocating on whichever thread the bucket is filled.
+bool draw_bucket_reserve(DrawBucket* bucket, uint32_t capacity);
+bool draw_bucket_push(DrawBucket* bucket, uint64_t key, R_Handle mesh, R_Handle material, const float model[16], uint32_t lod);
+void draw_bucket_free(DrawBucket* bucket);
+
+// Appends the bucket's draws to the queue in one copy and empties the bucket. Returns the
+// number merged; draws that did not fit count as queue->dropped.
+uint32_t draw_queue_merge(DrawQueue* queue, DrawBucket* bucket);
+
+// Radix sorts the submissions by key into queue->order
+void draw_queue_sort(DrawQueue* queue);
+
+// Sorts the queue, resolves every draw through the backend once and splits the result into
+// runs, packing instance matrices as it goes. Matrices go to instances when given (room for
+// queue->count of them, e.g. mapped GPU memory, written in order and never read), otherwise
+// to the frame arena like the rest of the storage; returns false when the arena is exhausted.
+bool draw_queue_build_runs(DrawQueue* queue, DrawResolveFn resolve, void* backend, float (*instances)[16], DrawBatches* out);
+
+// Sort keys, most significant field first:
+//   opaque:      [63] 0 | [62..51] shader | [50..39] textures | [38..27] material | [26..13] mesh | [12..0] depth
+//   translucent: [63] 1 | [62..47] inverted depth | [46..35] shader | [34..26] textures | [25..14] material | [13..0] mesh
+// Opaque draws group by state and go front to back within a group; translucent draws go
+// back to front. Fields hold handle slot indices and are truncated, so equal fields
+// suggest but do not guarantee equal state - replay still compares the real handles.
+uint64_t draw_key_make(
+    bool translucent,
+    uint32_t shader_slot,
+    uint32_t texture_hash,
+    uint32_t material_slot,
+    uint32_t mesh_slot,
+    float view_depth);
+
+// View space distance of the model's origin, from a column major view matrix
+float draw_key_view_depth(const float view[16], const float model[16]);
+
+// Folds a material's texture slots into a sort key field
+uint32_t draw_key_texture_hash(const R_Handle* textures, int count);
+
+#endif //DRAW_QUEUE_H
@@ -0,0 +1,166 @@
+//
+// Created by Cain Martin on 2025/09/08.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "mesh_lod.h"
+#include "../core/handle_pool.h"
+#include "../core/memory.h"
+
+bool mesh_lods_valid(const EngineMeshDesc* desc, const char* caller)
+{
+    const EngineMeshLods* lods = &desc->lods;
+    if (lods->count == 0) return true;
+    if (lods->count >= ENGINE_MESH_MAX_LODS || !lods->indices) {
+        fprintf(stderr, "%s: %u LODs, at most %d with indices\n", caller, lods->count, ENGINE_MESH_MAX_LODS - 1);
+        return false;
+    }
+    for (uint32_t l = 0; l < lods->count; ++l) {
+        if (lods->indices_count[l] == 0 || lods->indices_count[l] % 3 != 0) {
+            fprintf(stderr, "%s: LOD %u has %u indices, not whole triangles\n", caller, l + 1, lods->indices_count[l]);
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t mesh_lod_ranges(const EngineMeshDesc* desc, MeshLodRanges* out)
+{
+    out->end[0] = desc->indices_count;
+    out->count = 1 + desc->lods.count;
+    for (uint32_t l = 0; l < desc->lods.count; ++l)
+        out->end[l + 1] = out->end[l] + desc->lods.indices_count[l];
+    return out->end[out->count - 1];
+}
+
+static void write_indices(const uint32_t* indices, uint32_t count, void* out, uint32_t index_size)
+{
+    if (index_size == 4) {
+        memcpy(out, indices, count * sizeof(uint32_t));
+        return;
+    }
+    uint16_t* short_indices = out;
+    for (uint32_t n = 0; n < count; ++n) short_indices[n] = (uint16_t)indices[n];
+}
+
+void mesh_lod_write_indices(const EngineMeshDesc* desc, void* out, uint32_t index_size)
+{
+    write_indices(desc->indices, desc->indices_count, out, index_size);
+    uint8_t* dst = (uint8_t*)out + (size_t)desc->indices_count * index_size;
+    const uint32_t* src = desc->lods.indices;
+    for (uint32_t l = 0; l < desc->lods.count; ++l) {
+        write_indices(src, desc->lods.indices_count[l], dst, index_size);
+        dst += (size_t)desc->lods.indices_count[l] * index_size;
+        src += desc->lods.indices_count[l];
+    }
+}
+
+void lod_camera_from(const EngineCamera* camera, int fb_height, float error_pixels, LodCamera* out)
+{
+    memset(out, 0, sizeof *out);
+    const float* p = camera->projection;
+    if (fb_height <= 0 || p[5] == 0.0f) return;
+
+    // Column major, right handed: view space -z is the distance in front of the eye
+    for (int c = 0; c < 4; ++c) out->depth[c] = -camera->view[c * 4 + 2];
+
+    // p[5] maps a vertical unit at distance 1 (or anywhere, orthographic) to half the viewport
+    out->units_per_px = 2.0f / (fabsf(p[5]) * (float)fb_height);
+    out->limit = out->units_per_px * (error_pixels > 0.0f ? error_pixels : 1.0f);
+    out->perspective = p[11] != 0.0f;
+    out->valid = true;
+}
+
+bool lod_table_init(LodTable* table, uint32_t capacity)
+{
+    table->entries = mem_calloc(capacity, sizeof(LodEntry));
+    table->capacity = table->entries ? capacity : 0;
+    return table->entries != NULL;
+}
+
+void lod_table_free(LodTable* table)
+{
+    mem_free(table->entries);
+    memset(table, 0, sizeof *table);
+}
+
+void lod_table_set(LodTable* table, R_Handle mesh, const EngineMeshDesc* desc, const EngineBounds* bounds)
+{
+    const uint32_t slot = handle_index(mesh);
+    if (!mesh || slot >= table->capacity) return;
+
+    LodEntry* entry = &table->entries[slot];
+    memset(entry, 0, sizeof *entry);
+    entry->handle = mesh;
+    entry->count = 1 + desc->lods.count;
+    entry->triangles[0] = desc->indices_count / 3;
+    for (uint32_t l = 0; l < desc->lods.count; ++l) {
+        entry->error[l + 1] = desc->lods.error[l];
+        entry->triangles[l + 1] = desc->lods.indices_count[l] / 3;
+    }
+    if (bounds) {
+        memcpy(entry->center, bounds->center, sizeof entry->center);
+        entry->radius = bounds->radius;
+    } else {
+        entry->radius = -1.0f;
+    }
+}
+
+void lod_table_remove(LodTable* table, R_Handle mesh)
+{
+    const uint32_t slot = handle_index(mesh);
+    if (slot < table->capacity && table->entries[slot].handle == mesh) table->entries[slot].handle = 0;
+}
+
+static const LodEntry* lod_entry(const LodTable* table, R_Handle mesh)
+{
+    const uint32_t slot = handle_index(mesh);
+    if (!mesh || slot >= table->capacity || table->entries[slot].handle != mesh) return NULL;
+    return &table->entries[slot];
+}
+
+uint32_t lod_select(const LodTable* table, const LodCamera* camera, R_Handle mesh, const float model[16], uint32_t previous)
+{
+    const LodEntry* entry = lod_entry(table, mesh);
+    if (!entry || entry->count == 1 || entry->radius < 0.0f || !camera->valid) return 0;
+
+    const float* m = model;
+    float scale_sq = 0.0f;
+    for (int c = 0; c < 3; ++c) {
+        const float s = m[c * 4] * m[c * 4] + m[c * 4 + 1] * m[c * 4 + 1] + m[c * 4 + 2] * m[c * 4 + 2];
+        scale_sq = s > scale_sq ? s : scale_sq;
+    }
+    const float scale = sqrtf(scale_sq);
+
+    // Errors are compared in mesh units: the limit grows with distance and shrinks with scale
+    float allowed = camera->limit;
+    if (camera->perspective) {
+        const float x = entry->center[0], y = entry->center[1], z = entry->center[2];
+        const float wx = m[0] * x + m[4] * y + m[8] * z + m[12];
+        const float wy = m[1] * x + m[5] * y + m[9] * z + m[13];
+        const float wz = m[2] * x + m[6] * y + m[10] * z + m[14];
+        const float* d = camera->depth;
+        const float distance = d[0] * wx + d[1] * wy + d[2] * wz + d[3] - entry->radius * scale;
+        if (distance <= 0.0f) return 0; // The camera is inside or level with the bounds
+        allowed *= distance;
+    }
+    allowed = scale > 0.0f ? allowed / scale : INFINITY;
+
+    uint32_t lod = 0;
+    while (lod + 1 < entry->count && entry->error[lod + 1] <= allowed) lod++;
+
+    if (previous < lod) {
+        const float keep = allowed * (1.0f - LOD_HYSTERESIS);
+        while (lod > previous && entry->error[lod] > keep) lod--;
+    }
+    return lod;
+}
+
+uint32_t lod_table_triangles(const LodTable* table, R_Handle mesh, uint32_t lod)
+{
+    const LodEntry* entry = lod_entry(table, mesh);
+    if (!entry) return 0;
+    return entry->triangles[lod < entry->count ? lod : entry->count - 1];
+}
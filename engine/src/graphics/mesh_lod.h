@@ -0,0 +1,87 @@
+//
+// Created by Cain Martin on 2025/09/08.
+//
+
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+#include "renderer.h"
+
+#define LOD_HYSTERESIS 0.25f       // Share of the error limit a coarser level must leave spare
+#define LOD_NONE       UINT32_MAX  // No earlier level, so no hysteresis
+
+// Where each level of a mesh sits in its index buffer, LOD 0 first: level l is
+// [end[l - 1], end[l]), starting at 0
+typedef struct MeshLodRanges
+{
+    uint32_t end[ENGINE_MESH_MAX_LODS];
+    uint32_t count;
+} MeshLodRanges;
+
+// False, with the reason on stderr, when desc->lods is malformed: too many levels, no
+// indices, or a level that is empty or not whole triangles
+bool     mesh_lods_valid(const EngineMeshDesc* desc, const char* caller);
+
+// Returns the index count of all levels together
+uint32_t mesh_lod_ranges(const EngineMeshDesc* desc, MeshLodRanges* out);
+
+// Writes every level back to back as index_size (2 or 4) byte indices, room for the total
+// mesh_lod_ranges gives
+void     mesh_lod_write_indices(const EngineMeshDesc* desc, void* out, uint32_t index_size);
+
+// Levels past the last draw the coarsest
+static inline void mesh_lod_range(const MeshLodRanges* ranges, uint32_t lod, uint32_t* first, uint32_t* count)
+{
+    if (lod >= ranges->count) lod = ranges->count - 1;
+    *first = lod ? ranges->end[lod - 1] : 0;
+    *count = ranges->end[lod] - *first;
+}
+
+// The camera as selection needs it, taken once per frame and camera change
+typedef struct LodCamera
+{
+    float depth[4];      // Row of the view matrix giving -z, the distance along the view direction
+    float units_per_px;  // Mesh units one pixel covers at distance 1, or at any distance when orthographic
+    float limit;         // EngineConfig.lod_error_pixels in those units, units_per_px * pixels
+    bool  perspective;
+    bool  valid;         // False before a camera or framebuffer is known; everything draws LOD 0
+} LodCamera;
+
+void lod_camera_from(const EngineCamera* camera, int fb_height, float error_pixels, LodCamera* out);
+
+// Every mesh's triangles per level and, for meshes with a chain and bounds, what selection
+// needs, by handle slot. One entry per mesh keeps a draw's lookup to a couple of cache lines.
+typedef struct LodEntry
+{
+    R_Handle handle;                          // 0 when the slot is free
+    uint32_t count;                           // Levels, LOD 0 included
+    float    center[3];                       // Bounding sphere in mesh space
+    float    radius;                          // Negative without bounds, which pins LOD 0
+    float    error[ENGINE_MESH_MAX_LODS];     // error[0] is 0
+    uint32_t triangles[ENGINE_MESH_MAX_LODS];
+} LodEntry;
+
+typedef struct LodTable
+{
+    LodEntry* entries;
+    uint32_t  capacity;
+} LodTable;
+
+bool     lod_table_init(LodTable* table, uint32_t capacity);
+void     lod_table_free(LodTable* table);
+void     lod_table_set(LodTable* table, R_Handle mesh, const EngineMeshDesc* desc, const EngineBounds* bounds);
+void     lod_table_remove(LodTable* table, R_Handle mesh);
+
+// The coarsest level whose error, projected at the point of the bounding sphere nearest the
+// camera and grown by the model's largest axis scale, stays within the camera's limit. Going
+// coarser than previous needs LOD_HYSTERESIS of the limit to spare; going finer does not.
+// Reads only, so any thread may select while no mesh is created or destroyed.
+uint32_t lod_select(const LodTable* table, const LodCamera* camera, R_Handle mesh, const float model[16], uint32_t previous);
+
+// Triangles drawn at a level, clamped like mesh_lod_range; 0 for an unknown mesh
+uint32_t lod_table_triangles(const LodTable* table, R_Handle mesh, uint32_t lod);
+
+#endif //MESH_LOD_H
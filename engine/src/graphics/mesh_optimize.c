@@ -0,0 +1,362 @@
+//
+// Created by Cain Martin on 2025/08/30.
+//
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mesh_optimize.h"
+#include "../core/hash_map.h"
+#include "../core/memory.h"
+
+#define MESH_NONE UINT32_MAX
+
+static uint64_t hash_vertex(const EngineVertex* v)
+{
+    uint32_t words[sizeof(EngineVertex) / 4];
+    memcpy(words, v, sizeof words);
+    uint64_t h = 0;
+    for (size_t i = 0; i < sizeof words / sizeof words[0]; ++i) h = hash_u64(h ^ words[i]);
+    return h;
+}
+
+uint32_t mesh_dedup_vertices(EngineVertex* vertices, uint32_t vertex_count, uint32_t* indices, uint32_t index_count)
+{
+    // Open addressing over the unique vertices written so far, compared bytewise
+    uint32_t capacity = 16;
+    while (capacity < vertex_count * 2) capacity *= 2;
+    uint32_t* table = mem_alloc(capacity * sizeof(uint32_t));
+    uint32_t* remap = mem_alloc(vertex_count * sizeof(uint32_t));
+    if (!table || !remap) {
+        mem_free(table);
+        mem_free(remap);
+        return vertex_count;
+    }
+    memset(table, 0xff, capacity * sizeof(uint32_t));
+
+    uint32_t unique = 0;
+    for (uint32_t v = 0; v < vertex_count; ++v) {
+        uint32_t slot = (uint32_t)hash_vertex(&vertices[v]) & (capacity - 1);
+        while (table[slot] != MESH_NONE && memcmp(&vertices[table[slot]], &vertices[v], sizeof(EngineVertex)) != 0)
+            slot = (slot + 1) & (capacity - 1);
+
+        if (table[slot] == MESH_NONE) {
+            // unique <= v, so the slot being overwritten has already been read
+            vertices[unique] = vertices[v];
+            table[slot] = unique++;
+        }
+        remap[v] = table[slot];
+    }
+
+    for (uint32_t i = 0; i < index_count; ++i) indices[i] = remap[indices[i]];
+
+    mem_free(table);
+    mem_free(remap);
+    return unique;
+}
+
+// Vertex to triangle adjacency in compressed rows
+typedef struct MeshAdjacency
+{
+    uint32_t* offsets;   // vertex_count + 1
+    uint32_t* triangles;
+} MeshAdjacency;
+
+static bool adjacency_build(MeshAdjacency* adj, const uint32_t* indices, uint32_t index_count, uint32_t vertex_count)
+{
+    adj->offsets = mem_calloc(vertex_count + 1, sizeof(uint32_t));
+    adj->triangles = mem_alloc(index_count * sizeof(uint32_t));
+    if (!adj->offsets || !adj->triangles) return false;
+
+    for (uint32_t i = 0; i < index_count; ++i) adj->offsets[indices[i] + 1]++;
+    for (uint32_t v = 0; v < vertex_count; ++v) adj->offsets[v + 1] += adj->offsets[v];
+
+    // Fill using offsets as cursors, then shift them back into place
+    for (uint32_t i = 0; i < index_count; ++i) adj->triangles[adj->offsets[indices[i]]++] = i / 3;
+    for (uint32_t v = vertex_count; v > 0; --v) adj->offsets[v] = adj->offsets[v - 1];
+    adj->offsets[0] = 0;
+    return true;
+}
+
+static void adjacency_free(MeshAdjacency* adj)
+{
+    mem_free(adj->offsets);
+    mem_free(adj->triangles);
+}
+
+bool mesh_optimize_vertex_cache(uint32_t* indices, uint32_t index_count, uint32_t vertex_count)
+{
+    const uint32_t triangle_count = index_count / 3;
+    const uint32_t k = MESH_CACHE_SIZE;
+
+    MeshAdjacency adj;
+    uint32_t* live = mem_alloc(vertex_count * sizeof(uint32_t));      // Triangles not yet emitted
+    uint32_t* stamp = mem_calloc(vertex_count, sizeof(uint32_t));     // Time each vertex entered the cache
+    uint32_t* dead_end = mem_alloc(index_count * sizeof(uint32_t));   // Recently used vertices, a stack
+    uint32_t* candidates = mem_alloc(index_count * sizeof(uint32_t));
+    uint8_t* emitted = mem_calloc(triangle_count, 1);
+    uint32_t* output = mem_alloc(index_count * sizeof(uint32_t));
+    const bool ok = adjacency_build(&adj, indices, index_count, vertex_count)
+        && live && stamp && dead_end && candidates && emitted && output;
+
+    if (ok) {
+        for (uint32_t v = 0; v < vertex_count; ++v) live[v] = adj.offsets[v + 1] - adj.offsets[v];
+
+        uint32_t written = 0, dead_top = 0, cursor = 0;
+        uint32_t time = k + 1;
+        uint32_t fan = 0;
+        while (fan < vertex_count && live[fan] == 0) ++fan;
+
+        while (fan < vertex_count) {
+            // Emit every remaining triangle around the fanning vertex
+            uint32_t candidate_count = 0;
+            for (uint32_t a = adj.offsets[fan]; a < adj.offsets[fan + 1]; ++a) {
+                const uint32_t t = adj.triangles[a];
+                if (emitted[t]) continue;
+                emitted[t] = 1;
+
+                for (int c = 0; c < 3; ++c) {
+                    const uint32_t v = indices[t * 3 + c];
+                    output[written++] = v;
+                    dead_end[dead_top++] = v;
+                    candidates[candidate_count++] = v;
+                    live[v]--;
+                    if (time - stamp[v] > k) stamp[v] = time++;
+                }
+            }
+
+            // Next fan: the candidate that stays cached longest while its triangles go out
+            uint32_t next = MESH_NONE;
+            uint32_t best = 0;
+            for (uint32_t c = 0; c < candidate_count; ++c) {
+                const uint32_t v = candidates[c];
+                if (live[v] == 0) continue;
+                uint32_t priority = 0;
+                if (time - stamp[v] + 2 * live[v] <= k) priority = time - stamp[v];
+                if (next == MESH_NONE || priority > best) {
+                    best = priority;
+                    next = v;
+                }
+            }
+
+            if (next == MESH_NONE) {
+                // Dead end: the most recent vertex with work left, else the next unfinished one
+                while (dead_top && next == MESH_NONE) {
+                    const uint32_t v = dead_end[--dead_top];
+                    if (live[v]) next = v;
+                }
+                if (next == MESH_NONE) {
+                    while (cursor < vertex_count && live[cursor] == 0) ++cursor;
+                    next = cursor;
+                }
+            }
+            fan = next;
+        }
+
+        memcpy(indices, output, index_count * sizeof(uint32_t));
+    }
+
+    adjacency_free(&adj);
+    mem_free(live);
+    mem_free(stamp);
+    mem_free(dead_end);
+    mem_free(candidates);
+    mem_free(emitted);
+    mem_free(output);
+    return ok;
+}
+
+typedef struct MeshCluster
+{
+    uint32_t first;    // Triangle
+    uint32_t count;
+    float    sort_key;
+} MeshCluster;
+
+static int compare_cluster(const void* a, const void* b)
+{
+    const float x = ((const MeshCluster*)a)->sort_key, y = ((const MeshCluster*)b)->sort_key;
+    return (x < y) - (x > y); // Descending
+}
+
+// Triangle offsets where the order can be cut cheaply, see mesh_optimize_overdraw
+static uint32_t find_clusters(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count, float threshold, uint32_t* clusters)
+{
+    float acmr, atvr;
+    mesh_cache_stats(indices, index_count, vertex_count, &acmr, &atvr);
+    const float limit = acmr * threshold;
+
+    uint32_t cache[MESH_CACHE_SIZE];
+    uint32_t head = 0, count = 0, cluster_misses = 0, cluster_first = 0;
+    memset(cache, 0xff, sizeof cache);
+
+    for (uint32_t t = 0; t < index_count / 3; ++t) {
+        uint32_t misses = 0;
+        for (int c = 0; c < 3; ++c) {
+            const uint32_t v = indices[t * 3 + c];
+            bool hit = false;
+            for (uint32_t i = 0; i < MESH_CACHE_SIZE && !hit; ++i) hit = cache[i] == v;
+            if (hit) continue;
+            cache[head] = v;
+            head = (head + 1) % MESH_CACHE_SIZE;
+            misses++;
+        }
+
+        const bool cold = misses == 3;
+        if (t == 0 || (cold && (float)cluster_misses <= limit * (float)(t - cluster_first))) {
+            clusters[count++] = t;
+            cluster_first = t;
+            cluster_misses = 0;
+        }
+        cluster_misses += misses;
+    }
+    return count;
+}
+
+bool mesh_optimize_overdraw(uint32_t* indices, uint32_t index_count, const EngineVertex* vertices,
+                            uint32_t vertex_count, float threshold)
+{
+    const uint32_t triangle_count = index_count / 3;
+
+    uint32_t* clusters = mem_alloc(triangle_count * sizeof(uint32_t));
+    MeshCluster* sorted = mem_alloc(triangle_count * sizeof(MeshCluster));
+    uint32_t* output = mem_alloc(index_count * sizeof(uint32_t));
+    const uint32_t cluster_count = clusters && sorted && output
+        ? find_clusters(indices, index_count, vertex_count, threshold, clusters) : 0;
+    if (cluster_count < 2) {
+        mem_free(clusters);
+        mem_free(sorted);
+        mem_free(output);
+        return clusters && sorted && output;
+    }
+
+    // Area weighted centroid of the whole mesh
+    float mesh_centre[3] = { 0.0f, 0.0f, 0.0f };
+    float mesh_area = 0.0f;
+    for (uint32_t t = 0; t < triangle_count; ++t) {
+        const float* p0 = vertices[indices[t * 3]].pos;
+        const float* p1 = vertices[indices[t * 3 + 1]].pos;
+        const float* p2 = vertices[indices[t * 3 + 2]].pos;
+        const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        const float area = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (int c = 0; c < 3; ++c) mesh_centre[c] += (p0[c] + p1[c] + p2[c]) * area;
+        mesh_area += area;
+    }
+    for (int c = 0; c < 3; ++c) mesh_centre[c] = mesh_area > 0.0f ? mesh_centre[c] / (3.0f * mesh_area) : 0.0f;
+
+    // Clusters whose surface faces away from the centre are drawn first (Sander et al.)
+    for (uint32_t c = 0; c < cluster_count; ++c) {
+        MeshCluster* cluster = &sorted[c];
+        cluster->first = clusters[c];
+        cluster->count = (c + 1 < cluster_count ? clusters[c + 1] : triangle_count) - cluster->first;
+
+        float centre[3] = { 0.0f, 0.0f, 0.0f }, normal[3] = { 0.0f, 0.0f, 0.0f }, area = 0.0f;
+        for (uint32_t t = cluster->first; t < cluster->first + cluster->count; ++t) {
+            const float* p0 = vertices[indices[t * 3]].pos;
+            const float* p1 = vertices[indices[t * 3 + 1]].pos;
+            const float* p2 = vertices[indices[t * 3 + 2]].pos;
+            const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            const float a = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int i = 0; i < 3; ++i) {
+                centre[i] += (p0[i] + p1[i] + p2[i]) * a;
+                normal[i] += n[i];
+            }
+            area += a;
+        }
+
+        float key = 0.0f;
+        const float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (area > 0.0f && length > 0.0f) {
+            for (int i = 0; i < 3; ++i) key += (centre[i] / (3.0f * area) - mesh_centre[i]) * normal[i] / length;
+        }
+        cluster->sort_key = key;
+    }
+
+    qsort(sorted, cluster_count, sizeof(MeshCluster), compare_cluster);
+
+    uint32_t written = 0;
+    for (uint32_t c = 0; c < cluster_count; ++c) {
+        memcpy(output + written, indices + sorted[c].first * 3, sorted[c].count * 3 * sizeof(uint32_t));
+        written += sorted[c].count * 3;
+    }
+    memcpy(indices, output, index_count * sizeof(uint32_t));
+
+    mem_free(clusters);
+    mem_free(sorted);
+    mem_free(output);
+    return true;
+}
+
+uint32_t mesh_optimize_vertex_fetch(EngineVertex* vertices, uint32_t vertex_count, uint32_t* indices, uint32_t index_count)
+{
+    uint32_t* remap = mem_alloc(vertex_count * sizeof(uint32_t));
+    EngineVertex* reordered = mem_alloc(vertex_count * sizeof(EngineVertex));
+    if (!remap || !reordered) {
+        mem_free(remap);
+        mem_free(reordered);
+        return vertex_count;
+    }
+    memset(remap, 0xff, vertex_count * sizeof(uint32_t));
+
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < index_count; ++i) {
+        const uint32_t v = indices[i];
+        if (remap[v] == MESH_NONE) {
+            remap[v] = next;
+            reordered[next++] = vertices[v];
+        }
+        indices[i] = remap[v];
+    }
+    memcpy(vertices, reordered, next * sizeof(EngineVertex));
+
+    mem_free(remap);
+    mem_free(reordered);
+    return next;
+}
+
+void mesh_cache_stats(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count, float* out_acmr, float* out_atvr)
+{
+    uint32_t cache[MESH_CACHE_SIZE];
+    uint32_t head = 0, misses = 0;
+    memset(cache, 0xff, sizeof cache);
+
+    for (uint32_t i = 0; i < index_count; ++i) {
+        bool hit = false;
+        for (uint32_t c = 0; c < MESH_CACHE_SIZE && !hit; ++c) hit = cache[c] == indices[i];
+        if (hit) continue;
+        cache[head] = indices[i];
+        head = (head + 1) % MESH_CACHE_SIZE;
+        misses++;
+    }
+
+    *out_acmr = index_count >= 3 ? (float)misses / (float)(index_count / 3) : 0.0f;
+    *out_atvr = vertex_count ? (float)misses / (float)vertex_count : 0.0f;
+}
+
+uint32_t mesh_optimize(EngineVertex* vertices, uint32_t vertex_count, uint32_t* indices, uint32_t index_count,
+                       EngineMeshOptimizeStats* out_stats)
+{
+    if (vertex_count == 0 || index_count == 0 || index_count % 3 != 0) return 0;
+    for (uint32_t i = 0; i < index_count; ++i)
+        if (indices[i] >= vertex_count) return 0;
+
+    EngineMeshOptimizeStats stats;
+    stats.vertices_before = vertex_count;
+    mesh_cache_stats(indices, index_count, vertex_count, &stats.acmr_before, &stats.atvr_before);
+
+    vertex_count = mesh_dedup_vertices(vertices, vertex_count, indices, index_count);
+
+    if (mesh_optimize_vertex_cache(indices, index_count, vertex_count))
+        mesh_optimize_overdraw(indices, index_count, vertices, vertex_count, MESH_OVERDRAW_THRESHOLD);
+
+    vertex_count = mesh_optimize_vertex_fetch(vertices, vertex_count, indices, index_count);
+
+    stats.vertices_after = vertex_count;
+    mesh_cache_stats(indices, index_count, vertex_count, &stats.acmr_after, &stats.atvr_after);
+    if (out_stats) *out_stats = stats;
+    return vertex_count;
+}
@@ -0,0 +1,43 @@
+//
+// Created by Cain Martin on 2025/08/30.
+//
+
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+
+#define MESH_CACHE_SIZE         16    // FIFO entries assumed by the optimizer and the statistics
+#define MESH_OVERDRAW_THRESHOLD 1.05f // Cache efficiency traded for overdraw, see mesh_optimize_overdraw
+
+// Offline and load time passes over indexed triangle lists. Each works in place and
+// allocates its scratch through core/memory; those that can fail return false and leave
+// their input untouched.
+
+// Merges bitwise identical vertices and rewrites indices to match. Returns the new count.
+uint32_t mesh_dedup_vertices(EngineVertex* vertices, uint32_t vertex_count, uint32_t* indices, uint32_t index_count);
+
+// Tipsify (Sander et al. 2007): greedy fanning around the cached vertex that will stay in
+// the cache longest, falling back to recently used vertices at dead ends
+bool     mesh_optimize_vertex_cache(uint32_t* indices, uint32_t index_count, uint32_t vertex_count);
+
+// Run after the cache pass. Cuts the triangle order into clusters where the cache is cold
+// anyway (all three vertices miss) and the cluster so far has an ACMR within threshold of
+// the whole mesh, e.g. 1.05, then draws clusters outside-in - those facing away from the
+// mesh centre first - so near surfaces tend to occlude the rest.
+bool     mesh_optimize_overdraw(uint32_t* indices, uint32_t index_count, const EngineVertex* vertices,
+                                uint32_t vertex_count, float threshold);
+
+// Renumbers vertices in first use order and drops unreferenced ones. Returns the new count.
+uint32_t mesh_optimize_vertex_fetch(EngineVertex* vertices, uint32_t vertex_count, uint32_t* indices, uint32_t index_count);
+
+// Simulates a MESH_CACHE_SIZE FIFO. ACMR is misses per triangle, ATVR misses per vertex.
+void     mesh_cache_stats(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count, float* out_acmr, float* out_atvr);
+
+// All of the above, in order. Returns the final vertex count, 0 on failure.
+uint32_t mesh_optimize(EngineVertex* vertices, uint32_t vertex_count, uint32_t* indices, uint32_t index_count,
+                       EngineMeshOptimizeStats* out_stats);
+
+#endif //MESH_OPTIMIZE_H
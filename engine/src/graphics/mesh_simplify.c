@@ -0,0 +1,424 @@
+//
+// Created by Cain Martin on 2025/09/08.
+//
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mesh_simplify.h"
+#include "mesh_optimize.h"
+#include "../core/hash_map.h"
+#include "../core/memory.h"
+
+#define SIMPLIFY_NONE           UINT32_MAX
+#define SIMPLIFY_NO_EDGE        UINT64_MAX
+#define SIMPLIFY_MAX_NEIGHBOURS 32    // Collapses around busier vertices are skipped
+#define SIMPLIFY_MIN_DOT        1e-2f // Least cosine between a triangle's normals before and after a collapse
+#define LOD_MIN_TRIANGLES       16    // No level below this
+#define LOD_MIN_REDUCTION       0.75f // A level keeping more of the one before ends the chain
+
+enum {
+    VERTEX_LOCKED  = 1 << 0, // Border, non-manifold or seam: never collapses
+    VERTEX_TOUCHED = 1 << 1, // Took part in a collapse this pass
+};
+
+// Sum of squared distances to a set of planes, each weighted by its triangle's area
+typedef struct Quadric
+{
+    float a00, a11, a22, a01, a02, a12; // Sum of w n n^T
+    float b0, b1, b2;                   // Sum of w n d
+    float c;                            // Sum of w d d
+    float w;
+} Quadric;
+
+typedef struct Collapse
+{
+    float    cost;
+    uint32_t from;
+    uint32_t to;
+} Collapse;
+
+static void quadric_add_plane(Quadric* q, const float n[3], float d, float w)
+{
+    q->a00 += w * n[0] * n[0];
+    q->a11 += w * n[1] * n[1];
+    q->a22 += w * n[2] * n[2];
+    q->a01 += w * n[0] * n[1];
+    q->a02 += w * n[0] * n[2];
+    q->a12 += w * n[1] * n[2];
+    q->b0 += w * n[0] * d;
+    q->b1 += w * n[1] * d;
+    q->b2 += w * n[2] * d;
+    q->c += w * d * d;
+    q->w += w;
+}
+
+static void quadric_add(Quadric* q, const Quadric* r)
+{
+    q->a00 += r->a00; q->a11 += r->a11; q->a22 += r->a22;
+    q->a01 += r->a01; q->a02 += r->a02; q->a12 += r->a12;
+    q->b0 += r->b0; q->b1 += r->b1; q->b2 += r->b2;
+    q->c += r->c;
+    q->w += r->w;
+}
+
+// Mean squared distance of p to the planes of a and b together
+static float quadric_error(const Quadric* a, const Quadric* b, const float p[3])
+{
+    Quadric q = *a;
+    quadric_add(&q, b);
+    const float x = p[0], y = p[1], z = p[2];
+    const float r = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z
+                  + 2.0f * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z)
+                  + 2.0f * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+    return q.w > 0.0f ? fabsf(r) / q.w : 0.0f;
+}
+
+static void cross(const float a[3], const float b[3], const float c[3], float out[3])
+{
+    const float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    const float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    out[0] = e0[1] * e1[2] - e0[2] * e1[1];
+    out[1] = e0[2] * e1[0] - e0[0] * e1[2];
+    out[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+static int compare_collapse(const void* a, const void* b)
+{
+    const float x = ((const Collapse*)a)->cost, y = ((const Collapse*)b)->cost;
+    return (x > y) - (x < y);
+}
+
+static uint64_t hash_position(const float* p)
+{
+    uint32_t words[3];
+    memcpy(words, p, sizeof words);
+    return hash_u64(hash_u64(hash_u64(words[0]) ^ words[1]) ^ words[2]);
+}
+
+static uint32_t edge_slot(const uint64_t* keys, uint32_t mask, uint64_t key)
+{
+    uint32_t slot = (uint32_t)hash_u64(key) & mask;
+    while (keys[slot] != SIMPLIFY_NO_EDGE && keys[slot] != key) slot = (slot + 1) & mask;
+    return slot;
+}
+
+typedef struct Simplifier
+{
+    const uint32_t* position; // Vertex -> the first vertex at its position, which stands for it
+    float*          pos;      // Normalized into the unit cube, by vertex
+    uint32_t*       wedge;    // Vertex -> the vertex it collapsed into, itself if none
+    uint32_t*       single;   // Position -> its only referenced vertex, when not locked
+    uint8_t*        flags;    // By position
+    Quadric*        quadrics; // By position
+    uint32_t*       offsets;  // Position -> triangle adjacency, rebuilt every pass
+    uint32_t*       triangles;
+    Collapse*       collapses; // Candidates of a pass, one per edge at most
+} Simplifier;
+
+static uint32_t resolve(const Simplifier* s, uint32_t v)
+{
+    while (s->wedge[v] != v) v = s->wedge[v];
+    return v;
+}
+
+// Collapses position u into its neighbour v unless that would flip a triangle, pinch the
+// surface (u and v sharing more than the two neighbours across their edge) or make u's
+// triangles take different vertices at v. Returns the triangles removed, 0 if rejected.
+static uint32_t try_collapse(Simplifier* s, const uint32_t* indices, uint32_t u, uint32_t v)
+{
+    uint32_t neighbours[SIMPLIFY_MAX_NEIGHBOURS], neighbour_count = 0;
+    uint32_t target = SIMPLIFY_NONE, removed = 0;
+    for (uint32_t i = s->offsets[u]; i < s->offsets[u + 1]; ++i) {
+        const uint32_t* tri = indices + s->triangles[i] * 3;
+        uint32_t w[3], p[3];
+        for (int k = 0; k < 3; ++k) {
+            w[k] = resolve(s, tri[k]);
+            p[k] = s->position[w[k]];
+        }
+        if (p[0] == p[1] || p[1] == p[2] || p[0] == p[2]) continue;
+
+        const int k = p[0] == u ? 0 : p[1] == u ? 1 : 2;
+        const uint32_t a = p[(k + 1) % 3], b = p[(k + 2) % 3];
+        for (int n = 0; n < 2; ++n) {
+            const uint32_t q = n ? b : a;
+            if (q == v) continue;
+            uint32_t j = 0;
+            while (j < neighbour_count && neighbours[j] != q) ++j;
+            if (j == neighbour_count) {
+                if (neighbour_count == SIMPLIFY_MAX_NEIGHBOURS) return 0;
+                neighbours[neighbour_count++] = q;
+            }
+        }
+
+        if (a == v || b == v) {
+            const uint32_t at_v = w[a == v ? (k + 1) % 3 : (k + 2) % 3];
+            if (target != SIMPLIFY_NONE && target != at_v) return 0;
+            target = at_v;
+            removed++;
+            continue;
+        }
+
+        float before[3], after[3];
+        cross(s->pos + u * 3, s->pos + a * 3, s->pos + b * 3, before);
+        cross(s->pos + v * 3, s->pos + a * 3, s->pos + b * 3, after);
+        const float dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+        const float len2 = (before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+                         * (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+        if (dot <= SIMPLIFY_MIN_DOT * sqrtf(len2)) return 0;
+    }
+    if (target == SIMPLIFY_NONE) return 0;
+
+    uint32_t shared = 0, seen = 0;
+    for (uint32_t i = s->offsets[v]; i < s->offsets[v + 1]; ++i) {
+        const uint32_t* tri = indices + s->triangles[i] * 3;
+        uint32_t p[3];
+        for (int k = 0; k < 3; ++k) p[k] = s->position[resolve(s, tri[k])];
+        if (p[0] == p[1] || p[1] == p[2] || p[0] == p[2]) continue;
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t q = p[k];
+            for (uint32_t j = 0; j < neighbour_count; ++j) {
+                if (neighbours[j] != q || (seen >> j & 1)) continue;
+                seen |= 1u << j;
+                if (++shared > 2) return 0;
+            }
+        }
+    }
+
+    s->wedge[s->single[u]] = target;
+    quadric_add(&s->quadrics[v], &s->quadrics[u]);
+    s->flags[u] |= VERTEX_TOUCHED;
+    s->flags[v] |= VERTEX_TOUCHED;
+    return removed;
+}
+
+// Locks both ends of every edge without exactly one twin running the other way
+static bool lock_borders(Simplifier* s, const uint32_t* indices, uint32_t index_count)
+{
+    uint32_t capacity = 16;
+    while (capacity < index_count * 2) capacity *= 2;
+    uint64_t* keys = mem_alloc(capacity * sizeof(uint64_t));
+    uint8_t* counts = mem_calloc(capacity, 1);
+    if (!keys || !counts) {
+        mem_free(keys);
+        mem_free(counts);
+        return false;
+    }
+    memset(keys, 0xff, capacity * sizeof(uint64_t));
+
+    for (uint32_t i = 0; i < index_count; ++i) {
+        const uint64_t a = s->position[indices[i]], b = s->position[indices[i - i % 3 + (i + 1) % 3]];
+        const uint32_t slot = edge_slot(keys, capacity - 1, a << 32 | b);
+        keys[slot] = a << 32 | b;
+        if (counts[slot] < 2) counts[slot]++;
+    }
+    for (uint32_t i = 0; i < index_count; ++i) {
+        const uint64_t a = s->position[indices[i]], b = s->position[indices[i - i % 3 + (i + 1) % 3]];
+        const uint32_t twin = edge_slot(keys, capacity - 1, b << 32 | a);
+        if (counts[edge_slot(keys, capacity - 1, a << 32 | b)] != 1 || counts[twin] != 1) {
+            s->flags[a] |= VERTEX_LOCKED;
+            s->flags[b] |= VERTEX_LOCKED;
+        }
+    }
+
+    mem_free(keys);
+    mem_free(counts);
+    return true;
+}
+
+// Position -> triangle adjacency in compressed rows, as mesh_optimize builds it for vertices
+static void adjacency_build(Simplifier* s, const uint32_t* indices, uint32_t index_count, uint32_t vertex_count)
+{
+    memset(s->offsets, 0, (vertex_count + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < index_count; ++i) s->offsets[s->position[indices[i]] + 1]++;
+    for (uint32_t v = 0; v < vertex_count; ++v) s->offsets[v + 1] += s->offsets[v];
+    for (uint32_t i = 0; i < index_count; ++i) s->triangles[s->offsets[s->position[indices[i]]]++] = i / 3;
+    for (uint32_t v = vertex_count; v > 0; --v) s->offsets[v] = s->offsets[v - 1];
+    s->offsets[0] = 0;
+}
+
+// Vertex -> first vertex with the same position, by open addressing as mesh_dedup_vertices does
+static bool weld_positions(const EngineVertex* vertices, uint32_t vertex_count, uint32_t* position)
+{
+    uint32_t capacity = 16;
+    while (capacity < vertex_count * 2) capacity *= 2;
+    uint32_t* table = mem_alloc(capacity * sizeof(uint32_t));
+    if (!table) return false;
+    memset(table, 0xff, capacity * sizeof(uint32_t));
+
+    for (uint32_t v = 0; v < vertex_count; ++v) {
+        const float* p = vertices[v].pos;
+        uint32_t slot = (uint32_t)hash_position(p) & (capacity - 1);
+        while (table[slot] != SIMPLIFY_NONE && memcmp(vertices[table[slot]].pos, p, 3 * sizeof(float)) != 0)
+            slot = (slot + 1) & (capacity - 1);
+        if (table[slot] == SIMPLIFY_NONE) table[slot] = v;
+        position[v] = table[slot];
+    }
+    mem_free(table);
+    return true;
+}
+
+// The passes themselves, once the scratch is in place and positions are welded
+static uint32_t simplify(Simplifier* s, const EngineVertex* vertices, uint32_t vertex_count, uint32_t* indices,
+                         uint32_t index_count, uint32_t target_index_count, float target_error, float* out_error)
+{
+    const uint32_t* position = s->position;
+    if (!lock_borders(s, indices, index_count)) return 0;
+
+    // Errors are measured in the unit cube and scaled back at the end
+    float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t v = 0; v < vertex_count; ++v) {
+        for (int k = 0; k < 3; ++k) {
+            if (vertices[v].pos[k] < lo[k]) lo[k] = vertices[v].pos[k];
+            if (vertices[v].pos[k] > hi[k]) hi[k] = vertices[v].pos[k];
+        }
+    }
+    float extent = fmaxf(hi[0] - lo[0], fmaxf(hi[1] - lo[1], hi[2] - lo[2]));
+    if (!(extent > 0.0f)) extent = 1.0f;
+    for (uint32_t v = 0; v < vertex_count; ++v) {
+        for (int k = 0; k < 3; ++k) s->pos[v * 3 + k] = (vertices[v].pos[k] - lo[k]) / extent;
+        s->wedge[v] = v;
+        s->single[v] = SIMPLIFY_NONE;
+    }
+
+    // Several referenced vertices at one position make a seam
+    for (uint32_t i = 0; i < index_count; ++i) {
+        const uint32_t v = indices[i], p = position[v];
+        if (s->single[p] == SIMPLIFY_NONE) s->single[p] = v;
+        else if (s->single[p] != v) s->flags[p] |= VERTEX_LOCKED;
+    }
+
+    for (uint32_t i = 0; i < index_count; i += 3) {
+        const uint32_t a = position[indices[i]], b = position[indices[i + 1]], c = position[indices[i + 2]];
+        float n[3];
+        cross(s->pos + a * 3, s->pos + b * 3, s->pos + c * 3, n);
+        const float area2 = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (area2 <= 0.0f) continue;
+        n[0] /= area2;
+        n[1] /= area2;
+        n[2] /= area2;
+        const float d = -(n[0] * s->pos[a * 3] + n[1] * s->pos[a * 3 + 1] + n[2] * s->pos[a * 3 + 2]);
+        quadric_add_plane(&s->quadrics[a], n, d, area2 * 0.5f);
+        quadric_add_plane(&s->quadrics[b], n, d, area2 * 0.5f);
+        quadric_add_plane(&s->quadrics[c], n, d, area2 * 0.5f);
+    }
+
+    const float error_limit = target_error / extent;
+    const float cost_limit = error_limit * error_limit;
+    float max_cost = 0.0f;
+    uint32_t count = index_count;
+    while (count > target_index_count) {
+        adjacency_build(s, indices, count, vertex_count);
+
+        // Each edge once, from the triangle where it runs from the lower position; a border
+        // edge has no such twin, but both its ends are locked anyway
+        uint32_t candidates = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t a = position[indices[i]], b = position[indices[i - i % 3 + (i + 1) % 3]];
+            if (a >= b) continue;
+            const float ab = s->flags[a] & VERTEX_LOCKED ? FLT_MAX : quadric_error(&s->quadrics[a], &s->quadrics[b], s->pos + b * 3);
+            const float ba = s->flags[b] & VERTEX_LOCKED ? FLT_MAX : quadric_error(&s->quadrics[a], &s->quadrics[b], s->pos + a * 3);
+            if (ab == FLT_MAX && ba == FLT_MAX) continue;
+            const Collapse collapse = { ab <= ba ? ab : ba, ab <= ba ? a : b, ab <= ba ? b : a };
+            s->collapses[candidates++] = collapse;
+        }
+        qsort(s->collapses, candidates, sizeof(Collapse), compare_collapse);
+
+        // Cheapest first, each vertex in at most one collapse per pass so adjacency stays valid
+        for (uint32_t v = 0; v < vertex_count; ++v) s->flags[v] &= (uint8_t)~VERTEX_TOUCHED;
+        const uint32_t excess = (count - target_index_count) / 3;
+        uint32_t removed = 0;
+        for (uint32_t c = 0; c < candidates && removed < excess; ++c) {
+            const Collapse* collapse = &s->collapses[c];
+            if (collapse->cost > cost_limit) break;
+            if ((s->flags[collapse->from] | s->flags[collapse->to]) & VERTEX_TOUCHED) continue;
+            const uint32_t gone = try_collapse(s, indices, collapse->from, collapse->to);
+            if (gone && collapse->cost > max_cost) max_cost = collapse->cost;
+            removed += gone;
+        }
+        if (!removed) break;
+
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < count; i += 3) {
+            const uint32_t a = resolve(s, indices[i]), b = resolve(s, indices[i + 1]), c = resolve(s, indices[i + 2]);
+            if (position[a] == position[b] || position[b] == position[c] || position[a] == position[c]) continue;
+            indices[kept++] = a;
+            indices[kept++] = b;
+            indices[kept++] = c;
+        }
+        count = kept;
+    }
+    if (out_error) *out_error = sqrtf(max_cost) * extent;
+    return count;
+}
+
+uint32_t mesh_simplify(const EngineVertex* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count,
+                       uint32_t target_index_count, float target_error, uint32_t* out_indices, float* out_error)
+{
+    if (out_error) *out_error = 0.0f;
+    if (!vertices || !indices || !out_indices || index_count % 3 != 0) return 0;
+    for (uint32_t i = 0; i < index_count; ++i)
+        if (indices[i] >= vertex_count) return 0;
+    memmove(out_indices, indices, (size_t)index_count * sizeof(uint32_t));
+    if (index_count <= target_index_count) return index_count;
+
+    Simplifier s;
+    uint32_t* position = mem_alloc(vertex_count * sizeof(uint32_t));
+    s.position = position;
+    s.pos = mem_alloc((size_t)vertex_count * 3 * sizeof(float));
+    s.wedge = mem_alloc(vertex_count * sizeof(uint32_t));
+    s.single = mem_alloc(vertex_count * sizeof(uint32_t));
+    s.flags = mem_calloc(vertex_count, 1);
+    s.quadrics = mem_calloc(vertex_count, sizeof(Quadric));
+    s.offsets = mem_alloc((vertex_count + 1) * sizeof(uint32_t));
+    s.triangles = mem_alloc(index_count * sizeof(uint32_t));
+    s.collapses = mem_alloc(index_count * sizeof(Collapse));
+
+    uint32_t count = 0;
+    if (position && s.pos && s.wedge && s.single && s.flags && s.quadrics && s.offsets && s.triangles && s.collapses
+        && weld_positions(vertices, vertex_count, position))
+        count = simplify(&s, vertices, vertex_count, out_indices, index_count, target_index_count, target_error, out_error);
+
+    mem_free(position);
+    mem_free(s.pos);
+    mem_free(s.wedge);
+    mem_free(s.single);
+    mem_free(s.flags);
+    mem_free(s.quadrics);
+    mem_free(s.offsets);
+    mem_free(s.triangles);
+    mem_free(s.collapses);
+    return count;
+}
+
+uint32_t mesh_build_lods(const EngineVertex* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count,
+                         uint32_t* out_indices, EngineMeshLods* out_lods)
+{
+    memset(out_lods, 0, sizeof *out_lods);
+    out_lods->indices = out_indices;
+    uint32_t* scratch = mem_alloc((size_t)index_count * sizeof(uint32_t));
+    if (!scratch) return 0;
+
+    const uint32_t* level = indices;
+    uint32_t level_count = index_count, used = 0;
+    float error = 0.0f;
+    while (out_lods->count < ENGINE_MESH_MAX_LODS - 1 && level_count / 3 >= 2 * LOD_MIN_TRIANGLES) {
+        float step;
+        const uint32_t target = level_count / 6 * 3;
+        const uint32_t count = mesh_simplify(vertices, vertex_count, level, level_count, target, FLT_MAX, scratch, &step);
+        if (!count || (float)count > (float)level_count * LOD_MIN_REDUCTION || used + count > index_count) break;
+        mesh_optimize_vertex_cache(scratch, count, vertex_count);
+
+        memcpy(out_indices + used, scratch, (size_t)count * sizeof(uint32_t));
+        error += step;
+        out_lods->indices_count[out_lods->count] = count;
+        out_lods->error[out_lods->count] = error;
+        out_lods->count++;
+        level = out_indices + used;
+        level_count = count;
+        used += count;
+    }
+    mem_free(scratch);
+    return out_lods->count;
+}
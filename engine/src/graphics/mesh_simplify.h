@@ -0,0 +1,30 @@
+//
+// Created by Cain Martin on 2025/09/08.
+//
+
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <stdint.h>
+#include "../../include/engine.h"
+
+// Edge collapse simplification under quadric error metrics (Garland and Heckbert 1997).
+// Each vertex carries the planes of the triangles it has absorbed, and the collapse that
+// strays least from them goes first. A vertex only ever merges into a neighbour, never to a
+// new position, so the result indexes the input vertices. Vertices on an open border, on a
+// non-manifold edge or at a position several vertices share (an attribute seam) never move.
+// Like the passes in mesh_optimize.h, these allocate their scratch through core/memory.
+
+// Collapses until index_count reaches target_index_count or the next collapse would stray more
+// than target_error, in mesh units. out_indices has room for index_count and may alias
+// indices; out_error gets how far the result strays. Returns the new index count, 0 on
+// failure.
+uint32_t mesh_simplify(const EngineVertex* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count,
+                       uint32_t target_index_count, float target_error, uint32_t* out_indices, float* out_error);
+
+// engine_mesh_build_lods: each level simplified from the one before to half its triangles and
+// reordered for the vertex cache; errors add up along the chain
+uint32_t mesh_build_lods(const EngineVertex* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count,
+                         uint32_t* out_indices, EngineMeshLods* out_lods);
+
+#endif //MESH_SIMPLIFY_H
@@ -0,0 +1,321 @@
+//
+// Created by Cain Martin on 2025/08/31.
+//
+
+#include <math.h>
+#include <string.h>
+#include "mip_generator.h"
+#include "texture_format.h"
+#include "../core/atomic.h"
+#include "../core/job_system.h"
+#include "../core/memory.h"
+#include "../core/simd.h"
+
+#define MIP_MAX_TAPS       6
+#define MIP_KAISER_ALPHA   4.0f
+#define MIP_KAISER_RADIUS  3.0f  // Source texels either side of a destination texel's centre
+#define MIP_RING_ROWS      8     // Horizontally filtered rows kept, power of two >= MIP_MAX_TAPS
+#define MIP_SRGB_STEPS     4096  // Linear to sRGB table resolution
+#define MIP_JOB_TEXELS     65536 // Destination texels per job at least, so small levels stay on one thread
+
+typedef struct SrgbTables
+{
+    float   decode[256];
+    uint8_t encode[MIP_SRGB_STEPS];
+} SrgbTables;
+
+#ifdef ENGINE_SSE2
+typedef __m128 MipPixel;
+
+static inline MipPixel pixel_load(const float* v) { return _mm_loadu_ps(v); }
+static inline void     pixel_store(MipPixel p, float* v) { _mm_storeu_ps(v, p); }
+static inline MipPixel pixel_zero(void) { return _mm_setzero_ps(); }
+static inline MipPixel pixel_madd(MipPixel acc, MipPixel p, float w) { return _mm_add_ps(acc, _mm_mul_ps(p, _mm_set1_ps(w))); }
+static inline MipPixel pixel_saturate(MipPixel p) { return _mm_min_ps(_mm_max_ps(p, _mm_setzero_ps()), _mm_set1_ps(1.0f)); }
+#else
+typedef struct { float v[4]; } MipPixel;
+
+static inline MipPixel pixel_load(const float* v) { MipPixel p; memcpy(p.v, v, sizeof p.v); return p; }
+static inline void     pixel_store(MipPixel p, float* v) { memcpy(v, p.v, sizeof p.v); }
+static inline MipPixel pixel_zero(void) { MipPixel p = { { 0.0f, 0.0f, 0.0f, 0.0f } }; return p; }
+
+static inline MipPixel pixel_madd(MipPixel acc, MipPixel p, float w)
+{
+    for (int c = 0; c < 4; ++c) acc.v[c] += p.v[c] * w;
+    return acc;
+}
+
+static inline MipPixel pixel_saturate(MipPixel p)
+{
+    for (int c = 0; c < 4; ++c) p.v[c] = p.v[c] < 0.0f ? 0.0f : p.v[c] > 1.0f ? 1.0f : p.v[c];
+    return p;
+}
+#endif
+
+static void srgb_tables_init(SrgbTables* tables)
+{
+    for (int i = 0; i < 256; ++i) {
+        const float c = (float)i / 255.0f;
+        tables->decode[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+    for (int i = 0; i < MIP_SRGB_STEPS; ++i) {
+        const float l = (float)i / (float)(MIP_SRGB_STEPS - 1);
+        const float s = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+        tables->encode[i] = (uint8_t)(s * 255.0f + 0.5f);
+    }
+}
+
+// Modified Bessel function of the first kind, order 0
+static float bessel_i0(float x)
+{
+    float sum = 1.0f, term = 1.0f;
+    for (int k = 1; k < 20; ++k) {
+        const float t = x / (2.0f * (float)k);
+        term *= t * t;
+        sum += term;
+    }
+    return sum;
+}
+
+// Weights of the taps around a destination texel, nearest source texel first at
+// MIP_MAX_TAPS / 2 - 1 and normalized to sum to one. Returns the tap count.
+static uint32_t filter_weights(EngineMipFilter filter, float* weights)
+{
+    if (filter != ENGINE_MIP_FILTER_KAISER) {
+        weights[0] = weights[1] = 0.5f;
+        return 2;
+    }
+
+    const float pi = 3.14159265f;
+    float sum = 0.0f;
+    for (int k = 0; k < MIP_MAX_TAPS; ++k) {
+        // Distance of the source texel centre from the destination texel centre, in source texels
+        const float d = (float)k - (MIP_MAX_TAPS - 1) * 0.5f;
+        const float x = d * 0.5f; // Cut off at the destination's Nyquist frequency
+        const float sinc = sinf(pi * x) / (pi * x);
+        const float t = d / MIP_KAISER_RADIUS;
+        const float window = bessel_i0(MIP_KAISER_ALPHA * sqrtf(1.0f - t * t)) / bessel_i0(MIP_KAISER_ALPHA);
+        weights[k] = sinc * window;
+        sum += weights[k];
+    }
+    for (int k = 0; k < MIP_MAX_TAPS; ++k) weights[k] /= sum;
+    return MIP_MAX_TAPS;
+}
+
+static inline uint32_t clamp_index(int32_t i, uint32_t count)
+{
+    return i < 0 ? 0 : (uint32_t)i >= count ? count - 1 : (uint32_t)i;
+}
+
+// Exact (a + b + c + d + 2) / 4 of every 2x2 quad; odd edges reuse their last row or column.
+// Writes destination rows [y_begin, y_end).
+static void box_integer(uint32_t channels, uint32_t width, uint32_t height, const uint8_t* src, uint8_t* dst,
+                        uint32_t y_begin, uint32_t y_end)
+{
+    const uint32_t dst_width = texture_mip_extent(width, 1);
+    const size_t pitch = (size_t)width * channels;
+
+    for (uint32_t y = y_begin; y < y_end; ++y) {
+        const uint8_t* row0 = src + (size_t)clamp_index((int32_t)y * 2, height) * pitch;
+        const uint8_t* row1 = src + (size_t)clamp_index((int32_t)y * 2 + 1, height) * pitch;
+        uint8_t* out = dst + (size_t)y * dst_width * channels;
+        uint32_t x = 0;
+
+#ifdef ENGINE_SSE2
+        const __m128i zero = _mm_setzero_si128(), two = _mm_set1_epi16(2);
+        if (channels == 4) {
+            // Four source texels from each row give two destination texels
+            for (; x + 2 <= dst_width; x += 2) {
+                const __m128i a = _mm_loadu_si128((const __m128i*)(row0 + x * 8));
+                const __m128i b = _mm_loadu_si128((const __m128i*)(row1 + x * 8));
+                const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                __m128i sum = _mm_unpacklo_epi64(_mm_add_epi16(lo, _mm_srli_si128(lo, 8)),
+                                                 _mm_add_epi16(hi, _mm_srli_si128(hi, 8)));
+                sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+                _mm_storel_epi64((__m128i*)(out + x * 4), _mm_packus_epi16(sum, sum));
+            }
+        } else if (channels == 1) {
+            // Sixteen source texels from each row give eight; even and odd texels split by lane half
+            const __m128i low_bytes = _mm_set1_epi16(0x00ff);
+            for (; x + 8 <= dst_width; x += 8) {
+                const __m128i a = _mm_loadu_si128((const __m128i*)(row0 + x * 2));
+                const __m128i b = _mm_loadu_si128((const __m128i*)(row1 + x * 2));
+                __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, low_bytes), _mm_srli_epi16(a, 8)),
+                                            _mm_add_epi16(_mm_and_si128(b, low_bytes), _mm_srli_epi16(b, 8)));
+                sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+                _mm_storel_epi64((__m128i*)(out + x), _mm_packus_epi16(sum, sum));
+            }
+        }
+#endif
+
+        for (; x < dst_width; ++x) {
+            const size_t x0 = (size_t)clamp_index((int32_t)x * 2, width) * channels;
+            const size_t x1 = (size_t)clamp_index((int32_t)x * 2 + 1, width) * channels;
+            for (uint32_t c = 0; c < channels; ++c)
+                out[x * channels + c] = (uint8_t)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+        }
+    }
+}
+
+static MipPixel decode_texel(const uint8_t* texel, uint32_t channels, const SrgbTables* srgb)
+{
+    float v[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (uint32_t c = 0; c < channels; ++c)
+        v[c] = srgb && c < 3 ? srgb->decode[texel[c]] : (float)texel[c] * (1.0f / 255.0f);
+    return pixel_load(v);
+}
+
+static void encode_texel(MipPixel p, uint32_t channels, const SrgbTables* srgb, uint8_t* texel)
+{
+    float v[4];
+    pixel_store(pixel_saturate(p), v);
+    for (uint32_t c = 0; c < channels; ++c) {
+        texel[c] = srgb && c < 3 ? srgb->encode[(int)(v[c] * (MIP_SRGB_STEPS - 1) + 0.5f)]
+                                 : (uint8_t)(v[c] * 255.0f + 0.5f);
+    }
+}
+
+// Separable filter in float. Rows are filtered horizontally once, into a small ring, and
+// the vertical taps then read the ring. Writes destination rows [y_begin, y_end); source rows
+// shared with the neighbouring ranges are filtered by both.
+static bool filter_float(uint32_t channels, const float* weights, uint32_t taps, uint32_t width, uint32_t height,
+                         const uint8_t* src, uint8_t* dst, const SrgbTables* srgb, uint32_t y_begin, uint32_t y_end)
+{
+    const uint32_t dst_width = texture_mip_extent(width, 1);
+    const int32_t first = 1 - (int32_t)(taps / 2); // First tap, relative to twice the destination index
+
+    MipPixel* decoded = mem_alloc(width * sizeof(MipPixel));
+    MipPixel* ring = mem_alloc((size_t)MIP_RING_ROWS * dst_width * sizeof(MipPixel));
+    if (!decoded || !ring) {
+        mem_free(decoded);
+        mem_free(ring);
+        return false;
+    }
+    int64_t ring_row[MIP_RING_ROWS];
+    for (int i = 0; i < MIP_RING_ROWS; ++i) ring_row[i] = -1;
+
+    for (uint32_t y = y_begin; y < y_end; ++y) {
+        const MipPixel* rows[MIP_MAX_TAPS];
+        for (uint32_t k = 0; k < taps; ++k) {
+            const uint32_t sy = clamp_index((int32_t)y * 2 + first + (int32_t)k, height);
+            MipPixel* filtered = ring + (size_t)(sy & (MIP_RING_ROWS - 1)) * dst_width;
+            rows[k] = filtered;
+            if (ring_row[sy & (MIP_RING_ROWS - 1)] == sy) continue;
+            ring_row[sy & (MIP_RING_ROWS - 1)] = sy;
+
+            const uint8_t* row = src + (size_t)sy * width * channels;
+            for (uint32_t x = 0; x < width; ++x) decoded[x] = decode_texel(row + x * channels, channels, srgb);
+            for (uint32_t x = 0; x < dst_width; ++x) {
+                MipPixel acc = pixel_zero();
+                for (uint32_t t = 0; t < taps; ++t)
+                    acc = pixel_madd(acc, decoded[clamp_index((int32_t)x * 2 + first + (int32_t)t, width)], weights[t]);
+                filtered[x] = acc;
+            }
+        }
+
+        uint8_t* out = dst + (size_t)y * dst_width * channels;
+        for (uint32_t x = 0; x < dst_width; ++x) {
+            MipPixel acc = pixel_zero();
+            for (uint32_t k = 0; k < taps; ++k) acc = pixel_madd(acc, rows[k][x], weights[k]);
+            encode_texel(acc, channels, srgb, out + x * channels);
+        }
+    }
+
+    mem_free(decoded);
+    mem_free(ring);
+    return true;
+}
+
+// One level, split into bands of destination rows
+typedef struct MipLevelJob
+{
+    uint32_t           channels;
+    bool               box;       // box_integer, otherwise filter_float
+    float              weights[MIP_MAX_TAPS];
+    uint32_t           taps;
+    uint32_t           width, height;
+    const uint8_t*     src;
+    uint8_t*           dst;
+    const SrgbTables*  srgb;
+    uint32_t           failed;    // Set by any band that ran out of memory
+} MipLevelJob;
+
+static void generate_rows(void* data, uint32_t begin, uint32_t end)
+{
+    MipLevelJob* job = data;
+    if (job->box) {
+        box_integer(job->channels, job->width, job->height, job->src, job->dst, begin, end);
+    } else if (!filter_float(job->channels, job->weights, job->taps, job->width, job->height, job->src, job->dst,
+                             job->srgb, begin, end)) {
+        atomic_store_u32(&job->failed, 1);
+    }
+}
+
+static bool generate_level(JobSystem* jobs, const TextureFormatInfo* info, EngineMipFilter filter,
+                           uint32_t width, uint32_t height, const uint8_t* src, uint8_t* dst, const SrgbTables* srgb)
+{
+    MipLevelJob job;
+    memset(&job, 0, sizeof job);
+    job.channels = info->channels;
+    job.box = filter == ENGINE_MIP_FILTER_BOX && !info->srgb;
+    if (!job.box) job.taps = filter_weights(filter, job.weights);
+    job.width = width;
+    job.height = height;
+    job.src = src;
+    job.dst = dst;
+    job.srgb = info->srgb ? srgb : NULL;
+
+    const uint32_t dst_width = texture_mip_extent(width, 1), dst_height = texture_mip_extent(height, 1);
+    const uint32_t min_rows = dst_width < MIP_JOB_TEXELS ? MIP_JOB_TEXELS / dst_width : 1;
+    job_system_parallel_for(jobs, dst_height, min_rows, generate_rows, &job);
+    return !job.failed;
+}
+
+bool mip_generate_level(EngineTextureFormat format, EngineMipFilter filter, uint32_t width, uint32_t height,
+                        const uint8_t* src, uint8_t* dst)
+{
+    TextureFormatInfo info;
+    if (!texture_format_info(format, &info) || info.channels == 0 || width == 0 || height == 0) return false;
+
+    SrgbTables* srgb = NULL;
+    if (info.srgb) {
+        srgb = mem_alloc(sizeof(SrgbTables));
+        if (!srgb) return false;
+        srgb_tables_init(srgb);
+    }
+    const bool ok = generate_level(NULL, &info, filter, width, height, src, dst, srgb);
+    mem_free(srgb);
+    return ok;
+}
+
+bool mip_generate_chain(JobSystem* jobs, EngineTextureDesc* desc, EngineMipFilter filter, void* dst)
+{
+    TextureFormatInfo info;
+    if (!desc->pixels || desc->width <= 0 || desc->height <= 0
+        || !texture_format_info(desc->format, &info) || info.channels == 0)
+        return false;
+
+    SrgbTables* srgb = NULL;
+    if (info.srgb) {
+        srgb = mem_alloc(sizeof(SrgbTables));
+        if (!srgb) return false;
+        srgb_tables_init(srgb);
+    }
+
+    const uint32_t width = (uint32_t)desc->width, height = (uint32_t)desc->height;
+    const uint32_t mip_count = texture_mip_count(width, height);
+    uint8_t* at = dst;
+    bool ok = true;
+    desc->levels[0] = desc->pixels;
+    for (uint32_t level = 1; level < mip_count && ok; ++level) {
+        const uint32_t w = texture_mip_extent(width, level - 1), h = texture_mip_extent(height, level - 1);
+        ok = generate_level(jobs, &info, filter, w, h, desc->levels[level - 1], at, srgb);
+        desc->levels[level] = at;
+        at += texture_level_size(desc->format, texture_mip_extent(width, level), texture_mip_extent(height, level));
+    }
+    mem_free(srgb);
+
+    if (ok) desc->mip_count = (int)mip_count;
+    return ok;
+}
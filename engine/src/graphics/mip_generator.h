@@ -0,0 +1,25 @@
+//
+// Created by Cain Martin on 2025/08/31.
+//
+
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+#include "../core/job_system.h"
+
+// Halves one level of an uncompressed texture: dst is max(width / 2, 1) by max(height / 2, 1).
+// The box filter on linear formats runs on 8 bit integers with SSE2, averaging each 2x2 quad
+// exactly; everything else (Kaiser, sRGB) filters in float, one RGBA pixel per SSE register,
+// keeping only the few horizontally filtered rows the vertical taps need. sRGB levels are
+// decoded to linear through a table, filtered, and encoded back.
+bool mip_generate_level(EngineTextureFormat format, EngineMipFilter filter, uint32_t width, uint32_t height,
+                        const uint8_t* src, uint8_t* dst);
+
+// Every level below 0, each generated from the one above (see engine_texture_generate_mips).
+// Large levels are split into bands of rows run on jobs; jobs may be NULL.
+bool mip_generate_chain(JobSystem* jobs, EngineTextureDesc* desc, EngineMipFilter filter, void* dst);
+
+#endif //MIP_GENERATOR_H
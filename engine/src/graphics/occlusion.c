@@ -0,0 +1,472 @@
+//
+// Created by Cain Martin on 2025/09/05.
+//
+
+#include <float.h>
+#include <stdio.h>
+#include <string.h>
+#include "occlusion.h"
+#include "vertex_format.h"
+#include "../core/handle_pool.h"
+#include "../core/mat4.h"
+#include "../core/memory.h"
+#include "../core/profiler.h"
+#include "../core/simd.h"
+#include "../core/sparse_set.h"
+
+#define OCCLUSION_BAND_ROWS 8     // Rows per rasterizer job at least
+#define OCCLUSION_MIN_W     1e-6f // Guards the divide for vertices on the camera plane
+
+typedef struct OccluderMesh
+{
+    R_Handle  handle;      // The mesh it was copied from, so a stale handle finds nothing
+    float*    positions;   // xyz per vertex
+    uint32_t* indices;
+    uint32_t  vertex_count;
+    uint32_t  index_count;
+} OccluderMesh;
+
+// Screen space triangle ready to rasterize: three edge functions a * x + b * y + c, each
+// non-negative inside, and the depth plane, both at pixel centres
+typedef struct RasterTriangle
+{
+    float   a[3], b[3], c[3];
+    float   za, zb, zc;
+    int32_t min_x, max_x, min_y, max_y; // Pixels, clamped to the buffer
+} RasterTriangle;
+
+struct Occlusion
+{
+    SparseSet       meshes;          // OccluderMesh by mesh slot; occluders are a handful of meshes
+    uint32_t        capacity;        // Mesh slots
+
+    float           view_proj[16];
+    bool            active;          // Something was rasterized this frame
+    float*          depth;           // Every level, level 0 first; 16 byte aligned
+    uint32_t        level_offset[OCCLUSION_LEVELS];
+    RasterTriangle* triangles;
+    uint32_t        triangle_count;
+};
+
+static uint32_t level_width(uint32_t level)
+{
+    const uint32_t w = OCCLUSION_WIDTH >> level;
+    return w ? w : 1;
+}
+
+static uint32_t level_height(uint32_t level)
+{
+    const uint32_t h = OCCLUSION_HEIGHT >> level;
+    return h ? h : 1;
+}
+
+static void transform_point(const float m[16], const float p[3], float out[4])
+{
+    for (int r = 0; r < 4; ++r) out[r] = m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+}
+
+Occlusion* occlusion_create(uint32_t mesh_capacity)
+{
+    Occlusion* o = mem_calloc(1, sizeof *o);
+    if (!o) return NULL;
+
+    size_t depth_floats = 0;
+    for (uint32_t level = 0; level < OCCLUSION_LEVELS; ++level) {
+        o->level_offset[level] = (uint32_t)depth_floats;
+        depth_floats += ((size_t)level_width(level) * level_height(level) + 3) & ~(size_t)3; // Keep levels aligned
+    }
+
+    const bool meshes = sparse_set_init(&o->meshes, sizeof(OccluderMesh), 0, NULL);
+    o->depth = mem_alloc_aligned(depth_floats * sizeof(float), 16);
+    o->triangles = mem_alloc(OCCLUSION_MAX_TRIANGLES * sizeof(RasterTriangle));
+    if (!meshes || !o->depth || !o->triangles) {
+        occlusion_destroy(o);
+        return NULL;
+    }
+    o->capacity = mesh_capacity;
+    for (size_t i = 0; i < depth_floats; ++i) o->depth[i] = 1.0f;
+    return o;
+}
+
+void occlusion_destroy(Occlusion* occlusion)
+{
+    if (!occlusion) return;
+    const OccluderMesh* meshes = D_ARRAY_DATA(&occlusion->meshes.values, OccluderMesh);
+    for (uint32_t i = 0; i < sparse_set_count(&occlusion->meshes); ++i) {
+        mem_free(meshes[i].positions);
+        mem_free(meshes[i].indices);
+    }
+    sparse_set_free(&occlusion->meshes);
+    mem_free_aligned(occlusion->depth);
+    mem_free(occlusion->triangles);
+    mem_free(occlusion);
+}
+
+bool occlusion_add_mesh(Occlusion* occlusion, R_Handle mesh, const EngineMeshDesc* desc)
+{
+    const uint32_t slot = handle_index(mesh);
+    if (!mesh || slot >= occlusion->capacity || !desc->indices || desc->indices_count < 3) return false;
+    if (!desc->vertices && !desc->packed_vertices) return false;
+
+    OccluderMesh copy;
+    copy.handle = mesh;
+    copy.vertex_count = desc->vertex_count;
+    copy.index_count = desc->indices_count - desc->indices_count % 3;
+    copy.positions = mem_alloc((size_t)copy.vertex_count * 3 * sizeof(float));
+    copy.indices = mem_alloc((size_t)copy.index_count * sizeof(uint32_t));
+    if (!copy.positions || !copy.indices) {
+        mem_free(copy.positions);
+        mem_free(copy.indices);
+        fprintf(stderr, "occlusion_add_mesh: out of memory\n");
+        return false;
+    }
+    for (uint32_t i = 0; i < copy.vertex_count; ++i) {
+        if (desc->packed_vertices) vertex_decode_position(&desc->layout, desc->packed_vertices, i, copy.positions + i * 3);
+        else memcpy(copy.positions + i * 3, desc->vertices[i].pos, 3 * sizeof(float));
+    }
+    // Out of range indices would read past the positions; drop the whole mesh instead
+    for (uint32_t i = 0; i < copy.index_count; ++i) {
+        if (desc->indices[i] >= copy.vertex_count) {
+            mem_free(copy.positions);
+            mem_free(copy.indices);
+            return false;
+        }
+        copy.indices[i] = desc->indices[i];
+    }
+
+    // A mesh destroyed without occlusion_remove_mesh leaves its copy in the slot
+    OccluderMesh* old = sparse_set_get(&occlusion->meshes, slot);
+    if (old) occlusion_remove_mesh(occlusion, old->handle);
+    OccluderMesh* entry = sparse_set_insert(&occlusion->meshes, slot);
+    if (!entry) {
+        mem_free(copy.positions);
+        mem_free(copy.indices);
+        fprintf(stderr, "occlusion_add_mesh: out of memory\n");
+        return false;
+    }
+    *entry = copy;
+    return true;
+}
+
+static OccluderMesh* find_occluder(const Occlusion* occlusion, R_Handle mesh)
+{
+    const uint32_t slot = handle_index(mesh);
+    if (!mesh || slot >= occlusion->capacity) return NULL;
+    OccluderMesh* om = sparse_set_get(&occlusion->meshes, slot);
+    return om && om->handle == mesh ? om : NULL;
+}
+
+void occlusion_remove_mesh(Occlusion* occlusion, R_Handle mesh)
+{
+    const OccluderMesh* om = find_occluder(occlusion, mesh);
+    if (!om) return;
+    mem_free(om->positions);
+    mem_free(om->indices);
+    sparse_set_remove(&occlusion->meshes, handle_index(mesh));
+}
+
+bool occlusion_is_occluder(const Occlusion* occlusion, R_Handle mesh)
+{
+    return find_occluder(occlusion, mesh) != NULL;
+}
+
+void occlusion_begin(Occlusion* occlusion, const EngineCamera* camera)
+{
+    mat4_mul(camera->projection, camera->view, occlusion->view_proj);
+    occlusion->triangle_count = 0;
+    occlusion->active = false;
+}
+
+// Screen space setup of one triangle already in front of the near plane
+static void setup_triangle(Occlusion* occlusion, const float clip[3][4])
+{
+    float x[3], y[3], z[3];
+    for (int k = 0; k < 3; ++k) {
+        if (clip[k][3] < OCCLUSION_MIN_W) return;
+        const float inv_w = 1.0f / clip[k][3];
+        x[k] = (clip[k][0] * inv_w * 0.5f + 0.5f) * (float)OCCLUSION_WIDTH;
+        y[k] = (clip[k][1] * inv_w * 0.5f + 0.5f) * (float)OCCLUSION_HEIGHT;
+        z[k] = clip[k][2] * inv_w * 0.5f + 0.5f;
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area == 0.0f) return;
+    if (area < 0.0f) {
+        // Occluders are two sided: wind every triangle the same way
+        float t = x[1]; x[1] = x[2]; x[2] = t;
+        t = y[1]; y[1] = y[2]; y[2] = t;
+        t = z[1]; z[1] = z[2]; z[2] = t;
+        area = -area;
+    }
+
+    float lo_x = x[0], hi_x = x[0], lo_y = y[0], hi_y = y[0];
+    for (int k = 1; k < 3; ++k) {
+        lo_x = x[k] < lo_x ? x[k] : lo_x;
+        hi_x = x[k] > hi_x ? x[k] : hi_x;
+        lo_y = y[k] < lo_y ? y[k] : lo_y;
+        hi_y = y[k] > hi_y ? y[k] : hi_y;
+    }
+    if (hi_x < 0.0f || hi_y < 0.0f || lo_x >= (float)OCCLUSION_WIDTH || lo_y >= (float)OCCLUSION_HEIGHT) return;
+
+    RasterTriangle* t = &occlusion->triangles[occlusion->triangle_count++];
+    // Edge k runs from vertex k to vertex k + 1; the one opposite vertex k is edge k + 1
+    for (int k = 0; k < 3; ++k) {
+        const int n = (k + 1) % 3;
+        t->a[k] = y[k] - y[n];
+        t->b[k] = x[n] - x[k];
+        t->c[k] = -t->a[k] * x[k] - t->b[k] * y[k];
+    }
+    const float inv_area = 1.0f / area;
+    const float w0[3] = { t->a[1] * inv_area, t->b[1] * inv_area, t->c[1] * inv_area }; // Weight of vertex 0
+    const float w1[3] = { t->a[2] * inv_area, t->b[2] * inv_area, t->c[2] * inv_area };
+    const float w2[3] = { t->a[0] * inv_area, t->b[0] * inv_area, t->c[0] * inv_area };
+    t->za = w0[0] * z[0] + w1[0] * z[1] + w2[0] * z[2];
+    t->zb = w0[1] * z[0] + w1[1] * z[1] + w2[1] * z[2];
+    t->zc = w0[2] * z[0] + w1[2] * z[1] + w2[2] * z[2];
+
+    t->min_x = lo_x < 0.0f ? 0 : (int32_t)lo_x;
+    t->min_y = lo_y < 0.0f ? 0 : (int32_t)lo_y;
+    t->max_x = hi_x >= (float)(OCCLUSION_WIDTH - 1) ? OCCLUSION_WIDTH - 1 : (int32_t)hi_x;
+    t->max_y = hi_y >= (float)(OCCLUSION_HEIGHT - 1) ? OCCLUSION_HEIGHT - 1 : (int32_t)hi_y;
+}
+
+void occlusion_add_draw(Occlusion* occlusion, R_Handle mesh, const float model[16])
+{
+    const OccluderMesh* om = find_occluder(occlusion, mesh);
+    if (!om) return;
+    float m[16];
+    mat4_mul(occlusion->view_proj, model, m);
+
+    for (uint32_t i = 0; i < om->index_count; i += 3) {
+        // A clipped triangle can become two
+        if (occlusion->triangle_count + 2 > OCCLUSION_MAX_TRIANGLES) return;
+
+        float in[3][4];
+        for (int k = 0; k < 3; ++k) transform_point(m, om->positions + (size_t)om->indices[i + k] * 3, in[k]);
+
+        // Clip against the near plane, z + w >= 0 in GL clip space
+        float out[4][4];
+        int n = 0;
+        for (int k = 0; k < 3; ++k) {
+            const float* p = in[k];
+            const float* q = in[(k + 1) % 3];
+            const float dp = p[2] + p[3], dq = q[2] + q[3];
+            if (dp >= 0.0f) memcpy(out[n++], p, sizeof out[0]);
+            if ((dp >= 0.0f) != (dq >= 0.0f)) {
+                const float t = dp / (dp - dq);
+                for (int c = 0; c < 4; ++c) out[n][c] = p[c] + (q[c] - p[c]) * t;
+                n++;
+            }
+        }
+        if (n < 3) continue;
+
+        float tri[3][4];
+        memcpy(tri[0], out[0], sizeof tri[0]);
+        for (int k = 1; k + 1 < n; ++k) {
+            memcpy(tri[1], out[k], sizeof tri[1]);
+            memcpy(tri[2], out[k + 1], sizeof tri[2]);
+            setup_triangle(occlusion, (const float (*)[4])tri);
+        }
+    }
+}
+
+static void raster_rows(void* data, uint32_t begin, uint32_t end)
+{
+    Occlusion* o = data;
+    float* depth = o->depth;
+
+    for (uint32_t i = 0; i < o->triangle_count; ++i) {
+        const RasterTriangle* t = &o->triangles[i];
+        const int32_t y0 = t->min_y > (int32_t)begin ? t->min_y : (int32_t)begin;
+        const int32_t y1 = t->max_y < (int32_t)end - 1 ? t->max_y : (int32_t)end - 1;
+        const int32_t x0 = t->min_x & ~3; // Whole groups of four; the width is a multiple of four
+
+        for (int32_t y = y0; y <= y1; ++y) {
+            const float py = (float)y + 0.5f;
+            const float e_row[3] = { t->b[0] * py + t->c[0], t->b[1] * py + t->c[1], t->b[2] * py + t->c[2] };
+            const float z_row = t->zb * py + t->zc;
+            float* row = depth + (size_t)y * OCCLUSION_WIDTH;
+            int32_t x = x0;
+
+#ifdef ENGINE_SSE2
+            const __m128 zero = _mm_setzero_ps(), lanes = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            for (; x <= t->max_x; x += 4) {
+                const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+                const __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t->a[0]), px), _mm_set1_ps(e_row[0]));
+                const __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t->a[1]), px), _mm_set1_ps(e_row[1]));
+                const __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t->a[2]), px), _mm_set1_ps(e_row[2]));
+                const __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+                if (!_mm_movemask_ps(inside)) continue;
+
+                const __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t->za), px), _mm_set1_ps(z_row));
+                const __m128 d = _mm_load_ps(row + x);
+                _mm_store_ps(row + x, _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(d, z)), _mm_andnot_ps(inside, d)));
+            }
+#endif
+
+            for (; x <= t->max_x; ++x) {
+                const float px = (float)x + 0.5f;
+                if (t->a[0] * px + e_row[0] < 0.0f || t->a[1] * px + e_row[1] < 0.0f || t->a[2] * px + e_row[2] < 0.0f)
+                    continue;
+                const float z = t->za * px + z_row;
+                if (z < row[x]) row[x] = z;
+            }
+        }
+    }
+}
+
+// Each texel the farthest of the 2x2 below it
+static void build_level(const float* src, uint32_t src_w, uint32_t src_h, float* dst, uint32_t dst_w, uint32_t dst_h)
+{
+    for (uint32_t y = 0; y < dst_h; ++y) {
+        const float* r0 = src + (size_t)(2 * y < src_h ? 2 * y : src_h - 1) * src_w;
+        const float* r1 = src + (size_t)(2 * y + 1 < src_h ? 2 * y + 1 : src_h - 1) * src_w;
+        float* out = dst + (size_t)y * dst_w;
+        uint32_t x = 0;
+
+#ifdef ENGINE_SSE2
+        if (src_w == 2 * dst_w) {
+            for (; x + 4 <= dst_w; x += 4) {
+                const __m128 a = _mm_max_ps(_mm_loadu_ps(r0 + 2 * x), _mm_loadu_ps(r1 + 2 * x));
+                const __m128 b = _mm_max_ps(_mm_loadu_ps(r0 + 2 * x + 4), _mm_loadu_ps(r1 + 2 * x + 4));
+                _mm_storeu_ps(out + x, _mm_max_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                                                  _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+            }
+        }
+#endif
+
+        for (; x < dst_w; ++x) {
+            const uint32_t x0 = 2 * x < src_w ? 2 * x : src_w - 1, x1 = 2 * x + 1 < src_w ? 2 * x + 1 : src_w - 1;
+            float m = r0[x0] > r0[x1] ? r0[x0] : r0[x1];
+            m = r1[x0] > m ? r1[x0] : m;
+            out[x] = r1[x1] > m ? r1[x1] : m;
+        }
+    }
+}
+
+void occlusion_rasterize(Occlusion* occlusion, JobSystem* jobs)
+{
+    PROFILE_BEGIN("occlusion_raster");
+    float* depth = occlusion->depth;
+    for (uint32_t i = 0; i < OCCLUSION_WIDTH * OCCLUSION_HEIGHT; ++i) depth[i] = 1.0f;
+    job_system_parallel_for(jobs, OCCLUSION_HEIGHT, OCCLUSION_BAND_ROWS, raster_rows, occlusion);
+
+    for (uint32_t level = 1; level < OCCLUSION_LEVELS; ++level) {
+        build_level(depth + occlusion->level_offset[level - 1], level_width(level - 1), level_height(level - 1),
+                    depth + occlusion->level_offset[level], level_width(level), level_height(level));
+    }
+    occlusion->active = occlusion->triangle_count > 0;
+    PROFILE_END();
+}
+
+#ifdef ENGINE_SSE2
+static float horizontal_min(__m128 v)
+{
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+static float horizontal_max(__m128 v)
+{
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+#endif
+
+bool occlusion_test(const Occlusion* occlusion, const EngineBounds* bounds, const float model[16])
+{
+    if (!occlusion->active) return true;
+
+    // In clip space the box is its min corner plus any sum of its three edges, so the corners
+    // cost adds rather than a transform each
+    float m[16], base[4], edge[3][4], corner[4][8]; // corner: x, y, z, w rows
+    mat4_mul(occlusion->view_proj, model, m);
+    transform_point(m, bounds->min, base);
+    for (int a = 0; a < 3; ++a) {
+        const float extent = bounds->max[a] - bounds->min[a];
+        for (int r = 0; r < 4; ++r) edge[a][r] = m[a * 4 + r] * extent;
+    }
+    for (int c = 0; c < 8; ++c) {
+        for (int r = 0; r < 4; ++r)
+            corner[r][c] = base[r] + (c & 1 ? edge[0][r] : 0.0f) + (c & 2 ? edge[1][r] : 0.0f) + (c & 4 ? edge[2][r] : 0.0f);
+    }
+
+    // A corner reaching the near plane leaves the rectangle unbounded: call it visible
+    float lo_x, lo_y, hi_x, hi_y, nearest;
+#ifdef ENGINE_SSE2
+    const __m128 half_w = _mm_set1_ps(0.5f * (float)OCCLUSION_WIDTH), half_h = _mm_set1_ps(0.5f * (float)OCCLUSION_HEIGHT);
+    const __m128 half = _mm_set1_ps(0.5f);
+    __m128 clipped = _mm_setzero_ps(), x_lo = _mm_set1_ps(FLT_MAX), y_lo = x_lo, z_lo = x_lo;
+    __m128 x_hi = _mm_set1_ps(-FLT_MAX), y_hi = x_hi;
+    for (int c = 0; c < 8; c += 4) {
+        const __m128 w = _mm_loadu_ps(corner[3] + c), z = _mm_loadu_ps(corner[2] + c);
+        clipped = _mm_or_ps(clipped, _mm_or_ps(_mm_cmplt_ps(_mm_add_ps(z, w), _mm_setzero_ps()),
+                                               _mm_cmplt_ps(w, _mm_set1_ps(OCCLUSION_MIN_W))));
+        const __m128 inv_w = _mm_div_ps(_mm_set1_ps(1.0f), w);
+        const __m128 x = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(corner[0] + c), inv_w), half_w), half_w);
+        const __m128 y = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(corner[1] + c), inv_w), half_h), half_h);
+        x_lo = _mm_min_ps(x_lo, x);
+        x_hi = _mm_max_ps(x_hi, x);
+        y_lo = _mm_min_ps(y_lo, y);
+        y_hi = _mm_max_ps(y_hi, y);
+        z_lo = _mm_min_ps(z_lo, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(z, inv_w), half), half));
+    }
+    if (_mm_movemask_ps(clipped)) return true;
+    lo_x = horizontal_min(x_lo);
+    hi_x = horizontal_max(x_hi);
+    lo_y = horizontal_min(y_lo);
+    hi_y = horizontal_max(y_hi);
+    nearest = horizontal_min(z_lo);
+#else
+    lo_x = lo_y = nearest = FLT_MAX;
+    hi_x = hi_y = -FLT_MAX;
+    for (int c = 0; c < 8; ++c) {
+        const float w = corner[3][c];
+        if (corner[2][c] + w < 0.0f || w < OCCLUSION_MIN_W) return true;
+
+        const float inv_w = 1.0f / w;
+        const float x = (corner[0][c] * inv_w * 0.5f + 0.5f) * (float)OCCLUSION_WIDTH;
+        const float y = (corner[1][c] * inv_w * 0.5f + 0.5f) * (float)OCCLUSION_HEIGHT;
+        const float z = corner[2][c] * inv_w * 0.5f + 0.5f;
+        lo_x = x < lo_x ? x : lo_x;
+        hi_x = x > hi_x ? x : hi_x;
+        lo_y = y < lo_y ? y : lo_y;
+        hi_y = y > hi_y ? y : hi_y;
+        nearest = z < nearest ? z : nearest;
+    }
+#endif
+    if (hi_x < 0.0f || hi_y < 0.0f || lo_x >= (float)OCCLUSION_WIDTH || lo_y >= (float)OCCLUSION_HEIGHT) return true;
+
+    const uint32_t x0 = lo_x < 0.0f ? 0 : (uint32_t)lo_x, y0 = lo_y < 0.0f ? 0 : (uint32_t)lo_y;
+    const uint32_t x1 = hi_x >= (float)(OCCLUSION_WIDTH - 1) ? OCCLUSION_WIDTH - 1 : (uint32_t)hi_x;
+    const uint32_t y1 = hi_y >= (float)(OCCLUSION_HEIGHT - 1) ? OCCLUSION_HEIGHT - 1 : (uint32_t)hi_y;
+
+    // The finest level at which the rectangle touches at most 2x2 texels
+    uint32_t level = 0;
+    while (level + 1 < OCCLUSION_LEVELS && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+        level++;
+
+    // Always four reads, the same texel twice when the rectangle spans only one
+    const float* texels = occlusion->depth + occlusion->level_offset[level];
+    const uint32_t width = level_width(level);
+    const float* row0 = texels + (size_t)(y0 >> level) * width;
+    const float* row1 = texels + (size_t)(y1 >> level) * width;
+    const float a = row0[x0 >> level], b = row0[x1 >> level], c = row1[x0 >> level], d = row1[x1 >> level];
+    const float ab = a > b ? a : b, cd = c > d ? c : d;
+    return nearest <= (ab > cd ? ab : cd);
+}
+
+uint32_t occlusion_triangle_count(const Occlusion* occlusion)
+{
+    return occlusion->triangle_count;
+}
+
+const float* occlusion_depth(const Occlusion* occlusion, uint32_t level, uint32_t* out_width, uint32_t* out_height)
+{
+    if (level >= OCCLUSION_LEVELS) return NULL;
+    if (out_width) *out_width = level_width(level);
+    if (out_height) *out_height = level_height(level);
+    return occlusion->depth + occlusion->level_offset[level];
+}
@@ -0,0 +1,53 @@
+//
+// Created by Cain Martin on 2025/09/05.
+//
+
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+#include "../core/job_system.h"
+#include "renderer.h"
+
+// Depth buffer size, powers of two so every pyramid level halves exactly. Width is a
+// multiple of four for the SIMD rasterizer.
+#define OCCLUSION_WIDTH         256
+#define OCCLUSION_HEIGHT        128
+#define OCCLUSION_LEVELS        9     // 256x128 down to 1x1
+#define OCCLUSION_MAX_TRIANGLES 16384 // Rasterized per frame; occluder draws past it are skipped
+
+// Software occlusion culling (EngineConfig.occlusion_culling). Meshes created with
+// ENGINE_MESH_OCCLUDER keep a copy of their triangles here. Each frame their draws are
+// clipped to the near plane and rasterized, depth only, into a small buffer in bands of rows
+// on the job threads, four pixels at a time with SSE2. A pyramid of 2x2 maxima is built over
+// it, and a draw is hidden when the nearest point of its projected bounds lies behind the
+// farthest occluder depth in the few texels of the level its screen rectangle covers.
+//
+// Depth is NDC z mapped to [0, 1], smaller nearer, as a conventional GL projection gives.
+// Occluders are sampled at pixel centres, so thin gaps between them may be closed over.
+typedef struct Occlusion Occlusion;
+
+Occlusion* occlusion_create(uint32_t mesh_capacity);
+void       occlusion_destroy(Occlusion* occlusion);
+
+// Copies the mesh's positions and indices as occluder geometry
+bool       occlusion_add_mesh(Occlusion* occlusion, R_Handle mesh, const EngineMeshDesc* desc);
+void       occlusion_remove_mesh(Occlusion* occlusion, R_Handle mesh);
+bool       occlusion_is_occluder(const Occlusion* occlusion, R_Handle mesh);
+
+// Per frame: begin, add the occluder draws that survived frustum culling, rasterize, test
+void       occlusion_begin(Occlusion* occlusion, const EngineCamera* camera);
+void       occlusion_add_draw(Occlusion* occlusion, R_Handle mesh, const float model[16]);
+void       occlusion_rasterize(Occlusion* occlusion, JobSystem* jobs);
+
+// False when the bounds, placed by model, are certainly hidden. Thread safe after rasterize.
+bool       occlusion_test(const Occlusion* occlusion, const EngineBounds* bounds, const float model[16]);
+
+uint32_t   occlusion_triangle_count(const Occlusion* occlusion); // Rasterized this frame
+
+// One pyramid level, row major with row 0 at the bottom of the screen
+const float* occlusion_depth(const Occlusion* occlusion, uint32_t level, uint32_t* out_width, uint32_t* out_height);
+
+#endif //OCCLUSION_H
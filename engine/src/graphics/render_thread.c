@@ -0,0 +1,865 @@
+//
+// Created by Cain Martin on 2025/09/02.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "render_thread.h"
+#include "draw_queue.h"
+#include "mesh_lod.h"
+#include "texture_format.h"
+#include "vertex_format.h"
+#include "../core/arena.h"
+#include "../core/atomic.h"
+#include "../core/d_array.h"
+#include "../core/handle_pool.h"
+#include "../core/memory.h"
+#include "../core/profiler.h"
+#include "../platform/clock.h"
+#include "../platform/platform.h"
+#include "../platform/thread.h"
+
+#define RT_COMMANDS_MIN_CAPACITY 4096
+#define RT_ALIGN(size) (((size) + 15u) & ~(size_t)15u)
+
+typedef enum {
+    RT_CMD_BEGIN_FRAME,
+    RT_CMD_END_FRAME,
+    RT_CMD_CLEAR,
+    RT_CMD_SET_CAMERA,
+    RT_CMD_SET_UNIFORM,
+    RT_CMD_DRAW,
+    RT_CMD_DRAW_BUCKET,
+    RT_CMD_DRAW_TRANSIENT,
+    RT_CMD_MESH_CREATE,
+    RT_CMD_MESH_DESTROY,
+    RT_CMD_SHADER_CREATE,
+    RT_CMD_SHADER_DESTROY,
+    RT_CMD_TEXTURE_CREATE,
+    RT_CMD_TEXTURE_DESTROY,
+    RT_CMD_MATERIAL_CREATE,
+    RT_CMD_MATERIAL_DESTROY,
+} RTCommandType;
+
+// Transient geometry is written into the command buffer's arena behind this header, and
+// copied to the backend's streaming memory when its first draw is replayed
+typedef struct RTTransient
+{
+    EngineTransientMesh backend;
+    bool                allocated;
+    bool                failed;
+} RTTransient;
+
+#define RT_TRANSIENT_HEADER RT_ALIGN(sizeof(RTTransient))
+
+typedef struct RTCommand
+{
+    uint32_t type;
+    R_Handle handle; // Proxy handle the command creates or destroys
+    union {
+        struct { int width, height; uint32_t rejected; } frame;
+        float               color[4];
+        const EngineCamera* camera;
+        DrawItem            draw;
+        struct { DrawItem* items; uint32_t count; } bucket;
+        struct { RTTransient* mesh; R_Handle material; float model[16]; } transient;
+        struct { const char* name; const float* vals; int count; R_Handle material; } uniform;
+        EngineMaterialDesc  material;
+        void*               data; // Heap copy of a description and everything it points at
+    } u;
+} RTCommand;
+
+typedef struct RTBuffer
+{
+    DArray   commands; // RTCommand, heap storage kept across frames
+    Arena    arena;    // Camera, bucket draws, transient geometry and uniforms
+    uint32_t bucketed; // Draws in its RT_CMD_DRAW_BUCKET commands
+    bool     quit;
+} RTBuffer;
+
+typedef struct RenderThread
+{
+    // Recording thread
+    const PlatformAPI* plat;
+    Platform*          platform;
+    HandlePool         meshes;
+    HandlePool         shaders;
+    HandlePool         textures;
+    HandlePool         materials;
+    RTBuffer           buffers[2];
+    uint32_t           write;       // Buffer being recorded
+    bool               acquired;    // The render thread is done with it
+    uint32_t           rejected;    // Draws with stale handles this frame
+    uint32_t           last_commands; // Recorded into the buffer handed over last
+    uint64_t           wait_ticks;  // Blocked on the render thread since the last begin_frame
+    EngineRenderStats  stats;
+    DArray             log;         // EngineCommand
+
+    // Render thread
+    const RendererAPI* backend;
+    Renderer*          inner;
+    RendererCreateInfo info;
+    FrameArena         frame_arena; // The backend's, switched here rather than by the engine
+    R_Handle*          mesh_map;    // Proxy slot -> backend handle
+    R_Handle*          shader_map;
+    R_Handle*          texture_map;
+    R_Handle*          material_map;
+    DArray             pending_shaders; // Proxy handles of shaders the backend is still compiling
+    DrawBucket         bucket;
+    FramePacing        pacing;
+    double             frame_start;
+    uint32_t           read;
+
+    // Shared
+    Thread*            thread;
+    Semaphore*         ready;       // Posted per buffer handed over
+    Semaphore*         free;        // Posted per buffer replayed
+    Semaphore*         started;
+    bool               created;     // Both written before started is posted
+    bool               formats[ENGINE_TEXTURE_FORMAT_COUNT];
+    uint64_t*          shader_status; // Per proxy slot: handle << 32 | EngineShaderStatus
+    Mutex*             lock;          // Guards published and published_log
+    EngineRenderStats  published;
+    DArray             published_log;
+} RenderThread;
+
+// Frame pacing
+
+void frame_pacing_present(FramePacing* pacing, double now_seconds)
+{
+    if (pacing->last_present > 0.0) {
+        pacing->intervals[pacing->count & (FRAME_PACING_WINDOW - 1)] = (float)((now_seconds - pacing->last_present) * 1000.0);
+        pacing->count++;
+    }
+    pacing->last_present = now_seconds;
+}
+
+void frame_pacing_stats(const FramePacing* pacing, EngineRenderStats* out_stats)
+{
+    out_stats->frame_interval_ms = 0.0f;
+    out_stats->frame_interval_max_ms = 0.0f;
+    if (pacing->count == 0) return;
+
+    out_stats->frame_interval_ms = pacing->intervals[(pacing->count - 1) & (FRAME_PACING_WINDOW - 1)];
+    const uint32_t n = pacing->count < FRAME_PACING_WINDOW ? pacing->count : FRAME_PACING_WINDOW;
+    for (uint32_t i = 0; i < n; ++i)
+        if (pacing->intervals[i] > out_stats->frame_interval_max_ms) out_stats->frame_interval_max_ms = pacing->intervals[i];
+}
+
+// Render thread
+
+static R_Handle rt_map(const R_Handle* map, R_Handle handle)
+{
+    return handle ? map[handle_index(handle)] : 0;
+}
+
+static void rt_store_status(RenderThread* rt, R_Handle handle, EngineShaderStatus status)
+{
+    atomic_store_u64(&rt->shader_status[handle_index(handle)], (uint64_t)handle << 32 | (uint32_t)status);
+}
+
+static void rt_replay_bucket(RenderThread* rt, const DrawItem* items, uint32_t count)
+{
+    // Keys depend on backend state, so they are made here rather than by the recording threads
+    for (uint32_t i = 0; i < count; ++i) {
+        const R_Handle mesh = rt_map(rt->mesh_map, items[i].mesh);
+        const R_Handle material = rt_map(rt->material_map, items[i].material);
+        uint64_t key;
+        if (rt->backend->draw_key(rt->inner, mesh, material, items[i].model, &key))
+            draw_bucket_push(&rt->bucket, key, mesh, material, items[i].model, items[i].lod);
+        else
+            rt->bucket.rejected++;
+    }
+    rt->backend->merge_draws(rt->inner, &rt->bucket);
+}
+
+static void rt_replay_transient(RenderThread* rt, const RTCommand* cmd)
+{
+    RTTransient* t = cmd->u.transient.mesh;
+    const EngineVertex* vertices = (const EngineVertex*)((const uint8_t*)t + RT_TRANSIENT_HEADER);
+    const uint32_t* indices = (const uint32_t*)(vertices + t->backend.vertex_count);
+    if (!t->allocated && !t->failed) {
+        const uint32_t vertex_count = t->backend.vertex_count, index_count = t->backend.index_count;
+        t->failed = !rt->backend->transient_alloc(rt->inner, vertex_count, index_count, &t->backend);
+        if (!t->failed) {
+            memcpy(t->backend.vertices, vertices, (size_t)vertex_count * sizeof(EngineVertex));
+            memcpy(t->backend.indices, indices, (size_t)index_count * sizeof(uint32_t));
+        }
+        t->allocated = true;
+    }
+    if (t->failed) return;
+    rt->backend->draw_transient(rt->inner, &t->backend, rt_map(rt->material_map, cmd->u.transient.material), cmd->u.transient.model);
+}
+
+static void rt_end_frame(RenderThread* rt, uint32_t rejected)
+{
+    const RendererAPI* api = rt->backend;
+
+    PROFILE_BEGIN("render_submit");
+    api->end_frame(rt->inner);
+    PROFILE_END();
+
+    PROFILE_BEGIN("present");
+    const double present_start = rt->plat->time_now_seconds();
+    api->present(rt->inner);
+    const double present_end = rt->plat->time_now_seconds();
+    PROFILE_END();
+    PROFILE_END(); // render_frame
+    frame_pacing_present(&rt->pacing, present_end);
+
+    EngineRenderStats stats;
+    api->get_stats(rt->inner, &stats);
+    stats.draws_rejected += rejected;
+    stats.present_ms = (float)((present_end - present_start) * 1000.0);
+    stats.render_thread_ms = (float)((present_start - rt->frame_start) * 1000.0);
+    frame_pacing_stats(&rt->pacing, &stats);
+
+    // Background compiles finish between frames, so pending shaders are looked at once a frame.
+    // Entries of shaders destroyed since, whose slot may already hold another, are dropped.
+    for (uint32_t i = 0; i < rt->pending_shaders.count;) {
+        const R_Handle handle = D_ARRAY_DATA(&rt->pending_shaders, R_Handle)[i];
+        const uint32_t slot = handle_index(handle);
+        const bool live = (R_Handle)(atomic_load_u64(&rt->shader_status[slot]) >> 32) == handle && rt->shader_map[slot];
+        const EngineShaderStatus status = live ? api->shader_status(rt->inner, rt->shader_map[slot]) : ENGINE_SHADER_INVALID;
+        if (status == ENGINE_SHADER_COMPILING) {
+            ++i;
+            continue;
+        }
+        if (live) rt_store_status(rt, handle, status);
+        d_array_swap_remove(&rt->pending_shaders, i);
+    }
+
+    const EngineCommand* log = NULL;
+    const uint32_t log_count = api->get_command_log ? api->get_command_log(rt->inner, &log) : 0;
+    mutex_lock(rt->lock);
+    rt->published = stats;
+    d_array_clear(&rt->published_log);
+    if (log_count) d_array_append(&rt->published_log, log, log_count);
+    mutex_unlock(rt->lock);
+}
+
+static void rt_execute(RenderThread* rt, RTCommand* cmd)
+{
+    const RendererAPI* api = rt->backend;
+    Renderer* inner = rt->inner;
+    const uint32_t slot = handle_index(cmd->handle);
+
+    switch ((RTCommandType)cmd->type) {
+        case RT_CMD_BEGIN_FRAME:
+            PROFILE_BEGIN("render_frame");
+            rt->frame_start = rt->plat->time_now_seconds();
+            frame_arena_begin(&rt->frame_arena);
+            api->begin_frame(inner, cmd->u.frame.width, cmd->u.frame.height);
+            break;
+        case RT_CMD_END_FRAME:
+            rt_end_frame(rt, cmd->u.frame.rejected);
+            break;
+        case RT_CMD_CLEAR:
+            api->clear(inner, cmd->u.color[0], cmd->u.color[1], cmd->u.color[2], cmd->u.color[3]);
+            break;
+        case RT_CMD_SET_CAMERA:
+            api->set_camera(inner, cmd->u.camera);
+            break;
+        case RT_CMD_SET_UNIFORM:
+            api->material_set_uniform_f(inner, rt_map(rt->material_map, cmd->u.uniform.material),
+                                        cmd->u.uniform.name, cmd->u.uniform.vals, cmd->u.uniform.count);
+            break;
+        case RT_CMD_DRAW:
+            api->draw(inner, rt_map(rt->mesh_map, cmd->u.draw.mesh), rt_map(rt->material_map, cmd->u.draw.material), cmd->u.draw.model,
+                      cmd->u.draw.lod);
+            break;
+        case RT_CMD_DRAW_BUCKET:
+            rt_replay_bucket(rt, cmd->u.bucket.items, cmd->u.bucket.count);
+            break;
+        case RT_CMD_DRAW_TRANSIENT:
+            rt_replay_transient(rt, cmd);
+            break;
+        case RT_CMD_MESH_CREATE:
+            rt->mesh_map[slot] = api->mesh_create(inner, cmd->u.data);
+            mem_free(cmd->u.data);
+            break;
+        case RT_CMD_MESH_DESTROY:
+            if (rt->mesh_map[slot]) api->mesh_destroy(inner, rt->mesh_map[slot]);
+            rt->mesh_map[slot] = 0;
+            break;
+        case RT_CMD_SHADER_CREATE: {
+            const char* vs = cmd->u.data;
+            rt->shader_map[slot] = api->shader_create(inner, vs, vs + strlen(vs) + 1);
+            const EngineShaderStatus status = rt->shader_map[slot] ? api->shader_status(inner, rt->shader_map[slot]) : ENGINE_SHADER_FAILED;
+            rt_store_status(rt, cmd->handle, status);
+            R_Handle* pending = status == ENGINE_SHADER_COMPILING ? d_array_push(&rt->pending_shaders) : NULL;
+            if (pending) *pending = cmd->handle;
+            mem_free(cmd->u.data);
+            break;
+        }
+        case RT_CMD_SHADER_DESTROY:
+            if (rt->shader_map[slot]) api->shader_destroy(inner, rt->shader_map[slot]);
+            rt->shader_map[slot] = 0;
+            break;
+        case RT_CMD_TEXTURE_CREATE:
+            rt->texture_map[slot] = api->texture_create(inner, cmd->u.data);
+            mem_free(cmd->u.data);
+            break;
+        case RT_CMD_TEXTURE_DESTROY:
+            if (rt->texture_map[slot]) api->texture_destroy(inner, rt->texture_map[slot]);
+            rt->texture_map[slot] = 0;
+            break;
+        case RT_CMD_MATERIAL_CREATE: {
+            EngineMaterialDesc desc = cmd->u.material;
+            desc.shader = rt_map(rt->shader_map, desc.shader);
+            for (int i = 0; i < desc.texture_count; ++i) desc.texture[i] = rt_map(rt->texture_map, desc.texture[i]);
+            rt->material_map[slot] = api->material_create(inner, &desc);
+            break;
+        }
+        case RT_CMD_MATERIAL_DESTROY:
+            if (rt->material_map[slot]) api->material_destroy(inner, rt->material_map[slot]);
+            rt->material_map[slot] = 0;
+            break;
+    }
+}
+
+static int rt_main(void* arg)
+{
+    RenderThread* rt = arg;
+    profiler_set_thread_name("render");
+
+    rt->plat->make_current(rt->platform, true);
+    rt->inner = rt->backend->create(&rt->info);
+    rt->created = rt->inner != NULL;
+    for (int format = 0; rt->created && format < ENGINE_TEXTURE_FORMAT_COUNT; ++format)
+        rt->formats[format] = rt->backend->texture_format_supported(rt->inner, (EngineTextureFormat)format);
+    semaphore_post(rt->started);
+
+    bool quit = !rt->created;
+    while (!quit) {
+        semaphore_wait(rt->ready);
+        RTBuffer* buffer = &rt->buffers[rt->read];
+        // Buckets are replayed through one, which the frame's total bounds whichever thread filled them
+        draw_bucket_reserve(&rt->bucket, buffer->bucketed);
+        RTCommand* commands = D_ARRAY_DATA(&buffer->commands, RTCommand);
+        for (uint32_t i = 0; i < buffer->commands.count; ++i) rt_execute(rt, &commands[i]);
+        quit = buffer->quit;
+        rt->read ^= 1;
+        semaphore_post(rt->free);
+    }
+
+    if (rt->inner) rt->backend->destroy(rt->inner);
+    rt->plat->make_current(rt->platform, false);
+    return 0;
+}
+
+// Recording thread
+
+static RTBuffer* rt_buffer(RenderThread* rt)
+{
+    RTBuffer* buffer = &rt->buffers[rt->write];
+    if (rt->acquired) return buffer;
+
+    PROFILE_BEGIN("render_wait");
+    const uint64_t start = clock_ticks();
+    semaphore_wait(rt->free);
+    rt->wait_ticks += clock_ticks() - start;
+    PROFILE_END();
+
+    // The other buffer's first frame sizes this one, so neither grows once both have been used
+    d_array_clear(&buffer->commands);
+    d_array_reserve(&buffer->commands, rt->last_commands);
+    arena_reset(&buffer->arena);
+    buffer->bucketed = 0;
+    buffer->quit = false;
+    rt->acquired = true;
+    return buffer;
+}
+
+static RTCommand* rt_push(RenderThread* rt, RTCommandType type, R_Handle handle)
+{
+    // Grows during the first frames only - the buffers are reused afterwards
+    RTCommand* cmd = d_array_push(&rt_buffer(rt)->commands);
+    if (!cmd) return NULL;
+    cmd->type = (uint32_t)type;
+    cmd->handle = handle;
+    return cmd;
+}
+
+static void* rt_arena_alloc(RenderThread* rt, size_t size, size_t align)
+{
+    return arena_alloc(&rt_buffer(rt)->arena, size, align);
+}
+
+static void rt_hand_over(RenderThread* rt)
+{
+    // Even an empty buffer takes its turn, so the two sides stay in step
+    rt->last_commands = rt_buffer(rt)->commands.count;
+    semaphore_post(rt->ready);
+    rt->write ^= 1;
+    rt->acquired = false;
+}
+
+// Allocates the proxy handle of a resource and queues its creation. Frees data and returns
+// 0 on failure.
+static R_Handle rt_push_create(RenderThread* rt, HandlePool* pool, RTCommandType type, void* data, const char* fn)
+{
+    uint32_t dense, removed, moved;
+    const R_Handle handle = data ? handle_pool_alloc(pool, &dense) : 0;
+    RTCommand* cmd = handle ? rt_push(rt, type, handle) : NULL;
+    if (!cmd) {
+        if (handle) handle_pool_release(pool, handle, &removed, &moved);
+        mem_free(data);
+        fprintf(stderr, "%s: out of handles or memory\n", fn);
+        return 0;
+    }
+    cmd->u.data = data;
+    return handle;
+}
+
+static void rt_push_destroy(RenderThread* rt, HandlePool* pool, RTCommandType type, R_Handle handle, const char* fn)
+{
+    uint32_t removed, moved;
+    if (!handle_pool_release(pool, handle, &removed, &moved)) {
+        fprintf(stderr, "%s: stale or invalid handle 0x%08x\n", fn, handle);
+        return;
+    }
+    rt_push(rt, type, handle);
+}
+
+static void rt_destroy(Renderer* renderer);
+
+static Renderer* rt_create(RendererCreateInfo* create_info)
+{
+    if (!create_info->backend || !create_info->platform_api->make_current) return NULL;
+
+    RenderThread* rt = mem_calloc(1, sizeof *rt);
+    if (!rt) return NULL;
+
+    rt->plat = create_info->platform_api;
+    rt->platform = create_info->platform;
+    rt->backend = create_info->backend;
+    rt->info = *create_info;
+    rt->info.backend = NULL;
+    rt->info.frame_arena = &rt->frame_arena;
+
+    // Command buffers get as much room as a frame of engine scratch, since that is the budget
+    // the application already sized its transient geometry against
+    const size_t arena_size = create_info->frame_arena->frames[0].size;
+    bool ok = handle_pool_init(&rt->meshes, R_MAX_MESHES) && handle_pool_init(&rt->shaders, R_MAX_SHADERS)
+        && handle_pool_init(&rt->textures, R_MAX_TEXTURES) && handle_pool_init(&rt->materials, R_MAX_MATERIALS)
+        && frame_arena_init(&rt->frame_arena, arena_size);
+    for (int i = 0; i < 2; ++i) {
+        ok = ok && arena_init(&rt->buffers[i].arena, arena_size)
+            && d_array_init(&rt->buffers[i].commands, sizeof(RTCommand), 0, NULL)
+            && d_array_reserve(&rt->buffers[i].commands, RT_COMMANDS_MIN_CAPACITY);
+    }
+    ok = ok && d_array_init(&rt->log, sizeof(EngineCommand), 0, NULL) && d_array_init(&rt->published_log, sizeof(EngineCommand), 0, NULL)
+        && d_array_init(&rt->pending_shaders, sizeof(R_Handle), 0, NULL) && d_array_reserve(&rt->pending_shaders, R_MAX_SHADERS);
+
+    rt->mesh_map = mem_calloc(R_MAX_MESHES, sizeof(R_Handle));
+    rt->shader_map = mem_calloc(R_MAX_SHADERS, sizeof(R_Handle));
+    rt->texture_map = mem_calloc(R_MAX_TEXTURES, sizeof(R_Handle));
+    rt->material_map = mem_calloc(R_MAX_MATERIALS, sizeof(R_Handle));
+    rt->shader_status = mem_calloc(R_MAX_SHADERS, sizeof(uint64_t));
+    rt->ready = semaphore_create(0);
+    rt->free = semaphore_create(2);
+    rt->started = semaphore_create(0);
+    rt->lock = mutex_create();
+    ok = ok && rt->mesh_map && rt->shader_map && rt->texture_map && rt->material_map && rt->shader_status
+        && rt->ready && rt->free && rt->started && rt->lock;
+
+    // The backend is created on its thread, which takes the context over from this one
+    if (ok) {
+        rt->plat->make_current(rt->platform, false);
+        rt->thread = thread_create(rt_main, "render", rt);
+        if (rt->thread) semaphore_wait(rt->started);
+        else rt->plat->make_current(rt->platform, true);
+        ok = rt->thread && rt->created;
+    }
+    if (!ok) {
+        fprintf(stderr, "rt_create: unable to start the render thread\n");
+        rt_destroy((Renderer*)rt);
+        return NULL;
+    }
+    return (Renderer*)rt;
+}
+
+static void rt_destroy(Renderer* renderer)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    if (!rt) return;
+
+    if (rt->thread) {
+        // Whatever was recorded since the last frame still runs, then the backend is destroyed
+        if (rt->created) {
+            rt_buffer(rt)->quit = true;
+            rt_hand_over(rt);
+        }
+        thread_join(rt->thread);
+        rt->plat->make_current(rt->platform, true);
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        arena_shutdown(&rt->buffers[i].arena);
+        d_array_free(&rt->buffers[i].commands);
+    }
+    handle_pool_shutdown(&rt->meshes);
+    handle_pool_shutdown(&rt->shaders);
+    handle_pool_shutdown(&rt->textures);
+    handle_pool_shutdown(&rt->materials);
+    frame_arena_shutdown(&rt->frame_arena);
+    draw_bucket_free(&rt->bucket);
+    d_array_free(&rt->log);
+    d_array_free(&rt->published_log);
+    d_array_free(&rt->pending_shaders);
+    mem_free(rt->mesh_map);
+    mem_free(rt->shader_map);
+    mem_free(rt->texture_map);
+    mem_free(rt->material_map);
+    mem_free(rt->shader_status);
+    semaphore_destroy(rt->ready);
+    semaphore_destroy(rt->free);
+    semaphore_destroy(rt->started);
+    mutex_destroy(rt->lock);
+    mem_free(rt);
+}
+
+static void rt_begin(Renderer* renderer, int fb_w, int fb_h)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    RTCommand* cmd = rt_push(rt, RT_CMD_BEGIN_FRAME, 0);
+    if (cmd) {
+        cmd->u.frame.width = fb_w;
+        cmd->u.frame.height = fb_h;
+        cmd->u.frame.rejected = 0;
+    }
+
+    // Pick up the newest frame the render thread has finished
+    mutex_lock(rt->lock);
+    rt->stats = rt->published;
+    d_array_clear(&rt->log);
+    if (rt->published_log.count) d_array_append(&rt->log, rt->published_log.data, rt->published_log.count);
+    mutex_unlock(rt->lock);
+
+    rt->stats.frame_wait_ms = (float)((double)rt->wait_ticks * 1000.0 / (double)clock_frequency());
+    rt->wait_ticks = 0;
+}
+
+static void rt_end(Renderer* renderer)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    RTCommand* cmd = rt_push(rt, RT_CMD_END_FRAME, 0);
+    if (cmd) cmd->u.frame.rejected = rt->rejected;
+    rt->rejected = 0;
+    rt_hand_over(rt);
+}
+
+static void rt_present(Renderer* renderer)
+{
+    // The render thread presents each frame it is handed
+    (void)renderer;
+}
+
+static void rt_clear(Renderer* renderer, float red, float green, float blue, float alpha)
+{
+    RTCommand* cmd = rt_push((RenderThread*)renderer, RT_CMD_CLEAR, 0);
+    if (!cmd) return;
+    cmd->u.color[0] = red;
+    cmd->u.color[1] = green;
+    cmd->u.color[2] = blue;
+    cmd->u.color[3] = alpha;
+}
+
+// Resources
+
+static R_Handle rt_mesh_create(Renderer* renderer, const EngineMeshDesc* desc)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    if ((!desc->vertices && !desc->packed_vertices) || desc->vertex_count == 0 || !desc->indices || desc->indices_count == 0)
+        return 0;
+
+    VertexFormat format;
+    if (!vertex_format_get(&desc->layout, &format)) {
+        fprintf(stderr, "rt_mesh_create: invalid vertex layout\n");
+        return 0;
+    }
+
+    const size_t vertex_bytes = (size_t)desc->vertex_count * (desc->packed_vertices ? format.stride : sizeof(EngineVertex));
+    const size_t vertex_offset = RT_ALIGN(sizeof(EngineMeshDesc));
+    const size_t index_offset = RT_ALIGN(vertex_offset + vertex_bytes);
+    const size_t index_bytes = (size_t)desc->indices_count * sizeof(uint32_t);
+    MeshLodRanges lods;
+    const size_t lod_bytes = (size_t)(mesh_lod_ranges(desc, &lods) - desc->indices_count) * sizeof(uint32_t);
+    uint8_t* data = mem_alloc(index_offset + index_bytes + lod_bytes);
+    if (data) {
+        EngineMeshDesc* copy = (EngineMeshDesc*)data;
+        *copy = *desc;
+        memcpy(data + vertex_offset, desc->packed_vertices ? desc->packed_vertices : (const void*)desc->vertices, vertex_bytes);
+        memcpy(data + index_offset, desc->indices, index_bytes);
+        if (lod_bytes) memcpy(data + index_offset + index_bytes, desc->lods.indices, lod_bytes);
+        if (desc->packed_vertices) copy->packed_vertices = data + vertex_offset;
+        else copy->vertices = (const EngineVertex*)(data + vertex_offset);
+        copy->indices = (const uint32_t*)(data + index_offset);
+        copy->lods.indices = lod_bytes ? (const uint32_t*)(data + index_offset + index_bytes) : NULL;
+        copy->optimize_stats = NULL;
+    }
+    return rt_push_create(rt, &rt->meshes, RT_CMD_MESH_CREATE, data, "rt_mesh_create");
+}
+
+static void rt_mesh_destroy(Renderer* renderer, R_Handle handle)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    rt_push_destroy(rt, &rt->meshes, RT_CMD_MESH_DESTROY, handle, "rt_mesh_destroy");
+}
+
+static R_Handle rt_shader_create(Renderer* renderer, const char* vs_src, const char* fs_src)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    const size_t vs_size = strlen(vs_src) + 1, fs_size = strlen(fs_src) + 1;
+    char* data = mem_alloc(vs_size + fs_size);
+    if (data) {
+        memcpy(data, vs_src, vs_size);
+        memcpy(data + vs_size, fs_src, fs_size);
+    }
+    return rt_push_create(rt, &rt->shaders, RT_CMD_SHADER_CREATE, data, "rt_shader_create");
+}
+
+static void rt_shader_destroy(Renderer* renderer, R_Handle handle)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    rt_push_destroy(rt, &rt->shaders, RT_CMD_SHADER_DESTROY, handle, "rt_shader_destroy");
+}
+
+static EngineShaderStatus rt_shader_status(Renderer* renderer, R_Handle handle)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    if (!handle_pool_is_valid(&rt->shaders, handle)) return ENGINE_SHADER_INVALID;
+
+    // An entry left by an older shader in the slot means this one has not been created yet
+    const uint64_t entry = atomic_load_u64(&rt->shader_status[handle_index(handle)]);
+    return (R_Handle)(entry >> 32) == handle ? (EngineShaderStatus)(uint32_t)entry : ENGINE_SHADER_COMPILING;
+}
+
+static R_Handle rt_texture_create(Renderer* renderer, const EngineTextureDesc* desc)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    uint32_t mip_count;
+    bool generate;
+    if (!texture_desc_validate(desc, &mip_count, &generate)) {
+        fprintf(stderr, "rt_texture_create: invalid texture description\n");
+        return 0;
+    }
+    if (!rt->formats[desc->format]) {
+        fprintf(stderr, "rt_texture_create: format %d is not supported by this driver\n", (int)desc->format);
+        return 0;
+    }
+
+    // Only the levels given are copied; generated ones are made by the backend as usual
+    const uint32_t levels = desc->mip_count > 0 ? (uint32_t)desc->mip_count : 1;
+    const uint32_t width = (uint32_t)desc->width, height = (uint32_t)desc->height;
+    size_t size = RT_ALIGN(sizeof(EngineTextureDesc));
+    for (uint32_t level = 0; level < levels; ++level)
+        size += RT_ALIGN(texture_level_size(desc->format, texture_mip_extent(width, level), texture_mip_extent(height, level)));
+
+    uint8_t* data = mem_alloc(size);
+    if (data) {
+        EngineTextureDesc* copy = (EngineTextureDesc*)data;
+        *copy = *desc;
+        size_t offset = RT_ALIGN(sizeof(EngineTextureDesc));
+        for (uint32_t level = 0; level < levels; ++level) {
+            const size_t level_size = texture_level_size(desc->format, texture_mip_extent(width, level), texture_mip_extent(height, level));
+            memcpy(data + offset, desc->mip_count > 0 ? desc->levels[level] : desc->pixels, level_size);
+            if (desc->mip_count > 0) copy->levels[level] = data + offset;
+            else copy->pixels = data + offset;
+            offset += RT_ALIGN(level_size);
+        }
+        if (desc->mip_count > 0) copy->pixels = copy->levels[0];
+    }
+    return rt_push_create(rt, &rt->textures, RT_CMD_TEXTURE_CREATE, data, "rt_texture_create");
+}
+
+static void rt_texture_destroy(Renderer* renderer, R_Handle handle)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    rt_push_destroy(rt, &rt->textures, RT_CMD_TEXTURE_DESTROY, handle, "rt_texture_destroy");
+}
+
+static bool rt_texture_format_supported(Renderer* renderer, EngineTextureFormat format)
+{
+    return ((RenderThread*)renderer)->formats[format];
+}
+
+static R_Handle rt_material_create(Renderer* renderer, const EngineMaterialDesc* desc)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    uint32_t dense, removed, moved;
+    const R_Handle handle = handle_pool_alloc(&rt->materials, &dense);
+    RTCommand* cmd = handle ? rt_push(rt, RT_CMD_MATERIAL_CREATE, handle) : NULL;
+    if (!cmd) {
+        if (handle) handle_pool_release(&rt->materials, handle, &removed, &moved);
+        fprintf(stderr, "rt_material_create: out of handles or memory\n");
+        return 0;
+    }
+
+    // Stale handles become 0, which the backend rejects like any other invalid handle
+    EngineMaterialDesc* copy = &cmd->u.material;
+    *copy = *desc;
+    if (copy->texture_count < 0) copy->texture_count = 0;
+    if (copy->texture_count > R_MAX_MATERIAL_TEXTURES) copy->texture_count = R_MAX_MATERIAL_TEXTURES;
+    if (!handle_pool_is_valid(&rt->shaders, copy->shader)) copy->shader = 0;
+    for (int i = 0; i < copy->texture_count; ++i)
+        if (!handle_pool_is_valid(&rt->textures, copy->texture[i])) copy->texture[i] = 0;
+    return handle;
+}
+
+static void rt_material_destroy(Renderer* renderer, R_Handle handle)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    rt_push_destroy(rt, &rt->materials, RT_CMD_MATERIAL_DESTROY, handle, "rt_material_destroy");
+}
+
+// State
+
+static void rt_set_camera(Renderer* renderer, const EngineCamera* camera)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    EngineCamera* copy = rt_arena_alloc(rt, sizeof *copy, 16);
+    RTCommand* cmd = copy ? rt_push(rt, RT_CMD_SET_CAMERA, 0) : NULL;
+    if (!cmd) return;
+    *copy = *camera;
+    cmd->u.camera = copy;
+}
+
+static bool rt_draw_valid(RenderThread* rt, R_Handle mesh, R_Handle material)
+{
+    return handle_pool_is_valid(&rt->meshes, mesh) && handle_pool_is_valid(&rt->materials, material);
+}
+
+static void rt_draw(Renderer* renderer, R_Handle mesh, R_Handle material, const float model[16], uint32_t lod)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    RTCommand* cmd = rt_draw_valid(rt, mesh, material) ? rt_push(rt, RT_CMD_DRAW, 0) : NULL;
+    if (!cmd) {
+        rt->rejected++;
+        return;
+    }
+    memcpy(cmd->u.draw.model, model, sizeof cmd->u.draw.model);
+    cmd->u.draw.mesh = mesh;
+    cmd->u.draw.material = material;
+    cmd->u.draw.lod = lod;
+}
+
+static bool rt_draw_key(Renderer* renderer, R_Handle mesh, R_Handle material, const float model[16], uint64_t* out_key)
+{
+    // Only validates: the real key is made on the render thread, where the backend's state is
+    (void)model;
+    *out_key = 0;
+    return rt_draw_valid((RenderThread*)renderer, mesh, material);
+}
+
+static void rt_merge_draws(Renderer* renderer, DrawBucket* bucket)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    rt->rejected += bucket->rejected;
+    bucket->rejected = 0;
+    if (bucket->count == 0) return;
+
+    DrawItem* items = rt_arena_alloc(rt, (size_t)bucket->count * sizeof(DrawItem), 16);
+    RTCommand* cmd = items ? rt_push(rt, RT_CMD_DRAW_BUCKET, 0) : NULL;
+    if (!cmd) {
+        rt->rejected += bucket->count;
+    } else {
+        memcpy(items, bucket->items, (size_t)bucket->count * sizeof(DrawItem));
+        cmd->u.bucket.items = items;
+        cmd->u.bucket.count = bucket->count;
+        rt_buffer(rt)->bucketed += bucket->count;
+    }
+    bucket->count = 0;
+}
+
+static void rt_get_stats(Renderer* renderer, EngineRenderStats* out_stats)
+{
+    *out_stats = ((RenderThread*)renderer)->stats;
+}
+
+static bool rt_transient_alloc(Renderer* renderer, uint32_t vertex_count, uint32_t index_count, EngineTransientMesh* out)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    const size_t size = RT_TRANSIENT_HEADER + (size_t)vertex_count * sizeof(EngineVertex) + (size_t)index_count * sizeof(uint32_t);
+    RTTransient* t = rt_arena_alloc(rt, size, 16);
+    if (!t) return false;
+
+    memset(t, 0, sizeof *t);
+    t->backend.vertex_count = vertex_count;
+    t->backend.index_count = index_count;
+    out->vertices = (EngineVertex*)((uint8_t*)t + RT_TRANSIENT_HEADER);
+    out->indices = (uint32_t*)(out->vertices + vertex_count);
+    out->vertex_count = vertex_count;
+    out->index_count = index_count;
+    out->vertex_offset = 0;
+    out->index_offset = 0;
+    return true;
+}
+
+static void rt_draw_transient(Renderer* renderer, const EngineTransientMesh* mesh, R_Handle material, const float model[16])
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    RTCommand* cmd = handle_pool_is_valid(&rt->materials, material) ? rt_push(rt, RT_CMD_DRAW_TRANSIENT, 0) : NULL;
+    if (!cmd) {
+        rt->rejected++;
+        return;
+    }
+    cmd->u.transient.mesh = (RTTransient*)((uint8_t*)mesh->vertices - RT_TRANSIENT_HEADER);
+    cmd->u.transient.material = material;
+    memcpy(cmd->u.transient.model, model, sizeof cmd->u.transient.model);
+}
+
+static uint32_t rt_get_command_log(Renderer* renderer, const EngineCommand** out_commands)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    *out_commands = D_ARRAY_DATA(&rt->log, EngineCommand);
+    return rt->log.count;
+}
+
+static void rt_material_set_uniform_f(Renderer* renderer, R_Handle mat, const char* name, const float* val, int count)
+{
+    RenderThread* rt = (RenderThread*)renderer;
+    if (count <= 0 || !handle_pool_is_valid(&rt->materials, mat)) return;
+
+    const size_t name_size = strlen(name) + 1;
+    float* vals = rt_arena_alloc(rt, (size_t)count * sizeof(float) + name_size, 4);
+    RTCommand* cmd = vals ? rt_push(rt, RT_CMD_SET_UNIFORM, 0) : NULL;
+    if (!cmd) return;
+    memcpy(vals, val, (size_t)count * sizeof(float));
+    memcpy(vals + count, name, name_size);
+    cmd->u.uniform.name = (const char*)(vals + count);
+    cmd->u.uniform.vals = vals;
+    cmd->u.uniform.count = count;
+    cmd->u.uniform.material = mat;
+}
+
+static const RendererAPI api = {
+    .create = rt_create,
+    .destroy = rt_destroy,
+    .begin_frame = rt_begin,
+    .end_frame = rt_end,
+    .clear = rt_clear,
+    .present = rt_present,
+    .mesh_create = rt_mesh_create,
+    .mesh_destroy = rt_mesh_destroy,
+    .shader_create = rt_shader_create,
+    .shader_destroy = rt_shader_destroy,
+    .shader_status = rt_shader_status,
+    .texture_create = rt_texture_create,
+    .texture_destroy = rt_texture_destroy,
+    .texture_format_supported = rt_texture_format_supported,
+    .material_create = rt_material_create,
+    .material_destroy = rt_material_destroy,
+    .set_camera = rt_set_camera,
+    .draw = rt_draw,
+    .draw_key = rt_draw_key,
+    .merge_draws = rt_merge_draws,
+    .get_stats = rt_get_stats,
+    .transient_alloc = rt_transient_alloc,
+    .draw_transient = rt_draw_transient,
+    .get_command_log = rt_get_command_log,
+    .material_set_uniform_f = rt_material_set_uniform_f,
+};
+
+const RendererAPI* get_render_thread_api(void) { return &api; }
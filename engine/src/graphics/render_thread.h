@@ -0,0 +1,43 @@
+//
+// Created by Cain Martin on 2025/09/02.
+//
+
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <stdint.h>
+#include "renderer.h"
+
+// Runs a backend on a thread of its own (EngineConfig.render_thread), which owns the GL
+// context and does all submission and presenting. The RendererAPI below is what the engine
+// talks to instead: its calls only record. Resources get their handles at once and have
+// their data copied into the command stream; draws, camera and uniforms are appended to it.
+// end_frame hands the frame over and returns, so frame N is submitted and presented while
+// the caller records N+1. There are two command buffers - recording into one blocks only
+// while the render thread is still busy with the frame before the last.
+//
+// Handles are the proxy's own and are translated on the render thread, so a resource can be
+// created, drawn and destroyed within one frame without waiting for the backend. Stats,
+// shader status and the command log are those the render thread last published, picked up
+// at begin_frame.
+//
+// Pass the backend to wrap in RendererCreateInfo.backend. The platform's context is
+// released on the calling thread for the lifetime of the renderer.
+const RendererAPI* get_render_thread_api(void);
+
+// Present to present intervals, kept by whichever thread presents
+#define FRAME_PACING_WINDOW 64 // Power of two
+
+typedef struct FramePacing
+{
+    double   last_present;                   // Seconds, 0 before the first present
+    float    intervals[FRAME_PACING_WINDOW]; // Milliseconds, a ring
+    uint32_t count;                          // Intervals recorded so far
+} FramePacing;
+
+void frame_pacing_present(FramePacing* pacing, double now_seconds);
+
+// Fills frame_interval_ms and frame_interval_max_ms
+void frame_pacing_stats(const FramePacing* pacing, EngineRenderStats* out_stats);
+
+#endif //RENDER_THREAD_H
@@ -8,16 +8,37 @@
 #include "../../include/engine.h"
 
 typedef struct Renderer Renderer;
+struct DrawBucket;
 
 typedef struct RendererCreateInfo
 {
     const struct PlatformAPI* platform_api; // Opaque bridge
     struct Platform* platform;
+    struct FrameArena* frame_arena; // Switched by the engine at the start of each frame
     int fb_width, fb_height;
+    const char* shader_cache_dir; // NULL when disabled
+    const struct RendererAPI* backend; // Driven by the render thread proxy; backends ignore it
+    struct JobSystem* jobs;         // For CPU work at create time, e.g. vertex encoding. May be NULL.
 } RendererCreateInfo;
 
+// Generational handle (see core/handle_pool.h). 0 is never a valid handle, and a destroyed
+// handle goes stale instead of aliasing whatever reuses its slot.
 typedef uint32_t R_Handle;
 
+// Resource table sizes. Tables are allocated once when the renderer is created.
+#define R_MAX_MESHES    16384
+#define R_MAX_SHADERS   1024
+#define R_MAX_TEXTURES  8192
+#define R_MAX_MATERIALS 8192
+#define R_MAX_MATERIAL_TEXTURES 4
+
+// Meshes get 16 bit indices whenever every vertex is addressable with them
+#define R_MAX_SHORT_INDEX_VERTICES 65536
+static inline uint32_t r_index_size(uint32_t vertex_count)
+{
+    return vertex_count <= R_MAX_SHORT_INDEX_VERTICES ? 2 : 4;
+}
+
 typedef struct RendererAPI {
     Renderer* (*create)(RendererCreateInfo *create_info);
     void (*destroy)(Renderer* renderer);
@@ -32,9 +53,11 @@ typedef struct RendererAPI {
 
     R_Handle (*shader_create)(Renderer*, const char* vs_src, const char* fs_src);
     void (*shader_destroy)(Renderer*, R_Handle);
+    EngineShaderStatus (*shader_status)(Renderer*, R_Handle);
 
     R_Handle (*texture_create)(Renderer*, const EngineTextureDesc*);
     void (*texture_destroy)(Renderer*, R_Handle);
+    bool (*texture_format_supported)(Renderer*, EngineTextureFormat);
 
     R_Handle (*material_create)(Renderer*, const EngineMaterialDesc*);
     void (*material_destroy)(Renderer*, R_Handle);
@@ -42,10 +65,30 @@ typedef struct RendererAPI {
     // State
     void (*set_camera)(Renderer*, const EngineCamera*);
 
+    // Queues a draw for the current frame. The queue is sorted and flushed by end_frame. lod
+    // picks a level of the mesh's EngineMeshLods chain, clamped to its coarsest.
+    void (*draw)(Renderer*, R_Handle mesh, R_Handle material, const float model[16], uint32_t lod);
+
+    // Sort key of a draw, false for stale handles. Only reads, so any thread may call it as
+    // long as no resource is created or destroyed and the camera is not set meanwhile.
+    bool (*draw_key)(Renderer*, R_Handle mesh, R_Handle material, const float model[16], uint64_t* out_key);
+    // Moves draws recorded on other threads into this frame's queue and empties the bucket
+    void (*merge_draws)(Renderer*, struct DrawBucket* bucket);
+
+    void (*get_stats)(Renderer*, EngineRenderStats* out_stats);
+
+    // Per frame geometry written in place, drawn after the queue in submission order
+    bool (*transient_alloc)(Renderer*, uint32_t vertex_count, uint32_t index_count, EngineTransientMesh* out);
+    void (*draw_transient)(Renderer*, const EngineTransientMesh*, R_Handle material, const float model[16]);
+
+    // Optional - only recording backends provide a command log
+    uint32_t (*get_command_log)(Renderer*, const EngineCommand** out_commands);
+
     // Uniforms by name
     void (*material_set_uniform_f)(Renderer*, R_Handle mat, const char* name, const float* val, int count);
 } RendererAPI;
 
-const RendererAPI* get_renderer_api(void);
+const RendererAPI* get_renderer_api(void);      // OpenGL
+const RendererAPI* get_null_renderer_api(void); // Headless, records commands
 
 #endif //RENDERER_H
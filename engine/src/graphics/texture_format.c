@@ -0,0 +1,71 @@
+//
+// Created by Cain Martin on 2025/08/31.
+//
+
+#include "texture_format.h"
+
+bool texture_format_info(EngineTextureFormat format, TextureFormatInfo* out)
+{
+    static const TextureFormatInfo infos[ENGINE_TEXTURE_FORMAT_COUNT] = {
+        [ENGINE_TEXTURE_RGBA8]     = { 4,  1, 4, false },
+        [ENGINE_TEXTURE_RGB8]      = { 3,  1, 3, false },
+        [ENGINE_TEXTURE_R8]        = { 1,  1, 1, false },
+        [ENGINE_TEXTURE_SRGB8_A8]  = { 4,  1, 4, true  },
+        [ENGINE_TEXTURE_SRGB8]     = { 3,  1, 3, true  },
+        [ENGINE_TEXTURE_BC1]       = { 8,  4, 0, false },
+        [ENGINE_TEXTURE_BC1_SRGB]  = { 8,  4, 0, true  },
+        [ENGINE_TEXTURE_BC3]       = { 16, 4, 0, false },
+        [ENGINE_TEXTURE_BC3_SRGB]  = { 16, 4, 0, true  },
+        [ENGINE_TEXTURE_BC4]       = { 8,  4, 0, false },
+        [ENGINE_TEXTURE_BC5]       = { 16, 4, 0, false },
+        [ENGINE_TEXTURE_BC7]       = { 16, 4, 0, false },
+        [ENGINE_TEXTURE_BC7_SRGB]  = { 16, 4, 0, true  },
+    };
+    if ((unsigned)format >= ENGINE_TEXTURE_FORMAT_COUNT) return false;
+    *out = infos[format];
+    return true;
+}
+
+size_t texture_level_size(EngineTextureFormat format, uint32_t width, uint32_t height)
+{
+    TextureFormatInfo info;
+    if (width == 0 || height == 0 || !texture_format_info(format, &info)) return 0;
+    const size_t blocks_x = (width + info.block_size - 1) / info.block_size;
+    const size_t blocks_y = (height + info.block_size - 1) / info.block_size;
+    return blocks_x * blocks_y * info.block_bytes;
+}
+
+uint32_t texture_mip_count(uint32_t width, uint32_t height)
+{
+    uint32_t count = 1;
+    for (uint32_t extent = width > height ? width : height; extent > 1 && count < ENGINE_TEXTURE_MAX_MIPS; extent >>= 1)
+        ++count;
+    return count;
+}
+
+uint64_t texture_chain_size(EngineTextureFormat format, uint32_t width, uint32_t height,
+                            uint32_t first_level, uint32_t mip_count)
+{
+    uint64_t size = 0;
+    for (uint32_t level = first_level; level < mip_count; ++level)
+        size += texture_level_size(format, texture_mip_extent(width, level), texture_mip_extent(height, level));
+    return size;
+}
+
+bool texture_desc_validate(const EngineTextureDesc* desc, uint32_t* out_mip_count, bool* out_generate)
+{
+    TextureFormatInfo info;
+    if (desc->width <= 0 || desc->height <= 0 || !texture_format_info(desc->format, &info)) return false;
+
+    const uint32_t width = (uint32_t)desc->width, height = (uint32_t)desc->height;
+    *out_generate = desc->mip_count == 0 && info.channels > 0;
+    if (desc->mip_count == 0) {
+        *out_mip_count = *out_generate ? texture_mip_count(width, height) : 1;
+        return desc->pixels != NULL;
+    }
+    if (desc->mip_count < 0 || (uint32_t)desc->mip_count > texture_mip_count(width, height)) return false;
+    for (int level = 0; level < desc->mip_count; ++level)
+        if (!desc->levels[level]) return false;
+    *out_mip_count = (uint32_t)desc->mip_count;
+    return true;
+}
@@ -0,0 +1,46 @@
+//
+// Created by Cain Martin on 2025/08/31.
+//
+
+#ifndef TEXTURE_FORMAT_H
+#define TEXTURE_FORMAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+
+// Storage of one texel, or of one 4x4 block for the compressed formats
+typedef struct TextureFormatInfo
+{
+    uint32_t block_bytes;
+    uint32_t block_size;  // Texels along each side of a block: 1, or 4 when compressed
+    uint32_t channels;    // Of the uncompressed formats, 0 when compressed
+    bool     srgb;
+} TextureFormatInfo;
+
+// Returns false for an unknown format
+bool     texture_format_info(EngineTextureFormat format, TextureFormatInfo* out);
+
+// Bytes in one level, rows tightly packed; 0 for an unknown format or empty size
+size_t   texture_level_size(EngineTextureFormat format, uint32_t width, uint32_t height);
+
+// Levels in a full chain down to 1x1, capped at ENGINE_TEXTURE_MAX_MIPS
+uint32_t texture_mip_count(uint32_t width, uint32_t height);
+
+// Bytes in levels first_level to mip_count - 1 of a chain
+uint64_t texture_chain_size(EngineTextureFormat format, uint32_t width, uint32_t height,
+                            uint32_t first_level, uint32_t mip_count);
+
+static inline uint32_t texture_mip_extent(uint32_t extent, uint32_t level)
+{
+    extent >>= level;
+    return extent ? extent : 1;
+}
+
+// Checks the descriptor's size, format and levels. out_mip_count is the levels the texture
+// ends up with; out_generate is set when only level 0 is given and the backend generates the
+// rest (uncompressed formats with mip_count 0).
+bool     texture_desc_validate(const EngineTextureDesc* desc, uint32_t* out_mip_count, bool* out_generate);
+
+#endif //TEXTURE_FORMAT_H
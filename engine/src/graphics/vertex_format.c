@@ -0,0 +1,362 @@
+//
+// Created by Cain Martin on 2025/08/29.
+//
+
+#include <math.h>
+#include <string.h>
+#include "vertex_format.h"
+#include "../core/simd.h"
+
+// A vertex is encoded as up to 8 32-bit words - every format is a multiple of 4 bytes - so
+// the SIMD path can produce one word column for four vertices at a time and interleave last.
+#define VERTEX_MAX_WORDS 8
+
+// Guards the octahedral divide for zero normals, which encode as (0, 0)
+#define VERTEX_OCT_EPSILON 1e-20f
+
+// Vertices per job at least when encoding on the job system
+#define VERTEX_JOB_VERTICES 16384
+
+static uint32_t position_size(EnginePositionFormat format)
+{
+    switch (format) {
+        case ENGINE_POSITION_FLOAT3: return 12;
+        case ENGINE_POSITION_HALF3:  return 8;
+        default: return 0;
+    }
+}
+
+static uint32_t normal_size(EngineNormalFormat format)
+{
+    switch (format) {
+        case ENGINE_NORMAL_FLOAT3:          return 12;
+        case ENGINE_NORMAL_INT_2_10_10_10:  return 4;
+        case ENGINE_NORMAL_OCT16:           return 4;
+        case ENGINE_NORMAL_NONE:            return 0;
+        default: return UINT32_MAX;
+    }
+}
+
+static uint32_t uv_size(EngineUVFormat format)
+{
+    switch (format) {
+        case ENGINE_UV_FLOAT2:  return 8;
+        case ENGINE_UV_UNORM16: return 4;
+        case ENGINE_UV_NONE:    return 0;
+        default: return UINT32_MAX;
+    }
+}
+
+bool vertex_format_get(const EngineVertexLayout* layout, VertexFormat* out)
+{
+    const uint32_t sizes[3] = { position_size(layout->position), normal_size(layout->normal), uv_size(layout->uv) };
+    if (sizes[0] == 0 || sizes[1] == UINT32_MAX || sizes[2] == UINT32_MAX) return false;
+
+    out->stride = 0;
+    for (int a = 0; a < 3; ++a) {
+        out->offset[a] = sizes[a] ? out->stride : 0;
+        out->size[a] = sizes[a];
+        out->stride += sizes[a];
+    }
+    return true;
+}
+
+bool vertex_layout_is_full(const EngineVertexLayout* layout)
+{
+    return layout->position == ENGINE_POSITION_FLOAT3 && layout->normal == ENGINE_NORMAL_FLOAT3
+        && layout->uv == ENGINE_UV_FLOAT2;
+}
+
+// Scalar
+
+static uint32_t float_bits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof bits);
+    return bits;
+}
+
+static float bits_float(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof value);
+    return value;
+}
+
+uint16_t vertex_float_to_half(float value)
+{
+    uint32_t bits = float_bits(value);
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t half;
+    if (bits >= (127u + 16u) << 23) {
+        half = bits > 255u << 23 ? 0x7e00 : 0x7c00; // NaN stays NaN, the rest overflows to inf
+    } else if (bits < 113u << 23) {
+        // Denormal: let the FPU shift the mantissa into place by adding a magic float
+        const uint32_t magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+        half = float_bits(bits_float(bits) + bits_float(magic)) - magic;
+    } else {
+        const uint32_t mantissa_odd = (bits >> 13) & 1;
+        bits += ((uint32_t)(15 - 127) << 23) + 0xfff;
+        half = (bits + mantissa_odd) >> 13;
+    }
+    return (uint16_t)(half | (sign >> 16));
+}
+
+float vertex_half_to_float(uint16_t half)
+{
+    const uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1f, mantissa = half & 0x3ff;
+    if (exponent == 0x1f) return bits_float(sign | 0x7f800000u | mantissa << 13);
+    if (exponent != 0) return bits_float(sign | (exponent + 112u) << 23 | mantissa << 13);
+    // Zero and denormals: the mantissa counts in units of 2^-24
+    const float value = (float)mantissa * (1.0f / 16777216.0f);
+    return sign ? -value : value;
+}
+
+void vertex_decode_position(const EngineVertexLayout* layout, const void* vertices, uint32_t index, float out[3])
+{
+    VertexFormat format;
+    if (!vertex_format_get(layout, &format)) return;
+    const uint8_t* at = (const uint8_t*)vertices + (size_t)index * format.stride + format.offset[0];
+    if (layout->position == ENGINE_POSITION_FLOAT3) {
+        memcpy(out, at, 3 * sizeof(float));
+    } else {
+        uint16_t half[3];
+        memcpy(half, at, sizeof half);
+        for (int c = 0; c < 3; ++c) out[c] = vertex_half_to_float(half[c]);
+    }
+}
+
+static int32_t snorm(float value, float scale)
+{
+    value = value < -1.0f ? -1.0f : value > 1.0f ? 1.0f : value;
+    return (int32_t)lrintf(value * scale);
+}
+
+static uint32_t unorm16(float value)
+{
+    value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+    return (uint32_t)lrintf(value * 65535.0f);
+}
+
+static void oct_encode(const float n[3], float* out_x, float* out_y)
+{
+    float l1 = fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]);
+    if (l1 < VERTEX_OCT_EPSILON) l1 = VERTEX_OCT_EPSILON;
+    float x = n[0] / l1, y = n[1] / l1;
+    if (n[2] < 0.0f) {
+        // Fold the lower hemisphere over the diagonals
+        const float fx = (1.0f - fabsf(y)) * copysignf(1.0f, x);
+        const float fy = (1.0f - fabsf(x)) * copysignf(1.0f, y);
+        x = fx;
+        y = fy;
+    }
+    *out_x = x;
+    *out_y = y;
+}
+
+static uint32_t encode_one(const EngineVertexLayout* layout, const EngineVertex* v, uint32_t* words)
+{
+    uint32_t n = 0;
+
+    if (layout->position == ENGINE_POSITION_FLOAT3) {
+        for (int c = 0; c < 3; ++c) words[n++] = float_bits(v->pos[c]);
+    } else {
+        words[n++] = vertex_float_to_half(v->pos[0]) | (uint32_t)vertex_float_to_half(v->pos[1]) << 16;
+        words[n++] = vertex_float_to_half(v->pos[2]);
+    }
+
+    if (layout->normal == ENGINE_NORMAL_FLOAT3) {
+        for (int c = 0; c < 3; ++c) words[n++] = float_bits(v->normal[c]);
+    } else if (layout->normal == ENGINE_NORMAL_INT_2_10_10_10) {
+        words[n++] = ((uint32_t)snorm(v->normal[0], 511.0f) & 0x3ff)
+            | ((uint32_t)snorm(v->normal[1], 511.0f) & 0x3ff) << 10
+            | ((uint32_t)snorm(v->normal[2], 511.0f) & 0x3ff) << 20;
+    } else if (layout->normal == ENGINE_NORMAL_OCT16) {
+        float x, y;
+        oct_encode(v->normal, &x, &y);
+        words[n++] = ((uint32_t)snorm(x, 32767.0f) & 0xffff) | (uint32_t)snorm(y, 32767.0f) << 16;
+    }
+
+    if (layout->uv == ENGINE_UV_FLOAT2) {
+        words[n++] = float_bits(v->uv[0]);
+        words[n++] = float_bits(v->uv[1]);
+    } else if (layout->uv == ENGINE_UV_UNORM16) {
+        words[n++] = unorm16(v->uv[0]) | unorm16(v->uv[1]) << 16;
+    }
+
+    return n;
+}
+
+// SSE2: four vertices per iteration, one attribute component per register
+
+#ifdef ENGINE_SSE2
+
+static __m128i select_si128(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static __m128i half4(__m128 value)
+{
+#ifdef ENGINE_F16C
+    return _mm_unpacklo_epi16(_mm_cvtps_ph(value, _MM_FROUND_TO_NEAREST_INT), _mm_setzero_si128());
+#else
+    // vertex_float_to_half, with both branches computed and selected per lane
+    __m128i bits = _mm_castps_si128(value);
+    const __m128i sign = _mm_and_si128(bits, _mm_set1_epi32((int)0x80000000u));
+    bits = _mm_xor_si128(bits, sign);
+
+    const __m128i overflow = _mm_cmpgt_epi32(bits, _mm_set1_epi32(((127 + 16) << 23) - 1));
+    const __m128i nan = _mm_cmpgt_epi32(bits, _mm_set1_epi32(255 << 23));
+    const __m128i inf_or_nan = select_si128(nan, _mm_set1_epi32(0x7e00), _mm_set1_epi32(0x7c00));
+
+    const __m128i denormal = _mm_cmplt_epi32(bits, _mm_set1_epi32(113 << 23));
+    const __m128i magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i denormal_half = _mm_sub_epi32(
+        _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(magic))), magic);
+
+    const __m128i mantissa_odd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+    __m128i normal_half = _mm_add_epi32(bits, _mm_set1_epi32((int)(((uint32_t)(15 - 127) << 23) + 0xfff)));
+    normal_half = _mm_srli_epi32(_mm_add_epi32(normal_half, mantissa_odd), 13);
+
+    __m128i half = select_si128(denormal, denormal_half, normal_half);
+    half = select_si128(overflow, inf_or_nan, half);
+    return _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+#endif
+}
+
+static __m128i snorm4(__m128 value, float scale)
+{
+    value = _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+    return _mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(scale)));
+}
+
+static __m128i unorm16x4(__m128 value)
+{
+    value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(65535.0f)));
+}
+
+static __m128 abs4(__m128 value)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+}
+
+static __m128 sign4(__m128 value) // copysign(1, value)
+{
+    return _mm_or_ps(_mm_and_ps(value, _mm_set1_ps(-0.0f)), _mm_set1_ps(1.0f));
+}
+
+static uint32_t encode_four(const EngineVertexLayout* layout, const EngineVertex* v, __m128i* columns)
+{
+    // EngineVertex is 8 floats: two transposes give each component for all four vertices
+    const float* f = (const float*)v;
+    __m128 px = _mm_loadu_ps(f),      py = _mm_loadu_ps(f + 8),  pz = _mm_loadu_ps(f + 16), nx = _mm_loadu_ps(f + 24);
+    __m128 ny = _mm_loadu_ps(f + 4),  nz = _mm_loadu_ps(f + 12), tu = _mm_loadu_ps(f + 20), tv = _mm_loadu_ps(f + 28);
+    _MM_TRANSPOSE4_PS(px, py, pz, nx);
+    _MM_TRANSPOSE4_PS(ny, nz, tu, tv);
+
+    uint32_t n = 0;
+
+    if (layout->position == ENGINE_POSITION_FLOAT3) {
+        columns[n++] = _mm_castps_si128(px);
+        columns[n++] = _mm_castps_si128(py);
+        columns[n++] = _mm_castps_si128(pz);
+    } else {
+        columns[n++] = _mm_or_si128(half4(px), _mm_slli_epi32(half4(py), 16));
+        columns[n++] = half4(pz);
+    }
+
+    if (layout->normal == ENGINE_NORMAL_FLOAT3) {
+        columns[n++] = _mm_castps_si128(nx);
+        columns[n++] = _mm_castps_si128(ny);
+        columns[n++] = _mm_castps_si128(nz);
+    } else if (layout->normal == ENGINE_NORMAL_INT_2_10_10_10) {
+        const __m128i mask = _mm_set1_epi32(0x3ff);
+        columns[n++] = _mm_or_si128(_mm_or_si128(
+            _mm_and_si128(snorm4(nx, 511.0f), mask),
+            _mm_slli_epi32(_mm_and_si128(snorm4(ny, 511.0f), mask), 10)),
+            _mm_slli_epi32(_mm_and_si128(snorm4(nz, 511.0f), mask), 20));
+    } else if (layout->normal == ENGINE_NORMAL_OCT16) {
+        const __m128 l1 = _mm_max_ps(_mm_add_ps(_mm_add_ps(abs4(nx), abs4(ny)), abs4(nz)), _mm_set1_ps(VERTEX_OCT_EPSILON));
+        const __m128 x = _mm_div_ps(nx, l1), y = _mm_div_ps(ny, l1);
+        const __m128 fx = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), abs4(y)), sign4(x));
+        const __m128 fy = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), abs4(x)), sign4(y));
+        const __m128 lower = _mm_cmplt_ps(nz, _mm_setzero_ps());
+        const __m128 ox = _mm_or_ps(_mm_and_ps(lower, fx), _mm_andnot_ps(lower, x));
+        const __m128 oy = _mm_or_ps(_mm_and_ps(lower, fy), _mm_andnot_ps(lower, y));
+        columns[n++] = _mm_or_si128(_mm_and_si128(snorm4(ox, 32767.0f), _mm_set1_epi32(0xffff)),
+                                    _mm_slli_epi32(snorm4(oy, 32767.0f), 16));
+    }
+
+    if (layout->uv == ENGINE_UV_FLOAT2) {
+        columns[n++] = _mm_castps_si128(tu);
+        columns[n++] = _mm_castps_si128(tv);
+    } else if (layout->uv == ENGINE_UV_UNORM16) {
+        columns[n++] = _mm_or_si128(unorm16x4(tu), _mm_slli_epi32(unorm16x4(tv), 16));
+    }
+
+    return n;
+}
+
+#endif
+
+typedef struct VertexEncodeJob
+{
+    const EngineVertexLayout* layout;
+    VertexFormat              format;
+    const EngineVertex*       src;
+    uint8_t*                  dst;
+} VertexEncodeJob;
+
+static void encode_range(void* data, uint32_t begin, uint32_t end)
+{
+    const VertexEncodeJob* job = data;
+    const EngineVertexLayout* layout = job->layout;
+    const VertexFormat format = job->format;
+    const EngineVertex* src = job->src;
+    uint8_t* out = job->dst;
+    uint32_t i = begin;
+
+#ifdef ENGINE_SSE2
+    for (; i + 4 <= end; i += 4) {
+        __m128i columns[VERTEX_MAX_WORDS];
+        const uint32_t n = encode_four(layout, src + i, columns);
+        uint8_t* base = out + (size_t)i * format.stride;
+
+        // Interleave the columns back into vertices, four words at a time by transposing
+        uint32_t k = 0;
+        for (; k + 4 <= n; k += 4) {
+            const __m128i t0 = _mm_unpacklo_epi32(columns[k], columns[k + 1]);
+            const __m128i t1 = _mm_unpacklo_epi32(columns[k + 2], columns[k + 3]);
+            const __m128i t2 = _mm_unpackhi_epi32(columns[k], columns[k + 1]);
+            const __m128i t3 = _mm_unpackhi_epi32(columns[k + 2], columns[k + 3]);
+            _mm_storeu_si128((__m128i*)(base + 4 * k), _mm_unpacklo_epi64(t0, t1));
+            _mm_storeu_si128((__m128i*)(base + format.stride + 4 * k), _mm_unpackhi_epi64(t0, t1));
+            _mm_storeu_si128((__m128i*)(base + 2 * format.stride + 4 * k), _mm_unpacklo_epi64(t2, t3));
+            _mm_storeu_si128((__m128i*)(base + 3 * format.stride + 4 * k), _mm_unpackhi_epi64(t2, t3));
+        }
+        for (; k < n; ++k) {
+            uint32_t words[4];
+            _mm_storeu_si128((__m128i*)words, columns[k]);
+            for (uint32_t v = 0; v < 4; ++v) memcpy(base + v * format.stride + 4 * k, &words[v], 4);
+        }
+    }
+#endif
+
+    for (; i < end; ++i) {
+        uint32_t vertex[VERTEX_MAX_WORDS];
+        encode_one(layout, &src[i], vertex);
+        memcpy(out + (size_t)i * format.stride, vertex, format.stride);
+    }
+}
+
+void vertex_encode(JobSystem* jobs, const EngineVertexLayout* layout, const EngineVertex* src, uint32_t count, void* dst)
+{
+    VertexEncodeJob job = { layout, { 0 }, src, dst };
+    if (!vertex_format_get(layout, &job.format)) return;
+    job_system_parallel_for(jobs, count, VERTEX_JOB_VERTICES, encode_range, &job);
+}
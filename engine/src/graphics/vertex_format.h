@@ -0,0 +1,40 @@
+//
+// Created by Cain Martin on 2025/08/29.
+//
+
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../include/engine.h"
+#include "../core/job_system.h"
+
+// Byte offsets of position, normal and uv within a vertex of the layout. Attributes the
+// layout leaves out get offset 0 and size 0.
+typedef struct VertexFormat
+{
+    uint32_t stride;
+    uint32_t offset[3];
+    uint32_t size[3];
+} VertexFormat;
+
+// Returns false for a layout with an unknown format
+bool     vertex_format_get(const EngineVertexLayout* layout, VertexFormat* out);
+
+// True for the zero layout, which stores EngineVertex as is
+bool     vertex_layout_is_full(const EngineVertexLayout* layout);
+
+// Converts count EngineVertex into layout at dst (count * stride bytes, any alignment).
+// Four vertices at a time with SSE2 where available; large meshes are split across jobs,
+// which may be NULL.
+void     vertex_encode(JobSystem* jobs, const EngineVertexLayout* layout, const EngineVertex* src, uint32_t count, void* dst);
+
+// Round to nearest even, overflow to infinity. Scalar, used for the tail of the SIMD loop.
+uint16_t vertex_float_to_half(float value);
+float    vertex_half_to_float(uint16_t half);
+
+// Position of one vertex of an encoded array, for CPU-side work such as bounds
+void     vertex_decode_position(const EngineVertexLayout* layout, const void* vertices, uint32_t index, float out[3]);
+
+#endif //VERTEX_FORMAT_H
@@ -0,0 +1,15 @@
+//
+// Created by Cain Martin on 2025/08/28.
+//
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+// Raw high resolution counter, cheaper than PlatformAPI.time_now_seconds in hot code and
+// usable from any thread without a platform instance
+uint64_t clock_ticks(void);
+uint64_t clock_frequency(void); // Ticks per second
+
+#endif //CLOCK_H
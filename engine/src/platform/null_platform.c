@@ -0,0 +1,90 @@
+//
+// Created by Cain Martin on 2025/08/25.
+//
+
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+#include "platform.h"
+#include "../core/memory.h"
+
+// Headless platform for build machines without a display. There is no window, no GL context
+// and no input; the drawable size is whatever the engine was created with.
+struct Platform
+{
+    int width;
+    int height;
+};
+
+static Platform* null_create(int w, int h, const char* title, int vsync)
+{
+    (void)title;
+    (void)vsync;
+
+    Platform* p = mem_alloc(sizeof(*p));
+    if (!p) return NULL;
+
+    p->width = w;
+    p->height = h;
+
+    return p;
+}
+
+static void null_destroy(Platform* platform)
+{
+    mem_free(platform);
+}
+
+static void* null_get_gl_proc(const char* name)
+{
+    (void)name;
+    return NULL;
+}
+
+static void null_swap_buffers(Platform* platform)
+{
+    (void)platform;
+}
+
+static void null_make_current(Platform* platform, bool current)
+{
+    (void)platform;
+    (void)current;
+}
+
+static void null_poll_events(const Platform* platform, struct InputSystem* input_system, bool* out_should_quit)
+{
+    (void)platform;
+    (void)input_system;
+    (void)out_should_quit;
+}
+
+static double null_time_now_seconds(void)
+{
+    // The SDL timer works without SDL_Init, so no video subsystem is touched
+    static double freq_inv = 0.0;
+    if (freq_inv == 0.0) freq_inv = 1.0 / (double) SDL_GetPerformanceFrequency();
+
+    return (double)SDL_GetPerformanceCounter() * freq_inv;
+}
+
+static void null_get_drawable_size(Platform* p, int* w, int* h)
+{
+    *w = p->width;
+    *h = p->height;
+}
+
+const PlatformAPI* null_platform_get_api(void)
+{
+    static const PlatformAPI api = {
+        .create = null_create,
+        .destroy = null_destroy,
+        .get_gl_proc = null_get_gl_proc,
+        .swap_buffers = null_swap_buffers,
+        .make_current = null_make_current,
+        .poll_events = null_poll_events,
+        .time_now_seconds = null_time_now_seconds,
+        .get_drawable_size = null_get_drawable_size,
+    };
+
+    return &api;
+}
@@ -17,10 +17,13 @@ typedef struct PlatformAPI
     void* (*get_gl_proc)(const char* name);
     void (*poll_events)(const Platform* platform, struct InputSystem* input_system, bool* out_should_quit);
     void (*swap_buffers)(Platform* platform);
+    // Makes the GL context current on the calling thread, or releases it from that thread
+    void (*make_current)(Platform* platform, bool current);
     double (*time_now_seconds)(void);
     void (*get_drawable_size)(Platform* platform, int* width, int* height);
 } PlatformAPI;
 
-const PlatformAPI* platform_get_api(void);
+const PlatformAPI* platform_get_api(void);          // SDL window + GL context
+const PlatformAPI* null_platform_get_api(void);     // Headless, no window
 
 #endif //PLATFORM_H
@@ -0,0 +1,16 @@
+//
+// Created by Cain Martin on 2025/08/28.
+//
+
+#include <SDL3/SDL.h>
+#include "clock.h"
+
+uint64_t clock_ticks(void)
+{
+    return SDL_GetPerformanceCounter();
+}
+
+uint64_t clock_frequency(void)
+{
+    return SDL_GetPerformanceFrequency();
+}
@@ -6,6 +6,7 @@
 #include <SDL3/SDL.h>
 #include <stdlib.h>
 #include "platform.h"
+#include "../core/memory.h"
 #include "../../include/engine.h" // For EngineKey mapping
 
 struct Platform
@@ -22,8 +23,9 @@ static Platform* sdl_create(int w, int h, const char* title, int vsync)
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 
-    if (__APPLE__)
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+#ifdef __APPLE__
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+#endif
 
     SDL_Window* window = SDL_CreateWindow(title, w, h, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
     if (!window) return NULL;
@@ -32,7 +34,7 @@ static Platform* sdl_create(int w, int h, const char* title, int vsync)
     SDL_GL_MakeCurrent(window, context);
     SDL_GL_SetSwapInterval(vsync ? 1 : 0);
 
-    Platform* p = malloc(sizeof(*p));
+    Platform* p = mem_alloc(sizeof(*p));
     if (!p) return NULL;
 
     p->window = window;
@@ -49,7 +51,7 @@ static void sdl_destroy(Platform* platform)
     SDL_DestroyWindow(platform->window);
     SDL_QuitSubSystem(SDL_INIT_VIDEO);
 
-    free(platform);
+    mem_free(platform);
 }
 
 static void* sdl_get_gl_proc(const char* name)
@@ -62,6 +64,11 @@ static void sdl_swap_buffers(Platform* platform)
     SDL_GL_SwapWindow(platform->window);
 }
 
+static void sdl_make_current(Platform* platform, bool current)
+{
+    SDL_GL_MakeCurrent(platform->window, current ? platform->gl : NULL);
+}
+
 static EngineKey map_scancode(SDL_Scancode scancode)
 {
     switch (scancode) {
@@ -149,6 +156,7 @@ const PlatformAPI* platform_get_api(void)
         .destroy = sdl_destroy,
         .get_gl_proc = sdl_get_gl_proc,
         .swap_buffers = sdl_swap_buffers,
+        .make_current = sdl_make_current,
         .poll_events = sdl_poll_events,
         .time_now_seconds = sdl_time_now_seconds,
         .get_drawable_size = sdl_get_drawable_size,
@@ -0,0 +1,69 @@
+//
+// Created by Cain Martin on 2025/08/27.
+//
+
+#include <SDL3/SDL.h>
+#include "thread.h"
+
+// The wrapper types are never defined - the pointers are SDL's own objects
+
+Thread* thread_create(ThreadFn fn, const char* name, void* arg)
+{
+    return (Thread*)SDL_CreateThread(fn, name, arg);
+}
+
+void thread_join(Thread* thread)
+{
+    if (thread) SDL_WaitThread((SDL_Thread*)thread, NULL);
+}
+
+uint32_t thread_cpu_count(void)
+{
+    const int count = SDL_GetNumLogicalCPUCores();
+    return count > 0 ? (uint32_t)count : 1;
+}
+
+uint64_t thread_current_id(void)
+{
+    return (uint64_t)SDL_GetCurrentThreadID();
+}
+
+Semaphore* semaphore_create(uint32_t initial)
+{
+    return (Semaphore*)SDL_CreateSemaphore(initial);
+}
+
+void semaphore_destroy(Semaphore* semaphore)
+{
+    if (semaphore) SDL_DestroySemaphore((SDL_Semaphore*)semaphore);
+}
+
+void semaphore_wait(Semaphore* semaphore)
+{
+    SDL_WaitSemaphore((SDL_Semaphore*)semaphore);
+}
+
+void semaphore_post(Semaphore* semaphore)
+{
+    SDL_SignalSemaphore((SDL_Semaphore*)semaphore);
+}
+
+Mutex* mutex_create(void)
+{
+    return (Mutex*)SDL_CreateMutex();
+}
+
+void mutex_destroy(Mutex* mutex)
+{
+    if (mutex) SDL_DestroyMutex((SDL_Mutex*)mutex);
+}
+
+void mutex_lock(Mutex* mutex)
+{
+    SDL_LockMutex((SDL_Mutex*)mutex);
+}
+
+void mutex_unlock(Mutex* mutex)
+{
+    SDL_UnlockMutex((SDL_Mutex*)mutex);
+}
@@ -0,0 +1,40 @@
+//
+// Created by Cain Martin on 2025/08/27.
+//
+
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Thin wrapper over the platform's threads so core code does not include SDL directly.
+// None of this needs the video subsystem, so it works on the headless platform too.
+typedef struct Thread Thread;
+typedef struct Semaphore Semaphore;
+typedef struct Mutex Mutex;
+
+typedef int (*ThreadFn)(void* arg);
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+Thread*    thread_create(ThreadFn fn, const char* name, void* arg);
+void       thread_join(Thread* thread);
+uint32_t   thread_cpu_count(void);
+uint64_t   thread_current_id(void);
+
+Semaphore* semaphore_create(uint32_t initial);
+void       semaphore_destroy(Semaphore* semaphore);
+void       semaphore_wait(Semaphore* semaphore);
+void       semaphore_post(Semaphore* semaphore);
+
+Mutex*     mutex_create(void);
+void       mutex_destroy(Mutex* mutex);
+void       mutex_lock(Mutex* mutex);
+void       mutex_unlock(Mutex* mutex);
+
+#endif //THREAD_H
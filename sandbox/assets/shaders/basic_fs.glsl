@@ -1,5 +1,18 @@
 #version 330
 
-void main() {
+in vec3 v_normal;
+in vec2 v_uv;
+
+uniform sampler2D u_texture0;
+
+// Set with engine_set_uniform_f(engine, material, "u_tint", ...)
+layout(std140) uniform MaterialData {
+    vec4 u_tint;
+};
 
+out vec4 frag_color;
+
+void main() {
+    float light = max(dot(normalize(v_normal), normalize(vec3(0.3, 1.0, 0.5))), 0.15);
+    frag_color = vec4(texture(u_texture0, v_uv).rgb * u_tint.rgb * light, 1.0);
 }
@@ -1,5 +1,22 @@
 #version 330
 
-void main() {
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec3 a_normal;
+layout(location = 2) in vec2 a_uv;
+layout(location = 4) in mat4 a_instance_model; // Filled by the engine - draws get instanced
+
+layout(std140) uniform FrameData {
+    mat4 u_view;
+    mat4 u_projection;
+    mat4 u_inverse_projection;
+    vec4 u_view_position;
+};
 
+out vec3 v_normal;
+out vec2 v_uv;
+
+void main() {
+    v_normal = mat3(a_instance_model) * a_normal;
+    v_uv = a_uv;
+    gl_Position = u_projection * u_view * a_instance_model * vec4(a_position, 1.0);
 }
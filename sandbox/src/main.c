@@ -1,8 +1,510 @@
+#include <limits.h>
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "engine.h"
 
-int main(void) {
-    const EngineConfig cfg = { .width = 1280, .height = 720, .title = "Donkey Fartbox", .vsync = 1 };
+#define BENCH_MESHES    8
+#define BENCH_MATERIALS 16
+#define BENCH_OBJECTS   20000
+#define BENCH_ROWS      (BENCH_OBJECTS / 200)
+#define BENCH_RINGS     24 // Of the LOD sphere, twice as many segments around
+
+// The null renderer never compiles these, it only looks for a_instance_model
+static const char* bench_vs = "layout(location = 4) in mat4 a_instance_model;\n";
+static const char* bench_fs = "out vec4 o_color;\n";
+
+typedef struct BenchScene
+{
+    Engine*        eng;
+    MeshHandle     meshes[BENCH_MESHES];
+    MaterialHandle materials[BENCH_MATERIALS];
+    NodeHandle*    nodes;   // One per object when drawing through the transform hierarchy
+    int            buckets;
+} BenchScene;
+
+static void bench_record(void* data, uint32_t begin, uint32_t end)
+{
+    const BenchScene* scene = data;
+    // One bucket per job thread, so no two threads ever share one
+    EngineDrawBucket* bucket = scene->buckets > 0 ? engine_draw_bucket(scene->eng, engine_job_thread_index(scene->eng)) : NULL;
+    for (uint32_t i = begin; i < end; ++i) {
+        float model[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+        model[12] = (float)(i % 200);
+        model[13] = (float)(i / 200);
+        model[14] = -(float)((i * 7) % 100);
+        const MeshHandle mesh = scene->meshes[i % BENCH_MESHES];
+        const MaterialHandle material = scene->materials[(i / 64) % BENCH_MATERIALS];
+        if (scene->nodes) {
+            if (bucket) engine_bucket_draw_node(bucket, mesh, material, scene->nodes[i]);
+            else engine_draw_node(scene->eng, mesh, material, scene->nodes[i]);
+        } else if (bucket) engine_bucket_draw(bucket, mesh, material, model);
+        else engine_draw(scene->eng, mesh, material, model);
+    }
+}
+
+// Unit diameter sphere with one vertex per position, poles included, so the simplifier can
+// collapse all of it. Returns the index count, 0 when out of memory.
+static uint32_t bench_sphere(EngineVertex** out_vertices, uint32_t* out_vertex_count, uint32_t** out_indices)
+{
+    const uint32_t rings = BENCH_RINGS, segments = 2 * BENCH_RINGS;
+    const uint32_t vertex_count = 2 + (rings - 1) * segments;
+    const uint32_t index_count = 6 * segments * (rings - 1);
+    EngineVertex* vertices = malloc(vertex_count * sizeof(EngineVertex));
+    uint32_t* indices = malloc(index_count * sizeof(uint32_t));
+    if (!vertices || !indices) {
+        free(vertices);
+        free(indices);
+        return 0;
+    }
+
+    // Pole, rings from the top down, pole
+    uint32_t v = 0;
+    for (uint32_t r = 0; r <= rings; ++r) {
+        const float theta = 3.14159265f * (float)r / (float)rings;
+        for (uint32_t s = 0; s < (r == 0 || r == rings ? 1 : segments); ++s) {
+            const float phi = 6.28318531f * (float)s / (float)segments;
+            const float n[3] = { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+            const EngineVertex vertex = {
+                { n[0] * 0.5f, n[1] * 0.5f, n[2] * 0.5f }, { n[0], n[1], n[2] }, { (float)s / (float)segments, (float)r / (float)rings }
+            };
+            vertices[v++] = vertex;
+        }
+    }
+
+    uint32_t i = 0;
+    const uint32_t bottom = vertex_count - 1;
+    for (uint32_t s = 0; s < segments; ++s) {
+        const uint32_t next = (s + 1) % segments;
+        indices[i++] = 0;
+        indices[i++] = 1 + next;
+        indices[i++] = 1 + s;
+        for (uint32_t r = 1; r + 1 < rings; ++r) {
+            const uint32_t a = 1 + (r - 1) * segments, b = a + segments;
+            indices[i++] = a + s;
+            indices[i++] = a + next;
+            indices[i++] = b + s;
+            indices[i++] = a + next;
+            indices[i++] = b + next;
+            indices[i++] = b + s;
+        }
+        const uint32_t last = 1 + (rings - 2) * segments;
+        indices[i++] = bottom;
+        indices[i++] = last + s;
+        indices[i++] = last + next;
+    }
+
+    *out_vertices = vertices;
+    *out_vertex_count = vertex_count;
+    *out_indices = indices;
+    return index_count;
+}
+
+// The last frame's command log against the stats of the same frame: one frame bracketed by
+// begin, end and present, no resource churn, every submitted draw replayed exactly once and
+// nothing rejected. Prints what is off and returns false.
+static bool check_command_log(const EngineCommand* commands, uint32_t count, const EngineRenderStats* stats)
+{
+    uint32_t submits = 0, draws = 0, transients = 0, instances = 0, clears = 0, resources = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        switch ((EngineCommandOp)commands[i].op) {
+            case ENGINE_CMD_SUBMIT: submits++; break;
+            case ENGINE_CMD_DRAW: draws++; instances += commands[i].args[2]; break;
+            case ENGINE_CMD_DRAW_TRANSIENT: transients++; break;
+            case ENGINE_CMD_CLEAR: clears++; break;
+            case ENGINE_CMD_CREATE_MESH: case ENGINE_CMD_DESTROY_MESH:
+            case ENGINE_CMD_CREATE_SHADER: case ENGINE_CMD_DESTROY_SHADER:
+            case ENGINE_CMD_CREATE_TEXTURE: case ENGINE_CMD_DESTROY_TEXTURE:
+            case ENGINE_CMD_CREATE_MATERIAL: case ENGINE_CMD_DESTROY_MATERIAL: resources++; break;
+            default: break;
+        }
+    }
+
+    bool ok = true;
+    if (count < 3 || commands[0].op != ENGINE_CMD_BEGIN_FRAME || commands[count - 2].op != ENGINE_CMD_END_FRAME
+        || commands[count - 1].op != ENGINE_CMD_PRESENT) {
+        fprintf(stderr, "command log: not one frame from begin to present (%u commands)\n", count);
+        ok = false;
+    }
+    if (clears != 1 || resources != 0) {
+        fprintf(stderr, "command log: %u clears and %u resource commands, expected 1 and 0\n", clears, resources);
+        ok = false;
+    }
+    if (draws == 0 || draws + transients != stats->draw_calls) {
+        fprintf(stderr, "command log: %u draws and %u transient draws for %u draw calls\n", draws, transients, stats->draw_calls);
+        ok = false;
+    }
+    if (submits + transients != stats->draws_submitted || instances != submits || stats->draws_rejected != 0) {
+        fprintf(stderr, "command log: %u submits drawn as %u, %u transient, for %u submitted and %u rejected\n",
+                submits, instances, transients, stats->draws_submitted, stats->draws_rejected);
+        ok = false;
+    }
+    return ok;
+}
+
+#define HEADLESS_USAGE \
+    "usage: sandbox --headless [--frames N] [--trace path] [--buckets N] [--render-thread]\n" \
+    "                          [--occlusion] [--nodes] [--entities] [--lods]\n"
+
+// What --headless runs; see run_headless
+typedef struct HeadlessConfig
+{
+    int         frames;
+    const char* trace_path;    // Chrome trace written after the last frame, NULL for none
+    int         buckets;       // 0 records on the calling thread only
+    bool        render_thread;
+    bool        occlusion;
+    bool        nodes;
+    bool        entities;
+    bool        lods;
+} HeadlessConfig;
+
+// Flags that take a value read it from the next argument
+static bool parse_count(const char* flag, const char* text, int min, int* out)
+{
+    char* end = NULL;
+    const long value = text ? strtol(text, &end, 10) : 0;
+    if (!text || end == text || *end != '\0' || value < min || value > INT_MAX) {
+        fprintf(stderr, "sandbox: %s needs a whole number from %d, got '%s'\n", flag, min, text ? text : "");
+        return false;
+    }
+    *out = (int)value;
+    return true;
+}
+
+// Reads the flags after --headless. False, with the reason and usage on stderr, on a flag it
+// does not know or a missing or malformed value.
+static bool parse_headless(int argc, char** argv, HeadlessConfig* out)
+{
+    const HeadlessConfig defaults = { .frames = 300 };
+    *out = defaults;
+    for (int i = 0; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = true;
+        if (strcmp(arg, "--frames") == 0) {
+            ok = parse_count(arg, value, 1, &out->frames);
+            ++i;
+        } else if (strcmp(arg, "--buckets") == 0) {
+            ok = parse_count(arg, value, 0, &out->buckets);
+            ++i;
+        } else if (strcmp(arg, "--trace") == 0) {
+            ok = value != NULL;
+            if (!ok) fprintf(stderr, "sandbox: --trace needs a path\n");
+            out->trace_path = value;
+            ++i;
+        } else if (strcmp(arg, "--render-thread") == 0) {
+            out->render_thread = true;
+        } else if (strcmp(arg, "--occlusion") == 0) {
+            out->occlusion = true;
+        } else if (strcmp(arg, "--nodes") == 0) {
+            out->nodes = true;
+        } else if (strcmp(arg, "--entities") == 0) {
+            out->entities = true;
+        } else if (strcmp(arg, "--lods") == 0) {
+            out->lods = true;
+        } else {
+            fprintf(stderr, "sandbox: unknown argument '%s'\n", arg);
+            ok = false;
+        }
+        if (!ok) {
+            fputs(HEADLESS_USAGE, stderr);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Pushes a fixed scene through the whole CPU pipeline with no window or GPU, for the build farm.
+// With --buckets N the engine gets N job threads, the calling one included, and the objects
+// are recorded by all of them, each into its own draw bucket. With --render-thread the null
+// renderer replays each frame on a render thread while the next one is recorded. With
+// --occlusion a wall stands between the camera and the middle of the grid as an occluder. With
+// --nodes every object is a node under one of the grid's rows, and one row moves each frame.
+// With --entities every object is an entity with a transform and a renderable instead, drawn
+// by engine_draw_entities. With --lods every mesh is a sphere with a LOD chain built at create
+// time, so the grid's far rows draw coarser levels.
+static int run_headless(const HeadlessConfig* config)
+{
+    const EngineConfig cfg = {
+        .width = 1280, .height = 720, .title = "sandbox (headless)",
+        .renderer = ENGINE_RENDERER_NULL, .platform = ENGINE_PLATFORM_HEADLESS,
+        .profiler = 1, .draw_buckets = config->buckets, .render_thread = config->render_thread,
+        .job_threads = config->buckets > 0 ? config->buckets - 1 : 0, .occlusion_culling = config->occlusion,
+        .transform_nodes = config->nodes ? BENCH_OBJECTS + BENCH_ROWS : 0
+    };
+    Engine* eng = engine_create(&cfg);
+    if (!eng) return 1;
+    int result = 1; // Until the run gets through its checks
+
+    const EngineVertex vertices[3] = {
+        { { -1.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } },
+        { {  1.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f } },
+        { {  0.0f,  1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.5f, 1.0f } },
+    };
+    const uint32_t indices[3] = { 0, 1, 2 };
+    // Half the meshes use the 16 byte layout, so the stats show both
+    const EngineVertexLayout compact = { ENGINE_POSITION_HALF3, ENGINE_NORMAL_OCT16, ENGINE_UV_UNORM16 };
+    BenchScene scene = { .eng = eng, .buckets = config->buckets };
+    MeshHandle* meshes = scene.meshes;
+    EngineVertex* sphere_vertices = NULL;
+    uint32_t* sphere_indices = NULL;
+    uint32_t sphere_vertex_count = 0;
+    const uint32_t sphere_index_count = config->lods ? bench_sphere(&sphere_vertices, &sphere_vertex_count, &sphere_indices) : 0;
+    if (config->lods && !sphere_index_count) goto done;
+    for (int i = 0; i < BENCH_MESHES; ++i) {
+        EngineMeshDesc mesh_desc = { .vertices = vertices, .vertex_count = 3, .indices = indices, .indices_count = 3 };
+        if (config->lods) {
+            mesh_desc.vertices = sphere_vertices;
+            mesh_desc.vertex_count = sphere_vertex_count;
+            mesh_desc.indices = sphere_indices;
+            mesh_desc.indices_count = sphere_index_count;
+            mesh_desc.flags = ENGINE_MESH_LODS;
+        }
+        if (i & 1) mesh_desc.layout = compact;
+        meshes[i] = engine_mesh_create(eng, &mesh_desc);
+    }
+
+    const ShaderHandle shader = engine_shader_create(eng, bench_vs, bench_fs);
+    MaterialHandle* materials = scene.materials;
+    for (int i = 0; i < BENCH_MATERIALS; ++i) {
+        const EngineMaterialDesc mat_desc = { .shader = shader, .depth_test = 1, .depth_write = 1, .blend = i % 8 == 7 };
+        materials[i] = engine_material_create(eng, &mat_desc);
+    }
+
+    // The same grid as bench_record lays out, as rows of child nodes
+    NodeHandle rows[BENCH_ROWS];
+    if (config->nodes) {
+        scene.nodes = malloc(BENCH_OBJECTS * sizeof(NodeHandle));
+        if (!scene.nodes) goto done;
+        EngineTransform local = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+        for (int r = 0; r < BENCH_ROWS; ++r) {
+            rows[r] = engine_node_create(eng, 0);
+            local.translation[1] = (float)r;
+            engine_node_set_local(eng, rows[r], &local);
+        }
+        local.translation[1] = 0.0f;
+        for (int i = 0; i < BENCH_OBJECTS; ++i) {
+            scene.nodes[i] = engine_node_create(eng, rows[i / 200]);
+            local.translation[0] = (float)(i % 200);
+            local.translation[2] = -(float)((i * 7) % 100);
+            engine_node_set_local(eng, scene.nodes[i], &local);
+        }
+    }
+
+    // The same grid again, as entities
+    if (config->entities) {
+        const ComponentId drawn[2] = { ENGINE_COMPONENT_TRANSFORM, ENGINE_COMPONENT_RENDERABLE };
+        for (int i = 0; i < BENCH_OBJECTS; ++i) {
+            const EntityHandle entity = engine_entity_create(eng, drawn, 2);
+            EngineTransform* transform = engine_entity_get(eng, entity, ENGINE_COMPONENT_TRANSFORM);
+            EngineRenderable* renderable = engine_entity_get(eng, entity, ENGINE_COMPONENT_RENDERABLE);
+            if (!transform || !renderable) goto done;
+            transform->translation[0] = (float)(i % 200);
+            transform->translation[1] = (float)(i / 200);
+            transform->translation[2] = -(float)((i * 7) % 100);
+            renderable->mesh = meshes[i % BENCH_MESHES];
+            renderable->material = materials[(i / 64) % BENCH_MATERIALS];
+        }
+    }
+
+    // 6 by 4 units, halfway between the camera and the grid, hiding its middle
+    MeshHandle wall = 0;
+    const float wall_model[16] = { 6,0,0,0, 0,4,0,0, 0,0,1,0, 97,48,10,1 };
+    if (config->occlusion) {
+        const EngineVertex wall_vertices[4] = {
+            { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } },
+            { { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f } },
+            { { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f } },
+            { { 1.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f } },
+        };
+        const uint32_t wall_indices[6] = { 0, 1, 2, 2, 1, 3 };
+        const EngineMeshDesc wall_desc = {
+            .vertices = wall_vertices, .vertex_count = 4, .indices = wall_indices, .indices_count = 6,
+            .flags = ENGINE_MESH_OCCLUDER
+        };
+        wall = engine_mesh_create(eng, &wall_desc);
+    }
+
+    // Over the middle of the grid looking down -z, 60 degree vertical field of view: the
+    // near rows only show their centre, so culling has work to do
+    const float near_z = 0.1f, far_z = 1000.0f, focal = 1.7320508f;
+    EngineCamera camera;
+    memset(&camera, 0, sizeof camera);
+    for (int i = 0; i < 4; ++i) camera.view[i * 5] = 1.0f;
+    camera.view[12] = -100.0f;
+    camera.view[13] = -50.0f;
+    camera.view[14] = -20.0f;
+    camera.projection[0] = focal * 720.0f / 1280.0f;
+    camera.projection[5] = focal;
+    camera.projection[10] = (far_z + near_z) / (near_z - far_z);
+    camera.projection[11] = -1.0f;
+    camera.projection[14] = 2.0f * far_z * near_z / (near_z - far_z);
+    engine_set_camera(eng, &camera);
+
+    double cpu_total = 0.0;
+    float cpu_max = 0.0f;
+    uint32_t steady_heap_allocs = 0; // Should stay 0 once the first frames have sized everything
+    // The render thread replays frame 0 while frame 1 records, and frame 2's begin waits for it,
+    // so what that replay sizes - the backend's and the published command log - lands as late as
+    // frame 2. The buffers it reserves cover the frames after it.
+    const int warm_up = config->render_thread ? 3 : 2;
+    EngineRenderStats stats = { 0 };
+    for (int frame = 0; frame < config->frames; ++frame) {
+        engine_begin_frame(eng);
+        engine_clear(eng, 0.0f, 0.0f, 0.0f, 1.0f);
+
+        if (config->nodes) {
+            // Only that row's 200 objects are recomputed
+            const EngineTransform row = {
+                { (float)(frame % 8) * 0.125f, (float)(frame % BENCH_ROWS), 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }
+            };
+            engine_node_set_local(eng, rows[frame % BENCH_ROWS], &row);
+            engine_update_transforms(eng);
+        }
+        if (config->entities) engine_draw_entities(eng);
+        else if (config->buckets > 0) engine_parallel_for(eng, BENCH_OBJECTS, 1024, bench_record, &scene);
+        else bench_record(&scene, 0, BENCH_OBJECTS);
+        if (wall) engine_draw(eng, wall, materials[0], wall_model);
+
+        // Geometry rebuilt every frame goes straight into the backend's streaming memory
+        EngineTransientMesh quad;
+        if (engine_transient_mesh_alloc(eng, 4, 6, &quad)) {
+            const float t = (float)frame * 0.01f;
+            for (uint32_t v = 0; v < 4; ++v) {
+                const EngineVertex vertex = {
+                    { (float)(v & 1) + t, (float)(v >> 1), 0.0f }, { 0.0f, 0.0f, 1.0f }, { (float)(v & 1), (float)(v >> 1) }
+                };
+                quad.vertices[v] = vertex;
+            }
+            const uint32_t quad_indices[6] = { 0, 1, 2, 2, 1, 3 };
+            memcpy(quad.indices, quad_indices, sizeof quad_indices);
+            const float identity[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+            engine_draw_transient(eng, &quad, materials[0], identity);
+        }
+
+        engine_end_frame(eng);
+        engine_get_render_stats(eng, &stats);
+        cpu_total += stats.cpu_frame_ms;
+        if (stats.cpu_frame_ms > cpu_max) cpu_max = stats.cpu_frame_ms;
+        if (frame >= warm_up) steady_heap_allocs += stats.heap_allocs;
+    }
+
+    const EngineCommand* commands = NULL;
+    const uint32_t command_count = engine_get_command_log(eng, &commands);
+    printf("frames %d, objects %d: cpu avg %.3f ms, max %.3f ms\n",
+           config->frames, BENCH_OBJECTS, config->frames > 0 ? cpu_total / config->frames : 0.0, cpu_max);
+    if (config->buckets > 0)
+        printf("recorded into %d draw buckets, %u merged last frame\n", config->buckets, stats.draws_bucketed);
+    if (config->render_thread)
+        printf("render thread %.3f ms, begin_frame waited %.3f ms, present interval %.3f ms (max %.3f)\n",
+               stats.render_thread_ms, stats.frame_wait_ms, stats.frame_interval_ms, stats.frame_interval_max_ms);
+    printf("culling: %u visible, %u culled\n", stats.draws_visible, stats.draws_culled);
+    if (config->occlusion)
+        printf("occlusion: %u occluded behind %u triangles\n", stats.draws_occluded, stats.occluder_triangles);
+    if (config->lods) {
+        printf("lods:");
+        for (int l = 0; l < ENGINE_MESH_MAX_LODS; ++l)
+            if (stats.lod_draws[l]) printf(" %d: %u draws %u triangles,", l, stats.lod_draws[l], stats.lod_triangles[l]);
+        printf("\n");
+    }
+    printf("last frame: %u submitted, %u rejected, %u batches, %u draw calls, %u instanced, %u commands\n",
+           stats.draws_submitted, stats.draws_rejected, stats.batches, stats.draw_calls,
+           stats.draws_instanced, command_count);
+    printf("frame arena %u bytes, streamed %u bytes, heap allocations after warm-up %u\n",
+           stats.frame_arena_used, stats.stream_bytes, steady_heap_allocs);
+    // The first frames' logs carry the scene's creation, and with a render thread the log trails
+    const bool log_ok = config->frames <= warm_up || check_command_log(commands, command_count, &stats);
+    printf("mesh memory %llu bytes (%llu as EngineVertex)\n",
+           (unsigned long long)stats.mesh_bytes, (unsigned long long)stats.mesh_bytes_full);
+
+    EngineProfileZone zones[32];
+    const uint32_t zone_count = engine_profiler_get_summary(eng, zones, 32);
+    for (uint32_t i = 0; i < zone_count; ++i)
+        printf("  %-16s min %7.3f  avg %7.3f  p99 %7.3f ms\n", zones[i].name, zones[i].min_ms, zones[i].avg_ms, zones[i].p99_ms);
+    if (config->trace_path && !engine_profiler_write_trace(eng, config->trace_path))
+        fprintf(stderr, "could not write %s\n", config->trace_path);
+
+    result = steady_heap_allocs == 0 && log_ok ? 0 : 1;
+
+done:
+    engine_shutdown(eng);
+    free(scene.nodes);
+    free(sphere_vertices);
+    free(sphere_indices);
+    return result;
+}
+
+// Opens a baked pack and creates every asset in it, timing the whole load. Headless unless
+// a shader cache directory is given, in which case it runs on OpenGL so the cache is used:
+// the first run is the cold start, later ones load the linked programs back.
+static int run_pack(const char* path, const char* shader_cache_dir)
+{
+    const EngineConfig cfg = {
+        .width = 1280, .height = 720, .title = "sandbox (pack)",
+        .renderer = shader_cache_dir ? ENGINE_RENDERER_OPENGL : ENGINE_RENDERER_NULL,
+        .platform = shader_cache_dir ? ENGINE_PLATFORM_SDL : ENGINE_PLATFORM_HEADLESS,
+        .shader_cache_dir = shader_cache_dir
+    };
+    Engine* eng = engine_create(&cfg);
+    if (!eng) return 1;
+
+    const clock_t start = clock();
+    EnginePack* pack = engine_pack_open(path);
+    if (!pack) {
+        engine_shutdown(eng);
+        return 1;
+    }
+
+    uint32_t created = 0;
+    const uint32_t asset_count = engine_pack_asset_count(pack);
+    for (uint32_t i = 0; i < asset_count; ++i) {
+        EnginePackAssetType type;
+        const char* name = engine_pack_asset_name(pack, i, &type);
+        EngineMeshDesc mesh;
+        EngineTextureDesc texture;
+        const char *vs, *fs;
+        if (type == ENGINE_PACK_MESH && engine_pack_mesh(pack, name, &mesh)) created += engine_mesh_create(eng, &mesh) != 0;
+        else if (type == ENGINE_PACK_TEXTURE && engine_pack_texture(pack, name, &texture)) created += engine_texture_create(eng, &texture) != 0;
+        else if (type == ENGINE_PACK_SHADER && engine_pack_shader(pack, name, &vs, &fs)) created += engine_shader_create(eng, vs, fs) != 0;
+    }
+    engine_pack_close(pack);
+    const double ms = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+
+    // Memory stats are published with the next frame; shaders finish linking over the next few
+    EngineRenderStats stats;
+    do {
+        engine_begin_frame(eng);
+        engine_end_frame(eng);
+        engine_get_render_stats(eng, &stats);
+    } while (stats.shaders_pending > 0 && !engine_should_quit(eng));
+    printf("%s: %u of %u assets created in %.3f ms\n", path, created, asset_count, ms);
+    printf("texture memory %llu bytes (%llu as RGBA8), mesh memory %llu bytes\n",
+           (unsigned long long)stats.texture_bytes, (unsigned long long)stats.texture_bytes_full,
+           (unsigned long long)stats.mesh_bytes);
+    if (shader_cache_dir)
+        printf("shaders created in %.3f ms (%s start: %u cached, %u compiled)\n", stats.shader_create_ms,
+               stats.shader_cache_hits && !stats.shader_cache_misses ? "warm" : "cold",
+               stats.shader_cache_hits, stats.shader_cache_misses);
+    engine_shutdown(eng);
+    return created == asset_count ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0) {
+        HeadlessConfig config;
+        if (!parse_headless(argc - 2, argv + 2, &config)) return 1;
+        return run_headless(&config);
+    }
+    if (argc > 2 && strcmp(argv[1], "--pack") == 0)
+        return run_pack(argv[2], argc > 3 ? argv[3] : NULL);
+
+    const EngineConfig cfg = {
+        .width = 1280, .height = 720, .title = "Donkey Fartbox", .vsync = 1,
+        .render_thread = argc > 1 && strcmp(argv[1], "--render-thread") == 0
+    };
     Engine* eng = engine_create(&cfg);
     if (!eng) return 1;
 
@@ -18,4 +520,4 @@ int main(void) {
 
     engine_shutdown(eng);
     return 0;
-}
\ No newline at end of file
+}
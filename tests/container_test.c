@@ -0,0 +1,254 @@
+//
+// Created by Cain Martin on 2025/09/11.
+//
+
+// DArray, SparseSet and HashMap against what their headers promise, including the paths that
+// move things: growth, swap-removal, backward-shift deletion and rehashing.
+
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "core/arena.h"
+#include "core/d_array.h"
+#include "core/hash_map.h"
+#include "core/sparse_set.h"
+
+static uint32_t next_random(uint32_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void test_d_array(void)
+{
+    DArray array;
+    CHECK(d_array_init(&array, sizeof(uint32_t), 0, NULL));
+    CHECK(array.count == 0 && array.capacity == 0);
+
+    for (uint32_t i = 0; i < 100; ++i) *(uint32_t*)d_array_push(&array) = i;
+    CHECK(array.count == 100 && array.capacity >= 100);
+    CHECK(((uintptr_t)array.data & (D_ARRAY_SIMD_ALIGN - 1)) == 0);
+    bool in_order = true;
+    for (uint32_t i = 0; i < 100; ++i) in_order = in_order && D_ARRAY_DATA(&array, uint32_t)[i] == i;
+    CHECK(in_order);
+
+    // The last element fills the hole
+    d_array_swap_remove(&array, 10);
+    CHECK(array.count == 99 && D_ARRAY_DATA(&array, uint32_t)[10] == 99);
+    d_array_swap_remove(&array, array.count - 1);
+    CHECK(array.count == 98 && D_ARRAY_DATA(&array, uint32_t)[97] == 97);
+    d_array_swap_remove(&array, 1000);
+    CHECK(array.count == 98);
+
+    const uint32_t more[3] = { 7, 8, 9 };
+    CHECK(d_array_append(&array, more, 3));
+    CHECK(array.count == 101 && D_ARRAY_DATA(&array, uint32_t)[100] == 9);
+
+    // Growing zeroes the new elements, shrinking the count keeps the storage
+    const uint32_t capacity = array.capacity;
+    CHECK(d_array_resize(&array, 10));
+    CHECK(array.count == 10 && array.capacity == capacity);
+    CHECK(d_array_resize(&array, 20));
+    bool zeroed = true;
+    for (uint32_t i = 10; i < 20; ++i) zeroed = zeroed && D_ARRAY_DATA(&array, uint32_t)[i] == 0;
+    CHECK(zeroed);
+
+    CHECK(d_array_reserve(&array, 1000) && array.capacity >= 1000 && array.count == 20);
+    CHECK(D_ARRAY_DATA(&array, uint32_t)[2] == 2);
+    d_array_shrink(&array);
+    CHECK(array.capacity == 20 && D_ARRAY_DATA(&array, uint32_t)[2] == 2);
+    d_array_clear(&array);
+    CHECK(array.count == 0);
+    d_array_free(&array);
+
+    // Arena storage, over-aligned
+    Arena arena;
+    CHECK(arena_init(&arena, 1 << 16));
+    CHECK(d_array_init(&array, 12, D_ARRAY_AVX_ALIGN, &arena));
+    for (uint32_t i = 0; i < 300; ++i) memset(d_array_push(&array), (int)(i & 0xff), 12);
+    CHECK(array.count == 300 && ((uintptr_t)array.data & (D_ARRAY_AVX_ALIGN - 1)) == 0);
+    CHECK(((const uint8_t*)d_array_at(&array, 299))[11] == (299 & 0xff));
+    arena_shutdown(&arena);
+}
+
+static void test_sparse_set(void)
+{
+    SparseSet set;
+    CHECK(sparse_set_init(&set, sizeof(uint64_t), 0, NULL));
+    CHECK(sparse_set_get(&set, 0) == NULL && sparse_set_get(&set, 123456) == NULL);
+    CHECK(!sparse_set_remove(&set, 5));
+
+    const uint32_t keys[6] = { 3, 70000, 0, 17, 9, 1 << 20 };
+    for (int i = 0; i < 6; ++i) *(uint64_t*)sparse_set_insert(&set, keys[i]) = (uint64_t)keys[i] * 10;
+    CHECK(sparse_set_count(&set) == 6);
+    bool found = true;
+    for (int i = 0; i < 6; ++i) {
+        const uint64_t* value = sparse_set_get(&set, keys[i]);
+        found = found && value && *value == (uint64_t)keys[i] * 10;
+    }
+    CHECK(found);
+    CHECK(sparse_set_get(&set, 4) == NULL && sparse_set_get(&set, 70001) == NULL);
+
+    // Inserting a present key returns its value untouched
+    CHECK(*(uint64_t*)sparse_set_insert(&set, 17) == 170 && sparse_set_count(&set) == 6);
+
+    // Removing from the middle moves the last value (key 1 << 20) into the hole
+    CHECK(sparse_set_remove(&set, 70000));
+    CHECK(sparse_set_count(&set) == 5);
+    CHECK(D_ARRAY_DATA(&set.keys, uint32_t)[1] == 1u << 20);
+    CHECK(*(uint64_t*)d_array_at(&set.values, 1) == (uint64_t)(1u << 20) * 10);
+    CHECK(*(uint64_t*)sparse_set_get(&set, 1u << 20) == (uint64_t)(1u << 20) * 10);
+    CHECK(sparse_set_get(&set, 70000) == NULL && !sparse_set_remove(&set, 70000));
+
+    // Removing the last value moves nothing
+    CHECK(sparse_set_remove(&set, 9));
+    CHECK(sparse_set_count(&set) == 4 && sparse_set_get(&set, 9) == NULL);
+    CHECK(*(uint64_t*)sparse_set_get(&set, 0) == 0 && *(uint64_t*)sparse_set_get(&set, 3) == 30);
+
+    sparse_set_clear(&set);
+    CHECK(sparse_set_count(&set) == 0 && sparse_set_get(&set, 3) == NULL && sparse_set_get(&set, 1u << 20) == NULL);
+    *(uint64_t*)sparse_set_insert(&set, 3) = 33;
+    CHECK(sparse_set_count(&set) == 1 && *(uint64_t*)sparse_set_get(&set, 3) == 33);
+    sparse_set_free(&set);
+}
+
+// Keys whose home slot in a table of slots entries is home
+static uint32_t colliding_keys(uint32_t slots, uint32_t home, uint64_t* out, uint32_t count)
+{
+    uint32_t found = 0;
+    for (uint64_t key = 1; found < count; ++key)
+        if (((uint32_t)hash_u64(key) & (slots - 1)) == home) out[found++] = key;
+    return found;
+}
+
+static void test_hash_map_collisions(void)
+{
+    HashMap map;
+    CHECK(hash_map_init(&map, sizeof(uint64_t), 0, NULL));
+    CHECK(hash_map_get(&map, 1) == NULL && !hash_map_remove(&map, 1));
+
+    // Three keys sharing a home slot form one probe run; a fourth key homes just past it
+    // and ends up after them
+    uint64_t keys[4];
+    colliding_keys(16, 5, keys, 3);
+    colliding_keys(16, 6, keys + 3, 1);
+    bool inserted = false;
+    for (int i = 0; i < 4; ++i) {
+        *(uint64_t*)hash_map_insert(&map, keys[i], &inserted) = keys[i] + 100;
+        CHECK(inserted);
+    }
+    CHECK(hash_map_count(&map) == 4 && map.keys.count == 16);
+
+    // Removing the head of the run shifts the rest back, so each stays reachable
+    CHECK(hash_map_remove(&map, keys[0]));
+    CHECK(hash_map_get(&map, keys[0]) == NULL);
+    bool reachable = true;
+    for (int i = 1; i < 4; ++i) {
+        const uint64_t* value = hash_map_get(&map, keys[i]);
+        reachable = reachable && value && *value == keys[i] + 100;
+    }
+    CHECK(reachable);
+    CHECK(D_ARRAY_DATA(&map.keys, uint64_t)[5] == keys[1]);
+    CHECK(D_ARRAY_DATA(&map.keys, uint64_t)[6] == keys[2]);
+    CHECK(D_ARRAY_DATA(&map.keys, uint64_t)[7] == keys[3]);
+    CHECK(!map.used.data[8]);
+
+    // Overwriting returns the same value and reports no insertion
+    uint64_t* value = hash_map_insert(&map, keys[2], &inserted);
+    CHECK(!inserted && value == hash_map_get(&map, keys[2]) && *value == keys[2] + 100);
+    CHECK(hash_map_count(&map) == 3);
+    hash_map_free(&map);
+}
+
+static void test_hash_map_overwrite_at_capacity(void)
+{
+    HashMap map;
+    CHECK(hash_map_init(&map, sizeof(uint32_t), 0, NULL));
+
+    // 12 of 16 slots is the most the table holds before growing
+    for (uint32_t key = 0; key < 12; ++key) *(uint32_t*)hash_map_insert(&map, key, NULL) = key;
+    CHECK(map.keys.count == 16 && hash_map_count(&map) == 12);
+
+    // Inserting a present key must not grow the table, or held pointers would dangle
+    uint32_t* held = hash_map_get(&map, 7);
+    bool inserted = true;
+    uint32_t* again = hash_map_insert(&map, 7, &inserted);
+    CHECK(!inserted && again == held && map.keys.count == 16);
+
+    // A new key grows it, and every value moves with its key
+    *(uint32_t*)hash_map_insert(&map, 12, &inserted) = 12;
+    CHECK(inserted && map.keys.count == 32 && hash_map_count(&map) == 13);
+    bool kept = true;
+    for (uint32_t key = 0; key < 13; ++key) {
+        const uint32_t* v = hash_map_get(&map, key);
+        kept = kept && v && *v == key;
+    }
+    CHECK(kept);
+    hash_map_free(&map);
+}
+
+// Random inserts, overwrites and removes against a flat reference, through several rehashes
+static void test_hash_map_random(void)
+{
+    enum { KEYS = 4096, OPS = 200000 };
+    HashMap map;
+    CHECK(hash_map_init(&map, sizeof(uint64_t), 0, NULL));
+    uint64_t* reference = calloc(KEYS, sizeof(uint64_t)); // 0 when absent
+    uint32_t present = 0, state = 0x2545f491u;
+    bool agree = true;
+
+    for (uint32_t op = 0; op < OPS && agree; ++op) {
+        const uint32_t r = next_random(&state);
+        const uint32_t k = (r >> 4) % KEYS;
+        const uint64_t key = (uint64_t)k * 0x100000001ull; // Spread over the upper bits too
+        if ((r & 3) != 0) {
+            bool inserted = false;
+            uint64_t* value = hash_map_insert(&map, key, &inserted);
+            agree = value && inserted == (reference[k] == 0);
+            if (value) *value = reference[k] = op + 1;
+            if (inserted) present++;
+        } else {
+            agree = hash_map_remove(&map, key) == (reference[k] != 0);
+            if (reference[k]) present--;
+            reference[k] = 0;
+        }
+        agree = agree && hash_map_count(&map) == present;
+    }
+    CHECK(agree);
+
+    bool matches = true;
+    for (uint32_t k = 0; k < KEYS; ++k) {
+        const uint64_t* value = hash_map_get(&map, (uint64_t)k * 0x100000001ull);
+        matches = matches && (reference[k] ? value && *value == reference[k] : value == NULL);
+    }
+    CHECK(matches);
+
+    // Iteration visits each entry once
+    uint32_t cursor = 0, visited = 0;
+    uint64_t key;
+    void* value;
+    bool known = true;
+    while (hash_map_next(&map, &cursor, &key, &value)) {
+        const uint32_t k = (uint32_t)key;
+        known = known && k < KEYS && reference[k] == *(uint64_t*)value;
+        visited++;
+    }
+    CHECK(known && visited == present);
+
+    hash_map_clear(&map);
+    CHECK(hash_map_count(&map) == 0 && hash_map_get(&map, 0x100000001ull) == NULL);
+    free(reference);
+    hash_map_free(&map);
+}
+
+int main(void)
+{
+    test_d_array();
+    test_sparse_set();
+    test_hash_map_collisions();
+    test_hash_map_overwrite_at_capacity();
+    test_hash_map_random();
+    return test_finish("container_test");
+}
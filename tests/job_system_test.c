@@ -0,0 +1,197 @@
+//
+// Created by Cain Martin on 2025/09/11.
+//
+
+// Every job runs exactly once however it reaches a thread: popped from its owner's deque,
+// stolen by another worker, taken from the shared queue, or run inline when a deque is full.
+// parallel_for covers every index exactly once, and a waiter that has gone to sleep wakes
+// when the counter's last job finishes elsewhere.
+
+#include <stdlib.h>
+#include "test.h"
+#include "core/atomic.h"
+#include "core/job_system.h"
+#include "platform/clock.h"
+#include "platform/thread.h"
+
+#define TEST_WORKERS     3
+#define TEST_CHILDREN    8     // Jobs each spawning job submits from its worker's deque
+#define TEST_JOBS        (2400 * (TEST_CHILDREN + 1)) // Per submitter, more than a deque holds
+#define TEST_BATCH       512
+#define TEST_INJECTORS   2     // Threads outside the system, submitting through the shared queue
+
+typedef struct RunCounts
+{
+    JobSystem*       jobs;
+    uint32_t*        runs;     // One per job, counted atomically
+    uint32_t         first;    // This submitter's range of runs
+    uint32_t         count;
+    EngineJobCounter counter;
+} RunCounts;
+
+typedef struct JobArg
+{
+    RunCounts* counts;
+    uint32_t   index;
+} JobArg;
+
+static void count_run(void* data)
+{
+    const JobArg* arg = data;
+    atomic_fetch_add_u32(&arg->counts->runs[arg->index], 1);
+}
+
+// Pushes its children to the running worker's own deque, where idle workers steal them,
+// and waits for them inside the job
+static void spawn_children(void* data)
+{
+    const JobArg* arg = data;
+    RunCounts* counts = arg->counts;
+    JobArg children[TEST_CHILDREN];
+    Job batch[TEST_CHILDREN];
+    EngineJobCounter counter = { 0 };
+    for (uint32_t i = 0; i < TEST_CHILDREN; ++i) {
+        children[i].counts = counts;
+        children[i].index = arg->index + 1 + i;
+        const Job job = { count_run, NULL, &children[i], 0, 0, &counter };
+        batch[i] = job;
+    }
+    job_system_submit(counts->jobs, batch, TEST_CHILDREN);
+    atomic_fetch_add_u32(&counts->runs[arg->index], 1);
+    job_system_wait(counts->jobs, &counter);
+}
+
+// Submits a submitter's jobs in batches and waits for them. Half of the groups of
+// TEST_CHILDREN + 1 jobs go in as a parent that spawns the rest, half as separate jobs.
+static void submit_all(RunCounts* counts)
+{
+    JobArg* args = malloc(counts->count * sizeof(JobArg));
+    Job* batch = malloc(counts->count * sizeof(Job));
+    uint32_t queued = 0;
+    for (uint32_t i = 0; i < counts->count; ++i) {
+        args[i].counts = counts;
+        args[i].index = counts->first + i;
+        const uint32_t group = i / (TEST_CHILDREN + 1), member = i % (TEST_CHILDREN + 1);
+        if (group % 2 == 0 && member != 0) continue; // Spawned by its parent
+        const Job job = { group % 2 == 0 ? spawn_children : count_run, NULL, &args[i], 0, 0, &counts->counter };
+        batch[queued++] = job;
+    }
+    for (uint32_t i = 0; i < queued; i += TEST_BATCH)
+        job_system_submit(counts->jobs, batch + i, queued - i < TEST_BATCH ? queued - i : TEST_BATCH);
+    job_system_wait(counts->jobs, &counts->counter);
+    free(batch);
+    free(args);
+}
+
+static int injector_main(void* arg)
+{
+    submit_all(arg);
+    return 0;
+}
+
+static void test_exactly_once(JobSystem* jobs)
+{
+    const uint32_t total = TEST_JOBS * (1 + TEST_INJECTORS);
+    uint32_t* runs = calloc(total, sizeof(uint32_t));
+    RunCounts counts[1 + TEST_INJECTORS] = { { 0 } };
+    for (uint32_t i = 0; i <= TEST_INJECTORS; ++i) {
+        counts[i].jobs = jobs;
+        counts[i].runs = runs;
+        counts[i].first = i * TEST_JOBS;
+        counts[i].count = TEST_JOBS;
+    }
+
+    Thread* injectors[TEST_INJECTORS];
+    for (uint32_t i = 0; i < TEST_INJECTORS; ++i) injectors[i] = thread_create(injector_main, "test_inject", &counts[1 + i]);
+    submit_all(&counts[0]);
+    for (uint32_t i = 0; i < TEST_INJECTORS; ++i) thread_join(injectors[i]);
+
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < total; ++i) wrong += runs[i] != 1;
+    CHECK(wrong == 0);
+    for (uint32_t i = 0; i <= TEST_INJECTORS; ++i) CHECK(counts[i].counter.pending == 0);
+    free(runs);
+}
+
+typedef struct Coverage
+{
+    uint32_t* hits;
+    uint32_t  count;
+    uint32_t  bad_ranges; // Empty, reversed or out of bounds
+} Coverage;
+
+static void cover_range(void* data, uint32_t begin, uint32_t end)
+{
+    Coverage* coverage = data;
+    if (begin >= end || end > coverage->count) {
+        atomic_fetch_add_u32(&coverage->bad_ranges, 1);
+        return;
+    }
+    for (uint32_t i = begin; i < end; ++i) atomic_fetch_add_u32(&coverage->hits[i], 1);
+}
+
+static void test_parallel_for(JobSystem* jobs)
+{
+    static const uint32_t counts[6] = { 1, 2, 7, 255, 1000, 100003 };
+    static const uint32_t min_ranges[4] = { 0, 1, 64, 1u << 20 };
+    for (uint32_t c = 0; c < 6; ++c) {
+        for (uint32_t m = 0; m < 4; ++m) {
+            Coverage coverage = { calloc(counts[c], sizeof(uint32_t)), counts[c], 0 };
+            job_system_parallel_for(jobs, counts[c], min_ranges[m], cover_range, &coverage);
+            uint32_t wrong = 0;
+            for (uint32_t i = 0; i < counts[c]; ++i) wrong += coverage.hits[i] != 1;
+            CHECK(wrong == 0 && coverage.bad_ranges == 0);
+            free(coverage.hits);
+        }
+    }
+    job_system_parallel_for(jobs, 0, 1, cover_range, NULL); // Nothing to call
+}
+
+typedef struct SlowJob
+{
+    uint32_t started;
+    uint32_t done;
+} SlowJob;
+
+// Holds a worker long enough for the waiting thread to give up spinning and sleep
+static void slow_job(void* data)
+{
+    SlowJob* slow = data;
+    atomic_store_u32(&slow->started, 1);
+    const uint64_t until = clock_ticks() + clock_frequency() / 20;
+    while (clock_ticks() < until) cpu_relax();
+    atomic_store_u32(&slow->done, 1);
+}
+
+static void test_wait_sleeps(JobSystem* jobs)
+{
+    if (job_system_thread_count(jobs) < 2) return;
+    for (int round = 0; round < 4; ++round) {
+        SlowJob slow = { 0, 0 };
+        EngineJobCounter counter = { 0 };
+        const Job job = { slow_job, NULL, &slow, 0, 0, &counter };
+        job_system_submit(jobs, &job, 1);
+        // Left in this thread's deque until a worker steals it, so the wait has nothing to run
+        while (!atomic_load_u32(&slow.started)) cpu_relax();
+        job_system_wait(jobs, &counter);
+        CHECK(atomic_load_u32(&slow.done) == 1 && counter.pending == 0);
+    }
+}
+
+int main(void)
+{
+    // Inline, with no system
+    test_parallel_for(NULL);
+
+    JobSystem* jobs = job_system_create(TEST_WORKERS);
+    CHECK(jobs != NULL);
+    if (!jobs) return test_finish("job_system_test");
+    CHECK(job_system_thread_count(jobs) == TEST_WORKERS + 1);
+    CHECK(job_system_thread_index(jobs) == 0);
+
+    test_exactly_once(jobs);
+    test_parallel_for(jobs);
+    test_wait_sleeps(jobs);
+    job_system_destroy(jobs);
+    return test_finish("job_system_test");
+}
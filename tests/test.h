@@ -0,0 +1,30 @@
+//
+// Created by Cain Martin on 2025/09/11.
+//
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+// Minimal checks for the engine's unit tests: a failed CHECK reports where and carries on, and
+// test_finish turns the tally into the exit code ctest reads
+static int g_test_checks;
+static int g_test_failures;
+
+#define CHECK(cond)                                                                         \
+    do {                                                                                    \
+        g_test_checks++;                                                                    \
+        if (!(cond)) {                                                                      \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);         \
+            g_test_failures++;                                                              \
+        }                                                                                   \
+    } while (0)
+
+static inline int test_finish(const char* name)
+{
+    printf("%s: %d checks, %d failed\n", name, g_test_checks, g_test_failures);
+    return g_test_failures ? 1 : 0;
+}
+
+#endif //TEST_H
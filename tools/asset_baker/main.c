@@ -0,0 +1,569 @@
+//
+// Created by Cain Martin on 2025/08/31.
+//
+
+// Offline asset baker. Reads a manifest and writes one pack (core/pack_format.h) that the
+// engine maps and uses in place. Each manifest line names one asset; paths are relative to
+// the manifest and '#' starts a comment:
+//
+//   mesh    <name> <file.obj> [compact] [raw] [lods]
+//       compact: half positions, oct normals, unorm UVs
+//       raw: skip engine_mesh_optimize
+//       lods: add the chain engine_mesh_build_lods makes, after optimization
+//   texture <name> <file> [srgb] [nomips] [kaiser]
+//       file: PGM/PPM (binary or ASCII, 8 bits per channel), mips generated with a box filter
+//             or the Kaiser one; or DDS with BC1/3/4/5/7, RGBA8 or R8 data and mips as stored
+//       srgb: color is sRGB encoded - PPM and legacy DXT1/DXT5 DDS cannot say so themselves
+//   shader  <name> <vs.glsl> <fs.glsl>
+//
+//   asset_baker <manifest> <output.pack>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "core/pack_format.h"
+#include "../common/obj_mesh.h"
+
+#define BAKER_MAX_PATH 1024
+
+typedef struct Bytes
+{
+    uint8_t* data;
+    size_t   size;
+    size_t   capacity;
+} Bytes;
+
+typedef struct Baker
+{
+    PackEntry* entries;
+    uint32_t   entry_count;
+    uint32_t   entry_capacity;
+    Bytes      strings;
+    Bytes      blobs;     // Offsets in entries are relative to this until the pack is written
+    char       dir[BAKER_MAX_PATH];
+} Baker;
+
+static bool bytes_reserve(Bytes* bytes, size_t size)
+{
+    if (size <= bytes->capacity) return true;
+    size_t capacity = bytes->capacity ? bytes->capacity : 4096;
+    while (capacity < size) capacity *= 2;
+    uint8_t* data = realloc(bytes->data, capacity);
+    if (!data) return false;
+    bytes->data = data;
+    bytes->capacity = capacity;
+    return true;
+}
+
+// Appends data on a PACK_ALIGN boundary and returns its offset, or SIZE_MAX
+static size_t bytes_push(Bytes* bytes, const void* data, size_t size, size_t align)
+{
+    const size_t offset = (bytes->size + align - 1) & ~(align - 1);
+    if (!bytes_reserve(bytes, offset + size)) return SIZE_MAX;
+    memset(bytes->data + bytes->size, 0, offset - bytes->size);
+    if (size) memcpy(bytes->data + offset, data, size);
+    bytes->size = offset + size;
+    return offset;
+}
+
+static PackEntry* baker_add(Baker* baker, const char* name, PackEntryType type)
+{
+    for (uint32_t i = 0; i < baker->entry_count; ++i) {
+        const PackEntry* entry = &baker->entries[i];
+        if (entry->type == (uint32_t)type && strcmp((const char*)baker->strings.data + entry->name_offset, name) == 0) {
+            fprintf(stderr, "duplicate asset '%s'\n", name);
+            return NULL;
+        }
+    }
+    if (baker->entry_count == baker->entry_capacity) {
+        const uint32_t capacity = baker->entry_capacity ? baker->entry_capacity * 2 : 64;
+        PackEntry* entries = realloc(baker->entries, capacity * sizeof(PackEntry));
+        if (!entries) return NULL;
+        baker->entries = entries;
+        baker->entry_capacity = capacity;
+    }
+
+    const size_t name_offset = bytes_push(&baker->strings, name, strlen(name) + 1, 1);
+    if (name_offset == SIZE_MAX) return NULL;
+    PackEntry* entry = &baker->entries[baker->entry_count++];
+    memset(entry, 0, sizeof *entry);
+    entry->name_hash = pack_name_hash(name);
+    entry->name_offset = (uint32_t)name_offset;
+    entry->type = type;
+    return entry;
+}
+
+// Resolves file against the manifest's directory. False, with the reason on stderr, when the
+// result does not fit in BAKER_MAX_PATH - baking a truncated path would read the wrong file.
+static bool baker_path(const Baker* baker, const char* file, char* out, const char* manifest, uint32_t line_number)
+{
+    const size_t dir = file[0] == '/' || baker->dir[0] == '\0' ? 0 : strlen(baker->dir);
+    const size_t length = strlen(file);
+    if (dir + 1 + length >= BAKER_MAX_PATH) {
+        fprintf(stderr, "%s:%u: path to '%s' is longer than %d bytes\n", manifest, line_number, file, BAKER_MAX_PATH - 1);
+        return false;
+    }
+    if (dir) {
+        memcpy(out, baker->dir, dir);
+        out[dir] = '/';
+        memcpy(out + dir + 1, file, length + 1);
+    } else {
+        memcpy(out, file, length + 1);
+    }
+    return true;
+}
+
+static bool bake_mesh(Baker* baker, const char* name, const char* path, bool compact, bool optimize, bool lods)
+{
+    ObjMesh mesh = { 0 };
+    if (!obj_mesh_load(path, &mesh)) return false;
+
+    bool ok = true;
+    if (optimize) {
+        const EngineMeshDesc desc = {
+            .vertices = mesh.vertices, .vertex_count = mesh.vertex_count,
+            .indices = mesh.indices, .indices_count = mesh.index_count
+        };
+        mesh.vertex_count = engine_mesh_optimize(&desc, mesh.vertices, mesh.indices, NULL);
+        ok = mesh.vertex_count > 0;
+        if (!ok) fprintf(stderr, "%s: optimization failed\n", path);
+    }
+
+    // LOD 0 and every level after it go in one index blob
+    EngineMeshLods chain = { 0 };
+    uint32_t index_count = mesh.index_count;
+    uint32_t* indices = ok && lods ? malloc((size_t)mesh.index_count * 2 * sizeof(uint32_t)) : NULL;
+    if (indices) {
+        const EngineMeshDesc desc = {
+            .vertices = mesh.vertices, .vertex_count = mesh.vertex_count,
+            .indices = mesh.indices, .indices_count = mesh.index_count
+        };
+        memcpy(indices, mesh.indices, mesh.index_count * sizeof(uint32_t));
+        engine_mesh_build_lods(&desc, indices + mesh.index_count, &chain);
+        for (uint32_t l = 0; l < chain.count; ++l) index_count += chain.indices_count[l];
+        printf("%s: %u LODs, %u triangles down to %u\n", path, chain.count, mesh.index_count / 3,
+               chain.count ? chain.indices_count[chain.count - 1] / 3 : mesh.index_count / 3);
+    }
+    ok = ok && (!lods || indices);
+
+    EngineVertexLayout layout = { 0 };
+    if (compact) layout = (EngineVertexLayout){ ENGINE_POSITION_HALF3, ENGINE_NORMAL_OCT16, ENGINE_UV_UNORM16 };
+    const uint32_t stride = engine_vertex_layout_stride(&layout);
+    void* vertices = ok ? malloc((size_t)mesh.vertex_count * stride) : NULL;
+    ok = vertices && engine_vertex_encode(NULL, &layout, mesh.vertices, mesh.vertex_count, vertices);
+
+    PackEntry* entry = ok ? baker_add(baker, name, PACK_ENTRY_MESH) : NULL;
+    if (entry) {
+        const size_t vertex_offset = bytes_push(&baker->blobs, vertices, (size_t)mesh.vertex_count * stride, PACK_ALIGN);
+        const size_t index_offset = bytes_push(&baker->blobs, indices ? indices : mesh.indices, index_count * sizeof(uint32_t), PACK_ALIGN);
+        PackMesh* out = &entry->u.mesh;
+        out->vertices = vertex_offset;
+        out->indices = index_offset;
+        out->vertex_count = mesh.vertex_count;
+        out->index_count = mesh.index_count;
+        out->position = layout.position;
+        out->normal = layout.normal;
+        out->uv = layout.uv;
+        out->lod_count = chain.count;
+        for (uint32_t l = 0; l < chain.count; ++l) {
+            out->lod_index_count[l] = chain.indices_count[l];
+            out->lod_error[l] = chain.error[l];
+        }
+        ok = vertex_offset != SIZE_MAX && index_offset != SIZE_MAX;
+    }
+
+    free(vertices);
+    free(indices);
+    obj_mesh_free(&mesh);
+    return entry && ok;
+}
+
+// Next header token of a PNM file, skipping whitespace and comments
+static bool pnm_token(const char* text, size_t size, size_t* at, unsigned* out)
+{
+    while (*at < size) {
+        if (text[*at] == '#') while (*at < size && text[*at] != '\n') ++*at;
+        else if (text[*at] == ' ' || text[*at] == '\t' || text[*at] == '\r' || text[*at] == '\n') ++*at;
+        else break;
+    }
+    if (*at >= size || text[*at] < '0' || text[*at] > '9') return false;
+    unsigned value = 0;
+    while (*at < size && text[*at] >= '0' && text[*at] <= '9') {
+        value = value * 10 + (unsigned)(text[*at] - '0');
+        if (value > 1u << 24) return false;
+        ++*at;
+    }
+    *out = value;
+    return true;
+}
+
+// P2/P5 load as R8, P3/P6 as RGB8. Values are rescaled when maxval is not 255.
+static uint8_t* load_pnm(const char* path, uint32_t* width, uint32_t* height, EngineTextureFormat* format)
+{
+    EngineFileView view;
+    if (!engine_file_map(path, &view)) return NULL;
+
+    const char* text = view.data;
+    size_t at = 2;
+    unsigned w = 0, h = 0, max = 0;
+    const char kind = view.size > 2 && text[0] == 'P' ? text[1] : 0;
+    const unsigned channels = kind == '2' || kind == '5' ? 1 : kind == '3' || kind == '6' ? 3 : 0;
+    const bool binary = kind == '5' || kind == '6';
+    if (!channels || !pnm_token(text, view.size, &at, &w) || !pnm_token(text, view.size, &at, &h)
+        || !pnm_token(text, view.size, &at, &max) || w == 0 || h == 0 || max == 0 || max > 255) {
+        fprintf(stderr, "%s: not an 8 bit PGM or PPM\n", path);
+        engine_file_unmap(&view);
+        return NULL;
+    }
+
+    const size_t count = (size_t)w * h * channels;
+    uint8_t* pixels = malloc(count);
+    bool ok = pixels != NULL;
+    if (ok && binary) {
+        ++at; // Exactly one whitespace byte separates the header from the raster
+        ok = at <= view.size && count <= view.size - at;
+        if (ok) memcpy(pixels, text + at, count);
+    }
+    for (size_t i = 0; ok && i < count; ++i) {
+        unsigned value = binary ? pixels[i] : 0;
+        if (!binary) ok = pnm_token(text, view.size, &at, &value) && value <= max;
+        pixels[i] = (uint8_t)((value * 255 + max / 2) / max);
+    }
+    engine_file_unmap(&view);
+
+    if (!ok) {
+        fprintf(stderr, "%s: truncated raster\n", path);
+        free(pixels);
+        return NULL;
+    }
+    *width = w;
+    *height = h;
+    *format = channels == 1 ? ENGINE_TEXTURE_R8 : ENGINE_TEXTURE_RGB8;
+    return pixels;
+}
+
+// Reads little-endian words of a DDS header
+static uint32_t read_u32(const uint8_t* bytes)
+{
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+static bool dds_format(const uint8_t* data, size_t size, bool srgb, EngineTextureFormat* format, size_t* data_offset)
+{
+    const uint32_t four_cc = read_u32(data + 84);
+    *data_offset = 128;
+    switch (four_cc) {
+        case 0x31545844: *format = srgb ? ENGINE_TEXTURE_BC1_SRGB : ENGINE_TEXTURE_BC1; return true; // DXT1
+        case 0x35545844: *format = srgb ? ENGINE_TEXTURE_BC3_SRGB : ENGINE_TEXTURE_BC3; return true; // DXT5
+        case 0x31495441: case 0x55344342: *format = ENGINE_TEXTURE_BC4; return true;                 // ATI1, BC4U
+        case 0x32495441: case 0x55354342: *format = ENGINE_TEXTURE_BC5; return true;                 // ATI2, BC5U
+        case 0x30315844: break;                                                                      // DX10
+        default: return false;
+    }
+
+    // DX10 extension: DXGI format, dimension, flags, array size
+    if (size < 148 || read_u32(data + 132) != 3 || read_u32(data + 140) > 1) return false;
+    *data_offset = 148;
+    switch (read_u32(data + 128)) {
+        case 28: *format = srgb ? ENGINE_TEXTURE_SRGB8_A8 : ENGINE_TEXTURE_RGBA8; return true;
+        case 29: *format = ENGINE_TEXTURE_SRGB8_A8; return true;
+        case 61: *format = ENGINE_TEXTURE_R8; return true;
+        case 71: *format = srgb ? ENGINE_TEXTURE_BC1_SRGB : ENGINE_TEXTURE_BC1; return true;
+        case 72: *format = ENGINE_TEXTURE_BC1_SRGB; return true;
+        case 77: *format = srgb ? ENGINE_TEXTURE_BC3_SRGB : ENGINE_TEXTURE_BC3; return true;
+        case 78: *format = ENGINE_TEXTURE_BC3_SRGB; return true;
+        case 80: *format = ENGINE_TEXTURE_BC4; return true;
+        case 83: *format = ENGINE_TEXTURE_BC5; return true;
+        case 98: *format = srgb ? ENGINE_TEXTURE_BC7_SRGB : ENGINE_TEXTURE_BC7; return true;
+        case 99: *format = ENGINE_TEXTURE_BC7_SRGB; return true;
+        default: return false;
+    }
+}
+
+// 2D DDS files as written by texture compressors, with their mip chain as stored. The levels
+// are copied into one buffer and desc points into it.
+static uint8_t* load_dds(const char* path, bool srgb, bool mips, EngineTextureDesc* desc)
+{
+    EngineFileView view;
+    if (!engine_file_map(path, &view)) return NULL;
+
+    const uint8_t* data = view.data;
+    EngineTextureFormat format;
+    size_t at;
+    if (view.size < 128 || read_u32(data + 4) != 124
+        || !dds_format(data, view.size, srgb, &format, &at)) {
+        fprintf(stderr, "%s: not a 2D DDS file in a supported format\n", path);
+        engine_file_unmap(&view);
+        return NULL;
+    }
+
+    const uint32_t height = read_u32(data + 12), width = read_u32(data + 16);
+    const uint32_t stored = read_u32(data + 28) ? read_u32(data + 28) : 1;
+    const int full = engine_texture_mip_count((int)width, (int)height);
+    const int mip_count = !mips ? 1 : (int)stored < full ? (int)stored : full;
+    size_t total = 0;
+    for (int level = 0; level < mip_count; ++level)
+        total += engine_texture_level_size(format, (int)(width >> level ? width >> level : 1), (int)(height >> level ? height >> level : 1));
+
+    uint8_t* levels = NULL;
+    if (width == 0 || height == 0 || width > INT32_MAX || height > INT32_MAX || total == 0 || at + total > view.size) {
+        fprintf(stderr, "%s: truncated or empty DDS\n", path);
+    } else if ((levels = malloc(total)) != NULL) {
+        memcpy(levels, data + at, total);
+        memset(desc, 0, sizeof *desc);
+        desc->width = (int)width;
+        desc->height = (int)height;
+        desc->format = format;
+        desc->pixels = levels;
+        desc->mip_count = mip_count;
+        size_t offset = 0;
+        for (int level = 0; level < mip_count; ++level) {
+            desc->levels[level] = levels + offset;
+            offset += engine_texture_level_size(format, (int)(width >> level ? width >> level : 1), (int)(height >> level ? height >> level : 1));
+        }
+    }
+    engine_file_unmap(&view);
+    return levels;
+}
+
+// PNM sources get their chain from the engine's mip generator
+static uint8_t* load_pnm_chain(const char* path, bool srgb, bool mips, EngineMipFilter filter, EngineTextureDesc* desc)
+{
+    uint32_t width, height;
+    EngineTextureFormat format;
+    uint8_t* pixels = load_pnm(path, &width, &height, &format);
+    if (!pixels) return NULL;
+    if (srgb && format == ENGINE_TEXTURE_RGB8) format = ENGINE_TEXTURE_SRGB8;
+
+    memset(desc, 0, sizeof *desc);
+    desc->width = (int)width;
+    desc->height = (int)height;
+    desc->format = format;
+    desc->pixels = pixels;
+    desc->mip_count = 1;
+    desc->levels[0] = pixels;
+    if (!mips) return pixels;
+
+    // Level 0 and the generated levels share one allocation
+    const size_t base = engine_texture_level_size(format, (int)width, (int)height);
+    uint8_t* chain = realloc(pixels, base + engine_texture_mips_size(format, (int)width, (int)height));
+    if (!chain) {
+        free(pixels);
+        return NULL;
+    }
+    desc->pixels = chain;
+    if (!engine_texture_generate_mips(NULL, desc, filter, chain + base)) {
+        fprintf(stderr, "%s: mip generation failed\n", path);
+        free(chain);
+        return NULL;
+    }
+    return chain;
+}
+
+static bool bake_texture(Baker* baker, const char* name, const char* path, bool srgb, bool mips, EngineMipFilter filter)
+{
+    const size_t length = strlen(path);
+    const bool dds = length > 4 && (strcmp(path + length - 4, ".dds") == 0 || strcmp(path + length - 4, ".DDS") == 0);
+    EngineTextureDesc desc;
+    uint8_t* storage = dds ? load_dds(path, srgb, mips, &desc) : load_pnm_chain(path, srgb, mips, filter, &desc);
+    if (!storage) return false;
+
+    PackEntry* entry = baker_add(baker, name, PACK_ENTRY_TEXTURE);
+    PackMip table[ENGINE_TEXTURE_MAX_MIPS];
+    bool ok = entry != NULL;
+    for (int level = 0; ok && level < desc.mip_count; ++level) {
+        const int w = desc.width >> level ? desc.width >> level : 1, h = desc.height >> level ? desc.height >> level : 1;
+        table[level].size = engine_texture_level_size(desc.format, w, h);
+        table[level].offset = bytes_push(&baker->blobs, desc.levels[level], table[level].size, PACK_ALIGN);
+        ok = table[level].offset != SIZE_MAX;
+    }
+    free(storage);
+
+    const size_t table_offset = ok ? bytes_push(&baker->blobs, table, desc.mip_count * sizeof(PackMip), PACK_ALIGN) : SIZE_MAX;
+    if (!ok || table_offset == SIZE_MAX) return false;
+    PackTexture* out = &entry->u.texture;
+    out->mips = table_offset;
+    out->width = (uint32_t)desc.width;
+    out->height = (uint32_t)desc.height;
+    out->format = desc.format;
+    out->mip_count = (uint32_t)desc.mip_count;
+    return true;
+}
+
+static bool push_source(Baker* baker, const char* path, uint64_t* offset, uint32_t* size)
+{
+    EngineFileView view;
+    if (!engine_file_map(path, &view)) return false;
+
+    const size_t at = bytes_push(&baker->blobs, view.data, view.size, PACK_ALIGN);
+    const char terminator = '\0';
+    const bool ok = at != SIZE_MAX && bytes_push(&baker->blobs, &terminator, 1, 1) != SIZE_MAX;
+    *offset = at;
+    *size = (uint32_t)view.size + 1;
+    engine_file_unmap(&view);
+    return ok;
+}
+
+static bool bake_shader(Baker* baker, const char* name, const char* vs_path, const char* fs_path)
+{
+    PackEntry* entry = baker_add(baker, name, PACK_ENTRY_SHADER);
+    if (!entry) return false;
+    PackShader* out = &entry->u.shader;
+    return push_source(baker, vs_path, &out->vs, &out->vs_size) && push_source(baker, fs_path, &out->fs, &out->fs_size);
+}
+
+static bool bake_line(Baker* baker, char* line, const char* manifest, uint32_t line_number)
+{
+    char* comment = strchr(line, '#');
+    if (comment) *comment = '\0';
+
+    char* words[8];
+    uint32_t count = 0;
+    for (char* word = strtok(line, " \t\r"); word && count < 8; word = strtok(NULL, " \t\r")) words[count++] = word;
+    if (count == 0) return true;
+
+    char path[BAKER_MAX_PATH], path2[BAKER_MAX_PATH];
+    if (strcmp(words[0], "mesh") == 0 && count >= 3) {
+        bool compact = false, optimize = true, lods = false;
+        for (uint32_t i = 3; i < count; ++i) {
+            if (strcmp(words[i], "compact") == 0) compact = true;
+            else if (strcmp(words[i], "raw") == 0) optimize = false;
+            else if (strcmp(words[i], "lods") == 0) lods = true;
+            else fprintf(stderr, "%s:%u: unknown mesh option '%s'\n", manifest, line_number, words[i]);
+        }
+        if (!baker_path(baker, words[2], path, manifest, line_number)) return false;
+        return bake_mesh(baker, words[1], path, compact, optimize, lods);
+    }
+    if (strcmp(words[0], "texture") == 0 && count >= 3) {
+        bool srgb = false, mips = true;
+        EngineMipFilter filter = ENGINE_MIP_FILTER_BOX;
+        for (uint32_t i = 3; i < count; ++i) {
+            if (strcmp(words[i], "srgb") == 0) srgb = true;
+            else if (strcmp(words[i], "nomips") == 0) mips = false;
+            else if (strcmp(words[i], "kaiser") == 0) filter = ENGINE_MIP_FILTER_KAISER;
+            else fprintf(stderr, "%s:%u: unknown texture option '%s'\n", manifest, line_number, words[i]);
+        }
+        if (!baker_path(baker, words[2], path, manifest, line_number)) return false;
+        return bake_texture(baker, words[1], path, srgb, mips, filter);
+    }
+    if (strcmp(words[0], "shader") == 0 && count == 4) {
+        if (!baker_path(baker, words[2], path, manifest, line_number)) return false;
+        if (!baker_path(baker, words[3], path2, manifest, line_number)) return false;
+        return bake_shader(baker, words[1], path, path2);
+    }
+
+    fprintf(stderr, "%s:%u: expected 'mesh', 'texture' or 'shader' and their arguments\n", manifest, line_number);
+    return false;
+}
+
+static int compare_entries(const void* a, const void* b)
+{
+    const PackEntry* x = a;
+    const PackEntry* y = b;
+    if (x->name_hash != y->name_hash) return x->name_hash < y->name_hash ? -1 : 1;
+    if (x->type != y->type) return x->type < y->type ? -1 : 1;
+    return (x->name_offset > y->name_offset) - (x->name_offset < y->name_offset);
+}
+
+static bool write_pack(Baker* baker, const char* path)
+{
+    if (baker->entry_count) qsort(baker->entries, baker->entry_count, sizeof(PackEntry), compare_entries);
+
+    const uint64_t strings_offset = sizeof(PackHeader) + (uint64_t)baker->entry_count * sizeof(PackEntry);
+    const uint64_t blobs_offset = (strings_offset + baker->strings.size + PACK_ALIGN - 1) & ~(uint64_t)(PACK_ALIGN - 1);
+
+    // Texture mip tables live in the blobs too, so they are rebased in place
+    for (uint32_t i = 0; i < baker->entry_count; ++i) {
+        PackEntry* entry = &baker->entries[i];
+        if (entry->type == PACK_ENTRY_MESH) {
+            entry->u.mesh.vertices += blobs_offset;
+            entry->u.mesh.indices += blobs_offset;
+        } else if (entry->type == PACK_ENTRY_TEXTURE) {
+            PackMip* mips = (PackMip*)(baker->blobs.data + entry->u.texture.mips);
+            for (uint32_t level = 0; level < entry->u.texture.mip_count; ++level) mips[level].offset += blobs_offset;
+            entry->u.texture.mips += blobs_offset;
+        } else {
+            entry->u.shader.vs += blobs_offset;
+            entry->u.shader.fs += blobs_offset;
+        }
+    }
+
+    const PackHeader header = {
+        .magic = PACK_MAGIC, .version = PACK_VERSION, .entry_count = baker->entry_count,
+        .strings_size = (uint32_t)baker->strings.size, .strings_offset = strings_offset,
+        .file_size = blobs_offset + baker->blobs.size
+    };
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+    static const uint8_t padding[PACK_ALIGN] = { 0 };
+    fwrite(&header, sizeof header, 1, file);
+    if (baker->entry_count) fwrite(baker->entries, sizeof(PackEntry), baker->entry_count, file);
+    fwrite(baker->strings.data, 1, baker->strings.size, file);
+    fwrite(padding, 1, (size_t)(blobs_offset - strings_offset - baker->strings.size), file);
+    if (baker->blobs.size) fwrite(baker->blobs.data, 1, baker->blobs.size, file);
+    const bool ok = ferror(file) == 0;
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "error writing %s\n", path);
+        return false;
+    }
+
+    printf("%s: %u assets, %llu bytes\n", path, baker->entry_count, (unsigned long long)header.file_size);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        fprintf(stderr, "usage: asset_baker <manifest> <output.pack>\n");
+        return 1;
+    }
+
+    Baker baker;
+    memset(&baker, 0, sizeof baker);
+    const int dir_length = snprintf(baker.dir, sizeof baker.dir, "%s", argv[1]);
+    if (dir_length < 0 || dir_length >= (int)sizeof baker.dir) {
+        fprintf(stderr, "asset_baker: manifest path is longer than %d bytes\n", BAKER_MAX_PATH - 1);
+        return 1;
+    }
+    char* slash = strrchr(baker.dir, '/');
+    if (slash) *slash = '\0';
+    else baker.dir[0] = '\0';
+
+    EngineFileView view;
+    if (!engine_file_map(argv[1], &view)) return 1;
+
+    // The table of contents needs a string table even when the manifest is empty
+    bool ok = bytes_push(&baker.strings, "", 1, 1) != SIZE_MAX;
+    const char* text = view.data;
+    size_t at = 0;
+    for (uint32_t line_number = 1; ok && at < view.size; ++line_number) {
+        char line[BAKER_MAX_PATH * 3];
+        size_t length = 0;
+        bool clipped = false;
+        while (at < view.size && text[at] != '\n') {
+            if (length + 1 < sizeof line) line[length++] = text[at];
+            else clipped = true;
+            ++at;
+        }
+        ++at;
+        line[length] = '\0';
+        if (clipped) {
+            fprintf(stderr, "%s:%u: line is longer than %zu bytes\n", argv[1], line_number, sizeof line - 1);
+            ok = false;
+        } else {
+            ok = bake_line(&baker, line, argv[1], line_number);
+        }
+    }
+    engine_file_unmap(&view);
+
+    ok = ok && write_pack(&baker, argv[2]);
+    free(baker.entries);
+    free(baker.strings.data);
+    free(baker.blobs.data);
+    return ok ? 0 : 1;
+}
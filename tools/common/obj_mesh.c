@@ -0,0 +1,167 @@
+//
+// Created by Cain Martin on 2025/08/31.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "obj_mesh.h"
+
+typedef struct FloatList
+{
+    float*   data;
+    uint32_t count;    // Floats
+    uint32_t capacity;
+} FloatList;
+
+static bool grow(void** data, uint32_t* capacity, uint32_t needed, size_t elem_size)
+{
+    if (needed <= *capacity) return true;
+    uint32_t capacity_new = *capacity ? *capacity : 1024;
+    while (capacity_new < needed) capacity_new *= 2;
+    void* data_new = realloc(*data, capacity_new * elem_size);
+    if (!data_new) return false;
+    *data = data_new;
+    *capacity = capacity_new;
+    return true;
+}
+
+static bool push_floats(FloatList* list, const float* values, uint32_t count)
+{
+    if (!grow((void**)&list->data, &list->capacity, list->count + count, sizeof(float))) return false;
+    memcpy(list->data + list->count, values, count * sizeof(float));
+    list->count += count;
+    return true;
+}
+
+bool obj_mesh_push_vertex(ObjMesh* mesh, const EngineVertex* vertex)
+{
+    if (!grow((void**)&mesh->vertices, &mesh->vertex_capacity, mesh->vertex_count + 1, sizeof(EngineVertex))) return false;
+    mesh->vertices[mesh->vertex_count++] = *vertex;
+    return true;
+}
+
+bool obj_mesh_push_index(ObjMesh* mesh, uint32_t index)
+{
+    if (!grow((void**)&mesh->indices, &mesh->index_capacity, mesh->index_count + 1, sizeof(uint32_t))) return false;
+    mesh->indices[mesh->index_count++] = index;
+    return true;
+}
+
+// 1-based, negative counts back from the end; returns -1 when out of range
+static long resolve_index(long index, uint32_t count)
+{
+    if (index > 0 && (uint32_t)index <= count) return index - 1;
+    if (index < 0 && (uint32_t)(-index) <= count) return (long)count + index;
+    return -1;
+}
+
+// One face corner, "p", "p/t", "p//n" or "p/t/n"
+static bool parse_corner(const char* token, const FloatList* p, const FloatList* t, const FloatList* n, EngineVertex* out)
+{
+    memset(out, 0, sizeof *out);
+    char* end;
+    const long pi = resolve_index(strtol(token, &end, 10), p->count / 3);
+    if (pi < 0) return false;
+    memcpy(out->pos, p->data + pi * 3, sizeof out->pos);
+
+    if (*end != '/') return true;
+    token = end + 1;
+    if (*token != '/') {
+        const long ti = resolve_index(strtol(token, &end, 10), t->count / 2);
+        if (ti >= 0) memcpy(out->uv, t->data + ti * 2, sizeof out->uv);
+        token = end;
+    }
+    if (*token != '/') return true;
+    const long ni = resolve_index(strtol(token + 1, &end, 10), n->count / 3);
+    if (ni >= 0) memcpy(out->normal, n->data + ni * 3, sizeof out->normal);
+    return true;
+}
+
+bool obj_mesh_load(const char* path, ObjMesh* mesh)
+{
+    EngineFileView view;
+    if (!engine_file_map(path, &view)) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+
+    FloatList positions = { 0 }, uvs = { 0 }, normals = { 0 };
+    const char* text = view.data;
+    size_t at = 0;
+    bool ok = true;
+
+    while (ok && at < view.size) {
+        char line[1024];
+        size_t length = 0;
+        while (at < view.size && text[at] != '\n') {
+            if (length + 1 < sizeof line) line[length++] = text[at];
+            ++at;
+        }
+        ++at;
+        line[length] = '\0';
+
+        float v[3];
+        if (strncmp(line, "v ", 2) == 0 && sscanf(line + 2, "%f %f %f", &v[0], &v[1], &v[2]) == 3) {
+            ok = push_floats(&positions, v, 3);
+        } else if (strncmp(line, "vt ", 3) == 0 && sscanf(line + 3, "%f %f", &v[0], &v[1]) == 2) {
+            ok = push_floats(&uvs, v, 2);
+        } else if (strncmp(line, "vn ", 3) == 0 && sscanf(line + 3, "%f %f %f", &v[0], &v[1], &v[2]) == 3) {
+            ok = push_floats(&normals, v, 3);
+        } else if (strncmp(line, "f ", 2) == 0) {
+            // Polygons are fanned into triangles
+            uint32_t first = mesh->vertex_count, corners = 0;
+            for (char* token = strtok(line + 2, " \t\r"); token && ok; token = strtok(NULL, " \t\r")) {
+                EngineVertex vertex;
+                if (!parse_corner(token, &positions, &uvs, &normals, &vertex)) {
+                    fprintf(stderr, "%s: bad face corner '%s'\n", path, token);
+                    ok = false;
+                    break;
+                }
+                ok = obj_mesh_push_vertex(mesh, &vertex);
+                if (ok && ++corners >= 3) {
+                    ok = obj_mesh_push_index(mesh, first) && obj_mesh_push_index(mesh, mesh->vertex_count - 2)
+                        && obj_mesh_push_index(mesh, mesh->vertex_count - 1);
+                }
+            }
+        }
+    }
+
+    free(positions.data);
+    free(uvs.data);
+    free(normals.data);
+    engine_file_unmap(&view);
+    if (ok && mesh->index_count == 0) fprintf(stderr, "%s: no faces\n", path);
+    return ok && mesh->index_count > 0;
+}
+
+bool obj_mesh_write(const char* path, const ObjMesh* mesh)
+{
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "# %u vertices, %u triangles\n", mesh->vertex_count, mesh->index_count / 3);
+    for (uint32_t i = 0; i < mesh->vertex_count; ++i) {
+        const EngineVertex* v = &mesh->vertices[i];
+        fprintf(file, "v %.9g %.9g %.9g\nvt %.9g %.9g\nvn %.9g %.9g %.9g\n",
+                v->pos[0], v->pos[1], v->pos[2], v->uv[0], v->uv[1], v->normal[0], v->normal[1], v->normal[2]);
+    }
+    for (uint32_t i = 0; i < mesh->index_count; i += 3) {
+        const uint32_t a = mesh->indices[i] + 1, b = mesh->indices[i + 1] + 1, c = mesh->indices[i + 2] + 1;
+        fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+    }
+
+    const bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
+
+void obj_mesh_free(ObjMesh* mesh)
+{
+    free(mesh->vertices);
+    free(mesh->indices);
+    memset(mesh, 0, sizeof *mesh);
+}
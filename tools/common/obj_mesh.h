@@ -0,0 +1,32 @@
+//
+// Created by Cain Martin on 2025/08/31.
+//
+
+#ifndef OBJ_MESH_H
+#define OBJ_MESH_H
+
+#include "engine.h"
+
+// Wavefront OBJ reading and writing shared by the offline tools. Heap memory is the C
+// runtime's, not the engine's - tools run outside any Engine.
+
+typedef struct ObjMesh
+{
+    EngineVertex* vertices;
+    uint32_t      vertex_count;
+    uint32_t      vertex_capacity;
+    uint32_t*     indices;
+    uint32_t      index_count;
+    uint32_t      index_capacity;
+} ObjMesh;
+
+// Every face corner becomes its own vertex and polygons are fanned into triangles;
+// deduplication is engine_mesh_optimize's job. Appends to mesh.
+bool obj_mesh_load(const char* path, ObjMesh* mesh);
+bool obj_mesh_write(const char* path, const ObjMesh* mesh);
+void obj_mesh_free(ObjMesh* mesh);
+
+bool obj_mesh_push_vertex(ObjMesh* mesh, const EngineVertex* vertex);
+bool obj_mesh_push_index(ObjMesh* mesh, uint32_t index);
+
+#endif //OBJ_MESH_H
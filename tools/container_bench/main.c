@@ -0,0 +1,214 @@
+//
+// Created by Cain Martin on 2025/09/10.
+//
+
+// Headless benchmark of the core containers on the job they are used for: values keyed by
+// handle slot. Compares a flat array indexed by slot, a SparseSet and a HashMap for lookups
+// (hits and misses), iteration over every value, and insert/remove churn, at a few fill
+// levels of R_MAX_MESHES slots. Prints nanoseconds per operation and the memory each holds.
+//
+//   container_bench [rounds]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "core/d_array.h"
+#include "core/hash_map.h"
+#include "core/sparse_set.h"
+#include "graphics/renderer.h"
+#include "platform/clock.h"
+
+#define BENCH_SLOTS   R_MAX_MESHES
+#define BENCH_LOOKUPS (1u << 20)
+
+typedef struct Value
+{
+    float    data[7];
+    uint32_t key;
+} Value;
+
+typedef struct Result
+{
+    double lookup_ns;
+    double iterate_ns;
+    double churn_ns;
+    size_t bytes;
+} Result;
+
+static double g_ns_per_tick;
+static volatile uint32_t g_sink; // Keeps the timed loops from being optimised away
+
+static uint32_t next_random(uint32_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static double elapsed_ns(uint64_t start) { return (double)(clock_ticks() - start) * g_ns_per_tick; }
+
+static size_t d_array_bytes(const DArray* array) { return (size_t)array->capacity * array->elem_size; }
+
+// Keys to store and keys to look up, half of the lookups missing
+static void make_keys(uint32_t* keys, uint32_t count, uint32_t* lookups)
+{
+    uint32_t* slots = malloc(BENCH_SLOTS * sizeof(uint32_t));
+    for (uint32_t i = 0; i < BENCH_SLOTS; ++i) slots[i] = i;
+    uint32_t state = 0x9e3779b9u;
+    for (uint32_t i = BENCH_SLOTS - 1; i > 0; --i) {
+        const uint32_t o = next_random(&state) % (i + 1), swap = slots[i];
+        slots[i] = slots[o];
+        slots[o] = swap;
+    }
+    memcpy(keys, slots, count * sizeof(uint32_t));
+    for (uint32_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        const uint32_t r = next_random(&state);
+        lookups[i] = (r & 1) ? keys[(r >> 1) % count] : slots[count + (r >> 1) % (BENCH_SLOTS - count)];
+    }
+    free(slots);
+}
+
+static Result bench_flat(const uint32_t* keys, uint32_t count, const uint32_t* lookups)
+{
+    Result result = { 0 };
+    Value* values = calloc(BENCH_SLOTS, sizeof(Value));
+    for (uint32_t i = 0; i < count; ++i) values[keys[i]].key = keys[i] + 1;
+    result.bytes = BENCH_SLOTS * sizeof(Value);
+
+    uint32_t sum = 0;
+    uint64_t start = clock_ticks();
+    for (uint32_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        const Value* v = &values[lookups[i]];
+        if (v->key) sum += v->key;
+    }
+    result.lookup_ns = elapsed_ns(start) / BENCH_LOOKUPS;
+
+    // Without a dense list every slot is visited
+    start = clock_ticks();
+    for (uint32_t i = 0; i < BENCH_SLOTS; ++i) {
+        if (values[i].key) sum += values[i].key;
+    }
+    result.iterate_ns = elapsed_ns(start) / count;
+
+    start = clock_ticks();
+    for (uint32_t i = 0; i < count; ++i) memset(&values[keys[i]], 0, sizeof(Value));
+    for (uint32_t i = 0; i < count; ++i) values[keys[i]].key = keys[i] + 1;
+    result.churn_ns = elapsed_ns(start) / (2.0 * count);
+
+    g_sink += sum;
+    free(values);
+    return result;
+}
+
+static Result bench_sparse(const uint32_t* keys, uint32_t count, const uint32_t* lookups)
+{
+    Result result = { 0 };
+    SparseSet set;
+    sparse_set_init(&set, sizeof(Value), 0, NULL);
+    for (uint32_t i = 0; i < count; ++i) ((Value*)sparse_set_insert(&set, keys[i]))->key = keys[i] + 1;
+    result.bytes = d_array_bytes(&set.sparse) + d_array_bytes(&set.keys) + d_array_bytes(&set.values);
+
+    uint32_t sum = 0;
+    uint64_t start = clock_ticks();
+    for (uint32_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        const Value* v = sparse_set_get(&set, lookups[i]);
+        if (v) sum += v->key;
+    }
+    result.lookup_ns = elapsed_ns(start) / BENCH_LOOKUPS;
+
+    start = clock_ticks();
+    const Value* values = D_ARRAY_DATA(&set.values, Value);
+    for (uint32_t i = 0; i < sparse_set_count(&set); ++i) sum += values[i].key;
+    result.iterate_ns = elapsed_ns(start) / count;
+
+    start = clock_ticks();
+    for (uint32_t i = 0; i < count; ++i) sparse_set_remove(&set, keys[i]);
+    for (uint32_t i = 0; i < count; ++i) ((Value*)sparse_set_insert(&set, keys[i]))->key = keys[i] + 1;
+    result.churn_ns = elapsed_ns(start) / (2.0 * count);
+
+    g_sink += sum;
+    sparse_set_free(&set);
+    return result;
+}
+
+static Result bench_hash(const uint32_t* keys, uint32_t count, const uint32_t* lookups)
+{
+    Result result = { 0 };
+    HashMap map;
+    hash_map_init(&map, sizeof(Value), 0, NULL);
+    for (uint32_t i = 0; i < count; ++i) ((Value*)hash_map_insert(&map, keys[i], NULL))->key = keys[i] + 1;
+    result.bytes = d_array_bytes(&map.keys) + d_array_bytes(&map.used) + d_array_bytes(&map.values);
+
+    uint32_t sum = 0;
+    uint64_t start = clock_ticks();
+    for (uint32_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        const Value* v = hash_map_get(&map, lookups[i]);
+        if (v) sum += v->key;
+    }
+    result.lookup_ns = elapsed_ns(start) / BENCH_LOOKUPS;
+
+    start = clock_ticks();
+    uint32_t cursor = 0;
+    uint64_t key;
+    void* value;
+    while (hash_map_next(&map, &cursor, &key, &value)) sum += ((const Value*)value)->key;
+    result.iterate_ns = elapsed_ns(start) / count;
+
+    start = clock_ticks();
+    for (uint32_t i = 0; i < count; ++i) hash_map_remove(&map, keys[i]);
+    for (uint32_t i = 0; i < count; ++i) ((Value*)hash_map_insert(&map, keys[i], NULL))->key = keys[i] + 1;
+    result.churn_ns = elapsed_ns(start) / (2.0 * count);
+
+    g_sink += sum;
+    hash_map_free(&map);
+    return result;
+}
+
+static void keep_best(Result* best, Result r)
+{
+    if (r.lookup_ns < best->lookup_ns) best->lookup_ns = r.lookup_ns;
+    if (r.iterate_ns < best->iterate_ns) best->iterate_ns = r.iterate_ns;
+    if (r.churn_ns < best->churn_ns) best->churn_ns = r.churn_ns;
+    best->bytes = r.bytes;
+}
+
+int main(int argc, char** argv)
+{
+    const int rounds = argc > 1 ? atoi(argv[1]) : 5;
+    if (rounds <= 0) {
+        fprintf(stderr, "usage: container_bench [rounds]\n");
+        return 1;
+    }
+    g_ns_per_tick = 1e9 / (double)clock_frequency();
+
+    uint32_t* keys = malloc(BENCH_SLOTS * sizeof(uint32_t));
+    uint32_t* lookups = malloc(BENCH_LOOKUPS * sizeof(uint32_t));
+    if (!keys || !lookups) {
+        fprintf(stderr, "container_bench: out of memory\n");
+        return 1;
+    }
+
+    static const char* names[3] = { "flat array", "sparse set", "hash map" };
+    static const uint32_t fills[3] = { 64, 1024, BENCH_SLOTS / 2 };
+    printf("%u slots, %u lookups (half missing), best of %d\n", BENCH_SLOTS, BENCH_LOOKUPS, rounds);
+    printf("%-8s %-12s %10s %10s %10s %10s\n", "values", "container", "lookup ns", "iterate ns", "churn ns", "KiB");
+    for (int f = 0; f < 3; ++f) {
+        const uint32_t count = fills[f];
+        make_keys(keys, count, lookups);
+        for (int c = 0; c < 3; ++c) {
+            Result best = { 1e30, 1e30, 1e30, 0 };
+            for (int r = 0; r < rounds; ++r) {
+                keep_best(&best, c == 0 ? bench_flat(keys, count, lookups)
+                               : c == 1 ? bench_sparse(keys, count, lookups)
+                                        : bench_hash(keys, count, lookups));
+            }
+            printf("%-8u %-12s %10.2f %10.2f %10.2f %10.1f\n", count, names[c], best.lookup_ns, best.iterate_ns,
+                   best.churn_ns, (double)best.bytes / 1024.0);
+        }
+    }
+
+    free(lookups);
+    free(keys);
+    return 0;
+}
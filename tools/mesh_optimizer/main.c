@@ -0,0 +1,89 @@
+//
+// Created by Cain Martin on 2025/08/30.
+//
+
+// Offline mesh optimizer. Reads a Wavefront OBJ, runs engine_mesh_optimize on it and reports
+// post-transform cache efficiency before and after; writes the result as OBJ when given an
+// output path. With no arguments it optimizes a generated sphere with scrambled triangles.
+//
+//   mesh_optimizer [input.obj [output.obj]]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "../common/obj_mesh.h"
+
+// UV sphere with one vertex per triangle corner and triangles in random order - a worst
+// case for the cache, like an exporter that writes faces unsorted and unwelded
+static bool generate_sphere(ObjMesh* mesh, uint32_t rings, uint32_t segments)
+{
+    const float pi = 3.14159265f;
+    for (uint32_t r = 0; r < rings; ++r) {
+        for (uint32_t s = 0; s < segments; ++s) {
+            EngineVertex quad[4];
+            for (int c = 0; c < 4; ++c) {
+                const float u = (float)(s + (c & 1)) / (float)segments, v = (float)(r + (c >> 1)) / (float)rings;
+                const float theta = u * 2.0f * pi, phi = v * pi;
+                EngineVertex* q = &quad[c];
+                q->normal[0] = sinf(phi) * cosf(theta);
+                q->normal[1] = cosf(phi);
+                q->normal[2] = sinf(phi) * sinf(theta);
+                memcpy(q->pos, q->normal, sizeof q->pos);
+                q->uv[0] = u;
+                q->uv[1] = v;
+            }
+            const int corners[6] = { 0, 2, 1, 1, 2, 3 };
+            for (int c = 0; c < 6; ++c) {
+                if (!obj_mesh_push_vertex(mesh, &quad[corners[c]]) || !obj_mesh_push_index(mesh, mesh->vertex_count - 1)) return false;
+            }
+        }
+    }
+
+    srand(1);
+    for (uint32_t t = mesh->index_count / 3 - 1; t > 0; --t) {
+        const uint32_t o = (uint32_t)rand() % (t + 1);
+        for (int c = 0; c < 3; ++c) {
+            const uint32_t swap = mesh->indices[t * 3 + c];
+            mesh->indices[t * 3 + c] = mesh->indices[o * 3 + c];
+            mesh->indices[o * 3 + c] = swap;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    ObjMesh mesh = { 0 };
+    const bool loaded = argc > 1 ? obj_mesh_load(argv[1], &mesh) : generate_sphere(&mesh, 64, 128);
+    if (!loaded) {
+        obj_mesh_free(&mesh);
+        return 1;
+    }
+
+    const EngineMeshDesc desc = {
+        .vertices = mesh.vertices, .vertex_count = mesh.vertex_count,
+        .indices = mesh.indices, .indices_count = mesh.index_count
+    };
+    EngineMeshOptimizeStats stats;
+    const uint32_t vertex_count = engine_mesh_optimize(&desc, mesh.vertices, mesh.indices, &stats);
+    if (vertex_count == 0) {
+        fprintf(stderr, "optimization failed - indices out of range or not a triangle list\n");
+        obj_mesh_free(&mesh);
+        return 1;
+    }
+    mesh.vertex_count = vertex_count;
+
+    const unsigned index_bits = vertex_count <= 65536 ? 16 : 32;
+    printf("%s: %u triangles\n", argc > 1 ? argv[1] : "generated sphere", mesh.index_count / 3);
+    printf("            before     after\n");
+    printf("vertices  %8u  %8u\n", stats.vertices_before, stats.vertices_after);
+    printf("ACMR      %8.3f  %8.3f\n", stats.acmr_before, stats.acmr_after);
+    printf("ATVR      %8.3f  %8.3f\n", stats.atvr_before, stats.atvr_after);
+    printf("bits/idx  %8u  %8u\n", 32u, index_bits);
+
+    const bool ok = argc <= 2 || obj_mesh_write(argv[2], &mesh);
+    obj_mesh_free(&mesh);
+    return ok ? 0 : 1;
+}